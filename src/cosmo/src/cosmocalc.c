@@ -224,6 +224,7 @@ int cosmocalc_batch(char *inname, char *outname)
   int contin=1;       /* Flag set to 0 to break loop */
   int no_error=1;     /* Flag set to 0 on error */
   int nz=0;           /* Number of redshifts */
+  int nalloc=0;       /* Number of elements allocated in z */
   double *z=NULL;     /* Lens redshift */
   double *zptr;       /* Pointer to navigate z */
   double dz=0.0;      /* Error on lens redshift */
@@ -245,45 +246,30 @@ int cosmocalc_batch(char *inname, char *outname)
     no_error = 0;
 
   /*
-   * Get number of lines in input file
-   */
-
-  if(no_error) {
-    if((nz = n_lines(ifp,'#')) == 0) {
-      fprintf(stderr,"ERROR: No valid data in %s.\n",inname);
-      no_error = 0;
-    }
-    else {
-      rewind(ifp);
-    }
-  }
-
-  /*
-   * Allocate memory for redshift array.
-   */
-
-  if(no_error) {
-    if(!(z = new_doubarray(nz)))
-      no_error = 0;
-    else
-      zptr = z;
-  }
-
-  /*
-   * Read in redshifts
+   * Read in redshifts in a single pass, growing the array as needed
    */
 
   while(no_error && fgets(line,MAXC,ifp) != NULL) {
     if(line[0] != comment) {
+      if(!(z = (double *) grow_array(z,&nalloc,nz+1,sizeof(double)))) {
+	no_error = 0;
+	break;
+      }
+      zptr = z + nz;
       if(sscanf(line,"%lf",zptr) != 1) {
 	fprintf(stderr,"ERROR: Invalid data format in %s\n",inname);
 	no_error = 0;
       }
       else
-	zptr++;
+	nz++;
     }
   }
 
+  if(no_error && nz == 0) {
+    fprintf(stderr,"ERROR: No valid data in %s.\n",inname);
+    no_error = 0;
+  }
+
   /*
    * Print out header info
    */
@@ -8,6 +8,8 @@
  * 09Apr2005 CDF,  First version
  * 02Feb2007 CDF,  Got rid of old distance calculations and replaced with
  *                  newer calc_cosdist library function
+ * 16Oct2026 AGT,  find_median now uses median_select on a workspace that
+ *                  is allocated once, instead of sorting on every call
  *
  */
 
@@ -18,6 +20,7 @@
 #include "structdef.h"
 #include "dataio.h"
 #include "cosmo.h"
+#include "catlib.h"
 
 typedef struct {
   int id;            /* Galaxy ID */
@@ -37,7 +40,7 @@ void search_radii(double sigma_obs, double z, double Hz, double da,
 		  double *dzmax, double *drmax, double *dthmax);
 int select_members(Zcat *zcat, int ncat, Zcat zmed, double dzmax,
 		    double dthmax, Zcat *gcat, int *ngroup);
-Zcat find_median(Zcat *gcat, int ngroup);
+Zcat find_median(Zcat *gcat, int ngroup, double *work);
 double sigma_gapper(Zcat *gcat, int ngroup);
 int doubcmp(const void *v1, const void *v2);
 
@@ -74,6 +77,7 @@ int main(int argc, char *argv[])
   Zcat *zcat=NULL;       /* Redshift catalog */
   Zcat *gcat=NULL;       /* Group catalog */
   Zcat *gcat2=NULL;      /* Previous version of the group catalog */
+  double *medwork=NULL;  /* Workspace for find_median */
   Zcat *gptr,*gptr2;     /* Pointers to navigate Zcats */
 
   /*
@@ -104,6 +108,8 @@ int main(int argc, char *argv[])
     no_error = 0;
   if(!(gcat2 = new_zcat(nlines)))
     no_error = 0;
+  if(!(medwork = new_doubarray(nlines)))
+    no_error = 0;
 
   /*
    * Initialize world model
@@ -239,7 +245,7 @@ int main(int argc, char *argv[])
        */
 
       if(no_error) {
-	zmed = find_median(gcat,ngroup);
+	zmed = find_median(gcat,ngroup,medwork);
 	if(zmed.z < 0)
 	  no_error = 0;
       }
@@ -287,6 +293,7 @@ int main(int argc, char *argv[])
   zcat = del_zcat(zcat);
   gcat = del_zcat(gcat);
   gcat2 = del_zcat(gcat2);
+  medwork = del_doubarray(medwork);
   
 
   printf("\n");
@@ -620,82 +627,48 @@ double sigma_gapper(Zcat *gcat, int ngroup)
  *
  * Function find_median
  *
- * Finds the median redshift and position for a group
+ * Finds the median redshift and position for a group.  Each median is 
+ *  found with median_select on a copy of the values in work, which takes
+ *  O(n) time and needs no memory of its own, since this function is 
+ *  called on every pass through the membership loop.
  *
  * Inputs: Zcat *gcat          group catalog
  *         int ngroup          number of group members
+ *         double *work        workspace of at least ngroup elements
  *
  * Output: Zcat medpos         container for median values
  */
 
-Zcat find_median(Zcat *gcat, int ngroup)
+Zcat find_median(Zcat *gcat, int ngroup, double *work)
 {
   int i;               /* Looping variable */
-  int medpos;          /* Position of median in sorted array */
-  int avgflag;         /* Flag set to 1 if averaging is needed */
-  double *temp=NULL;   /* Temporary container for redshift, x, and y */
-  double *dptr;        /* Pointer to navigate temp */
+  double *dptr;        /* Pointer to navigate work */
   Zcat zmed;           /* Median position */
   Zcat *gptr;          /* Pointer to navigate gcat */
 
   /*
-   * Allocate memory for temporary array
-   */
-
-  if(!(temp = new_doubarray(ngroup))) {
-    fprintf(stderr,"ERROR: find_median\n");
-    zmed.z = -999.0;
-    return zmed;
-  }
-
-  /*
-   * Find index location of median
-   */
-
-  if((ngroup/2.0) - floor(ngroup/2.0) == 0.0) {
-    avgflag = 1;
-    medpos = floor(ngroup/2) - 1;
-  }
-  else {
-    avgflag = 0;
-    medpos = floor(ngroup/2.0);
-  }
-
-  /*
-   * Median z
+   * Median x
    */
 
-  for(i=0,gptr=gcat,dptr=temp; i<ngroup; i++,gptr++,dptr++)
+  for(i=0,gptr=gcat,dptr=work; i<ngroup; i++,gptr++,dptr++)
     *dptr = gptr->x;
-  qsort(temp,ngroup,sizeof(double),doubcmp);
-  if(avgflag)
-    zmed.x = (*(temp+medpos) + *(temp+medpos+1)) / 2.0;
-  else
-    zmed.x = *(temp+medpos);
+  zmed.x = median_select(work,ngroup);
   
   /*
-   * Median z
+   * Median y
    */
 
-  for(i=0,gptr=gcat,dptr=temp; i<ngroup; i++,gptr++,dptr++)
+  for(i=0,gptr=gcat,dptr=work; i<ngroup; i++,gptr++,dptr++)
     *dptr = gptr->y;
-  qsort(temp,ngroup,sizeof(double),doubcmp);
-  if(avgflag)
-    zmed.y = (*(temp+medpos) + *(temp+medpos+1)) / 2.0;
-  else
-    zmed.y = *(temp+medpos);
+  zmed.y = median_select(work,ngroup);
   
   /*
    * Median z
    */
 
-  for(i=0,gptr=gcat,dptr=temp; i<ngroup; i++,gptr++,dptr++)
+  for(i=0,gptr=gcat,dptr=work; i<ngroup; i++,gptr++,dptr++)
     *dptr = gptr->z;
-  qsort(temp,ngroup,sizeof(double),doubcmp);
-  if(avgflag)
-    zmed.z = (*(temp+medpos) + *(temp+medpos+1)) / 2.0;
-  else
-    zmed.z = *(temp+medpos);
+  zmed.z = median_select(work,ngroup);
 
   /*
    * Give results
@@ -704,11 +677,6 @@ Zcat find_median(Zcat *gcat, int ngroup)
   printf("find_median: Median position = (%5.0f,%5.0f)\n",zmed.x,zmed.y);
   printf("find_median: Median redshift = %6.4f\n",zmed.z);
 
-  /*
-   * Clean up and exit
-   */
-
-  temp = del_doubarray(temp);
   return zmed;
 }
 
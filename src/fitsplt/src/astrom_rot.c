@@ -1,12 +1,17 @@
 /* astrom_rot.c
  *
- * Usage: astrom_rot fitsfile astrofile xycatfile ([setup_filename])
+ * Usage: astrom_rot (-a) fitsfile astrofile xycatfile ([setup_filename])
  *
  * Description:  Plots a FITS file as a greyscale plot and then overlays
  *                the positions of a starlist (e.g., USNO stars) at a
  *                given angle.  The user can then interactively rotate the 
  *                PA of the starlist to get a first estimate of the PA
  *                of the image.
+ *               With the -a flag, the lens position, the PA and the pixel
+ *                scale are instead found without any plotting or typed
+ *                input, by matching triangles of bright stars in the 
+ *                starlist and the catalog (see match_asterisms in 
+ *                catlib.c).
  *
  * To compile use the appropriate makefile in this directory.
  *
@@ -28,6 +33,10 @@
  *                  display_image.
  * v2008Jul16 CDF, Small modifications to incorporate new image reading
  *                  and display-opening functions. 
+ * v2026Oct16 AGT, Added the -a flag and the get_auto_pa function.
+ *                 print_astfile now takes the maximum offset for a good
+ *                  match, and only asks for it if that is not positive.
+ *                 Fixed reading of the optional setup file name.
  *
  */
 
@@ -40,9 +49,11 @@
 #include "structdef.h"
 #include "coords.h"
 #include "dataio.h"
+#include "catlib.h"
 #include "fitsim.h"
 
 #define SIZE 30
+#define MATCHLIM 3.0     /* Maximum pixel offset for a "good" match */
 
 /*.......................................................................
  *
@@ -50,12 +61,14 @@
  *
  */
 
+int get_auto_pa(Secat *astcat, int nast, Secat *xycat, int nxy, 
+		Setup *setup, Simtrans *trans);
 int pa2dpos(double centx, double centy, double pa, Secat *secat, Setup *setup);
 int print_clscript(Setup *setup, Secat *astcat, char *fitsname, char *clname);
 Secat *find_match(Setup *setup, Secat *astcat, Secat *xycat, int nxy,
 		  int *nmatch);
 int print_astfile(Setup *setup, Secat *matchcat, int nmatch, char *pfname,
-		  int format);
+		  int format, float maxoffset);
 
 
 /*.......................................................................
@@ -68,6 +81,8 @@ int main(int argc, char *argv[])
 {
   int no_error=1;       /* Flag set to 0 on error */
   int usefile=0;        /* Flag set to 1 to use input setup file */
+  int autopa=0;         /* Flag set to 1 to find the PA automatically */
+  int firstarg=1;       /* argv index of the first file name */
   int another_loop=1;   /* Flag set to 0 to stop loop of PA changes */
   int screenflag=1;     /* Flag set to 0 for no screen output */
   int fileflag=1;       /* Flag set to 0 for no screen output */
@@ -88,14 +103,22 @@ int main(int argc, char *argv[])
   Secat *astdat=NULL;   /* Astrometric data */
   Secat *catdat=NULL;   /* SExtractor catalog data */
   Secat *matchcat=NULL; /* Catalog of matches */
+  Simtrans trans;       /* Transform found by get_auto_pa */
   Labinfo *lptr;
 
   /*
    * Check the command line
    */
 
-  if(argc < 4) {
-    fprintf(stderr,"\nastrom_rot fitsfile astrofile xycatfile (setupfile)\n\n");
+  if(argc > 1 && strcmp(argv[1],"-a") == 0) {
+    autopa = 1;
+    firstarg = 2;
+  }
+  if(argc < firstarg + 3) {
+    fprintf(stderr,"\nastrom_rot (-a) fitsfile astrofile xycatfile ");
+    fprintf(stderr,"(setupfile)\n\n");
+    fprintf(stderr," -a  Find the lens position and PA without plotting or ");
+    fprintf(stderr,"typed input\n\n");
     return 1;
   }
 
@@ -103,12 +126,12 @@ int main(int argc, char *argv[])
    * Get the names of the files.
    */
 
-  strcpy(fitsfile,argv[1]);
-  strcpy(astfile,argv[2]);
-  strcpy(catfile,argv[3]);
-  if(argc == 5) {
+  strcpy(fitsfile,argv[firstarg]);
+  strcpy(astfile,argv[firstarg+1]);
+  strcpy(catfile,argv[firstarg+2]);
+  if(argc == firstarg + 4) {
     usefile = 1;
-    strcpy(setupfile,argv[3]);
+    strcpy(setupfile,argv[firstarg+3]);
   }
   else
     sprintf(setupfile,"");
@@ -143,7 +166,7 @@ int main(int argc, char *argv[])
    * Loop over displaying image until happy with results
    */
 
-  if(no_error) {
+  if(no_error && !autopa) {
     open_plot_window();
     if(display_image(image,setup))
       no_error = 0;
@@ -193,10 +216,35 @@ int main(int argc, char *argv[])
       no_error = 0;
 
   /*
-   * Get lens position
+   * In automatic mode, get the lens position, PA and pixel scale from the
+   *  transform between the starlist offsets, in pixels, and the catalog.
+   *  The lens, at zero offset, lands on the shift of the transform, and 
+   *  the PA is measured the other way from its rotation angle.
    */
 
-  if(no_error) {
+  pa = 0.0;
+  if(no_error && autopa) {
+    if(get_auto_pa(astdat,nast,catdat,ncat,setup,&trans))
+      no_error = 0;
+    else {
+      centx = trans.dx;
+      centy = trans.dy;
+      pa = -trans.rot;
+      setup->pixscale /= trans.scale;
+      printf("\nLens position: %8.2f %8.2f\n",centx,centy);
+      printf("PA:            %8.2f\n",pa);
+      printf("Pixel scale:   %8.5f\n",setup->pixscale);
+      setup->drawmarker = TRUE;
+      setup->markx = (float) centx;
+      setup->marky = (float) centy;
+    }
+  }
+
+  /*
+   * Otherwise, get lens position
+   */
+
+  if(no_error && !autopa) {
     centx = catdat->x;
     centy = catdat->y;
     printf("Enter lens position [x y]: [%8.2f %8.2f] ",centx,centy);
@@ -221,11 +269,16 @@ int main(int argc, char *argv[])
   }  
 
   /*
-   * Display the image and loop on PA.  
+   * In automatic mode, just calculate the rotated positions.  Otherwise,
+   *  display the image and loop on PA.  
    */
 
-  pa = 0.0;
-  if(no_error)
+  if(no_error && autopa) {
+    if(pa2dpos(centx,centy,pa,astdat,setup))
+      no_error = 0;
+    another_loop = 0;
+  }
+  else if(no_error)
     open_plot_window();
 
   while(another_loop && no_error) {
@@ -274,14 +327,16 @@ int main(int argc, char *argv[])
    */
 
   if(no_error)
-    if(print_astfile(setup,matchcat,nmatch,"astrom.dat",1))
+    if(print_astfile(setup,matchcat,nmatch,"astrom.dat",1,
+		     autopa ? MATCHLIM : 0.0))
       no_error = 0;
 
   /*
    * Clean up and exit
    */
 
-  cpgend();
+  if(!autopa)
+    cpgend();
   image = del_Image(image);
   setup = del_setup(setup);
   astdat = del_secat(astdat);
@@ -298,6 +353,108 @@ int main(int argc, char *argv[])
   }
 }
 
+/*.......................................................................
+ *
+ * Function get_auto_pa
+ *
+ * Finds the transform between the offsets of the astrometric stars from
+ *  the lens, converted to pixels with the current pixel scale, and the 
+ *  (x,y) positions in the catalog, by passing the brightest of each to
+ *  match_asterisms.  The offsets are the ones used by pa2dpos, i.e., 
+ *  for a PA of zero.  Stars that are further from the lens than the 
+ *  diagonal of the image cannot lie in the image, and are skipped.
+ *
+ * Inputs: Secat *astcat       astrometric catalog containing offsets
+ *         int nast            number of members in astcat
+ *         Secat *xycat        catalog based on fits image (x,y) positions
+ *         int nxy             number of members in xycat
+ *         Setup *setup        setup structure containing the image size
+ *                              and pixel scale
+ *         Simtrans *trans     transform from offsets to (x,y) positions 
+ *                              (set by this function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int get_auto_pa(Secat *astcat, int nast, Secat *xycat, int nxy, 
+		Setup *setup, Simtrans *trans)
+{
+  int i;                  /* Looping variable */
+  int no_error=1;         /* Flag set to 0 on error */
+  int n1=0,n2;            /* Numbers of positions to be matched */
+  int *aindex=NULL;       /* Members of astcat in order of brightness */
+  int *xindex=NULL;       /* Members of xycat in order of brightness */
+  double diag;            /* Length of the image diagonal in pixels */
+  Lpos tmppos;            /* Temporary holder for x,y offset */
+  Lpos *pos1=NULL;        /* Offsets of the brightest astrometric stars */
+  Lpos *pos2=NULL;        /* Positions of the brightest catalog members */
+  Secat *aptr;            /* Pointer to navigate astcat */
+
+  /*
+   * Get the offsets and positions of the brightest objects
+   */
+
+  if(setup->pixscale <= 0.0) {
+    fprintf(stderr,"ERROR: get_auto_pa.  No pixel scale.\n");
+    return 1;
+  }
+  diag = sqrt(1.0 * setup->xsize * setup->xsize + 
+	      1.0 * setup->ysize * setup->ysize);
+  n2 = (nxy < NASTER) ? nxy : NASTER;
+  if(!(aindex = bright_index(astcat,nast)))
+    no_error = 0;
+  if(no_error)
+    if(!(xindex = bright_index(xycat,nxy)))
+      no_error = 0;
+  if(no_error)
+    if(!(pos1 = new_lpos(NASTER)) || !(pos2 = new_lpos(n2)))
+      no_error = 0;
+
+  if(no_error) {
+    for(i=0; i<nast && n1<NASTER; i++) {
+      aptr = astcat + aindex[i];
+      if(aptr->dpos / setup->pixscale > diag)
+	continue;
+      rth2xy(aptr->dpos,aptr->dpostheta,&tmppos,1);
+      pos1[n1].x = tmppos.x / setup->pixscale;
+      pos1[n1].y = tmppos.y / setup->pixscale;
+      n1++;
+    }
+    for(i=0; i<n2; i++) {
+      pos2[i].x = xycat[xindex[i]].x;
+      pos2[i].y = xycat[xindex[i]].y;
+    }
+  }
+
+  /*
+   * Match them
+   */
+
+  if(no_error) {
+    printf("\nMatching triangles of %d astrometric stars and the %d ",n1,n2);
+    printf("brightest catalog objects\n");
+    if(match_asterisms(pos1,n1,pos2,n2,trans))
+      no_error = 0;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  free(aindex);
+  free(xindex);
+  pos1 = del_lpos(pos1);
+  pos2 = del_lpos(pos2);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: get_auto_pa\n");
+    return 1;
+  }
+}
+
 /*.......................................................................
  *
  * Function pa2dpos
@@ -323,7 +480,7 @@ int pa2dpos(double centx, double centy, double pa, Secat *secat, Setup *setup)
   float r_circ;      /* Circle radius in pixels */
   double dpostheta;  /* New theta position */
   char *star;        /* Star number, without the root name */
-  Pos tmppos;        /* Temporary holder for x,y position */
+  Lpos tmppos;       /* Temporary holder for x,y position */
   Labinfo *lptr;     /* Pointer to navigate Setup->circle */
   Secat *sptr;       /* Pointer to navigate secat */
 
@@ -577,18 +734,22 @@ Secat *find_match(Setup *setup, Secat *astcat, Secat *xycat, int nxy,
  *  within the boundaries of the fits image.
  *
  * Inputs:
+ *         float maxoffset     maximum offset for a good match, in pixels.
+ *                              If this is not positive, the user is asked 
+ *                              for it.
  *
  * Output: int (0 or 1)        0 ==> success, 1 ==> error
  *
  * v06May2004 CDF, Added a maximum pixel offset for a "good" match
+ * v2026Oct16 AGT, The maximum offset is now passed in, and only asked for
+ *                  if it is not positive.
  */
 
 int print_astfile(Setup *setup, Secat *matchcat, int nmatch, char *pfname,
-		  int format)
+		  int format, float maxoffset)
 {
   int i;            /* Looping variable */
   int no_error=1;   /* Flag set to 0 on error */
-  float maxoffset;  /* Maximum offset */
   char ew[5];       /* Direction of delta_RA */
   char ns[5];       /* Direction of delta_Dec */
   char dname[MAXC]; /* Name of distcalc-like output file */
@@ -616,13 +777,15 @@ int print_astfile(Setup *setup, Secat *matchcat, int nmatch, char *pfname,
    * Get maximum offset
    */
 
-  printf("\n");
-  printf("Enter the maximum value of mindpos (from find_match) allowed ");
-  printf("for a good match (in pixels): ");
-  fgets(line,MAXC,stdin);
-  while(sscanf(line,"%f",&maxoffset) != 1) {
-    fprintf(stderr,"Invalid number.  Enter value again: ");
+  if(maxoffset <= 0.0) {
+    printf("\n");
+    printf("Enter the maximum value of mindpos (from find_match) allowed ");
+    printf("for a good match (in pixels): ");
     fgets(line,MAXC,stdin);
+    while(sscanf(line,"%f",&maxoffset) != 1) {
+      fprintf(stderr,"Invalid number.  Enter value again: ");
+      fgets(line,MAXC,stdin);
+    }
   }
 
   /*
@@ -5,10 +5,16 @@
  *                user clicks on an object in each image.  The catalogs
  *                are then used to determine the offsets between the
  *                images.
+ *               With the -a flag, the initial shift is instead found
+ *                without any plotting or mouse clicks, from a histogram of
+ *                the offsets between the bright objects in the two 
+ *                catalogs, so that many exposures can be processed 
+ *                unattended.
  *               NB: This program assumes that there is no rotation between
  *                the dithered images.
  *
- * Usage: find_dither fitsfile1 catfile1 fitsfile2 catfile2 ([setup_filename])
+ * Usage: find_dither (-a) fitsfile1 catfile1 fitsfile2 catfile2 
+ *         ([setup_filename])
  *
  * Revision history
  *  27Aug2006 Chris Fassnacht (CDF),  First working version
@@ -19,6 +25,12 @@
  *                  by the imcombine task in iraf.
  *  2008Jul16 CDF, Small modifications to incorporate new image reading
  *                  and display-opening functions. 
+ *  2026Oct16 AGT, Added the -a flag and the get_auto_shift function, which
+ *                  finds the initial shift by voting with the offsets of
+ *                  the bright objects.
+ *                 find_shifts now finds the closest match with a Kdtree 
+ *                  (kd_nearest) rather than a scan of the second catalog.
+ *                 Now uses find_closest from catlib.c.
  *
  */
 
@@ -31,9 +43,14 @@
 #include "structdef.h"
 #include "coords.h"
 #include "dataio.h"
+#include "catlib.h"
 #include "fitsim.h"
 #include "plotfuncs.h"
 
+#define NBRIGHT 200      /* Number of bright objects used by get_auto_shift */
+#define NSHIFTBIN 256    /* Largest number of shift histogram bins per axis */
+#define MATCHLIM 3.0     /* Maximum pixel offset for a "good" match */
+
 /*.......................................................................
  *
  * Function declarations
@@ -42,12 +59,14 @@
 
 void get_init_shift(Secat *cat1, int ncat1, Secat *cat2, int ncat2, 
 		    Pos *initshift);
-Secat find_closest(Pos cpos, Secat *secat, int ncat);
+int get_auto_shift(Secat *cat1, int ncat1, Secat *cat2, int ncat2, 
+		   Setup *setup2, Pos *initshift);
 void markcatobj(Secat object);
 Secat *find_shifts(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
 		   Pos initshift, Setup *setup2, int *nshift, int verbose);
 int calc_shift_stats(Secat *shiftcat, int nshift, Pos *shiftmean,
 		     Pos *shiftrms, Pos *shiftmedian);
+int plot_shifts(Secat *shiftcat, int nshift, int doplot);
 void doubstats(double *data, int ndata, double *mean, double *sig, 
 	       double *median);
 int doubcmp(const void *v1, const void *v2);
@@ -62,6 +81,8 @@ int main(int argc, char *argv[])
 {
   int no_error=1;       /* Flag set to 0 on error */
   int usefile=0;        /* Flag set to 1 to use input setup file */
+  int autoshift=0;      /* Flag set to 1 to find the shift automatically */
+  int firstarg=1;       /* argv index of the first file name */
   int ncat1,ncat2;      /* Number of catalog objects */
   int nshift=0;         /* Number of matching objects */
   int another_loop=1;   /* Flag set to 0 when ending a loop */
@@ -87,9 +108,14 @@ int main(int argc, char *argv[])
    * Check the command line
    */
 
-  if(argc < 5) {
-    fprintf(stderr,"\nfind_dither fitsfile1 catfile1 fitsfile2 catfile2 ");
-    fprintf(stderr,"(setupfile)\n\n");
+  if(argc > 1 && strcmp(argv[1],"-a") == 0) {
+    autoshift = 1;
+    firstarg = 2;
+  }
+  if(argc < firstarg + 4) {
+    fprintf(stderr,"\nfind_dither (-a) fitsfile1 catfile1 fitsfile2 ");
+    fprintf(stderr,"catfile2 (setupfile)\n\n");
+    fprintf(stderr," -a  Find the shift without plotting or mouse clicks\n\n");
     return 1;
   }
 
@@ -97,13 +123,13 @@ int main(int argc, char *argv[])
    * Get the names of the files.
    */
 
-  strcpy(fitsfile1,argv[1]);
-  strcpy(catfile1,argv[2]);
-  strcpy(fitsfile2,argv[3]);
-  strcpy(catfile2,argv[4]);
-  if(argc == 6) {
+  strcpy(fitsfile1,argv[firstarg]);
+  strcpy(catfile1,argv[firstarg+1]);
+  strcpy(fitsfile2,argv[firstarg+2]);
+  strcpy(catfile2,argv[firstarg+3]);
+  if(argc == firstarg + 5) {
     usefile = 1;
-    strcpy(setupfile,argv[5]);
+    strcpy(setupfile,argv[firstarg+4]);
   }
   else
     sprintf(setupfile,"");
@@ -134,7 +160,7 @@ int main(int argc, char *argv[])
    * Loop over displaying image until happy with results
    */
 
-  if(no_error) {
+  if(no_error && !autoshift) {
     open_plot_window();
     if(display_image(image1,setup1))
       no_error = 0;
@@ -184,7 +210,7 @@ int main(int argc, char *argv[])
    * Loop over displaying image until happy with results
    */
 
-  if(no_error) {
+  if(no_error && !autoshift) {
     open_plot_window();
     if(display_image(image2,setup2))
       no_error = 0;
@@ -221,7 +247,7 @@ int main(int argc, char *argv[])
    * Plot the catalog
    */
 
-  if(no_error) {
+  if(no_error && !autoshift) {
     cpgslct(1);
     printf("\nPlotting SExtractor positions for first catalog\n");
     if(plot_secat(setup1,catdat1,ncat1,2,3,2.0))
@@ -240,7 +266,7 @@ int main(int argc, char *argv[])
    * Plot the catalog
    */
 
-  if(no_error) {
+  if(no_error && !autoshift) {
     cpgslct(2);
     printf("\nPlotting SExtractor positions for second catalog\n");
     if(plot_secat(setup2,catdat2,ncat2,2,3,2.0))
@@ -252,7 +278,12 @@ int main(int argc, char *argv[])
    */
 
   if(no_error) {
-    get_init_shift(catdat1,ncat1,catdat2,ncat2,&initshift);
+    if(autoshift) {
+      if(get_auto_shift(catdat1,ncat1,catdat2,ncat2,setup2,&initshift))
+	no_error = 0;
+    }
+    else
+      get_init_shift(catdat1,ncat1,catdat2,ncat2,&initshift);
   }
 
   /*
@@ -271,14 +302,16 @@ int main(int argc, char *argv[])
    */
 
   if(no_error)
-    plot_shifts(shiftcat,nshift);
+    plot_shifts(shiftcat,nshift,!autoshift);
 
   /*
    * Clean up and exit
    */
 
-  cpgend();
-  cpgend();
+  if(!autoshift) {
+    cpgend();
+    cpgend();
+  }
   image1 = del_Image(image1);
   setup1 = del_setup(setup1);
   catdat1 = del_secat(catdat1);
@@ -335,7 +368,7 @@ void get_init_shift(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
       printf("\nMouse clicked at: %7.2f %7.2f\n",cx,cy);
       cpos.x = cx;
       cpos.y = cy;
-      bestmatch1 = find_closest(cpos,cat1,ncat1);
+      bestmatch1 = find_closest(cpos,cat1,ncat1,1);
       printf("Position of closest match is: %7.2f %7.2f\n",
 	     bestmatch1.x,bestmatch1.y);
       markcatobj(bestmatch1);
@@ -357,7 +390,7 @@ void get_init_shift(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
       printf("\nMouse clicked at: %7.2f %7.2f\n",cx,cy);
       cpos.x = cx;
       cpos.y = cy;
-      bestmatch2 = find_closest(cpos,cat2,ncat2);
+      bestmatch2 = find_closest(cpos,cat2,ncat2,1);
       printf("Position of closest match is: %7.2f %7.2f\n\n",
 	     bestmatch2.x,bestmatch2.y);
       markcatobj(bestmatch2);
@@ -384,52 +417,172 @@ void get_init_shift(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
 
 /*.......................................................................
  *
- * Function find_closest
+ * Function get_auto_shift
  *
- * Finds the object giving the closest match between the input postion and 
- *  the members of a SExtractor catalog.
- *  The closest matching positions are returned in a Secat structure.
+ * Gets the initial (x,y) shift between the two catalogs without any
+ *  input from the user.  The offsets between every pair of bright objects,
+ *  one from each catalog, are binned into a 2-dimensional histogram.  The
+ *  pairs of real matches all have nearly the same offset and pile up in 
+ *  one place, while the other pairs are spread over the whole histogram.
+ *  The peak is found with a 2x2 bin box, so that a pile split by a bin 
+ *  edge is not missed, and the shift is then refined with the median 
+ *  offset of the pairs in the box and again with that of the pairs 
+ *  within MATCHLIM pixels of the first estimate.
  *
- * Inputs: Pos cpos            input position
- *         Secat *secat        catalog based on fits image (x,y) positions
- *         int ncat            number of members in secat
+ * Inputs: Secat *cat1         first catalog
+ *         int ncat1           number of objects in first catalog
+ *         Secat *cat2         second catalog
+ *         int ncat2           number of objects in second catalog
+ *         Setup *setup2       information about image 2
+ *         Pos *initshift      shift (set by this function)
  *
- * Output: Secat bestmatch     best match
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
  *
  */
 
-Secat find_closest(Pos cpos, Secat *secat, int ncat)
+int get_auto_shift(Secat *cat1, int ncat1, Secat *cat2, int ncat2, 
+		   Setup *setup2, Pos *initshift)
 {
-  int i,j;                /* Looping variables */
-  double dx,dy,dpos;      /* Offsets between (x,y) pairs */
-  double mindpos;         /* Running minimum position offset */
-  Secat bestmatch;        /* Container for best-matching xy object */
-  Secat *sptr;            /* Pointers to navigate astcat and xycat */
+  int i,j,k;              /* Looping variables */
+  int no_error=1;         /* Flag set to 0 on error */
+  int nb1,nb2;            /* Number of bright objects in each catalog */
+  int nbx,nby;            /* Number of histogram bins along each axis */
+  int ix,iy;              /* Histogram bin */
+  int box;                /* Number of pairs in a 2x2 bin box */
+  int maxbox=0;           /* Number of pairs in the peak box */
+  int npair;              /* Number of pairs used in the median */
+  int *hist=NULL;         /* Shift histogram */
+  double binsize;         /* Histogram bin size in pixels */
+  double xoff,yoff;       /* Offsets of the histogram origin */
+  double dx,dy;           /* Offsets between a pair of objects */
+  double cx,cy;           /* Current estimate of the shift */
+  double halfwidth;       /* Half-width of the window for the median */
+  double mean,sig;        /* Statistics of the pair offsets (not used) */
+  double *pdx=NULL;       /* x offsets of the pairs in the window */
+  double *pdy=NULL;       /* y offsets of the pairs in the window */
+  int *index1=NULL;       /* First catalog in order of magnitude */
+  int *index2=NULL;       /* Second catalog in order of magnitude */
+  Secat *s1,*s2;          /* Bright objects in the two catalogs */
+
+  /*
+   * Select the bright objects and set up the histogram, which covers all 
+   *  of the shifts that can leave the images overlapping
+   */
+
+  printf("---------------------------------------------------------------\n");
+  printf("\nFinding the shift from the offsets between bright objects\n");
+  if(!(index1 = bright_index(cat1,ncat1)))
+    no_error = 0;
+  if(!(index2 = bright_index(cat2,ncat2)))
+    no_error = 0;
+  nb1 = (ncat1 < NBRIGHT) ? ncat1 : NBRIGHT;
+  nb2 = (ncat2 < NBRIGHT) ? ncat2 : NBRIGHT;
+  binsize = 2.0 * ((setup2->xsize > setup2->ysize) ? 
+		   setup2->xsize : setup2->ysize) / NSHIFTBIN;
+  if(binsize < 1.0)
+    binsize = 1.0;
+  xoff = setup2->xsize;
+  yoff = setup2->ysize;
+  nbx = (int) (2.0 * xoff / binsize) + 2;
+  nby = (int) (2.0 * yoff / binsize) + 2;
+  if(no_error) {
+    if(!(hist = (int *) calloc(nbx * nby,sizeof(int))) ||
+       !(pdx = new_doubarray(nb1 * nb2 + 1)) ||
+       !(pdy = new_doubarray(nb1 * nb2 + 1))) {
+      fprintf(stderr,"ERROR: get_auto_shift.  Insufficient memory.\n");
+      no_error = 0;
+    }
+  }
 
   /*
-   * Loop through catalog
+   * Vote with the offset of each pair and find the peak
    */
 
-  dx = cpos.x - secat->x;
-  dy = cpos.y - secat->y;
-  bestmatch.dpos = sqrt(dx*dx + dy*dy);
-  for(i=0,sptr=secat; i < ncat; i++,sptr++) {
-    dx = cpos.x - sptr->x;
-    dy = cpos.y - sptr->y;
-    if((dpos = sqrt(dx*dx + dy*dy)) < bestmatch.dpos) {
-      bestmatch = *sptr;
-      bestmatch.dpos = dpos;
+  if(no_error) {
+    for(i=0; i<nb1; i++)
+      for(j=0,s1=cat1+index1[i]; j<nb2; j++) {
+	s2 = cat2 + index2[j];
+	ix = (int) floor((s2->x - s1->x + xoff) / binsize);
+	iy = (int) floor((s2->y - s1->y + yoff) / binsize);
+	if(ix >= 0 && ix < nbx && iy >= 0 && iy < nby)
+	  hist[iy * nbx + ix]++;
+      }
+    cx = cy = 0.0;
+    for(iy=0; iy<nby-1; iy++)
+      for(ix=0; ix<nbx-1; ix++) {
+	k = iy * nbx + ix;
+	box = hist[k] + hist[k+1] + hist[k+nbx] + hist[k+nbx+1];
+	if(box > maxbox) {
+	  maxbox = box;
+	  cx = (ix + 1) * binsize - xoff;
+	  cy = (iy + 1) * binsize - yoff;
+	}
+      }
+    if(maxbox < 3) {
+      fprintf(stderr,"ERROR: get_auto_shift.  No clear peak in the ");
+      fprintf(stderr,"offsets between the bright objects.\n");
+      no_error = 0;
     }
   }
-  printf("For this position, the best match is ID=%d at",
-	 bestmatch.id);
-  printf(" mindpos = %6.3f pix\n",bestmatch.dpos);
 
   /*
-   * Exit
+   * Refine the shift with the median offsets of the pairs near the peak
    */
 
-  return bestmatch;
+  halfwidth = binsize;
+  for(k=0; k<2 && no_error; k++) {
+    npair = 0;
+    for(i=0; i<nb1; i++)
+      for(j=0,s1=cat1+index1[i]; j<nb2; j++) {
+	s2 = cat2 + index2[j];
+	dx = s2->x - s1->x;
+	dy = s2->y - s1->y;
+	if(fabs(dx - cx) <= halfwidth && fabs(dy - cy) <= halfwidth) {
+	  pdx[npair] = dx;
+	  pdy[npair] = dy;
+	  npair++;
+	}
+      }
+    if(npair == 0) {
+      fprintf(stderr,"ERROR: get_auto_shift.  No pairs near the peak.\n");
+      no_error = 0;
+    }
+    else {
+      doubstats(pdx,npair,&mean,&sig,&cx);
+      doubstats(pdy,npair,&mean,&sig,&cy);
+      printf(" Median of %d pair offsets within %.1f pix: %8.2f %8.2f\n",
+	     npair,halfwidth,cx,cy);
+    }
+    halfwidth = MATCHLIM;
+  }
+
+  printf("---------------------------------------------------------------\n");
+  if(no_error) {
+    initshift->x = cx;
+    initshift->y = cy;
+    printf("\nInital estimate of shift between images: %8.2f %8.2f\n",
+	   initshift->x,initshift->y);
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  if(index1)
+    free(index1);
+  if(index2)
+    free(index2);
+  if(hist)
+    free(hist);
+  pdx = del_doubarray(pdx);
+  pdy = del_doubarray(pdy);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: get_auto_shift\n");
+    return 1;
+  }
 }
 
 /*.......................................................................
@@ -442,6 +595,8 @@ Secat find_closest(Pos cpos, Secat *secat, int ncat)
  *  and the catalog 2 position.  
  *  between the matched pairs.  The
  * The shifts are returned in a Secat array.
+ * The match is the closest catalog 2 object within MATCHLIM pixels, found
+ *  with a Kdtree over catalog 2.
  *
  * Inputs: 
  *   Secat *cat1               first catalog
@@ -462,24 +617,27 @@ Secat find_closest(Pos cpos, Secat *secat, int ncat)
 Secat *find_shifts(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
 		   Pos initshift, Setup *setup2, int *nshift, int verbose)
 {
-  int i,j;                /* Looping variables */
+  int i;                  /* Looping variable */
+  int best;               /* Index of closest catalog 2 object */
   double shiftx,shifty;   /* Shifted version of cat1 positions */
-  double dx,dy,dpos;      /* Offsets between (x,y) pairs */
-  double mindpos;         /* Running minimum position offset */
-  double matchlim=3.0;    /* Maximum pixel offset for a "good" match */
-  Secat bestmatch;        /* Container for best-matching xy object */
+  double dpos;            /* Offset between (x,y) pair */
   Secat *shiftcat=NULL;   /* Container for the shifts */
-  Secat *ptr1,*ptr2;      /* Pointers to navigate cat1 and cat2 */
+  Secat *ptr1;            /* Pointer to navigate cat1 */
   Secat *sptr;            /* Pointer to navigate shiftcat */
+  Kdtree *tree=NULL;      /* Tree over catalog 2 positions */
 
   /*
-   * Allocate memory for output structure
+   * Allocate memory for output structure and index catalog 2
    */
 
   if(!(shiftcat = new_secat(ncat2))) {
     fprintf(stderr,"ERROR: find_shifts.\n");
     return NULL;
   }
+  if(!(tree = new_kdtree(cat2,ncat2))) {
+    fprintf(stderr,"ERROR: find_shifts.\n");
+    return del_secat(shiftcat);
+  }
 
   /*
    * Loop through first catalog, shifting each of its positions by
@@ -499,26 +657,15 @@ Secat *find_shifts(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
     if(shiftx >= 1 && shiftx <= (setup2->xsize - 1) && 
        shifty >= 1 && shifty <= (setup2->ysize - 1)) {
     
-      bestmatch.dpos = 1.0 * setup2->xsize;
-      for(j=0,ptr2=cat2; j<ncat2; j++,ptr2++) {
-	dx = shiftx - ptr2->x;
-	dy = shifty - ptr2->y;
-	if((dpos = sqrt(dx*dx + dy*dy)) < bestmatch.dpos) {
-	  bestmatch = *ptr2;
-	  bestmatch.dx = ptr2->x - ptr1->x;
-	  bestmatch.dy = ptr2->y - ptr1->y;
-	  bestmatch.dpos = dpos;
-	}
-	if(bestmatch.dpos < matchlim)
-	  break;
-      }
-
       /*
        * Only accept best match if it is within the tolerance
        */
 
-      if(bestmatch.dpos < matchlim) {
-	*sptr = bestmatch;
+      if((best = kd_nearest(tree,shiftx,shifty,MATCHLIM,&dpos)) >= 0) {
+	*sptr = cat2[best];
+	sptr->dx = cat2[best].x - ptr1->x;
+	sptr->dy = cat2[best].y - ptr1->y;
+	sptr->dpos = dpos;
 	if(verbose) {
 	  printf("find_shifts: For %d, mindpos = %6.3f pix, shift = %f %f\n",
 		 ptr1->id,sptr->dpos,sptr->dx,sptr->dy);
@@ -530,9 +677,10 @@ Secat *find_shifts(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
   }
 
   /*
-   * Exit
+   * Clean up and exit
    */
 
+  tree = del_kdtree(tree);
   return shiftcat;
 }
 
@@ -546,6 +694,7 @@ Secat *find_shifts(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
  * Inputs:
  *  Secat shiftcat             catalog containing shifts
  *  int nshift                 number of shifts
+ *  int doplot                 set to 0 to skip the plot
  *
  * Output:
  *  int (0 or 1)               0 on success, 1 on error
@@ -554,7 +703,7 @@ Secat *find_shifts(Secat *cat1, int ncat1, Secat *cat2, int ncat2,
  *              median values on plot of distribution.
  */
 
-int plot_shifts(Secat *shiftcat, int nshift)
+int plot_shifts(Secat *shiftcat, int nshift, int doplot)
 {
   int i;                     /* Looping variable */
   int no_error=1;            /* Flag set to 0 on error */
@@ -628,11 +777,13 @@ int plot_shifts(Secat *shiftcat, int nshift)
     x2 = xmed + 5.0 * xsig;
     y1 = ymed - 5.0 * ysig;
     y2 = ymed + 5.0 * ysig;
+  }
 
-    /*
-     * Plot distribution
-     */
+  /*
+   * Plot distribution
+   */
 
+  if(no_error && doplot) {
     cpgslct(2);
     cpgenv(x1,x2,y1,y2,0,1);
     cpglab("x shift","y shift","Calculated Shifts");
@@ -2069,7 +2069,7 @@ void find_vslice_max(Image *image, int x, int ylo, int yhi,
  *
  * Creates a vertical slice through a 2D image given the column number
  *  (x0) and the range of y values (ymin to ymax).  The slice is returned
- *  as a Pos array containing (y,flux) pairs.
+ *  as a Sample array containing (y,flux) pairs.
  *
  * Inputs: Image *image        input image
  *         int x0              column
@@ -2077,19 +2077,20 @@ void find_vslice_max(Image *image, int x, int ylo, int yhi,
  *         float *smin,*smax   range of flux values (set by this function)
  *         double *ysmax       y position of smax (set by this function)
  *
- * Output: Pos *vslice         array containing slice.  NULL on error.
+ * Output: Sample *vslice      array containing slice.  NULL on error.
  *
+ * v16Oct26 AGT, Slice is now a Sample array rather than a Pos array.
  */
 
-Pos *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
-		 float *smax, double *ysmax)
+Sample *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
+		    float *smax, double *ysmax)
 {
   int y;             /* Looping variable */
   int no_error=1;    /* Flag set to 0 on error */
   float ydiff;       /* ymax - ymin */
   float *dptr;       /* Pointer to navigate image->data */
-  Pos *slice=NULL;   /* (y, flux) values */
-  Pos *slptr;        /* Pointer to navigate slice */
+  Sample *slice=NULL; /* (y, flux) values */
+  Sample *slptr;     /* Pointer to navigate slice */
 
   /*
    * Initialize
@@ -2100,17 +2101,17 @@ Pos *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
   *ysmax = ymin;
 
   /*
-   * Allocate memory for Pos array
+   * Allocate memory for Sample array
    */
 
   ydiff = ymax - ymin;
-  if(!(slice = new_pos(ydiff+1,1))) {
+  if(!(slice = new_sample(ydiff+1))) {
     fprintf(stderr,"ERROR: make_vslice.\n");
     return NULL;
   }
   
   /*
-   * Step through slice, assigning (y,flux) pairs to the Pos array
+   * Step through slice, assigning (y,flux) pairs to the Sample array
    */
 
   for(y=ymin,slptr=slice; y<=ymax; y++,slptr++) {
@@ -2129,7 +2130,7 @@ Pos *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
     return slice;
   else {
     fprintf(stderr,"ERROR: make_vslice.\n");
-    return del_pos(slice);
+    return del_sample(slice);
   }
 }
 
@@ -2138,9 +2139,9 @@ Pos *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
  *
  * Function plot_vslice
  *
- * Plots a Pos array by calling plot_spec.
+ * Plots a Sample array by calling plot_spec.
  *
- * Inputs: Pos *slice          slice to be plotted
+ * Inputs: Sample *slice       slice to be plotted
  *         double ymin, ymax   range of y values
  *         float smin,smax     range of flux values
  *         int dopoints        flag set to 1 if plotting slice as
@@ -2151,7 +2152,7 @@ Pos *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
  *
  */
 
-int plot_vslice(Pos *slice, double ymin, double ymax, float smin,
+int plot_vslice(Sample *slice, double ymin, double ymax, float smin,
 		float smax, int dopoints)
 {
   int i;             /* Looping variable */
@@ -2160,7 +2161,7 @@ int plot_vslice(Pos *slice, double ymin, double ymax, float smin,
   float fmin,fmax;   /* Min and max values in array */
   float sdiff;       /* smax - smin */
   float ydiff;       /* ymax - ymin */
-  Pos *sptr;         /* Pointer to navigate slice */
+  Sample *sptr;      /* Pointer to navigate slice */
 
   /*
    * Get integer versions of ymin and ymax.
@@ -2222,7 +2223,7 @@ int plot_vslice(Pos *slice, double ymin, double ymax, float smin,
  * Computes a continuum level given two background regions 
  *  delineated by (bk_lo,bk_hi)_1 and (bk_lo,bk_hi)_2.
  *  * 
- * Inputs: Pos *slice          slice to have continuum fit
+ * Inputs: Sample *slice       slice to have continuum fit
  *         int npoints         number of points in slice
  *         double bklo_1       lower limit of first background region
  *         double bkhi_1       upper limit of first background region
@@ -2235,21 +2236,21 @@ int plot_vslice(Pos *slice, double ymin, double ymax, float smin,
  *
  */
 
-int fit_continuum(Pos *slice, int npoints, double bklo_1, double bkhi_1, 
+int fit_continuum(Sample *slice, int npoints, double bklo_1, double bkhi_1, 
 		  double bklo_2, double bkhi_2, float *m, float *b)
 {
   int y;           /* Looping variable */
   int count=0;     /* Number of values going into continuum calculation */
-  Pos *bkgd=NULL;  /* Container for background values */
-  Pos *bptr;       /* Pointer to navigate bkgd */
-  Pos *sptr;       /* Pointer to navigate slice */
+  Sample *bkgd=NULL; /* Container for background values */
+  Sample *bptr;    /* Pointer to navigate bkgd */
+  Sample *sptr;    /* Pointer to navigate slice */
 
   /*
    * Allocate memory for bkgd.  For simplicity, make it the
    *  same size as slice.
    */
 
-  if(!(bkgd = new_pos(npoints,1))) {
+  if(!(bkgd = new_sample(npoints))) {
     fprintf(stderr,"ERROR: fit_continuum.\n");
     return 1;
   }
@@ -2284,9 +2285,9 @@ int fit_continuum(Pos *slice, int npoints, double bklo_1, double bkhi_1,
  *
  * Function pos_lsf
  *
- * Does a linear least-squares fit to the members of a Pos array.
+ * Does a linear least-squares fit to the members of a Sample array.
  *
- * Inputs: Pos *pos            pairs of points in array
+ * Inputs: Sample *pos         pairs of points in array
  *         int npoints         number of points in the array
  *         float *m            slope of linear fit (set by this 
  *                              function)
@@ -2297,7 +2298,7 @@ int fit_continuum(Pos *slice, int npoints, double bklo_1, double bkhi_1,
  *
  */
 
-int pos_lsf(Pos *pos, int npoints, float *m, float *b)
+int pos_lsf(Sample *pos, int npoints, float *m, float *b)
 {
   int i;     /* Looping variable */
   float weight;
@@ -2307,7 +2308,7 @@ int pos_lsf(Pos *pos, int npoints, float *m, float *b)
   float ysum=0.0;
   float xysum=0.0;
   float del=0.0;
-  Pos *pptr;       /* Pointer to navigate pos */
+  Sample *pptr;    /* Pointer to navigate pos */
 
   /*
    * Assume that errors are shot-noise only, and thus that
@@ -266,14 +266,14 @@ int lcontour(float *cont, int ncont, float max);
  */
 
 int imslice(Image *image);
-Pos *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
-		 float *smax, double *ysmax);
-int plot_vslice(Pos *slice, double ymin, double ymax, float smin,
+Sample *make_vslice(Image *image, int x0, int ymin, int ymax, float *smin,
+		    float *smax, double *ysmax);
+int plot_vslice(Sample *slice, double ymin, double ymax, float smin,
 		float smax, int dopoints);
 void find_vslice_max(Image *image, int x, int ylo, int yhi, 
 		     float *slmax, int *ymax);
-int fit_continuum(Pos *slice, int npoints, double bklo_1, double bkhi_1, 
+int fit_continuum(Sample *slice, int npoints, double bklo_1, double bkhi_1, 
 		  double bklo_2, double bkhi_2, float *m, float *b);
-int pos_lsf(Pos *pos, int npoints, float *m, float *b);
+int pos_lsf(Sample *pos, int npoints, float *m, float *b);
 
 #endif
@@ -459,7 +459,7 @@ Secat *full_display(Image *image, Setup *setup, Secat *astcat, int nast,
 int astcat2xy(Secat *astcat, int nast, WCSinfo wcs)
 {
   int i;        /* Looping variable */
-  Pos offset;   /* Offset in arcsec */
+  Lpos offset;  /* Offset in arcsec */
   Secat *aptr;  /* Pointer to navigate astcat */
   WCSinfo tmp;  /* Temporary wcs structure with inverted CD matrix */
 
@@ -665,7 +665,7 @@ void catxy2dpos(Pos cpos, Secat *secat, int ncat)
   int i,j;                /* Looping variables */
   double dx,dy,dpos;      /* Offsets between (x,y) pairs */
   double mindpos;         /* Running minimum position offset */
-  Pos tmppos;             /* Temporary container for (x,y) offset */
+  Lpos tmppos;            /* Temporary container for (x,y) offset */
   Secat *sptr;            /* Pointers to navigate astcat and xycat */
 
   /*
@@ -13,6 +13,7 @@
  *                of the functions.
  *               Added new read_onespec and read_multispec functions
  *                to take functionality previously in specplot.c.
+ * v16Oct26 AGT, Spectra are now Sample arrays rather than Pos arrays.
  *
  */
 
@@ -69,10 +70,10 @@ Spectrum *del_spectrum(Spectrum *spec) {
  *
  */
 
-Pos **new_spec(int nspec) {
-  Pos **newspec={NULL};  /* Array of spectra to be allocated */
+Sample **new_spec(int nspec) {
+  Sample **newspec={NULL};  /* Array of spectra to be allocated */
 
-  newspec = (Pos **) malloc(sizeof(Pos *) * nspec);
+  newspec = (Sample **) malloc(sizeof(Sample *) * nspec);
   if(!newspec) {
     fprintf(stderr,"ERROR:  Insufficient memory for array of pointers\n");
     fprintf(stderr,"        to the spectra.");
@@ -82,12 +83,12 @@ Pos **new_spec(int nspec) {
     return newspec;
 }
 
-Pos **del_spec(Pos **spec, int nspec) {
+Sample **del_spec(Sample **spec, int nspec) {
   int i;
 
   if(spec) {
     for(i=0; i<nspec; i++)
-      del_pos(spec[i]);
+      del_sample(spec[i]);
     free(spec);
   }
   return NULL;
@@ -229,9 +230,9 @@ Spectrum *read_multispec(char *filename, int *nspec)
  *
  * Function read_spectrum
  *
- * Given an input filename, this function opens the file, counts the number
- *  of lines in the file, reads in the wavelength and flux data from the
- *  file, and stores those data in the appropriate array.
+ * Given an input filename, this function opens the file, reads in the
+ *  wavelength and flux data from the file in a single pass, and stores
+ *  those data in the appropriate array.
  *
  * **NB: The spectrum structure MUST be allocated before calling this
  *        function.
@@ -259,21 +260,11 @@ int read_spectrum(char *filename, Spectrum *spectrum)
     return 1;
   }
 
-  /*
-   * Count number of lines in input file
-   */
-
-  if((spectrum->nlines = n_lines(ifp,'#')) < 0) {
-    fprintf(stderr,"ERROR:  read_spectrum\n");
-    return 1;
-  }
-
   /*
    * Read in spectrum
    */
 
   if(no_error) {
-    rewind(ifp);
     if(read_spec_list(spectrum,ifp))
       no_error = 0;
   }
@@ -295,7 +286,8 @@ int read_spectrum(char *filename, Spectrum *spectrum)
  *
  * Reads data from input file which contains two columns, wavelength and
  *  flux.  Puts data. as well asmin and max flux values into the Spectrum
- *  structure.
+ *  structure.  The file is read in a single pass, so spectrum->nlines is
+ *  set by this function.
  *
  * Inputs: Spectrum *spectrum  wavelengths, fluxes, and associated info
  *         FILE *ifp           input file
@@ -307,30 +299,33 @@ int read_spectrum(char *filename, Spectrum *spectrum)
 int read_spec_list(Spectrum *spectrum, FILE *ifp)
 {
  int i;            /* Counting variable */
+ int nalloc=0;     /* Number of points allocated in spectrum->spec */
  float min;        /* Minimum flux */
  float max;        /* Maximum flux */
  float fluxdiff;   /* Difference between min and max */
  char line[MAXC];  /* General string for reading input */
- Pos *sp;          /* Pointer to navigate spectrum->spec */
+ Sample *sp;       /* Pointer to navigate spectrum->spec */
 
  /*
-  * Allocate memory and initialize
+  * Initialize
   */
 
- if(!(spectrum->spec = new_pos(spectrum->nlines,1))) {
-   fprintf(stderr,"ERROR: read_spec_list\n");
-   return 1;
- }
-
- sp = spectrum->spec;
+ spectrum->spec = NULL;
  i = 0;
 
  /*
-  * Read in data
+  * Read in data, growing the spectrum array as needed
   */
 
  while(fgets(line,MAXC,ifp) != NULL) {
    if(line[0] != '#') {
+     if(!(spectrum->spec = (Sample *) grow_array(spectrum->spec,&nalloc,
+						 i+1,sizeof(Sample)))) {
+       fprintf(stderr,"ERROR: read_spec_list\n");
+       return 1;
+     }
+     sp = spectrum->spec + i;
+     sp->flag = 0;
      if(sscanf(line,"%lf %lf",&sp->x,&sp->y) != 2) {
        fprintf(stderr,"ERROR: read_spec_list\n");
        return 1;
@@ -354,17 +349,19 @@ int read_spec_list(Spectrum *spectrum, FILE *ifp)
        max = sp->y;
      if(sp->y < min)
        min = sp->y;
-     sp++;
      i++;
    }
  }
 
- if(i != spectrum->nlines) {
-   fprintf(stderr,"ERROR: read_spec_list.  Unexpected number of lines\n");
+ spectrum->nlines = i;
+ if(i == 0) {
+   fprintf(stderr,"ERROR: read_spec_list.  No valid lines in input file\n");
    return 1;
  }
  else {
-   spectrum->maxlambda = (sp-1)->x;
+   spectrum->spec = (Sample *) shrink_array(spectrum->spec,&nalloc,i,
+					    sizeof(Sample));
+   spectrum->maxlambda = spectrum->spec[i-1].x;
    printf("read_spec_list: Read in %d lines.\n",spectrum->nlines);
    printf("read_spec_list: Min lambda = %7.1f, max lambda = %7.1f\n",
 	  spectrum->minlambda,spectrum->maxlambda);
@@ -1147,7 +1144,7 @@ int speclab(float marklamb, Labinfo label, Spectrum *spectrum, Spsetup *setup)
   float fmax,fmin;             /* To get min and max fluxes in shortave */
   float fluxdiff0;             /* Difference btwn minflux and maxflux */
   float fluxdiff;              /* Scaled version of fluxdiff0 */
-  Pos *spptr;                  /* Pointer to navigate spectrum->spec */
+  Sample *spptr;               /* Pointer to navigate spectrum->spec */
 
   /*
    * Set default plot parameters.
@@ -1435,14 +1432,14 @@ void labcorner(char *labtext, char side, int option)
  *
  * (Bruzual 1983)
  *
- * Inputs: Pos *spectrum       array of wavelengths and fluxes
+ * Inputs: Sample *spectrum    array of wavelengths and fluxes
  *         int npoints         number of sampled point in the spectrum
  *
  * Output:  int (0 or 1)       0 ==> success, 1 ==> error
  *
  */
 
-int calc_d4000(Pos *spectrum, int npoints)
+int calc_d4000(Sample *spectrum, int npoints)
 {
   int i;             /* Looping variable */
   int nlsum=0;       /* Temporary variable used in calculating averages */
@@ -1454,7 +1451,7 @@ int calc_d4000(Pos *spectrum, int npoints)
   float loave;       /* Average of the lower portion */
   float hiave;       /* Average of the higher portion */
   char line[MAXC];   /* General string variable for reading input lines */
-  Pos *spptr;        /* Pointer for navigating spectrum */
+  Sample *spptr;     /* Pointer for navigating spectrum */
 
   /*
    * Get redshift of system so that location of observed wavelengths can
@@ -1514,7 +1511,7 @@ int calc_d4000(Pos *spectrum, int npoints)
  *
  * Converts a spectrum from f_lambda units to f_nu units.
  *
- * Inputs: Pos *spectrum       input spectrum -- gets modified by this 
+ * Inputs: Sample *spectrum    input spectrum -- gets modified by this 
  *                              function.
  *         int npoints         number of points in the spectrum
  *         float *minflux      minimum flux in rescaled spectrum
@@ -1524,7 +1521,7 @@ int calc_d4000(Pos *spectrum, int npoints)
  *
  */
 
-int flambda_to_fnu(Pos *spectrum, int npoints, float *minflux,
+int flambda_to_fnu(Sample *spectrum, int npoints, float *minflux,
 		   float *maxflux)
 {
   int i;               /* Looping variable */
@@ -1532,7 +1529,7 @@ int flambda_to_fnu(Pos *spectrum, int npoints, float *minflux,
   float dnu;           /* Width of bin in frequency */
   float newmin,newmax; /* Min and max in rescaled spectrum */
   float fluxdiff;      /* Final difference between newmax and newmin */
-  Pos *sptr;           /* Pointer to navigate spectrum */
+  Sample *sptr;        /* Pointer to navigate spectrum */
 
   /*
    * First calculate bin width in lambda (assumed to be constant)
@@ -46,7 +46,7 @@ typedef struct {
 } Spsetup;
 
 typedef struct {
-  Pos *spec;           /* Actual spectrum */
+  Sample *spec;        /* Actual spectrum */
   int nlines;          /* Number of points in the spectrum */
   float minlambda;     /* Wavelength of first point in spectrum */
   float maxlambda;     /* Wavelength of last point in spectrum */
@@ -64,8 +64,8 @@ typedef struct {
 
 Spectrum *new_spectrum(int nspec);
 Spectrum *del_spectrum(Spectrum *spec);
-Pos **new_spec(int nspec);
-Pos **del_spec(Pos **spec, int nspec);
+Sample **new_spec(int nspec);
+Sample **del_spec(Sample **spec, int nspec);
 Spectrum *read_onespec(char *filename);
 Spectrum *read_multispec(char *filename, int *nspec);
 int read_spectrum(char *filename, Spectrum *spectrum);
@@ -87,8 +87,8 @@ int speclab(float marklamb, Labinfo label, Spectrum *spectrum, Spsetup *setup);
 int get_sky_label(float *marklamb, Labinfo *label);
 int label_plot(char *title, int titleopt, int flchoice, float cheight);
 void labcorner(char *text, char side, int option);
-int calc_d4000(Pos *spectrum, int npoints);
-int flambda_to_fnu(Pos *spectrum, int npoints, float *minflux, 
+int calc_d4000(Sample *spectrum, int npoints);
+int flambda_to_fnu(Sample *spectrum, int npoints, float *minflux, 
 		   float *maxflux);
 
 /*
@@ -15,6 +15,7 @@
  *   opening function) from match_astrom.c into this library.
  *  2010Dec21, CDF, Added functionality to plot_xyerr
  *                  Added a new function, plot_xy
+ *  2026Oct16, AGT, plot_spec and plot_specpts now take Sample arrays.
  */
 
 #include <stdio.h>
@@ -733,7 +734,7 @@ int plot_labs(char *name, int size, float pixscale)
  *  of the box surrounding the spectrum and the line type used in the
  *  plotting.
  *
- * Inputs: Pos *spectrum       array of wavelengths and fluxes
+ * Inputs: Sample *spectrum    array of wavelengths and fluxes
  *         int nlines          number of lines in array
  *         float minflux       min value of y axis
  *         float maxflux       max value of y axis
@@ -756,9 +757,10 @@ int plot_labs(char *name, int size, float pixscale)
  *                components into a call to the new function pos2xy (in the
  *                structdef library).
  * v15Oct01 CDF, Moved drawing of box into new plot_specbox function below.
+ * v16Oct26 AGT, Spectrum is now a Sample array, split with sample2xy.
  */
 
-int plot_spec(Pos *spectrum, int nlines, float minflux, float maxflux, 
+int plot_spec(Sample *spectrum, int nlines, float minflux, float maxflux, 
 	      float minlambda, float maxlambda, int ltype, int dobox,
 	      float cheight) 
 {
@@ -771,7 +773,7 @@ int plot_spec(Pos *spectrum, int nlines, float minflux, float maxflux,
    * Convert spectrum to flux and lambda arrays
    */
 
-  if(!(xy = pos2xy(spectrum,nlines,&ngood))) {
+  if(!(xy = sample2xy(spectrum,nlines,&ngood))) {
     fprintf(stderr,"ERROR: plot_spec\n");
     return 1;
   }
@@ -816,7 +818,7 @@ int plot_spec(Pos *spectrum, int nlines, float minflux, float maxflux,
  *  are used to control the plotting of the box surrounding the spectrum 
  *  and the line type used in the plotting.
  *
- * Inputs: Pos *spectrum       array of wavelengths and fluxes
+ * Inputs: Sample *spectrum    array of wavelengths and fluxes
  *         int nlines          number of lines in array
  *         float minflux       min value of y axis
  *         float maxflux       max value of y axis
@@ -838,9 +840,10 @@ int plot_spec(Pos *spectrum, int nlines, float minflux, float maxflux,
  *                components into a call to the new function pos2xy (in the
  *                structdef library).
  * v15Oct01 CDF, Moved drawing of box into new plot_specbox function below.
+ * v16Oct26 AGT, Spectrum is now a Sample array, split with sample2xy.
  */
 
-int plot_specpts(Pos *spectrum, int nlines, float minflux, float maxflux, 
+int plot_specpts(Sample *spectrum, int nlines, float minflux, float maxflux, 
 		 float minlambda, float maxlambda, int dobox,
 		 float cheight) 
 {
@@ -853,7 +856,7 @@ int plot_specpts(Pos *spectrum, int nlines, float minflux, float maxflux,
    * Convert spectrum to flux and lambda arrays
    */
 
-  if(!(xy = pos2xy(spectrum,nlines,&ngood))) {
+  if(!(xy = sample2xy(spectrum,nlines,&ngood))) {
     fprintf(stderr,"ERROR: plot_spec\n");
     return 1;
   }
@@ -22,10 +22,10 @@ int plot_pts(Posinfo *pts, int size, float pixscale, int npts,
 	     int color, int ptype);
 int plot_obsim(Posinfo *pi, int size, Modinfo *modinfo);
 int plot_labs(char *name, int size, float pixscale);
-int plot_spec(Pos *spectrum, int nlines, float minflux, float maxflux, 
+int plot_spec(Sample *spectrum, int nlines, float minflux, float maxflux, 
 	      float minlambda, float maxlambda, int ltype, int dobox,
 	      float cheight);
-int plot_specpts(Pos *spectrum, int nlines, float minflux, float maxflux, 
+int plot_specpts(Sample *spectrum, int nlines, float minflux, float maxflux, 
 		 float minlambda, float maxlambda, int dobox,
 		 float cheight);
 void plot_specbox(float minlambda, float maxlambda, float minflux, 
@@ -1,12 +1,17 @@
 /* set_astrom.c
  *
- * Usage: set_astrom fitsfile astrofile xycatfile ([setup_filename])
+ * Usage: set_astrom (-a) fitsfile astrofile xycatfile ([setup_filename])
  *
  * Description:  Plots a FITS file as a greyscale plot and then overlays
  *                the positions of a starlist (e.g., USNO stars) at a
  *                given angle.  The user can then interactively change the 
  *                PA and location of the starlist.  The output is a
  *                file that can be used as input to the iraf task ccmap.
+ *               With the -a flag, the central position, the PA and the 
+ *                pixel scale are instead found without any plotting or
+ *                typed input, by matching triangles of bright stars in 
+ *                the starlist and the catalog (see match_asterisms in 
+ *                catlib.c).
  *
  * Inputs:
  *  1. FITS file for which astrometry needs to be done.
@@ -21,6 +26,7 @@
  * To compile use the appropriate makefile in this directory.
  *
  * 26Jul2004 CDF,  A modification of astrom_rot.c
+ * v2026Oct16 AGT, Added the -a flag and the get_auto_pa function.
  *
  */
 
@@ -33,6 +39,7 @@
 #include "structdef.h"
 #include "coords.h"
 #include "dataio.h"
+#include "catlib.h"
 #include "fitsim.h"
 
 #define SIZE 30
@@ -44,6 +51,8 @@
  */
 
 Secat *make_astcat(char *posfile, char *astfile, int *nast, int format);
+int get_auto_pa(Secat *astcat, int nast, Secat *xycat, int nxy, 
+		Setup *setup, Simtrans *trans);
 void pa2dpos(double centx, double centy, double pa, Setup *setup, Secat *incat, 
 	     Secat *rotcat, int ncat);
 int print_clscript(Setup *setup, Secat *astcat, char *fitsname, char *clname);
@@ -63,6 +72,8 @@ int main(int argc, char *argv[])
 {
   int no_error=1;       /* Flag set to 0 on error */
   int usefile=0;        /* Flag set to 1 to use input setup file */
+  int autopa=0;         /* Flag set to 1 to find the PA automatically */
+  int firstarg=1;       /* argv index of the first file name */
   int format;           /* Format of astrometric file */
   int another_loop=1;   /* Flag set to 0 to stop loop of PA changes */
   int nast;             /* Number of astrometric stars */
@@ -82,13 +93,18 @@ int main(int argc, char *argv[])
   Secat *catdat=NULL;   /* SExtractor catalog data */
   Secat *rotcat=NULL;   /* A working copy of catdat */
   Secat *matchcat=NULL; /* Catalog of matches */
+  Simtrans trans;       /* Transform found by get_auto_pa */
 
   /*
    * Check the command line
    */
 
-  if(argc < 6) {
-    fprintf(stderr,"\nset_astrom requires at least five inputs:\n");
+  if(argc > 1 && strcmp(argv[1],"-a") == 0) {
+    autopa = 1;
+    firstarg = 2;
+  }
+  if(argc < firstarg + 5) {
+    fprintf(stderr,"\nset_astrom (-a) requires at least five inputs:\n");
     fprintf(stderr,"  1. Input fits file\n");
     fprintf(stderr,"  2. SExtractor file created from input fits file\n");
     fprintf(stderr,"  3. File containing approximate RA and Dec of field ");
@@ -99,7 +115,9 @@ int main(int argc, char *argv[])
     fprintf(stderr," Options for format:\n");
     fprintf(stderr,"  4 ==> \"RA(degrees) Dec(degrees)\" (2MASS format)\n");
     fprintf(stderr,"  5 ==> \"ID RAhr RAmin RAsec Decdeg Decmin Decsec\"");
-    fprintf(stderr,"  (distcalc output format)\n");
+    fprintf(stderr,"  (distcalc output format)\n\n");
+    fprintf(stderr," -a  Find the central position and PA without plotting ");
+    fprintf(stderr,"or typed input\n\n");
     return 1;
   }
 
@@ -107,17 +125,17 @@ int main(int argc, char *argv[])
    * Get the names of the files.
    */
 
-  strcpy(fitsfile,argv[1]);
-  strcpy(catfile,argv[2]);
-  strcpy(posfile,argv[3]);
-  strcpy(astfile,argv[4]);
-  if(sscanf(argv[5],"%d",&format) != 1) {
+  strcpy(fitsfile,argv[firstarg]);
+  strcpy(catfile,argv[firstarg+1]);
+  strcpy(posfile,argv[firstarg+2]);
+  strcpy(astfile,argv[firstarg+3]);
+  if(sscanf(argv[firstarg+4],"%d",&format) != 1) {
     fprintf(stderr,"ERROR: Bad value for format (input 5)\n\n");
     return 1;
   }
-  if(argc == 7) {
+  if(argc == firstarg + 6) {
     usefile = 1;
-    strcpy(setupfile,argv[6]);
+    strcpy(setupfile,argv[firstarg+5]);
   }
   else
     sprintf(setupfile,"");
@@ -178,9 +196,34 @@ int main(int argc, char *argv[])
   pa = 0.0;
   centx = setup->centx;
   centy = setup->centy;
-  printf("For first run setting central position to %7.1f %7.1f\n",
-	 centx,centy);
-  if(no_error)
+  if(!autopa)
+    printf("For first run setting central position to %7.1f %7.1f\n",
+	   centx,centy);
+
+  /*
+   * In automatic mode, get the central position, PA and pixel scale from 
+   *  the transform between the starlist offsets, in pixels, and the 
+   *  catalog.  The central position, at zero offset, lands on the shift 
+   *  of the transform, and the PA is measured the other way from its 
+   *  rotation angle.
+   */
+
+  if(no_error && autopa) {
+    if(get_auto_pa(astcat,nast,catdat,ncat,setup,&trans))
+      no_error = 0;
+    else {
+      centx = trans.dx;
+      centy = trans.dy;
+      pa = -trans.rot;
+      setup->pixscale /= trans.scale;
+      pa2dpos(centx,centy,pa,setup,astcat,rotcat,nast);
+      printf("\nCentral position: %8.2f %8.2f\n",centx,centy);
+      printf("PA:               %8.2f\n",pa);
+      printf("Pixel scale:      %8.5f\n",setup->pixscale);
+    }
+    another_loop = 0;
+  }
+  else if(no_error)
     if(cpgopen("/xs") <= 0)
       no_error = 0;
 
@@ -242,11 +285,13 @@ int main(int argc, char *argv[])
    * Clean up and exit
    */
 
-  cpgend();
+  if(!autopa)
+    cpgend();
   image = del_Image(image);
   setup = del_setup(setup);
   astcat = del_secat(astcat);
   catdat = del_secat(catdat);
+  rotcat = del_secat(rotcat);
   matchcat = del_secat(matchcat);
 
   if(no_error) {
@@ -284,8 +329,8 @@ Secat *make_astcat(char *posfile, char *astfile, int *nast, int format)
   int i;                /* Looping variable */
   int no_error=1;       /* Flag set to 0 on error */
   int ncent;            /* Number of lines in posfile */
-  Pos *offsets=NULL;    /* Array to hold offsets */
-  Pos *optr;            /* Pointer to navigate offsets */
+  Lpos *offsets=NULL;   /* Array to hold offsets */
+  Lpos *optr;           /* Pointer to navigate offsets */
   Skypos *skypos=NULL;  /* Array of sky positions */
   Skypos *skptr;        /* Pointer to navigate skypos */
   Secat *centpos=NULL;  /* Central position for distance calculations */
@@ -349,7 +394,7 @@ Secat *make_astcat(char *posfile, char *astfile, int *nast, int format)
    * Clean up and return
    */
 
-  offsets = del_pos(offsets);
+  offsets = del_lpos(offsets);
   skypos = del_skypos(skypos);
   centpos = del_secat(centpos);
 
@@ -361,6 +406,108 @@ Secat *make_astcat(char *posfile, char *astfile, int *nast, int format)
   }
 }
 
+/*.......................................................................
+ *
+ * Function get_auto_pa
+ *
+ * Finds the transform between the offsets of the astrometric stars from
+ *  the central position, converted to pixels with the current pixel 
+ *  scale, and the (x,y) positions in the catalog, by passing the 
+ *  brightest of each to match_asterisms.  The offsets are the ones used
+ *  by pa2dpos, i.e., for a PA of zero.  Stars that are further from the
+ *  central position than the diagonal of the image are skipped.
+ *
+ * Inputs: Secat *astcat       astrometric catalog containing offsets
+ *         int nast            number of members in astcat
+ *         Secat *xycat        catalog based on fits image (x,y) positions
+ *         int nxy             number of members in xycat
+ *         Setup *setup        setup structure containing the image size
+ *                              and pixel scale
+ *         Simtrans *trans     transform from offsets to (x,y) positions 
+ *                              (set by this function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int get_auto_pa(Secat *astcat, int nast, Secat *xycat, int nxy, 
+		Setup *setup, Simtrans *trans)
+{
+  int i;                  /* Looping variable */
+  int no_error=1;         /* Flag set to 0 on error */
+  int n1=0,n2;            /* Numbers of positions to be matched */
+  int *aindex=NULL;       /* Members of astcat in order of brightness */
+  int *xindex=NULL;       /* Members of xycat in order of brightness */
+  double diag;            /* Length of the image diagonal in pixels */
+  Lpos tmppos;            /* Temporary holder for x,y offset */
+  Lpos *pos1=NULL;        /* Offsets of the brightest astrometric stars */
+  Lpos *pos2=NULL;        /* Positions of the brightest catalog members */
+  Secat *aptr;            /* Pointer to navigate astcat */
+
+  /*
+   * Get the offsets and positions of the brightest objects
+   */
+
+  if(setup->pixscale <= 0.0) {
+    fprintf(stderr,"ERROR: get_auto_pa.  No pixel scale.\n");
+    return 1;
+  }
+  diag = sqrt(1.0 * setup->xsize * setup->xsize + 
+	      1.0 * setup->ysize * setup->ysize);
+  n2 = (nxy < NASTER) ? nxy : NASTER;
+  if(!(aindex = bright_index(astcat,nast)))
+    no_error = 0;
+  if(no_error)
+    if(!(xindex = bright_index(xycat,nxy)))
+      no_error = 0;
+  if(no_error)
+    if(!(pos1 = new_lpos(NASTER)) || !(pos2 = new_lpos(n2)))
+      no_error = 0;
+
+  if(no_error) {
+    for(i=0; i<nast && n1<NASTER; i++) {
+      aptr = astcat + aindex[i];
+      if(aptr->dpos / setup->pixscale > diag)
+	continue;
+      rth2xy(aptr->dpos,aptr->dpostheta,&tmppos,1);
+      pos1[n1].x = tmppos.x / setup->pixscale;
+      pos1[n1].y = tmppos.y / setup->pixscale;
+      n1++;
+    }
+    for(i=0; i<n2; i++) {
+      pos2[i].x = xycat[xindex[i]].x;
+      pos2[i].y = xycat[xindex[i]].y;
+    }
+  }
+
+  /*
+   * Match them
+   */
+
+  if(no_error) {
+    printf("\nMatching triangles of %d astrometric stars and the %d ",n1,n2);
+    printf("brightest catalog objects\n");
+    if(match_asterisms(pos1,n1,pos2,n2,trans))
+      no_error = 0;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  free(aindex);
+  free(xindex);
+  pos1 = del_lpos(pos1);
+  pos2 = del_lpos(pos2);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: get_auto_pa\n");
+    return 1;
+  }
+}
+
 /*.......................................................................
  *
  * Function pa2dpos
@@ -384,7 +531,7 @@ void pa2dpos(double centx, double centy, double pa, Setup *setup, Secat *incat,
 {
   int i;              /* Looping variables */
   double dpostheta;   /* New theta position */
-  Pos tmppos;         /* Temporary holder for x,y position */
+  Lpos tmppos;        /* Temporary holder for x,y position */
   Secat *iptr,*rptr;  /* Pointers to navigate incat and rotcat */
 
   /*
@@ -425,7 +572,7 @@ int pa2dpos(double centx, double centy, double pa, Secat *secat, Setup *setup)
   float r_circ;      /* Circle radius in pixels */
   double dpostheta;  /* New theta position */
   char *star;        /* Star number, without the root name */
-  Pos tmppos;        /* Temporary holder for x,y position */
+  Lpos tmppos;       /* Temporary holder for x,y position */
   Labinfo *lptr;     /* Pointer to navigate Setup->circle */
   Secat *sptr;       /* Pointer to navigate secat */
 
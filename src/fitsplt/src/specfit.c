@@ -27,9 +27,9 @@
  *
  */
 
-Pos *get_trace(Image *image);
-int clip_trace(Pos *trace, int ntrace);
-int find_wmean(Pos *slice, int npoints, float m, float b, int ysmax,
+Sample *get_trace(Image *image);
+int clip_trace(Sample *trace, int ntrace);
+int find_wmean(Sample *slice, int npoints, float m, float b, int ysmax,
 	       float *ymean);
 
 /*.......................................................................
@@ -55,11 +55,11 @@ int main(int argc, char *argv[])
   char *setupname;      /* Name of the optional setup file */
   Image *image=NULL;    /* The container of the FITS image array */
   Setup *setup=NULL;    /* Container for the image display info */
-  Pos **xslice={NULL};  /* 1D vertical slices */
-  Pos **yslice={NULL};  /* 1D horizontal slices */
-  Pos *slice=NULL;      /* A 1D slice through the image */
-  Pos *trace=NULL;      /* Y position of the trace */
-  Pos *pptr;            /* Pointer to navigate Pos arrays */
+  Sample **xslice={NULL}; /* 1D vertical slices */
+  Sample **yslice={NULL}; /* 1D horizontal slices */
+  Sample *slice=NULL;   /* A 1D slice through the image */
+  Sample *trace=NULL;   /* Y position of the trace */
+  Sample *pptr;         /* Pointer to navigate Sample arrays */
 
   /*
    * Check the command line
@@ -100,12 +100,12 @@ int main(int argc, char *argv[])
    *  Allocate memory for the slice arrays
    */
 
-  xslice = (Pos **) malloc(sizeof(Pos *) * image->nx);
+  xslice = (Sample **) malloc(sizeof(Sample *) * image->nx);
   if(!xslice) {
     fprintf(stderr,"ERROR:  Insufficient memory for xslice array.\n");
     no_error = 0;
   }
-  yslice = (Pos **) malloc(sizeof(Pos *) * image->ny);
+  yslice = (Sample **) malloc(sizeof(Sample *) * image->ny);
   if(!yslice) {
     fprintf(stderr,"ERROR:  Insufficient memory for yslice array.\n");
     no_error = 0;
@@ -224,12 +224,12 @@ int main(int argc, char *argv[])
   setup = del_setup(setup);
 #if 0
   for(i=0; i<image->nx; i++) {
-    xslice[i] = del_pos(xslice[i]);
+    xslice[i] = del_sample(xslice[i]);
   }
 #endif
   x = del_array(x);
   y = del_array(y);
-  trace = del_pos(trace);
+  trace = del_sample(trace);
   plot_close();
   printf("\nPlot closed.\n");
   if(xslice)
@@ -256,24 +256,24 @@ int main(int argc, char *argv[])
  *
  * Inputs: Image *image        2D spectrum and associated info.
  *
- * Output: Pos *trace          trace of spectrum
+ * Output: Sample *trace       trace of spectrum
  *
  */
 
-Pos *get_trace(Image *image)
+Sample *get_trace(Image *image)
 {
   int i;                /* Looping variable */
   int no_error=1;       /* Flag set to 0 on error */
   float smin,smax;      /* Minimum and maximum along a slice */
-  Pos *slice=NULL;      /* A 1D slice through the image */
-  Pos *trace=NULL;      /* Y position of the trace */
-  Pos *pptr;            /* Pointer to navigate Pos arrays */
+  Sample *slice=NULL;   /* A 1D slice through the image */
+  Sample *trace=NULL;   /* Y position of the trace */
+  Sample *pptr;         /* Pointer to navigate Sample arrays */
 
   /*
    * Allocate memory for trace
    */
 
-  if(!(trace = new_pos(image->nx,1))) {
+  if(!(trace = new_sample(image->nx))) {
     fprintf(stderr,"ERROR: get_trace.\n");
     return NULL;
   }
@@ -290,7 +290,7 @@ Pos *get_trace(Image *image)
       if(!(slice = make_vslice(image,i,0,image->ny-1,&smin,&smax,
 			       &pptr->y)))
 	no_error = 0;
-      slice = del_pos(slice);
+      slice = del_sample(slice);
     }
   }
 
@@ -298,7 +298,7 @@ Pos *get_trace(Image *image)
     return trace;
   else {
     fprintf(stderr,"ERROR: get_trace.\n");
-    return del_pos(trace);
+    return del_sample(trace);
   }
 }
 
@@ -308,7 +308,7 @@ Pos *get_trace(Image *image)
  *
  * Does a sigma-clipping on the trace.
  *
- * Inputs: Pos *trace          spectral trace
+ * Inputs: Sample *trace       spectral trace
  *         int ntrace          number of points in trace
  *
  * Output: int ngood           number of good points after clipping.
@@ -316,7 +316,7 @@ Pos *get_trace(Image *image)
  *
  */
 
-int clip_trace(Pos *trace, int ntrace)
+int clip_trace(Sample *trace, int ntrace)
 {
   int i;            /* Looping variable */
   int no_error=1;   /* Flag set to 0 on error */
@@ -325,7 +325,7 @@ int clip_trace(Pos *trace, int ntrace)
   float *yptr;      /* Pointer to navigate y */
   double rms;       /* RMS of trace */
   double mean;      /* Mean of trace */
-  Pos *pptr;        /* Pointer to navigate trace */
+  Sample *pptr;     /* Pointer to navigate trace */
 
   /*
    * Allocate memory for temporary container
@@ -406,7 +406,7 @@ int get_bkgd(float *b1lo, float *b1hi, float *b2lo, float *b2hi)
  *
  * Calculates the weighted mean of the background-subtracted profile.
  *
- * Inputs: Pos *slice          uncorrected profile
+ * Inputs: Sample *slice       uncorrected profile
  *         int npoints         number of points in the profile
  *         float m,b           parameters describing background
  *         int ysmax           location of profile maximum
@@ -416,13 +416,13 @@ int get_bkgd(float *b1lo, float *b1hi, float *b2lo, float *b2hi)
  *
  */
 
-int find_wmean(Pos *slice, int npoints, float m, float b, int ysmax,
+int find_wmean(Sample *slice, int npoints, float m, float b, int ysmax,
 	       float *ymean)
 {
   int i;           /* Looping variable */
   float count=0.0; /* Running count */
   float sum=0.0;   /* Running sum */
-  Pos *sptr;   /* Pointer for navigating slice */
+  Sample *sptr; /* Pointer for navigating slice */
 
   for(i=0,sptr=slice; i<npoints; i++,sptr++) {
     sum += ((sptr->y - (m*sptr->x + b)) * sptr->x);
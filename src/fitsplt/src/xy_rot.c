@@ -1,18 +1,24 @@
 /* xy_rot.c
  *
- * Usage: xy_rot fitsfile1 catfile1 fitsfile2 catfile2 ([setup_filename])
+ * Usage: xy_rot (-a) fitsfile1 catfile1 fitsfile2 catfile2 ([setup_filename])
  *
  * Description:  Plots two fits files as greyscale plots and then
  *                overlays the catalogs generated from the images.  The
  *                user then can rotate the positions obtained in the
  *                first plot until they match the positions in the second
  *                plot.
+ *               With the -a flag, the rotation and shift are instead 
+ *                found without any plotting or mouse clicks, by matching
+ *                triangles of bright objects in the two catalogs (see
+ *                match_asterisms in catlib.c).
  *
  * To compile use the appropriate makefile in this directory.
  *
  * 04Jun2004 CDF,  First working version
  * v2008Jul16 CDF, Small modifications to incorporate new image reading
  *                  and display-opening functions. 
+ * v2026Oct16 AGT, Added the -a flag and the get_auto_pa function.
+ *                 Now uses find_closest from catlib.c.
  *
  */
 
@@ -25,16 +31,20 @@
 #include "structdef.h"
 #include "coords.h"
 #include "dataio.h"
+#include "catlib.h"
 #include "fitsim.h"
 #include "plotfuncs.h"
 
+#define MATCHLIM 3.0     /* Maximum pixel offset for a "good" match */
+
 /*.......................................................................
  *
  * Function declarations
  *
  */
 
-Secat find_closest(Pos cpos, Secat *secat, int ncat);
+int get_auto_pa(Secat *cat1, int ncat1, Secat *cat2, int ncat2, 
+		Simtrans *trans);
 void markcatobj(Secat object);
 void catxy2dpos(Pos cpos, Secat *secat, int ncat);
 void pa2dpos(Pos cpos, double pa, Secat *incat, Secat *rotcat, int ncat);
@@ -49,12 +59,17 @@ int main(int argc, char *argv[])
 {
   int no_error=1;       /* Flag set to 0 on error */
   int usefile=0;        /* Flag set to 1 to use input setup file */
+  int autopa=0;         /* Flag set to 1 to find the PA automatically */
+  int firstarg=1;       /* argv index of the first file name */
+  int nfound=0;         /* Number of rotated objects with a match */
+  int i;                /* Looping variable */
   int another_loop=1;   /* Flag set to 0 to stop loop of PA changes */
   int screenflag=1;     /* Flag set to 0 for no screen output */
   int fileflag=1;       /* Flag set to 0 for no screen output */
   int ncat1,ncat2;      /* Number of catalog objects */
   float cx,cy;          /* Cursor position */
   double pa;            /* Position angle (N->E) */
+  double sep;           /* Distance to the closest catalog 2 object */
   char cchar='0';       /* Character returned by cursor command */
   char fitsfile1[MAXC]; /* The name of the 1st FITS file to load */
   char catfile1[MAXC];  /* The name of the 1st SExtractor catalog file */
@@ -74,14 +89,21 @@ int main(int argc, char *argv[])
   Secat *rotcat=NULL;   /* Rotated version of first catalog */
   Secat bestmatch1;     /* Closest match in catalog 1 to the cursor position */
   Secat bestmatch2;     /* Closest match in catalog 2 to the cursor position */
+  Simtrans trans;       /* Transform found by get_auto_pa */
+  Kdtree *tree=NULL;    /* Tree over the second catalog */
 
   /*
    * Check the command line
    */
 
-  if(argc < 5) {
-    fprintf(stderr,"\nxy_rot fitsfile1 catfile1 fitsfile2 catfile2 ");
+  if(argc > 1 && strcmp(argv[1],"-a") == 0) {
+    autopa = 1;
+    firstarg = 2;
+  }
+  if(argc < firstarg + 4) {
+    fprintf(stderr,"\nxy_rot (-a) fitsfile1 catfile1 fitsfile2 catfile2 ");
     fprintf(stderr,"(setupfile)\n\n");
+    fprintf(stderr," -a  Find the PA without plotting or mouse clicks\n\n");
     return 1;
   }
 
@@ -89,13 +111,13 @@ int main(int argc, char *argv[])
    * Get the names of the files.
    */
 
-  strcpy(fitsfile1,argv[1]);
-  strcpy(catfile1,argv[2]);
-  strcpy(fitsfile2,argv[3]);
-  strcpy(catfile2,argv[4]);
-  if(argc == 6) {
+  strcpy(fitsfile1,argv[firstarg]);
+  strcpy(catfile1,argv[firstarg+1]);
+  strcpy(fitsfile2,argv[firstarg+2]);
+  strcpy(catfile2,argv[firstarg+3]);
+  if(argc == firstarg + 5) {
     usefile = 1;
-    strcpy(setupfile,argv[5]);
+    strcpy(setupfile,argv[firstarg+4]);
   }
   else
     sprintf(setupfile,"");
@@ -126,7 +148,7 @@ int main(int argc, char *argv[])
    * Loop over displaying image until happy with results
    */
 
-  if(no_error) {
+  if(no_error && !autopa) {
     open_plot_window();
     if(display_image(image1,setup1))
       no_error = 0;
@@ -175,7 +197,7 @@ int main(int argc, char *argv[])
    * Loop over displaying image until happy with results
    */
 
-  if(no_error) {
+  if(no_error && !autopa) {
     open_plot_window();
     if(display_image(image1,setup1))
       no_error = 0;
@@ -212,7 +234,7 @@ int main(int argc, char *argv[])
    * Plot the catalog
    */
 
-  if(no_error) {
+  if(no_error && !autopa) {
     cpgslct(1);
     printf("\nPlotting SExtractor positions for first catalog\n");
     if(plot_secat(setup1,catdat1,ncat1,2,3,2.0))
@@ -231,7 +253,7 @@ int main(int argc, char *argv[])
    * Plot the catalog
    */
 
-  if(no_error) {
+  if(no_error && !autopa) {
     cpgslct(2);
     printf("\nPlotting SExtractor positions for second catalog\n");
     if(plot_secat(setup2,catdat2,ncat2,2,3,2.0))
@@ -239,11 +261,32 @@ int main(int argc, char *argv[])
   }
 
   /*
-   * Get the desired position in image 1
+   * In automatic mode, take the object closest to the center of image 1
+   *  as the center of rotation, and find its position in image 2 and the
+   *  PA from the transform between the catalogs.  The PA is measured 
+   *  the other way from the rotation angle of the transform.
    */
 
   printf("---------------------------------------------------------------\n");
-  if(no_error) {
+  if(no_error && autopa) {
+    if(get_auto_pa(catdat1,ncat1,catdat2,ncat2,&trans))
+      no_error = 0;
+    else {
+      cpos.x = setup1->xsize / 2.0;
+      cpos.y = setup1->ysize / 2.0;
+      bestmatch1 = find_closest(cpos,catdat1,ncat1,1);
+      bestmatch2 = bestmatch1;
+      apply_simtrans(&trans,bestmatch1.x,bestmatch1.y,&bestmatch2.x,
+		     &bestmatch2.y);
+      pa = -trans.rot;
+    }
+  }
+
+  /*
+   * Otherwise, get the desired position in image 1
+   */
+
+  if(no_error && !autopa) {
     cx = 0.0;
     cy = 0.0;
     printf("\n");
@@ -254,7 +297,7 @@ int main(int argc, char *argv[])
       printf("\nMouse clicked at: %7.2f %7.2f\n",cx,cy);
       cpos.x = cx;
       cpos.y = cy;
-      bestmatch1 = find_closest(cpos,catdat1,ncat1);
+      bestmatch1 = find_closest(cpos,catdat1,ncat1,1);
       printf("Position of closest match is: %7.2f %7.2f\n",
 	     bestmatch1.x,bestmatch1.y);
       markcatobj(bestmatch1);
@@ -269,14 +312,14 @@ int main(int argc, char *argv[])
    * Now get position in image 2
    */
 
-  if(no_error) {
+  if(no_error && !autopa) {
     printf("\n Now click the mouse on the object in the SECOND image\n");
     cpgslct(2);
     if(cpgcurs(&cx,&cy,&cchar)>0) {
       printf("\nMouse clicked at: %7.2f %7.2f\n",cx,cy);
       cpos.x = cx;
       cpos.y = cy;
-      bestmatch2 = find_closest(cpos,catdat2,ncat2);
+      bestmatch2 = find_closest(cpos,catdat2,ncat2,1);
       printf("Position of closest match is: %7.2f %7.2f\n\n",
 	     bestmatch2.x,bestmatch2.y);
       markcatobj(bestmatch2);
@@ -309,17 +352,45 @@ int main(int argc, char *argv[])
       no_error = 0;
 
   /*
-   * Redisplay image 2 and loop on PA.  
+   * In automatic mode, rotate the first catalog by the PA that was found
+   *  and count the objects that land on objects in the second catalog.
    */
 
-  pa = 0.0;
   cpos.x = bestmatch2.x;
   cpos.y = bestmatch2.y;
-  cpgslct(2);
+  if(no_error && autopa) {
+    pa2dpos(cpos,pa,catdat1,rotcat,ncat1);
+    if(!(tree = new_kdtree(catdat2,ncat2)))
+      no_error = 0;
+    else {
+      for(i=0; i<ncat1; i++)
+	if(kd_nearest(tree,rotcat[i].x,rotcat[i].y,MATCHLIM,&sep) >= 0)
+	  nfound++;
+      printf("\nPA = %6.2f degrees about catalog 1 object ID=%d\n",pa,
+	     bestmatch1.id);
+      printf("Center of rotation is at %8.2f %8.2f in image 2\n",cpos.x,
+	     cpos.y);
+      if(fabs(trans.scale - 1.0) > 0.01)
+	printf("WARNING: The images differ in scale by %7.4f\n",trans.scale);
+      printf("%d of %d rotated catalog 1 positions are within %3.1f pix ",
+	     nfound,ncat1,MATCHLIM);
+      printf("of a catalog 2 object\n");
+    }
+    another_loop = 0;
+  }
+
+  /*
+   * Otherwise, redisplay image 2 and loop on PA.  
+   */
+
+  else {
+    pa = 0.0;
+    cpgslct(2);
+    printf("---------------------------------------------------------------\n");
+    printf("\nRedisplaying second image, but with shifted catalog from ");
+    printf("first image.\n");
+  }
 
-  printf("---------------------------------------------------------------\n");
-  printf("\nRedisplaying second image, but with shifted catalog from first ");
-  printf("image.\n");
   while(another_loop && no_error) {
     pa2dpos(cpos,pa,catdat1,rotcat,ncat1);
     if(display_image(image2,setup2))
@@ -345,13 +416,14 @@ int main(int argc, char *argv[])
   }
 
 
-  cpgend();
-
   /*
    * Clean up and exit
    */
 
-  cpgend();
+  if(!autopa)
+    cpgend();
+  tree = del_kdtree(tree);
+  rotcat = del_secat(rotcat);
   image1 = del_Image(image1);
   setup1 = del_setup(setup1);
   catdat1 = del_secat(catdat1);
@@ -371,52 +443,86 @@ int main(int argc, char *argv[])
 
 /*.......................................................................
  *
- * Function find_closest
+ * Function get_auto_pa
  *
- * Finds the object giving the closest match between the input postion and 
- *  the members of a SExtractor catalog.
- *  The closest matching positions are returned in a Secat structure.
+ * Finds the transform between the (x,y) positions in two catalogs, 
+ *  without a starting guess, by passing the positions of the brightest
+ *  objects in each to match_asterisms.
  *
- * Inputs: Pos cpos            input position
- *         Secat *secat        catalog based on fits image (x,y) positions
- *         int ncat            number of members in secat
+ * Inputs: Secat *cat1         first catalog
+ *         int ncat1           number of members in cat1
+ *         Secat *cat2         second catalog
+ *         int ncat2           number of members in cat2
+ *         Simtrans *trans     transform from cat1 to cat2 positions (set
+ *                              by this function)
  *
- * Output: Secat bestmatch     best match
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
  *
  */
 
-Secat find_closest(Pos cpos, Secat *secat, int ncat)
+int get_auto_pa(Secat *cat1, int ncat1, Secat *cat2, int ncat2, 
+		Simtrans *trans)
 {
-  int i,j;                /* Looping variables */
-  double dx,dy,dpos;      /* Offsets between (x,y) pairs */
-  double mindpos;         /* Running minimum position offset */
-  Secat bestmatch;        /* Container for best-matching xy object */
-  Secat *sptr;            /* Pointers to navigate astcat and xycat */
+  int i;                  /* Looping variable */
+  int no_error=1;         /* Flag set to 0 on error */
+  int n1,n2;              /* Numbers of positions to be matched */
+  int *index1=NULL;       /* Members of cat1 in order of brightness */
+  int *index2=NULL;       /* Members of cat2 in order of brightness */
+  Lpos *pos1=NULL;        /* Positions of the brightest members of cat1 */
+  Lpos *pos2=NULL;        /* Positions of the brightest members of cat2 */
 
   /*
-   * Loop through catalog
+   * Get the positions of the brightest objects
    */
 
-  dx = cpos.x - secat->x;
-  dy = cpos.y - secat->y;
-  bestmatch.dpos = sqrt(dx*dx + dy*dy);
-  for(i=0,sptr=secat; i < ncat; i++,sptr++) {
-    dx = cpos.x - sptr->x;
-    dy = cpos.y - sptr->y;
-    if((dpos = sqrt(dx*dx + dy*dy)) < bestmatch.dpos) {
-      bestmatch = *sptr;
-      bestmatch.dpos = dpos;
+  n1 = (ncat1 < NASTER) ? ncat1 : NASTER;
+  n2 = (ncat2 < NASTER) ? ncat2 : NASTER;
+  if(!(index1 = bright_index(cat1,ncat1)))
+    no_error = 0;
+  if(no_error)
+    if(!(index2 = bright_index(cat2,ncat2)))
+      no_error = 0;
+  if(no_error)
+    if(!(pos1 = new_lpos(n1)) || !(pos2 = new_lpos(n2)))
+      no_error = 0;
+
+  if(no_error) {
+    for(i=0; i<n1; i++) {
+      pos1[i].x = cat1[index1[i]].x;
+      pos1[i].y = cat1[index1[i]].y;
+    }
+    for(i=0; i<n2; i++) {
+      pos2[i].x = cat2[index2[i]].x;
+      pos2[i].y = cat2[index2[i]].y;
     }
   }
-  printf("For this position, the best match is ID=%d at",
-	 bestmatch.id);
-  printf(" mindpos = %6.3f pix\n",bestmatch.dpos);
 
   /*
-   * Exit
+   * Match them
    */
 
-  return bestmatch;
+  if(no_error) {
+    printf("\nMatching triangles of the %d and %d brightest objects\n",
+	   n1,n2);
+    if(match_asterisms(pos1,n1,pos2,n2,trans))
+      no_error = 0;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  free(index1);
+  free(index2);
+  pos1 = del_lpos(pos1);
+  pos2 = del_lpos(pos2);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: get_auto_pa\n");
+    return 1;
+  }
 }
 
 /*.......................................................................
@@ -462,7 +568,7 @@ void catxy2dpos(Pos cpos, Secat *secat, int ncat)
   int i,j;                /* Looping variables */
   double dx,dy,dpos;      /* Offsets between (x,y) pairs */
   double mindpos;         /* Running minimum position offset */
-  Pos tmppos;             /* Temporary container for (x,y) offset */
+  Lpos tmppos;            /* Temporary container for (x,y) offset */
   Secat *sptr;            /* Pointers to navigate astcat and xycat */
 
   /*
@@ -499,7 +605,7 @@ void pa2dpos(Pos cpos, double pa, Secat *incat, Secat *rotcat, int ncat)
 {
   int i;              /* Looping variables */
   double dpostheta;   /* New theta position */
-  Pos tmppos;         /* Temporary holder for x,y position */
+  Lpos tmppos;        /* Temporary holder for x,y position */
   Secat *iptr,*rptr;  /* Pointers to navigate incat and rotcat */
 
   /*
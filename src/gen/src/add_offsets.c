@@ -8,6 +8,12 @@
  *                central position and offsets in arcsec
  *
  * 27Jun00 CDF,  A modification of distcalc.c
+ * 16Oct2026 AGT, The central position is read with parse_hms and the 
+ *                positions are kept in decimal degrees (see ddeg2deg) and
+ *                printed with format_ra and format_dec, instead of going
+ *                through arrays of Skypos.
+ *               Positions and offsets are now Lpos arrays, with their 
+ *                labels kept in a Labpool.
  */
 
 #include <stdio.h>
@@ -23,9 +29,10 @@
  *
  */
 
-Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets);
-int print_spos(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
-	       char *outname);
+Lpos *read_offset_file(char *inname, Lpos *cent, Labpool *labels,
+		       int *noffsets);
+int print_spos(Lpos cent, Lpos *adpos, Lpos *offsets, int noffsets,
+	       Labpool *labels, char *outname);
 
 /*.......................................................................
  *
@@ -39,9 +46,10 @@ int main(int argc, char *argv[])
   int noffsets;         /* Number of offsets */
   char inname[MAXC];    /* Input filename */
   char outname[MAXC];   /* Input filename */
-  Pos *offsets=NULL;    /* Array of offsets from the central position */
-  Skypos cent;          /* Central position */
-  Skypos *skypos=NULL;  /* Array of calculated sky positions */
+  Lpos *offsets=NULL;   /* Array of offsets from the central position */
+  Lpos cent;            /* Central position in decimal degrees */
+  Lpos *adpos=NULL;     /* Calculated sky positions in decimal degrees */
+  Labpool *labels=NULL; /* Labels of the central position and offsets */
 
   /*
    * Check input line format
@@ -62,8 +70,10 @@ int main(int argc, char *argv[])
    */
 
   strcpy(inname,argv[1]);
-  if((offsets = read_offset_file(inname,&cent,&noffsets)) == NULL ||
-     noffsets == 0) {
+  if(!(labels = new_labpool(64)))
+    no_error = 0;
+  else if((offsets = read_offset_file(inname,&cent,labels,&noffsets)) == NULL
+	  || noffsets == 0) {
     fprintf(stderr,"ERROR.  Problem with input file.\n");
     no_error = 0;
   }
@@ -73,7 +83,7 @@ int main(int argc, char *argv[])
    */
 
   if(no_error)
-    if((skypos = dspos2spos(cent,offsets,noffsets)) == NULL)
+    if((adpos = ddeg2deg(cent,offsets,noffsets)) == NULL)
       no_error = 0;
 
   /*
@@ -83,11 +93,11 @@ int main(int argc, char *argv[])
   if(no_error) {
     if(argc == 3) {
       strcpy(outname,argv[2]);
-      if(print_spos(cent,skypos,offsets,noffsets,outname))
+      if(print_spos(cent,adpos,offsets,noffsets,labels,outname))
 	no_error = 0;
     }
     else
-      if(print_spos(cent,skypos,offsets,noffsets,NULL))
+      if(print_spos(cent,adpos,offsets,noffsets,labels,NULL))
 	no_error = 0;
   }
 
@@ -95,8 +105,9 @@ int main(int argc, char *argv[])
    * Clean up and exit
    */
 
-  offsets = del_pos(offsets);
-  skypos = del_skypos(skypos);
+  offsets = del_lpos(offsets);
+  adpos = del_lpos(adpos);
+  labels = del_labpool(labels);
 
   if(no_error) {
     printf("\nCompleted program add_offsets.\n\n");
@@ -118,22 +129,28 @@ int main(int argc, char *argv[])
  *  contain offsets in the form "label dra ddec" in arcsec.
  *
  * Inputs: char *inname        name of input file
- *         Skypos *cent        central position (set by this function)
+ *         Lpos *cent          central position in decimal degrees (set by
+ *                              this function)
+ *         Labpool *labels     pool for the labels of the central position
+ *                              and the offsets (added to by this function)
  *         int *noffsets       number of offsets in data file (set by
  *                              this function)
  *
- * Output: Pos *offsets        array containing offsets
+ * Output: Lpos *offsets       array containing offsets
  *
  */
 
-Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
+Lpos *read_offset_file(char *inname, Lpos *cent, Labpool *labels,
+		       int *noffsets)
 {
   int no_error=1;       /* Flag set to 0 on error */
   int nlines=0;         /* Number of data lines in input file */
   int count=0;          /* Number of lines actually read in */
   char line[MAXC];      /* General string variable for reading inputs */
-  Pos *offsets=NULL;    /* Array for offsets */
-  Pos *pptr;            /* Pointer to step through offsets array */
+  char label[MAXC];     /* Label read from a line */
+  char *ptr;            /* Position after the label in line */
+  Lpos *offsets=NULL;   /* Array for offsets */
+  Lpos *pptr=NULL;      /* Pointer to step through offsets array */
   FILE *ifp=NULL;       /* Input file pointer */
 
   /*
@@ -164,12 +181,10 @@ Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
    * Allocate memory for the array of positional offsets
    */
 
-  if(no_error) {
-    if(!(offsets = new_pos(nlines-1,1)))
+  if(no_error)
+    if(!(offsets = new_lpos(nlines-1)))
       no_error = 0;
-    else
-      pptr = offsets;
-  }
+  pptr = offsets;
 
 
   /*
@@ -185,15 +200,18 @@ Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
        */
 
       if(count == 1) {
-	if(sscanf(line,"%s %d %d %lf %d %d %lf",
-		  cent->label,&cent->hr,&cent->min,&cent->sec,
-		  &cent->deg,&cent->amin,&cent->asec) != 7) {
+	ptr = line + strspn(line," \t");
+	ptr += strcspn(ptr," \t\r\n");
+	if(sscanf(line,"%s",label) != 1 ||
+	   parse_hms(ptr,&cent->x,&cent->y,NULL)) {
 	  fprintf(stderr,"ERROR: read_offset_file.\n");
 	  fprintf(stderr,"   First data line of input file must be of ");
 	  fprintf(stderr,"the form\n");
 	  fprintf(stderr,"   label rahr ramin rasec decdeg decmin decsec\n");
 	  no_error = 0;
 	}
+	else if((cent->labid = labpool_add(labels,label)) < 0)
+	  no_error = 0;
       }
 
       /*
@@ -201,7 +219,7 @@ Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
        */
 
       else if(line[0] != '\n') {
-	if(sscanf(line,"%s %lf %lf",pptr->label,&pptr->x,&pptr->y) != 3) {
+	if(sscanf(line,"%s %lf %lf",label,&pptr->x,&pptr->y) != 3) {
 	  fprintf(stderr,"ERROR: read_offset_file.\n");
 	  fprintf(stderr,"   Positional offset data lines must be of ");
 	  fprintf(stderr,"the form\n");
@@ -209,6 +227,8 @@ Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
 	  fprintf(stderr,"   where dra and ddec are in arcsec.\n");
 	  no_error = 0;
 	}
+	else if((pptr->labid = labpool_add(labels,label)) < 0)
+	  no_error = 0;
 	else
 	  pptr++;
       }
@@ -225,7 +245,7 @@ Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
   }
   else {
     fprintf(stderr,"ERROR: read_offset_file\n");
-    return(del_pos(offsets));
+    return(del_lpos(offsets));
   }
 }
 
@@ -237,25 +257,29 @@ Pos *read_offset_file(char *inname, Skypos *cent, int *noffsets)
  *  and the list of offsets.
  * NB:  This produces output of the same format as distcalc.c.
  *
- * Inputs: Skypos cent         central position (RA, Dec)
- *         Skypos *skypos      calculated positions (RA, Dec)
- *         Pos *offsets        (x,y) offsets
+ * Inputs: Lpos cent           central position in decimal degrees
+ *         Lpos *adpos         calculated positions in decimal degrees
+ *         Lpos *offsets       (x,y) offsets
  *         int noffsets        number of offsets
+ *         Labpool *labels     labels of cent and offsets
  *         char *outname       output file name (NULL if no output file)
  *
  * Output: int (0 or 1)        0 ==> success, 1 ==> error
  *
  */
 
-int print_spos(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
-	       char *outname)
+int print_spos(Lpos cent, Lpos *adpos, Lpos *offsets, int noffsets,
+	       Labpool *labels, char *outname)
 {
-  int i;          /* Looping variable */
-  char ew[5];     /* Direction of delta_RA */
-  char ns[5];     /* Direction of delta_Dec */
-  Skypos *sptr;   /* Pointer used to navigate skypos */
-  Pos *optr;      /* Pointer used to navigate offsets */
-  FILE *ofp=NULL; /* Output file pointer */
+  int i;            /* Looping variable */
+  char ew[5];       /* Direction of delta_RA */
+  char ns[5];       /* Direction of delta_Dec */
+  char ra[HMSLEN];  /* RA in hh mm ss.ssss format */
+  char dec[HMSLEN]; /* Dec in dd mm ss.sss format */
+  char *centlab;    /* Label of the central position */
+  Lpos *aptr;       /* Pointer used to navigate adpos */
+  Lpos *optr;       /* Pointer used to navigate offsets */
+  FILE *ofp=NULL;   /* Output file pointer */
 
   /*
    * Open the output file if one is desired
@@ -271,13 +295,15 @@ int print_spos(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
    * Print out the central position
    */
 
+  centlab = labpool_get(labels,cent.labid);
+  format_ra(cent.x,' ',4,ra);
+  format_dec(cent.y,' ',4,dec);
   if(ofp) {
     fprintf(ofp,"#\n");
     fprintf(ofp,"#\n");
-    fprintf(ofp,"#                CENTRAL SOURCE:  %s\n",cent.label);
+    fprintf(ofp,"#                CENTRAL SOURCE:  %s\n",centlab);
     fprintf(ofp,"#\n");
-    fprintf(ofp,"#Central source:  %02d %02d %07.4f  %+03d %02d %07.4f\n",
-	    cent.hr,cent.min,cent.sec,cent.deg,cent.amin,cent.asec);
+    fprintf(ofp,"#Central source:  %s  %s\n",ra,dec);
     fprintf(ofp,"#\n");
     fprintf(ofp,"#                                         ");
     fprintf(ofp,"Shift FROM central source\n");
@@ -291,13 +317,12 @@ int print_spos(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
   else {
     printf("#\n");
     printf("#\n");
-    if(strcmp(cent.label,"") != 0) {
-      printf("#                CENTRAL SOURCE:  %s\n",cent.label);
+    if(strcmp(centlab,"") != 0) {
+      printf("#                CENTRAL SOURCE:  %s\n",centlab);
     }
     printf("#\n");
     printf("#\n");
-    printf("#Central source:  %02d %02d %07.4f  %+03d %02d %07.4f\n",
-	   cent.hr,cent.min,cent.sec,cent.deg,cent.amin,cent.asec);
+    printf("#Central source:  %s  %s\n",ra,dec);
     printf("#\n");
     printf("#                                         ");
     printf("Shift FROM central source\n");
@@ -309,7 +334,7 @@ int print_spos(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
     printf("-----------  -----------  ---------\n");
   }
 
-  for(i=0,sptr=skypos,optr=offsets; i<noffsets; i++,sptr++,optr++) {
+  for(i=0,aptr=adpos,optr=offsets; i<noffsets; i++,aptr++,optr++) {
 
     /*
      * Determine the direction of the shift
@@ -328,18 +353,16 @@ int print_spos(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
      * Print output to file or to STDOUT
      */
 
+    format_ra(aptr->x,' ',4,ra);
+    format_dec(aptr->y,' ',3,dec);
     if(ofp) {
-      fprintf(ofp,"%11s  %02d %02d %07.4f  %+03d %02d %06.3f ",
-	      optr->label,sptr->hr,sptr->min,sptr->sec,
-	      sptr->deg,sptr->amin,sptr->asec);
+      fprintf(ofp,"%11s  %s  %s ",labpool_get(labels,optr->labid),ra,dec);
       fprintf(ofp,"%10.4f %1s %10.4f %1s %10.4f\n",
 	      fabs(optr->x),ew,fabs(optr->y),ns,
 	      sqrt(optr->x * optr->x + optr->y * optr->y));
     }
     else {
-      printf("%11s  %02d %02d %07.4f  %+03d %02d %06.3f ",
-	      optr->label,sptr->hr,sptr->min,sptr->sec,
-	      sptr->deg,sptr->amin,sptr->asec);
+      printf("%11s  %s  %s ",labpool_get(labels,optr->labid),ra,dec);
       printf("%10.4f %1s %10.4f %1s %10.4f\n",
 	      fabs(optr->x),ew,fabs(optr->y),ns,
 	      sqrt(optr->x * optr->x + optr->y * optr->y));
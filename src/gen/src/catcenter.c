@@ -1,16 +1,24 @@
 /*
  * catcenter.c
  *
- * Usage: catcenter [input_catalog] [output_filename] 
+ * Usage: catcenter (-a) [input_catalog] [output_filename] 
  *   [calcmethod] ([format])
  *
  * This program finds the median position in a catalog.
+ * With the -a flag the median is estimated with a running approximate
+ *  median (see add_medstream), which does not need a copy of the 
+ *  positions, for very large catalogs.
  * The calcmethod parameter sets whether offsets are calculated based
  *  on (x,y) coordinates (calcmethod=xy) or (RA,Dec) coordinates
  *  (calcmethod=radec). 
  *
  * Revision history:
  *  2007Feb09, Chris Fassnacht (CDF) - First working version
+ *  2026Oct16, AGT - med_secat reads only the position columns that it uses
+ *  2026Oct16, AGT - The catalog is now sorted with sort_sdss_key
+ *  2026Oct16, AGT - The medians are now found with median_select instead
+ *                    of sorting the positions.  Added the -a flag.  
+ *                    med_sdss now finds the median of a SDSS catalog.
  */
 
 #include <stdio.h>
@@ -29,8 +37,11 @@
  */
 
 void catcenter_help();
-int med_secat(char *catfile, char *outfile, char *calcmethod, int format);
-int med_sdss(char *catfile, char *outfile, int format);
+int med_secat(char *catfile, char *outfile, char *calcmethod, int format,
+	      int approx);
+int med_sdss(char *catfile, char *outfile, int format, int approx);
+int median_pos(double *xcol, double *ycol, int ncat, int approx, 
+	       int isradec);
 
 
 /*.......................................................................
@@ -43,6 +54,8 @@ int main(int argc, char *argv[])
 {
   int no_error=1;          /* Flag set to 0 on error */
   int format;              /* Format of input/output files */
+  int approx=0;            /* Flag set to 1 for an approximate median */
+  int firstarg=1;          /* argv index of the catalog filename */
   char catfile[MAXC];      /* Filename for input catalog */
   char posfile[MAXC];      /* File containing central position */
   char outfile[MAXC];      /* Filename for input catalog */
@@ -52,7 +65,11 @@ int main(int argc, char *argv[])
    * Check the command line invocation
    */
 
-  if(argc < 3) {
+  if(argc > 1 && strcmp(argv[1],"-a") == 0) {
+    approx = 1;
+    firstarg++;
+  }
+  if(argc - firstarg < 3) {
     catcenter_help();
     return 1;
   }
@@ -62,11 +79,11 @@ int main(int argc, char *argv[])
    * Get the inputs from the command line.
    */
 
-  strcpy(catfile,argv[1]);
-  strcpy(outfile,argv[2]);
-  strcpy(calcmethod,argv[3]);
-  if(argc == 5) {
-    if(sscanf(argv[4],"%d",&format) != 1)
+  strcpy(catfile,argv[firstarg]);
+  strcpy(outfile,argv[firstarg+1]);
+  strcpy(calcmethod,argv[firstarg+2]);
+  if(argc - firstarg == 4) {
+    if(sscanf(argv[firstarg+3],"%d",&format) != 1)
       no_error = 0;
   }
   else
@@ -79,11 +96,11 @@ int main(int argc, char *argv[])
   if(no_error) {
     switch(format){
     case 11: case 12:
-      if(med_sdss(catfile,outfile,format))
-	no_error = 1;
+      if(med_sdss(catfile,outfile,format,approx))
+	no_error = 0;
       break;
     default:
-      if(med_secat(catfile,outfile,calcmethod,format))
+      if(med_secat(catfile,outfile,calcmethod,format,approx))
 	no_error = 0;
     }
   }
@@ -110,273 +127,206 @@ int main(int argc, char *argv[])
  * Here, the input file is a SExtractor output file, or at least a file that
  *  has a format compatible with a SExtractor format, in contrast to a
  *  SDSS-like file that has magnitudes for multiple bands all in one file.
- *  This function does the sorting and finds the median position
+ *  This function reads the positions and finds the median position
  *
  * Inputs: 
  *  char *catfile         filename for input catalog
  *  char *outfile         output filename
  *  char *calcmethod      method of calculating offsets
  *  int format            format of input catalog file
+ *  int approx            1 ==> approximate median (see median_pos)
  */
 
-int med_secat(char *catfile, char *outfile, char *calcmethod, int format)
+int med_secat(char *catfile, char *outfile, char *calcmethod, int format,
+	      int approx)
 {
-  int i;                   /* Looping variable */
   int no_error=1;          /* Flag set to 0 on error */
-  int ncat;                /* Number of lines in the input catalog */
-  int centindex;           /* Catalog index of closest match to central pos */
-  double *ra=NULL;         /* Vector for RA (or x) coordinate */
-  double *dec=NULL;        /* Vector for Dec (or y) coordinate */
-  double *dptr;            /* Pointer to navigate ra and dec */
-  double *tptr;            /* Pointer to navigate ra and dec */
-  Pos centpos;             /* Output central position */
-  Skypos centskypos;       /* Central position in hms format */
-  Secat *secat=NULL;       /* Data array from catalog */
-  Secat *sptr;             /* Pointer to navigate secat */
-
-  /*
-   * Fill the data structure
-   */
-
-  if(no_error)
-    if(!(secat = read_secat(catfile,'#',&ncat,format)))
-      no_error = 0;
+  Colcat *colcat=NULL;     /* Positions from catalog */
 
   /*
-   * Allocate memory for RA and Dec (or x and y) arrays
+   * Fill the data structure.  Only the positions are needed.
    */
 
-  if(no_error)
-    if(!(ra = new_doubarray(ncat)))
-      no_error = 0;
-  if(no_error)
-    if(!(dec = new_doubarray(ncat)))
+  if(no_error) {
+    if(strcmp(calcmethod,"radec") == 0)
+      colcat = read_colcat_cols(catfile,'#',format,"alpha,delta");
+    else
+      colcat = read_colcat_cols(catfile,'#',format,"x,y");
+    if(!colcat)
       no_error = 0;
-
-  /*
-   * Sort (RA,Dec) coordinates if calcmethod == radec
-   */
-
-  if(strcmp(calcmethod,"radec") == 0 && no_error) {
-
-    /*
-     * Fill the RA and Dec arrays
-     */
-
-    for(i=0,sptr=secat,dptr=ra; i<ncat; i++,sptr++,dptr++)
-      *dptr = sptr->alpha;
-    for(i=0,sptr=secat,dptr=dec; i<ncat; i++,sptr++,dptr++)
-      *dptr = sptr->delta;
-  }
-
-  /*
-   * Otherwise, fill the ra and dec arrays with the x and y positions from
-   *  the input catalog.
-   */
-
-  else {
-    if(no_error) {
-
-      /*
-       * Fill the RA and Dec arrays
-       */
-
-      for(i=0,sptr=secat,dptr=ra; i<ncat; i++,sptr++,dptr++)
-	*dptr = sptr->x;
-      for(i=0,sptr=secat,dptr=dec; i<ncat; i++,sptr++,dptr++)
-	*dptr = sptr->y;
-
-    }
-  }
-
-  /*
-   * Sort the RA and Dec arrays
-   */
-
-  qsort(ra,ncat,sizeof(ra[0]),dcmp);
-  qsort(dec,ncat,sizeof(dec[0]),dcmp);
-
-  /*
-   * Find median position by taking middle values of the ra and dec arrays.  
-   * The definition of "middle value" depends on whether the number of
-   *   elements in the array (ncat) is even or odd.
-   */
-
-  if((ncat/2.0) - (int) (ncat/2.0) == 0) {
-    centindex = ncat / 2;
-    centpos.x = (ra[centindex-1] + ra[centindex])/2.0;
-    centpos.y = (dec[centindex-1] + dec[centindex])/2.0;
-  }
-  else {
-    centindex = (ncat - 1) / 2;
-    centpos.x = ra[centindex];
-    centpos.y = dec[centindex];
   }
 
   /*
-   * Print out the central position.  If calcmethod is radec, also express
-   *  the answer in hms format.
+   * Find the median of the RA and Dec (or x and y) columns
    */
 
   if(no_error) {
-    printf("\n");
-    for(i=0,dptr=ra,tptr=dec; i<ncat; i++,dptr++,tptr++) {
-      deg2spos(*dptr,*tptr,&centskypos);
-      print_skypos(stdout,centskypos);
-      printf("\n");
+    if(strcmp(calcmethod,"radec") == 0) {
+      if(median_pos(colcat->alpha,colcat->delta,colcat->ncat,approx,1))
+	no_error = 0;
     }
-    printf("\nMedian position in the catalog is %lf %lf\n",centpos.x,centpos.y);
-    if(strcmp(calcmethod,"radec") == 0 && no_error) {
-      deg2spos(centpos.x,centpos.y,&centskypos);
-      print_skypos(stdout,centskypos);
+    else {
+      if(median_pos(colcat->x,colcat->y,colcat->ncat,approx,0))
+	no_error = 0;
     }
   }
 
-
   /*
    * Clean up and exit
    */
 
-  secat = del_secat(secat);
-  ra = del_doubarray(ra);
-  dec = del_doubarray(dec);
+  colcat = del_colcat(colcat);
 
   if(no_error)
     return 0;
   else {
-    fprintf(stderr,"ERROR: sort_secat\n");
-    return 0;
+    fprintf(stderr,"ERROR: med_secat\n");
+    return 1;
   }
 }
 
 /*.......................................................................
  *
- * Function sort_sdss
+ * Function med_sdss
  *
- * Here, the input file is a SExtractor output file, or at least a file that
- *  has a format compatible with a SExtractor format, in contrast to a
- *  SDSS-like file that has magnitudes for multiple bands all in one file.
- *  This function does the sorting and finds the median position.
+ * The same as med_secat, but for a SDSS-like file, for which the median
+ *  is always found in (RA,Dec).
  *
  * Inputs: 
  *  char *catfile         filename for input catalog
  *  char *outfile         output filename
- *  char *calcmethod      method of calculating offsets
  *  int format            format of input catalog file
+ *  int approx            1 ==> approximate median (see median_pos)
  */
 
-int med_sdss(char *catfile, char *outfile, int format)
+int med_sdss(char *catfile, char *outfile, int format, int approx)
 {
   int i;                   /* Looping variable */
   int no_error=1;          /* Flag set to 0 on error */
-  int ncat;                /* Number of lines in the final catalog */
-  int ncent;               /* Number of lines in posfile (should be 1) */
-  Pos *offsets=NULL;       /* Array to hold offsets */
-  Pos *pptr;               /* Pointer to navigate offsets */
-  Skypos *skypos=NULL;     /* Array of sky positions */
-  Skypos *skptr;           /* Pointer to navigate skypos */
-  Secat *centpos=NULL;     /* Central position for distance calculations */
-  SDSScat *scat=NULL;      /* Data array from catalog, after purging */
-  SDSScat *sptr;           /* Pointer to navigate secat */
-#if 0
+  int ncat;                /* Number of lines in the catalog */
+  double *ra=NULL;         /* RA of each member */
+  double *dec=NULL;        /* Dec of each member */
+  SDSScat *scat=NULL;      /* Data array from catalog */
+
   /*
-   * Fill the data structure
+   * Fill the data structure and copy out the positions
    */
 
   if(no_error)
     if(!(scat = read_sdss(catfile,'#',&ncat,format)))
       no_error = 0;
 
-  /*
-   * Read the central position
-   */
-
   if(no_error)
-    if(!(centpos = read_distcalc(posfile,'#',&ncent,0)))
+    if(!(ra = new_doubarray(2 * ncat)))
       no_error = 0;
 
-  /*
-   * Allocate memory for the skypos array
-   */
-
-  if(!(skypos = new_skypos(ncat)))
-    no_error = 0;
-
-  /*
-   * Load the skypos values into the skypos array
-   */
-
-  else {
-    for(i=0,sptr=scat,skptr=skypos; i<ncat; i++,sptr++,skptr++) {
-      *skptr = sptr->skypos;
-      sprintf(skptr->label,"%04d",sptr->id);
+  if(no_error) {
+    dec = ra + ncat;
+    for(i=0; i<ncat; i++) {
+      ra[i] = scat[i].alpha;
+      dec[i] = scat[i].delta;
     }
-
-    /*
-     * Calculate the offsets
-     */
-
-    if(!(offsets = dspos2xy(centpos->skypos,skypos,ncat)))
+    scat = del_sdsscat(scat);
+    if(median_pos(ra,dec,ncat,approx,1))
       no_error = 0;
   }
 
   /*
-   * Put the offsets into the catalog structure
+   * Clean up and exit
    */
 
-  if(no_error) {
-    for(i=0,sptr=scat,pptr=offsets; i<ncat; i++,sptr++,pptr++) {
-      sptr->dx = pptr->x;
-      sptr->dy = pptr->y;
-      sptr->dpos = sqrt(pptr->x * pptr->x + pptr->y * pptr->y);
-    }
+  scat = del_sdsscat(scat);
+  ra = del_doubarray(ra);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: med_sdss\n");
+    return 1;
   }
+}
 
-  /*
-   * Sort the catalog in order of
-   *  increasing distance from the central position.
-   */
+/*.......................................................................
+ *
+ * Function median_pos
+ *
+ * Prints the positions of the catalog members and their median 
+ *  position.  The medians are found with median_select on a copy of the
+ *  positions, which takes O(n) time.  If approx is set, they are instead
+ *  estimated in one pass with add_medstream, which needs no copy, for 
+ *  catalogs too large for that.
+ *
+ * Inputs: 
+ *  double *xcol          first coordinate (RA or x) of each member
+ *  double *ycol          second coordinate (Dec or y) of each member
+ *  int ncat              number of members
+ *  int approx            1 ==> approximate median
+ *  int isradec           1 ==> coordinates are (RA,Dec) in degrees
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
 
-  if(no_error) {
-    printf("\nSorting the catalog in order of increasing distance ");
-    printf("from the central position...");
-    qsort(scat,ncat,sizeof(scat[0]),dposcmp_sdss);
-    printf(" Done.\n");
-  }
+int median_pos(double *xcol, double *ycol, int ncat, int approx, 
+	       int isradec)
+{
+  int i;                   /* Looping variable */
+  double *work=NULL;       /* Copy of one coordinate */
+  Pos centpos;             /* Output central position */
+  Skypos centskypos;       /* Central position in hms format */
+  Medstream xms,yms;       /* Running medians */
 
   /*
-   * Renumber the sources
+   * Print out the positions
    */
 
-  if(no_error) {
-    for(i=0,sptr=scat; i<ncat; i++,sptr++)
-      sptr->id = i + 1;
+  printf("\n");
+  for(i=0; i<ncat; i++) {
+    deg2spos(xcol[i],ycol[i],&centskypos);
+    print_skypos(stdout,centskypos);
+    printf("\n");
   }
 
   /*
-   * Write output file
+   * Find the median of each coordinate
    */
 
-  if(no_error)
-     if(write_sdss(scat,ncat,outfile,format))
-       no_error = 0;
+  if(approx) {
+    init_medstream(&xms);
+    init_medstream(&yms);
+    for(i=0; i<ncat; i++) {
+      add_medstream(&xms,xcol[i]);
+      add_medstream(&yms,ycol[i]);
+    }
+    centpos.x = medstream_value(&xms);
+    centpos.y = medstream_value(&yms);
+  }
+  else {
+    if(!(work = new_doubarray(ncat))) {
+      fprintf(stderr,"ERROR: median_pos\n");
+      return 1;
+    }
+    for(i=0; i<ncat; i++)
+      work[i] = xcol[i];
+    centpos.x = median_select(work,ncat);
+    for(i=0; i<ncat; i++)
+      work[i] = ycol[i];
+    centpos.y = median_select(work,ncat);
+    work = del_doubarray(work);
+  }
 
   /*
-   * Clean up and exit
+   * Print out the central position.  If the coordinates are (RA,Dec), 
+   *  also express the answer in hms format.
    */
 
-  scat = del_sdsscat(scat);
-  centpos = del_secat(centpos);
-  skypos = del_skypos(skypos);
-  offsets = del_pos(offsets);
-
-  if(no_error)
-    return 0;
-  else {
-    fprintf(stderr,"ERROR: sort_secat\n");
-    return 0;
+  printf("\n%sedian position in the catalog is %lf %lf\n",
+	 approx ? "Approximate m" : "M",centpos.x,centpos.y);
+  if(isradec) {
+    deg2spos(centpos.x,centpos.y,&centskypos);
+    print_skypos(stdout,centskypos);
   }
-#endif
+
+  return 0;
 }
 
 /*.......................................................................
@@ -392,7 +342,7 @@ int med_sdss(char *catfile, char *outfile, int format)
 
 void catcenter_help()
 {
-  fprintf(stderr,"\nUsage: catcenter [catfile] [outfile] ");
+  fprintf(stderr,"\nUsage: catcenter (-a) [catfile] [outfile] ");
   fprintf(stderr,"[calcmethod] ([format])\n\n");
   fprintf(stderr,"  catfile is the file containing the catalog\n");
   fprintf(stderr,"  calcmethod sets the method for calculating the offsets.");
@@ -400,7 +350,9 @@ void catcenter_help()
   fprintf(stderr,"    For calcmethod = xy distances are based on");
   fprintf(stderr," (x,y) coordinates.\n");
   fprintf(stderr,"    For calcmethod = radec distances are based on");
-  fprintf(stderr," (RA,Dec) coordinates.\n\n");
+  fprintf(stderr," (RA,Dec) coordinates.\n");
+  fprintf(stderr,"  -a, if given, estimates the median in one pass");
+  fprintf(stderr," (for very large catalogs).\n\n");
   fprintf(stderr," The optional format flag indicates the format of the");
   fprintf(stderr," input file:\n");
   secat_format();
@@ -1,7 +1,8 @@
 /*
  * catcomb.c
  *
- * Usage: catcomb [catfile1] [format1] [catfile2] [format2] ....
+ * Usage: catcomb (-c [posfile]) (-m [tree|zones]) (-t [nthread]) 
+ *         [catfile1] [format1] [catfile2] [format2] ....
  *
  * This program combines multiple catalogs of the same field, based
  *  on the positions of the catalog objects.
@@ -19,6 +20,30 @@
  *                   central position.  
  *                  Put help info into the new help_catcomb function.
  *  2009Jan24 CDF - Modified so that format 10 now includes magnitude info
+ *  2026Oct16 AGT - write_matchcat now writes the catalog rows through an
+ *                   Outbuf
+ *                  Only the master catalog members that new_skytree/sky_cone
+ *                   find near each source are tested as matches
+ *                  Added the -m flag to choose between the tree and the
+ *                   declination zones (new_skyzones/zone_cone) for finding
+ *                   the match candidates
+ *                  The list of matches for a source is no longer limited
+ *                   to 10 entries, but matches beyond MAXMATCH are
+ *                   counted and dropped
+ *                  The offsets to the match candidates are computed in one
+ *                   call to rad2xy per source, from master catalog 
+ *                   positions converted to radians once per catalog, 
+ *                   rather than by calling dspos2xy for each pair
+ *                  The unit vectors of the catalog members are computed
+ *                   once, when the catalogs are read, and the match 
+ *                   candidates are checked with a dot product before their
+ *                   offsets are computed
+ *                  The matches of the sources in each catalog are now found
+ *                   all at once by sky_match_par, which runs on several
+ *                   threads (set with the new -t flag), and are then 
+ *                   merged into the master catalog in source order
+ *                  The -t flag now also reads the input catalogs with the
+ *                   multi-threaded READ_PAR reader (see read_secat_method)
  *
  */
 
@@ -30,6 +55,7 @@
 #include "coords.h"
 #include "dataio.h"
 #include "catlib.h"
+#include "catpar.h"
 
 /*.......................................................................
  *
@@ -54,6 +80,9 @@ int main(int argc, char *argv[])
   int i,j,k,m;             /* Looping variables */
   int no_error=1;          /* Flag set to 0 on error */
   int calc_offsets=0;      /* Set to 1 to calculate offsets */
+  int skymethod=SKY_TREE;  /* Method for finding match candidates */
+  int nthread=0;           /* Number of matching threads (0 ==> default) */
+  int readmode=READ_STDIO; /* Input method for the catalogs */
   int nfiles;              /* Number of input catalogs */
   int firstfile=1;         /* argv index of first file */
   int fileindex;           /* Index of current file being read */
@@ -63,32 +92,34 @@ int main(int argc, char *argv[])
   int ncat;                /* Number of lines in the final catalog */
   int ncent;               /* Number of lines in cent pos file (should be 1) */
   int *format=NULL;        /* Format of input/output files */
-  int mindex[10];          /* Catalog index of closest match */
   int **nmatch={NULL};      /* Number of matches within dmatch */
   int nmatch0;             /* Number of matches within dmatch - single source */
   int nmatchmax=0;         /* Maximum value of nmatch for the full comparison */
+  int nover=0;             /* Number of matches dropped from full match lists */
+  int mralloc=0;           /* Number of elements allocated in mastrad */
   int *iptr;               /* Pointer to navigate int arrays */
   int **id={NULL};         /* Output IDs */
   float **outmag={NULL};   /* Output magnitudes */
   float *fptr;             /* Pointer for navigating float arrays */
   double **dp={NULL};      /* Offsets between catalogs */
   double *dptr;            /* Pointer for navigating dp */
-  double tmpd;             /* Coordinate offset */
   double dmatch;           /* Cutoff distance for matching */
+  double **invec={NULL};   /* Unit vectors of the input catalogs */
+  double *mastvec=NULL;    /* Unit vectors of the master catalog */
+  double *mastrad=NULL;    /* Master catalog RAs then Decs in radians */
   char **infiles={NULL};   /* Input file names */
   char outfile[MAXC];      /* Filename for output file */
   char posfile[MAXC];      /* Filename for optional central position file */
   char line[MAXC];         /* General string for reading variables */
-  Pos *dpos=NULL;          /* Array to hold offsets */
-  Skypos currpos;          /* Central position for distance calculations */
-  Skypos *skypos=NULL;     /* Array of sky positions */
-  Skypos *skptr;           /* Pointer to navigate skypos */
-  Secat mindist[10];       /* Catalog entry for minimum offsets */
   Secat **incat={NULL};    /* Input catalogs */
   Secat *mastercat=NULL;   /* Data array from catalog, after purging */
   Secat *centpos=NULL;     /* Central position, if offsets are requested */
   Secat *sptr1,*sptr2;     /* Pointers to navigate catalogs */
   Secat *sptr3;            /* Pointers to navigate catalogs */
+  Kdtree *skytree=NULL;    /* Sky index of the master catalog */
+  Skyzones *skyzones=NULL; /* Zones index of the master catalog */
+  Matchlist *matches=NULL; /* Matches of the sources in one catalog */
+  Skymatch *mptr;          /* Pointer to navigate matches */
 
   /*
    * Check the command line invocation
@@ -111,18 +142,39 @@ int main(int argc, char *argv[])
   }
 
   /*
-   * Check whether offset calculation is desired
+   * Check whether offset calculation or a matching method is requested
    */
 
-  if(strcmp(argv[1],"-c") == 0) {
-    printf("Found -c flag.  Will calculate offsets\n");
-    calc_offsets = 1;
-    strcpy(posfile,argv[2]);
-    nfiles = (argc - 3)/2;
-    firstfile = 3;
+  while(firstfile < argc - 1 && argv[firstfile][0] == '-') {
+    if(strcmp(argv[firstfile],"-c") == 0) {
+      printf("Found -c flag.  Will calculate offsets\n");
+      calc_offsets = 1;
+      strcpy(posfile,argv[firstfile+1]);
+    }
+    else if(strcmp(argv[firstfile],"-m") == 0 &&
+	    strcmp(argv[firstfile+1],"zones") == 0) {
+      printf("Found -m flag.  Will match using declination zones\n");
+      skymethod = SKY_ZONES;
+    }
+    else if(strcmp(argv[firstfile],"-t") == 0 &&
+	    sscanf(argv[firstfile+1],"%d",&nthread) == 1) {
+      printf("Found -t flag.  Will read and match with %d threads\n",
+	     nthread);
+      readmode = READ_PAR;
+    }
+    else if(strcmp(argv[firstfile],"-m") != 0 ||
+	    strcmp(argv[firstfile+1],"tree") != 0) {
+      fprintf(stderr,"\nError. Bad option %s %s\n\n",argv[firstfile],
+	      argv[firstfile+1]);
+      help_catcomb();
+      return 1;
+    }
+    firstfile += 2;
   }
-  else {
-    nfiles = (argc - 1)/2;
+  nfiles = (argc - firstfile)/2;
+  if(nfiles < 2) {
+    help_catcomb();
+    return 1;
   }
 
   /*
@@ -159,6 +211,11 @@ int main(int argc, char *argv[])
     fprintf(stderr,"ERROR:  Insufficient memory for output outmag array.\n");
     return 1;
   }
+  invec = (double **) calloc(nfiles,sizeof(double *));
+  if(!invec) {
+    fprintf(stderr,"ERROR:  Insufficient memory for unit vector array.\n");
+    return 1;
+  }
 
   if(!(nlines = new_intarray(nfiles,1)))
     no_error = 0;
@@ -194,7 +251,10 @@ int main(int argc, char *argv[])
 	default:
 	  break;
 	}
-	if(!(incat[i] = read_secat(infiles[i],'#',&nlines[i],*iptr)))
+	if(!(incat[i] = read_secat_method(infiles[i],'#',&nlines[i],*iptr,
+					  readmode,nthread)))
+	  no_error = 0;
+	else if(!(invec[i] = secat2vec(incat[i],nlines[i])))
 	  no_error = 0;
 	else
 	  ninit += nlines[i];
@@ -214,6 +274,10 @@ int main(int argc, char *argv[])
       fprintf(stderr,"ERROR: Insufficient memory for combined catalog.\n");
       no_error = 0;
     }
+    else if(!(mastvec = (double *) malloc(3 * ninit * sizeof(double)))) {
+      fprintf(stderr,"ERROR: Insufficient memory for combined catalog.\n");
+      no_error = 0;
+    }
   }
 
   i=0;
@@ -236,6 +300,7 @@ int main(int argc, char *argv[])
 
   if(no_error) {
     ncat = nlines[0];
+    memcpy(mastvec,invec[0],3 * ncat * sizeof(double));
     for(i=0,sptr1=mastercat,sptr2=incat[0],iptr=id[0],fptr=outmag[0]; 
 	i<nlines[0]; i++,sptr1++,sptr2++,iptr++,fptr++) {
       *sptr1 = *sptr2;
@@ -254,15 +319,6 @@ int main(int argc, char *argv[])
     printf("\nAfter catalog 1, there are %d master catalog members\n",ncat);
   }
 
-  /*
-   * Allocate memory for the skypos array
-   */
-
-  if(!(skypos = new_skypos(1)))
-    no_error = 0;
-  else
-    skptr = skypos;
-
   /*
    * Loop over other catalogs, calculating distances for each object
    */
@@ -287,47 +343,48 @@ int main(int argc, char *argv[])
     }
 
     /*
-     * Loop through the next input catalog
+     * Index the master catalog as it stands before this catalog is added
      */
 
-    for(j=0,sptr2=incat[i]; j<nlines[i]; j++,sptr2++) {
+    if(skymethod == SKY_ZONES) {
+      if(!(skyzones = new_skyzones(mastvec,ncat,dmatch)))
+	no_error = 0;
+    }
+    else if(!(skytree = new_skytree(mastvec,ncat)))
+      no_error = 0;
 
-      /*
-       * Get the position of the current object
-       */
+    /*
+     * Convert the positions of the indexed members to radians for rad2xy
+     */
 
-      currpos = sptr2->skypos;
+    if(!(mastrad = (double *) grow_array(mastrad,&mralloc,2*ncat,
+					 sizeof(double))))
+      no_error = 0;
+    else
+      for(k=0; k<ncat; k++)
+	spos2rad(mastercat[k].skypos,mastrad+k,mastrad+ncat+k);
 
+    /*
+     * Find the matches of all the sources in this catalog among the 
+     *  indexed members.  The master catalog is only read here, so the
+     *  sources can be done in parallel.
+     */
 
-      /*
-       * Loop through the master catalog, and find all matches within
-       * the specified match radius
-       */
+    if(no_error)
+      if(!(matches = sky_match_par(skytree,skyzones,mastvec,mastrad,ncat,
+				   incat[i],invec[i],nlines[i],dmatch,
+				   nthread)))
+	no_error = 0;
 
-      if(no_error) {
-	nmatch0 = 0;
-	for(k=0,sptr1=mastercat; k<ncat; k++,sptr1++) {
-	  *skptr = sptr1->skypos;
-	  if(!(dpos = dspos2xy(currpos,skypos,1)))
-	    no_error = 0;
-	  if((tmpd = sqrt(dpos->x * dpos->x + dpos->y * dpos->y)) <
-		  dmatch) {
-	    mindist[nmatch0] = *sptr1;
-	    mindist[nmatch0].dpos = tmpd;
-	    mindist[nmatch0].matchid[0] = k;
-	    switch(format[i]) {
-	    case 6: case 7: case 9: case 10:
-	      mindist[nmatch0].mtot = sptr2->mtot;
-	      break;
-	    case 15: case 16:
-	      mindist[nmatch0].mtot = sptr2->zspec;
-	      break;
-	    }
-	    nmatch0++;
-	  }
-	  dpos = del_pos(dpos);
-	}
-      }
+    /*
+     * Loop through the next input catalog, merging the matches into the
+     *  master catalog in source order
+     */
+
+    for(j=0,sptr2=incat[i]; no_error && j<nlines[i]; j++,sptr2++) {
+
+      nmatch0 = matches->first[j+1] - matches->first[j];
+      mptr = matches->match + matches->first[j];
       if(nmatch0>nmatchmax) {
 	nmatchmax = nmatch0;
       }
@@ -338,28 +395,36 @@ int main(int argc, char *argv[])
        */
 
       if(nmatch0>0) {
-	/* Find the closest master catalog match */
-	if(nmatch0>1) {
-	  qsort(mindist,nmatch0,sizeof(mindist[0]),dposcmp);
-	}
-
 	/* Link the matched objects with the master catalog objext */
 	for(k=0; k<nmatch0; k++) {
-	  sptr1 = mastercat + mindist[k].matchid[0];
+	  sptr1 = mastercat + mptr[k].index;
 	  m = sptr1->nmatch;
-	  sptr1->matchid[m] = sptr2->id;
-	  sptr1->matchcat[m] = i;
-	  sptr1->sep[m] = mindist[k].dpos;
-	  sptr1->nmatch++;
+	  if(m < MAXMATCH) {
+	    sptr1->matchid[m] = sptr2->id;
+	    sptr1->matchcat[m] = i;
+	    sptr1->sep[m] = mptr[k].dpos;
+	    sptr1->nmatch++;
+	  }
+	  else {
+	    if(nover == 0)
+	      fprintf(stderr,"WARNING: catcomb.  More than %d matches for "
+		      "master catalog member %d.\n",MAXMATCH,sptr1->id);
+	    nover++;
+	  }
 	}
-	iptr = id[i] + mindist[0].matchid[0];
+
+	/* The closest master catalog match is first */
+	iptr = id[i] + mptr[0].index;
 	*iptr = sptr2->id;
-	dptr = dp[i] + mindist[0].matchid[0];
-	*dptr = mindist[0].dpos;
-	fptr = outmag[i] + mindist[0].matchid[0];
+	dptr = dp[i] + mptr[0].index;
+	*dptr = mptr[0].dpos;
+	fptr = outmag[i] + mptr[0].index;
 	switch(format[i]) {
-	case 6: case 7: case 9: case 10: case 15: case 16:
-	  *fptr = mindist[0].mtot;
+	case 6: case 7: case 9: case 10:
+	  *fptr = sptr2->mtot;
+	  break;
+	case 15: case 16:
+	  *fptr = sptr2->zspec;
 	  break;
 	default:
 	  *fptr = 0.0;
@@ -369,6 +434,7 @@ int main(int argc, char *argv[])
       /* Adding the current source to the master catalog */
       else {
 	*sptr3 = *sptr2;
+	memcpy(mastvec + 3*(ncat+nadd),invec[i] + 3*j,3 * sizeof(double));
 	sptr3->id = i * 10000 + sptr2->id;
 	sptr3->matchid[0] = 0;
 #if 0
@@ -393,12 +459,18 @@ int main(int argc, char *argv[])
 	sptr3++;
       }
     }
+    skytree = del_kdtree(skytree);
+    skyzones = del_skyzones(skyzones);
+    matches = del_matchlist(matches);
     ncat += nadd;
     printf("After catalog %d, there are %d master catalog members\n",
 	   i+1,ncat);
     i++;
     printf("%d\n",nmatchmax);
   }
+  if(nover > 0)
+    fprintf(stderr,"WARNING: catcomb.  %d matches did not fit in the "
+	    "%d-entry match lists and were dropped.\n",nover,MAXMATCH);
 
   /*
    * If requested, (re)compute offsets between each object and the given
@@ -433,17 +505,25 @@ int main(int argc, char *argv[])
    */
 
   mastercat = del_secat(mastercat);
-  skypos = del_skypos(skypos);
-  dpos = del_pos(dpos);
+  skytree = del_kdtree(skytree);
+  skyzones = del_skyzones(skyzones);
+  if(mastrad)
+    free(mastrad);
+  if(mastvec)
+    free(mastvec);
   for(i=0; i<nfiles; i++) {
     incat[i] = del_secat(incat[i]);
     id[i] = del_intarray(id[i]);
     dp[i] = del_doubarray(dp[i]);
     outmag[i] = del_array(outmag[i]);
     infiles[i] = del_string(infiles[i]);
+    if(invec[i])
+      free(invec[i]);
   }
   if(incat)
     free(incat);
+  if(invec)
+    free(invec);
   if(infiles)
     free(infiles);
   nlines = del_intarray(nlines);
@@ -486,6 +566,7 @@ int write_matchcat(Secat *matchcat, int ncat, int **id, double **dp,
 {
   int i,j;         /* Looping variables */
   Secat *mptr;     /* Pointer to navicage matchcat */
+  Outbuf *ob=NULL; /* Output buffer for the catalog rows */
   FILE *ofp=NULL;  /* Pointer to output file */
 
   if(!(ofp = open_writefile(outfile))) {
@@ -549,29 +630,52 @@ int write_matchcat(Secat *matchcat, int ncat, int **id, double **dp,
    * Write main part of output file
    */
 
+  if(!(ob = new_outbuf(ofp,OUTBUFSIZE))) {
+    fprintf(stderr,"ERROR: write_matchcat\n");
+    fclose(ofp);
+    return 1;
+  }
   for(i=0,mptr=matchcat; i<ncat; i++,mptr++) {
-    fprintf(ofp,"%05d %11.7f %+11.7f %8.2f %8.2f ",
-	    mptr->id,mptr->alpha,mptr->delta,mptr->dx,mptr->dy);
+    ob_int(ob,mptr->id,5,OB_ZERO);
+    ob_putc(ob,' ');
+    ob_fixed(ob,mptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,mptr->delta,11,7,OB_PLUS);
+    ob_putc(ob,' ');
+    ob_fixed(ob,mptr->dx,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,mptr->dy,8,2,0);
+    ob_putc(ob,' ');
     for(j=0; j<nfiles; j++) {
-      fprintf(ofp,"%5d %8.2f ",*(id[j]+i),*(dp[j]+i));
+      ob_int(ob,*(id[j]+i),5,0);
+      ob_putc(ob,' ');
+      ob_fixed(ob,*(dp[j]+i),8,2,0);
+      ob_putc(ob,' ');
       switch(format[j]) {
       case 6: case 7: case 9: case 10:
-	fprintf(ofp,"%6.2f ",*(outmag[j]+i));
+	ob_fixed(ob,*(outmag[j]+i),6,2,0);
+	ob_putc(ob,' ');
 	break;
       case 15: case 16:
-	fprintf(ofp,"%7.4f ",*(outmag[j]+i));
+	ob_fixed(ob,*(outmag[j]+i),7,4,0);
+	ob_putc(ob,' ');
 	break;
       default:
-	fprintf(ofp,"  0.00 ");
+	ob_puts(ob,"  0.00 ",0,0);
       }
     }
-    fprintf(ofp,"\n");
+    ob_putc(ob,'\n');
   }
 
   /*
    * Clean up and exit
    */
 
+  if(del_outbuf(ob)) {
+    fprintf(stderr,"ERROR: write_matchcat\n");
+    fclose(ofp);
+    return 1;
+  }
   if(ofp)
     fclose(ofp);
   return 0;
@@ -598,6 +702,8 @@ void help_catcomb()
   fprintf(stderr," ** or **\n\n");
   fprintf(stderr,"  catcomb -c [posfile] [catfile1] [format1] ... [catfileN] ");
   fprintf(stderr,"[formatN]\n\n");
+  fprintf(stderr," and either form may also start with -m [tree|zones] and/or");
+  fprintf(stderr," -t [nthread]\n\n");
   fprintf(stderr," At least 2 input catalogs are required\n\n");
   fprintf(stderr,"OPTIONS:\n");
   fprintf(stderr," (no flag)   Just match catalogs on positions\n");
@@ -608,7 +714,19 @@ void help_catcomb()
   fprintf(stderr,"             The central position is given in posfile,\n");
   fprintf(stderr,
 	  "              format: label ra_hr ra_min ra_sec dec_deg dec_amin");
-  fprintf(stderr," dec_asec\n\n");
+  fprintf(stderr," dec_asec\n");
+  fprintf(stderr,
+	  " -m          Method for finding the match candidates: tree (the\n");
+  fprintf(stderr,
+	  "              default) or zones (declination zones sorted in RA)\n");
+  fprintf(stderr,
+	  " -t          Number of threads used to find the matches (default:\n");
+  fprintf(stderr,
+	  "              one per processor).  The output does not depend on it\n");
+  fprintf(stderr,
+	  "              If given, the catalogs are also read with this many\n");
+  fprintf(stderr,
+	  "              threads\n\n");
   fprintf(stderr,"The format flags indicate the formats of the input ");
   fprintf(stderr,"catalogs.\n");
   fprintf(stderr,"Hit return to see format options: ");
@@ -1,7 +1,7 @@
 /*
  * catcompare.c
  *
- * Usage: catcompare [catfile1] [format1] [catfile2] [format2] 
+ * Usage: catcompare (-m [tree|zones]) [catfile1] [format1] [catfile2] [format2] 
  *
  * This program reads in two catalog files and finds matches based on the
  *  positions in each catalog.  The output is a file containing the offsets
@@ -10,6 +10,21 @@
  *
  * Revision history:
  *  2009May05, Chris Fassnacht (CDF) - A modified version of catcomb.c
+ *  2026Oct16 AGT - Only the members of the first catalog that 
+ *                   new_skytree/sky_cone find near each source are tested
+ *                   as matches
+ *                  A match is now recorded in matchid[0] of the first
+ *                   catalog member rather than in its id
+ *                  Added the -m flag to choose between the tree and the
+ *                   declination zones (new_skyzones/zone_cone) for finding
+ *                   the match candidates
+ *                  The offsets to the match candidates are computed in one
+ *                   call to rad2xy per source, rather than by calling 
+ *                   dspos2xy for each pair
+ *                  The unit vectors of the catalog members are computed
+ *                   once, when the catalogs are read, and the match 
+ *                   candidates are checked with a dot product before their
+ *                   offsets are computed
  *
  */
 
@@ -38,9 +53,10 @@ void help_catcompare();
 
 int main(int argc, char *argv[])
 {
-  int i,j,k;               /* Looping variables */
+  int i,j,c;               /* Looping variables */
   int no_error=1;          /* Flag set to 0 on error */
   int calc_offsets=0;      /* Set to 1 to calculate offsets */
+  int skymethod=SKY_TREE;  /* Method for finding match candidates */
   int nfiles;              /* Number of input catalogs */
   int firstfile=1;         /* argv index of first file */
   int fileindex;           /* Index of current file being read */
@@ -50,26 +66,39 @@ int main(int argc, char *argv[])
   int ncent;               /* Number of lines in cent pos file (should be 1) */
   int *format=NULL;        /* Format of input/output files */
   int mindex;              /* Catalog index of closest match */
+  int ncand;               /* Number of match candidates for one source */
+  int naccept;             /* Number of candidates passing the dot product */
+  int *cand=NULL;          /* First catalog indices of the candidates */
+  int candalloc=0;         /* Number of elements allocated in cand */
+  int cralloc=0;           /* Number of elements allocated in candrad */
   int *iptr;               /* Pointer to navigate int arrays */
   int **id={NULL};         /* Output IDs */
   float *fptr;             /* Pointer for navigating float arrays */
   double tmpd;             /* Coordinate offset */
   double dmatch;           /* Cutoff distance for matching */
+  double alpha0,delta0;    /* Current object position in radians */
+  double cosmin;           /* Dot product threshold for a match */
+  double *vec0,*vec1;      /* Unit vectors of a candidate pair */
+  double **invec={NULL};   /* Unit vectors of the input catalogs */
+  double *rad0=NULL;       /* First catalog RAs then Decs in radians */
+  double *candrad=NULL;    /* RAs, Decs, x and y offsets of the candidates */
+  double *calpha,*cdelta;  /* Candidate positions in radians, in candrad */
+  double *cx,*cy;          /* Candidate offsets in arcsec, in candrad */
   char **infiles={NULL};   /* Input file names */
   char outfile[MAXC];      /* Filename for output file */
   char posfile[MAXC];      /* Filename for optional central position file */
   char line[MAXC];         /* General string for reading variables */
-  Pos *dpos=NULL;          /* Array to hold offsets */
   Skypos currpos;          /* Central position for distance calculations */
-  Skypos *skypos=NULL;     /* Array of sky positions */
-  Skypos *skptr;           /* Pointer to navigate skypos */
-  Secat mindist;           /* Catalog entry for minimum offset */
+  Pos mindist;             /* Offsets of the closest match */
+  double mindpos;          /* Total offset of the closest match */
   Secat **dp={NULL};       /* Offsets between catalogs */
   Secat *dptr;             /* Pointer for navigating dp */
   Secat **incat={NULL};    /* Input catalogs */
   Secat *centpos=NULL;     /* Central position, if offsets are requested */
   Secat *sptr1,*sptr2;     /* Pointers to navigate catalogs */
   Secat *sptr3;            /* Pointers to navigate catalogs */
+  Kdtree *skytree=NULL;    /* Sky index of the first catalog */
+  Skyzones *skyzones=NULL; /* Zones index of the first catalog */
   FILE *ofp=NULL;          /* Output file pointer */
 
   /*
@@ -82,17 +111,38 @@ int main(int argc, char *argv[])
   }
   printf("\n");
 
+  /*
+   * Check whether a matching method is requested
+   */
+
+  if(strcmp(argv[1],"-m") == 0) {
+    if(strcmp(argv[2],"zones") == 0) {
+      printf("Found -m flag.  Will match using declination zones\n");
+      skymethod = SKY_ZONES;
+    }
+    else if(strcmp(argv[2],"tree") != 0) {
+      fprintf(stderr,"\nError. Bad matching method %s\n\n",argv[2]);
+      help_catcompare();
+      return 1;
+    }
+    firstfile = 3;
+  }
+
   /*
    * Need a check on even number of passed arguments, too
    */
 
-  if(((argc-1)/2.0 - floor((argc-1)/2))>0){
+  if((argc - firstfile) % 2 > 0){
     fprintf(stderr,"\nError. Odd number of arguments!\n\n");
     help_catcompare();
     return 1;
   }
   else {
-    nfiles = (argc - 1)/2;
+    nfiles = (argc - firstfile)/2;
+  }
+  if(nfiles < 2) {
+    help_catcompare();
+    return 1;
   }
 
   /*
@@ -109,6 +159,11 @@ int main(int argc, char *argv[])
     fprintf(stderr,"ERROR:  Insufficient memory for input catalog array.\n");
     return 1;
   }
+  invec = (double **) calloc(nfiles,sizeof(double *));
+  if(!invec) {
+    fprintf(stderr,"ERROR:  Insufficient memory for unit vector array.\n");
+    return 1;
+  }
   id = (int **) malloc(sizeof(int *) * nfiles);
   if(!id) {
     fprintf(stderr,"ERROR:  Insufficient memory for output id array.\n");
@@ -156,6 +211,8 @@ int main(int argc, char *argv[])
 	}
 	if(!(incat[i] = read_secat(infiles[i],'#',&nlines[i],*iptr)))
 	  no_error = 0;
+	else if(!(invec[i] = secat2vec(incat[i],nlines[i])))
+	  no_error = 0;
 	else
 	  ninit += nlines[i];
       }
@@ -178,13 +235,27 @@ int main(int argc, char *argv[])
   }
 
   /*
-   * Allocate memory for the skypos array
+   * Convert the first catalog positions to radians for rad2xy
    */
 
-  if(!(skypos = new_skypos(1)))
-    no_error = 0;
-  else 
-    skptr = skypos;
+  if(no_error) {
+    if(!(rad0 = (double *) malloc(2 * (nlines[0] + 1) * sizeof(double)))) {
+      fprintf(stderr,"ERROR:  Insufficient memory for position array.\n");
+      no_error = 0;
+    }
+    else
+      for(j=0; j<nlines[0]; j++)
+	spos2rad(incat[0][j].skypos,rad0+j,rad0+nlines[0]+j);
+  }
+
+  /*
+   * Index the first catalog.  The zones depend on the match radius, so
+   *  they are instead built once it is known for each catalog.
+   */
+
+  if(no_error && skymethod == SKY_TREE)
+    if(!(skytree = new_skytree(invec[0],nlines[0])))
+      no_error = 0;
 
   /*
    * Loop over other catalogs, finding matches in each one
@@ -223,54 +294,68 @@ int main(int argc, char *argv[])
       fprintf(stderr," ERROR: bad value.  Try again: ");
       fgets(line,MAXC,stdin);
     }
+    if(skymethod == SKY_ZONES)
+      if(!(skyzones = new_skyzones(invec[0],nlines[0],dmatch)))
+	no_error = 0;
+    cosmin = offset2cos(dmatch);
 
     /*
      * Loop through the next input catalog
      */
 
-    for(j=0,sptr2=incat[i]; j<nlines[i]; j++,sptr2++) {
+    for(j=0,sptr2=incat[i]; no_error && j<nlines[i]; j++,sptr2++) {
 
       /*
        * Get the position of the current object
        */
 
       currpos = sptr2->skypos;
+      vec0 = invec[i] + 3*j;
 
       /*
-       * Calculate the offset between the current and the first
-       *  entry in the first catalog.
+       * Find the closest match among the members of the first catalog 
+       *  near the current object
        */
 
-      *skptr = incat[0]->skypos;
-      if(!(dpos = dspos2xy(currpos,skypos,1)))
+      mindex = -1;
+      mindpos = HUGE_VAL;
+      if(skymethod == SKY_ZONES)
+	ncand = zone_cone(skyzones,vec0,dmatch,&cand,&candalloc);
+      else
+	ncand = sky_cone(skytree,vec0,dmatch,&cand,&candalloc);
+      if(ncand < 0)
 	no_error = 0;
       else {
-	mindex = 0;
-	mindist = *incat[0];
-	mindist.dx = dpos->x;
-	mindist.dy = dpos->y;
-	mindist.dpos = sqrt(dpos->x * dpos->x + dpos->y * dpos->y);
+	for(c=0,naccept=0; c<ncand; c++) {
+	  vec1 = invec[0] + 3*cand[c];
+	  if(vec0[0] * vec1[0] + vec0[1] * vec1[1] + vec0[2] * vec1[2] > 
+	     cosmin)
+	    cand[naccept++] = cand[c];
+	}
+	ncand = naccept;
       }
-      dpos = del_pos(dpos);
-
-      /*
-       * Loop through the first catalog, and find the closest match
-       */
-
-      if(no_error) {
-	for(k=0,sptr1=incat[0]; k<nlines[0]; k++,sptr1++) {
-	  *skptr = sptr1->skypos;
-	  if(!(dpos = dspos2xy(currpos,skypos,1)))
-	    no_error = 0;
-	  else if((tmpd = sqrt(dpos->x * dpos->x + dpos->y * dpos->y)) <
-		  mindist.dpos) {
-	    mindist = *sptr1;
-	    mindist.dx = dpos->x;
-	    mindist.dy = dpos->y;
-	    mindist.dpos = tmpd;
-	    mindex = k;
+      if(ncand > 0)
+	if(!(candrad = (double *) grow_array(candrad,&cralloc,4*ncand,
+					     sizeof(double))))
+	  no_error = 0;
+      if(no_error && ncand > 0) {
+	calpha = candrad;
+	cdelta = candrad + ncand;
+	cx = candrad + 2*ncand;
+	cy = candrad + 3*ncand;
+	for(c=0; c<ncand; c++) {
+	  calpha[c] = rad0[cand[c]];
+	  cdelta[c] = rad0[nlines[0]+cand[c]];
+	}
+	spos2rad(currpos,&alpha0,&delta0);
+	rad2xy(alpha0,delta0,calpha,cdelta,ncand,cx,cy);
+	for(c=0; c<ncand; c++) {
+	  if((tmpd = sqrt(cx[c] * cx[c] + cy[c] * cy[c])) < mindpos) {
+	    mindist.x = cx[c];
+	    mindist.y = cy[c];
+	    mindpos = tmpd;
+	    mindex = cand[c];
 	  }
-	  dpos = del_pos(dpos);
 	}
       }
 
@@ -279,22 +364,23 @@ int main(int argc, char *argv[])
        *  to the list of matches and to the output file.
        */
 
-      if(mindist.dpos < dmatch) {
+      if(mindex >= 0 && mindpos < dmatch) {
 	sptr1 = incat[0] + mindex;
-	sptr1->id[0] = i * 10000 + sptr2->id;
+	sptr1->matchid[0] = i * 10000 + sptr2->id;
 	iptr = id[i] + mindex;
 	*iptr = sptr2->id;
 	dptr = dp[i] + mindex;
-	dptr->dpos = mindist.dpos;
+	dptr->dpos = mindpos;
 	nmatch++;
-	fprintf(ofp,"%05d %8.2f %8.2f %8.2f %5d\n",sptr1->id,mindist.dx,
-		mindist.dy,mindist.dpos,sptr2->id);
+	fprintf(ofp,"%05d %8.2f %8.2f %8.2f %5d\n",sptr1->id,mindist.x,
+		mindist.y,mindpos,sptr2->id);
       }
     }
     printf("Between catalog %d and the first catalog, there are %d matches\n",
 	   i+1,nmatch);
     if(ofp)
       fclose(ofp);
+    skyzones = del_skyzones(skyzones);
     i++;
   }
 
@@ -302,16 +388,26 @@ int main(int argc, char *argv[])
    * Clean up and exit
    */
 
-  skypos = del_skypos(skypos);
-  dpos = del_pos(dpos);
+  if(rad0)
+    free(rad0);
+  if(candrad)
+    free(candrad);
+  skytree = del_kdtree(skytree);
+  skyzones = del_skyzones(skyzones);
+  if(cand)
+    free(cand);
   for(i=0; i<nfiles; i++) {
     incat[i] = del_secat(incat[i]);
     id[i] = del_intarray(id[i]);
     dp[i] = del_secat(dp[i]);
     infiles[i] = del_string(infiles[i]);
+    if(invec[i])
+      free(invec[i]);
   }
   if(incat)
     free(incat);
+  if(invec)
+    free(invec);
   if(infiles)
     free(infiles);
   nlines = del_intarray(nlines);
@@ -342,9 +438,12 @@ void help_catcompare()
   char line[MAXC];  /* General string */
 
   fprintf(stderr,"\nUsage: \n");
-  fprintf(stderr,"  catcompare [catfile1] [format1] ... [catfileN] ");
-  fprintf(stderr,"[formatN]\n\n");
-  fprintf(stderr," At least 2 input catalogs are required\n\n");
+  fprintf(stderr,"  catcompare (-m [tree|zones]) [catfile1] [format1] ... ");
+  fprintf(stderr,"[catfileN] [formatN]\n\n");
+  fprintf(stderr," At least 2 input catalogs are required\n");
+  fprintf(stderr," -m chooses the method for finding the match candidates:\n");
+  fprintf(stderr,"  tree (the default) or zones (declination zones sorted in");
+  fprintf(stderr," RA)\n\n");
   fprintf(stderr,"The format flags indicate the formats of the input ");
   fprintf(stderr,"catalogs.\n");
   fprintf(stderr,"Hit return to see format options: ");
@@ -57,7 +57,7 @@ int main(int argc, char *argv[])
   char posfile[MAXC];   /* Filename for input position file */
   char catfile[MAXC];   /* Filename for input catalog */
   char outfile[MAXC];   /* Filename for distcalc-like output file */
-  Pos *offsets=NULL;    /* Array to hold offsets */
+  Lpos *offsets=NULL;   /* Array to hold offsets */
   Skypos *skypos=NULL;  /* Array of sky positions */
   Skypos *skptr;        /* Pointer to navigate skypos */
   Secat *centpos=NULL;  /* Central position for distance calculations */
@@ -169,7 +169,7 @@ int main(int argc, char *argv[])
   secat = del_secat(secat);
   centpos = del_secat(centpos);
   skypos = del_skypos(skypos);
-  offsets = del_pos(offsets);
+  offsets = del_lpos(offsets);
   if(ofp)
     fclose(ofp);
 
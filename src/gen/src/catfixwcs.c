@@ -37,7 +37,7 @@ int main(int argc, char *argv[])
   char line[MAXC];      /* Generic string variable */
   char catfile[MAXC];   /* Filename for input catalog */
   char outfile[MAXC];   /* Filename for distcalc-like output file */
-  Pos offset;           /* Offset in arcsec to add to the coordinates */
+  Lpos offset;          /* Offset in arcsec to add to the coordinates */
   Secat *secat=NULL;    /* Data array from catalog */
   Secat *sptr;          /* Pointer to navigate secat */
 
@@ -1,14 +1,25 @@
 /*
  * catsort.c
  *
- * Usage: catsort [position_filename] [input_catalog] [output_filename] 
- *   [calcmethod] ([format])
+ * Usage: catsort (-n maxnum) (-r maxrad) (-t nthread) [position_filename] 
+ *   [input_catalog] [output_filename] [calcmethod] ([format]) ([memory_MB])
  *
  * This program sorts a SExtractor or SDSS catalog in terms of increasing 
  *  distance from some position, which is provided via the posfile parameter.
  * The calcmethod parameter sets whether offsets are calculated based
  *  on (x,y) coordinates (calcmethod=xy) or (RA,Dec) coordinates
  *  (calcmethod=radec). 
+ * If the optional memory_MB parameter is given, a secat-style catalog is
+ *  sorted without ever holding all of it in memory: it is split into
+ *  blocks of rows on disk, each block is purged, offset and sorted on
+ *  its own, and the sorted blocks are then merged into the output file.
+ * The optional -n and -r flags limit the output to the maxnum members
+ *  closest to the central position and/or to those within maxrad of it
+ *  (in arcsec for calcmethod=radec, pixels for calcmethod=xy).  Only 
+ *  those members are then sorted and written out.
+ * The optional -t flag reads and sorts the catalog with nthread threads
+ *  (0 ==> one per processor), through read_secat_method or 
+ *  read_sdss_method and sort_secat_key_par or sort_sdss_key_par.
  *
  * Revision history:
  *  2003Jul29, Chris Fassnacht (CDF) - First working version
@@ -20,6 +31,20 @@
  *                    position of the lens.
  *  2007Jan09, CDF - Added a parallel version for SDSS-format catalogs.
  *                   Improved documentation.
+ *  2026Oct16, AGT - Added the memory_MB parameter and the out-of-core
+ *                    sort_secat_blocks for catalogs larger than memory.
+ *  2026Oct16, AGT - Catalogs are now sorted with sort_secat_key and
+ *                    sort_sdss_key, which move each row only once.
+ *  2026Oct16, AGT - Added the -n and -r flags, and the nearest_secat, 
+ *                    nearest_sdss, sky_cut_secat and sky_cut_sdss 
+ *                    functions that do the selection.
+ *  2026Oct16, AGT - Added the -t flag, which reads the catalog with the
+ *                    multi-threaded READ_PAR reader.
+ *  2026Oct16, AGT - With -t, the catalog is also sorted on several
+ *                    threads, with sort_secat_key_par or sort_sdss_key_par.
+ *  2026Oct16, AGT - The offsets are now calculated by offset_secat and
+ *                    offset_sdss, with one call to rad2xy, rather than
+ *                    through a labelled Skypos array and dspos2xy.
  */
 
 #include <stdio.h>
@@ -27,8 +52,12 @@
 #include <math.h>
 #include <string.h>
 #include "structdef.h"
+#include "coords.h"
 #include "dataio.h"
 #include "catlib.h"
+#include "catpar.h"
+
+#define MERGEWAY 64    /* Largest number of sorted runs merged at once */
 
 /*.......................................................................
  *
@@ -38,8 +67,26 @@
 
 void catsort_help();
 int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod, 
-	       int format);
-int sort_sdss(char *catfile, char *posfile, char *outfile, int format);
+	       int format, int maxnum, double maxrad, int nthread);
+int sort_sdss(char *catfile, char *posfile, char *outfile, int format,
+	      int maxnum, double maxrad, int nthread);
+int sort_secat_blocks(char *catfile, char *posfile, char *outfile, 
+		      char *calcmethod, int format, double maxmem, int maxnum,
+		      double maxrad);
+int split_catalog(char *catfile, char *outfile, int format, int blockrows,
+		  int *nblock);
+int sort_block(char *blkname, char *runname, int format, Secat *centpos, 
+	       int maxnum, double maxrad, int *nrows);
+int merge_runs(char *outfile, int lo, int hi, char *mergename, int format,
+	       int maxrows, int *nrows);
+int sky_cut_secat(Secat *secat, int ncat, Skypos cent, double maxrad);
+int sky_cut_sdss(SDSScat *scat, int ncat, Skypos cent, double maxrad);
+int offset_secat(Secat *secat, int ncat, Skypos cent);
+int offset_sdss(SDSScat *scat, int ncat, Skypos cent);
+int nearest_secat(Secat *secat, int *ncat, int maxnum, double maxrad);
+int nearest_sdss(SDSScat *scat, int *ncat, int maxnum, double maxrad);
+int put_run_row(FILE *ofp, Secat *secat);
+int get_run_row(FILE *ifp, Secat *secat);
 
 
 /*.......................................................................
@@ -52,6 +99,11 @@ int main(int argc, char *argv[])
 {
   int no_error=1;          /* Flag set to 0 on error */
   int format;              /* Format of input/output files */
+  int firstarg=1;          /* argv index of the position filename */
+  int maxnum=0;            /* Most members to output (0 ==> all) */
+  int nthread=1;           /* Reading and sorting threads (1 ==> serial) */
+  double maxmem=0.0;       /* Memory budget in MB (0 ==> no budget) */
+  double maxrad=0.0;       /* Largest offset to output (0 ==> no limit) */
   char catfile[MAXC];      /* Filename for input catalog */
   char posfile[MAXC];      /* File containing central position */
   char outfile[MAXC];      /* Filename for input catalog */
@@ -61,7 +113,30 @@ int main(int argc, char *argv[])
    * Check the command line invocation
    */
 
-  if(argc < 4) {
+  while(firstarg < argc - 1 && argv[firstarg][0] == '-') {
+    if(strcmp(argv[firstarg],"-n") == 0) {
+      if(sscanf(argv[firstarg+1],"%d",&maxnum) != 1 || maxnum < 1) {
+	fprintf(stderr,"ERROR: Bad maximum number %s\n",argv[firstarg+1]);
+	no_error = 0;
+      }
+    }
+    else if(strcmp(argv[firstarg],"-r") == 0) {
+      if(sscanf(argv[firstarg+1],"%lf",&maxrad) != 1 || maxrad <= 0.0) {
+	fprintf(stderr,"ERROR: Bad maximum radius %s\n",argv[firstarg+1]);
+	no_error = 0;
+      }
+    }
+    else if(strcmp(argv[firstarg],"-t") == 0) {
+      if(sscanf(argv[firstarg+1],"%d",&nthread) != 1 || nthread < 0) {
+	fprintf(stderr,"ERROR: Bad number of threads %s\n",argv[firstarg+1]);
+	no_error = 0;
+      }
+    }
+    else
+      break;
+    firstarg += 2;
+  }
+  if(argc - firstarg < 4) {
     catsort_help();
     return 1;
   }
@@ -71,16 +146,22 @@ int main(int argc, char *argv[])
    * Get the inputs from the command line.
    */
 
-  strcpy(posfile,argv[1]);
-  strcpy(catfile,argv[2]);
-  strcpy(outfile,argv[3]);
-  strcpy(calcmethod,argv[4]);
-  if(argc == 6) {
-    if(sscanf(argv[5],"%d",&format) != 1)
+  strcpy(posfile,argv[firstarg]);
+  strcpy(catfile,argv[firstarg+1]);
+  strcpy(outfile,argv[firstarg+2]);
+  strcpy(calcmethod,argv[firstarg+3]);
+  if(argc - firstarg >= 5) {
+    if(sscanf(argv[firstarg+4],"%d",&format) != 1)
       no_error = 0;
   }
   else
     format = 6;
+  if(argc - firstarg == 6) {
+    if(sscanf(argv[firstarg+5],"%lf",&maxmem) != 1 || maxmem <= 0.0) {
+      fprintf(stderr,"ERROR: Bad memory budget %s\n",argv[firstarg+5]);
+      no_error = 0;
+    }
+  }
 
   /*
    * Do the sorting
@@ -89,11 +170,23 @@ int main(int argc, char *argv[])
   if(no_error) {
     switch(format){
     case 11: case 12:
-      if(sort_sdss(catfile,posfile,outfile,format))
+      if(maxmem > 0.0) {
+	fprintf(stderr,"ERROR: A memory budget can only be used with ");
+	fprintf(stderr,"secat-style catalogs.\n");
+	no_error = 0;
+      }
+      else if(sort_sdss(catfile,posfile,outfile,format,maxnum,maxrad,
+			nthread))
 	no_error = 1;
       break;
     default:
-      if(sort_secat(catfile,posfile,outfile,calcmethod,format))
+      if(maxmem > 0.0) {
+	if(sort_secat_blocks(catfile,posfile,outfile,calcmethod,format,
+			     maxmem,maxnum,maxrad))
+	  no_error = 0;
+      }
+      else if(sort_secat(catfile,posfile,outfile,calcmethod,format,maxnum,
+			 maxrad,nthread))
 	no_error = 0;
     }
   }
@@ -129,10 +222,14 @@ int main(int argc, char *argv[])
  *  char *outfile         output filename
  *  char *calcmethod      method of calculating offsets
  *  int format            format of input catalog file
+ *  int maxnum            most members to output (0 ==> all)
+ *  double maxrad         largest offset to output (0 ==> no limit)
+ *  int nthread           threads used to read and sort the catalog 
+ *                         (1 ==> serial, 0 ==> one per processor)
  */
 
 int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod, 
-	       int format)
+	       int format, int maxnum, double maxrad, int nthread)
 {
   int i;                   /* Looping variable */
   int no_error=1;          /* Flag set to 0 on error */
@@ -140,10 +237,6 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
   int ncat;                /* Number of lines in the final catalog */
   int ncent;               /* Number of lines in posfile (should be 1) */
   int centindex;           /* Catalog index of closest match to central pos */
-  Pos *offsets=NULL;       /* Array to hold offsets */
-  Pos *pptr;               /* Pointer to navigate offsets */
-  Skypos *skypos=NULL;     /* Array of sky positions */
-  Skypos *skptr;           /* Pointer to navigate skypos */
   Secat *centpos=NULL;     /* Central position for distance calculations */
   Secat *initcat=NULL;     /* Data array from input catalog */
   Secat *secat=NULL;       /* Data array from catalog, after purging */
@@ -154,7 +247,9 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
    */
 
   if(no_error)
-    if(!(initcat = read_secat(catfile,'#',&ninit,format)))
+    if(!(initcat = read_secat_method(catfile,'#',&ninit,format,
+				     nthread == 1 ? READ_STDIO : READ_PAR,
+				     nthread)))
       no_error = 0;
 
   /*
@@ -181,41 +276,20 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
 	no_error = 0;
 
     /*
-     * Allocate memory for the skypos array
-     */
-
-    if(!(skypos = new_skypos(ncat)))
-      no_error = 0;
-
-    /*
-     * Load the skypos values into the skypos array
+     * With a radius limit, drop the members that are clearly outside it
+     *  before any offsets are calculated
      */
 
-    else {
-      for(i=0,sptr=secat,skptr=skypos; i<ncat; i++,sptr++,skptr++) {
-	*skptr = sptr->skypos;
-	sprintf(skptr->label,"%04d",sptr->id);
-      }
+    if(no_error && maxrad > 0.0)
+      ncat = sky_cut_secat(secat,ncat,centpos->skypos,maxrad);
 
     /*
-     * Calculate the offsets
+     * Calculate the offsets and put them into the catalog structure
      */
 
-      if(!(offsets = dspos2xy(centpos->skypos,skypos,ncat)))
+    if(no_error)
+      if(offset_secat(secat,ncat,centpos->skypos))
 	no_error = 0;
-    }
-
-    /*
-     * Put the offsets into the catalog structure
-     */
-
-    if(no_error) {
-      for(i=0,sptr=secat,pptr=offsets; i<ncat; i++,sptr++,pptr++) {
-	sptr->dx = pptr->x;
-	sptr->dy = pptr->y;
-	sptr->dpos = sqrt(pptr->x * pptr->x + pptr->y * pptr->y);
-      }
-    }
   }
 
   /*
@@ -242,8 +316,18 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
   if(no_error) {
     printf("\nSorting the catalog in order of increasing distance ");
     printf("from the central position...");
-    qsort(secat,ncat,sizeof(secat[0]),dposcmp);
-    printf(" Done.\n");
+    if(maxnum > 0 || maxrad > 0.0) {
+      if(nearest_secat(secat,&ncat,maxnum,maxrad))
+	no_error = 0;
+    }
+    else if(nthread != 1) {
+      if(sort_secat_key_par(secat,ncat,SORT_DPOS,nthread))
+	no_error = 0;
+    }
+    else if(sort_secat_key(secat,ncat,SORT_DPOS))
+      no_error = 0;
+    if(no_error)
+      printf(" Done.\n");
   }
 
   /*
@@ -270,8 +354,6 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
   initcat = del_secat(initcat);
   secat = del_secat(secat);
   centpos = del_secat(centpos);
-  skypos = del_skypos(skypos);
-  offsets = del_pos(offsets);
 
   if(no_error)
     return 0;
@@ -283,13 +365,19 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
 
 /*.......................................................................
  *
- * Function sort_sdss
+ * Function sort_secat_blocks
  *
- * Here, the input file is a SExtractor output file, or at least a file that
- *  has a format compatible with a SExtractor format, in contrast to a
- *  SDSS-like file that has magnitudes for multiple bands all in one file.
- *  This function does the sorting and creates the output for a Secat 
- *  structure.
+ * Does the same job as sort_secat, but for catalogs that are too large
+ *  to be held in memory.  The input catalog is split into blocks of rows
+ *  on disk, each holding as many rows as the memory budget allows.  Each
+ *  block is then read, purged, offset from the central position and
+ *  sorted on its own, and written out as a binary sorted run.  Finally
+ *  the runs are merged, at most MERGEWAY at a time, and the merged
+ *  catalog is renumbered and written to the output file.
+ * The temporary files are named after the output file.  Only the radec
+ *  method is supported, since find_lens needs the whole catalog at once.
+ * With the maxnum and maxrad limits, each run holds only the members of 
+ *  its block that pass them, and the merge stops after maxnum rows.
  *
  * Inputs: 
  *  char *catfile         filename for input catalog
@@ -297,74 +385,651 @@ int sort_secat(char *catfile, char *posfile, char *outfile, char *calcmethod,
  *  char *outfile         output filename
  *  char *calcmethod      method of calculating offsets
  *  int format            format of input catalog file
+ *  double maxmem         memory budget, in MB
+ *  int maxnum            most members to output (0 ==> all)
+ *  double maxrad         largest offset to output (0 ==> no limit)
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
  */
 
-int sort_sdss(char *catfile, char *posfile, char *outfile, int format)
+int sort_secat_blocks(char *catfile, char *posfile, char *outfile, 
+		      char *calcmethod, int format, double maxmem, int maxnum,
+		      double maxrad)
 {
   int i;                   /* Looping variable */
   int no_error=1;          /* Flag set to 0 on error */
-  int ncat;                /* Number of lines in the final catalog */
+  int nexp,nskip;          /* Not used */
+  int blockrows;           /* Number of catalog rows per block */
+  int nblock=0;            /* Number of blocks */
+  int nrows;               /* Number of rows in a run */
+  int ncat=0;              /* Number of rows in the final catalog */
   int ncent;               /* Number of lines in posfile (should be 1) */
-  Pos *offsets=NULL;       /* Array to hold offsets */
-  Pos *pptr;               /* Pointer to navigate offsets */
-  Skypos *skypos=NULL;     /* Array of sky positions */
-  Skypos *skptr;           /* Pointer to navigate skypos */
+  int lo,hi;               /* Range of runs still to be merged */
+  double rowcost;          /* Memory needed per row of a block, in bytes */
+  char blkname[MAXC];      /* Name of a block file */
+  char runname[MAXC];      /* Name of a sorted run */
   Secat *centpos=NULL;     /* Central position for distance calculations */
-  SDSScat *scat=NULL;      /* Data array from catalog, after purging */
-  SDSScat *sptr;           /* Pointer to navigate secat */
 
   /*
-   * Fill the data structure
+   * Check that this catalog can be done in blocks
    */
 
-  if(no_error)
-    if(!(scat = read_sdss(catfile,'#',&ncat,format)))
-      no_error = 0;
+  if(strcmp(calcmethod,"radec") != 0) {
+    fprintf(stderr,"ERROR: sort_secat_blocks.  A memory budget can only be ");
+    fprintf(stderr,"used with calcmethod = radec.\n");
+    return 1;
+  }
+  if(format != 20 && secat_format_info(format,&nexp,&nskip)) {
+    fprintf(stderr,"ERROR: sort_secat_blocks.  Format %d can not be ",format);
+    fprintf(stderr,"split into blocks.\n");
+    return 1;
+  }
+  if(strlen(outfile) + 20 > MAXC) {
+    fprintf(stderr,"ERROR: sort_secat_blocks.  Output name too long.\n");
+    return 1;
+  }
 
   /*
-   * Read the central position
+   * A block is held as read in (with room for the array to grow), 
+   *  purged, and as positions in radians and offsets (see offset_secat)
+   */
+
+  rowcost = 3.0 * sizeof(Secat) + 4.0 * sizeof(double);
+  if((blockrows = (int) (maxmem * 1048576.0 / rowcost)) < 1)
+    blockrows = 1;
+  printf("sort_secat_blocks: Sorting %s in blocks of %d rows\n",catfile,
+	 blockrows);
+
+  /*
+   * Read the central position and split the catalog
    */
 
+  if(!(centpos = read_distcalc(posfile,'#',&ncent,0)))
+    no_error = 0;
+
   if(no_error)
-    if(!(centpos = read_distcalc(posfile,'#',&ncent,0)))
+    if(split_catalog(catfile,outfile,format,blockrows,&nblock))
       no_error = 0;
 
   /*
-   * Allocate memory for the skypos array
+   * Sort each block into a run
    */
 
-  if(!(skypos = new_skypos(ncat)))
-    no_error = 0;
+  for(i=0; i<nblock; i++) {
+    sprintf(blkname,"%s.blk%d",outfile,i);
+    sprintf(runname,"%s.run%d",outfile,i);
+    if(no_error)
+      if(sort_block(blkname,runname,format,centpos,maxnum,maxrad,&nrows))
+	no_error = 0;
+    remove(blkname);
+  }
 
   /*
-   * Load the skypos values into the skypos array
+   * Merge the runs, MERGEWAY at a time, until few enough are left to be
+   *  merged into the output file
    */
 
+  lo = 0;
+  hi = nblock;
+  while(no_error && hi - lo > MERGEWAY) {
+    sprintf(runname,"%s.run%d",outfile,hi);
+    if(merge_runs(outfile,lo,lo+MERGEWAY,runname,-1,maxnum,&nrows))
+      no_error = 0;
+    lo += MERGEWAY;
+    hi++;
+  }
+  if(no_error) {
+    printf("\nsort_secat_blocks: Merging %d sorted blocks in order of ",
+	   hi-lo);
+    printf("increasing distance\n");
+    if(merge_runs(outfile,lo,hi,outfile,format,maxnum,&ncat))
+      no_error = 0;
+    else
+      printf("sort_secat_blocks: Wrote %d rows to %s\n",ncat,outfile);
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  for(i=lo; i<hi; i++) {
+    sprintf(runname,"%s.run%d",outfile,i);
+    remove(runname);
+  }
+  centpos = del_secat(centpos);
+
+  if(no_error)
+    return 0;
   else {
-    for(i=0,sptr=scat,skptr=skypos; i<ncat; i++,sptr++,skptr++) {
-      *skptr = sptr->skypos;
-      sprintf(skptr->label,"%04d",sptr->id);
+    fprintf(stderr,"ERROR: sort_secat_blocks\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function split_catalog
+ *
+ * Copies a catalog into block files of at most blockrows data lines
+ *  each, named outfile.blk0, outfile.blk1, ...  The header lines of the
+ *  catalog (the nskip lines of its format, and any comment lines before
+ *  the first data line) are repeated at the top of every block, so that
+ *  each block can be read with read_secat_mode like the catalog itself.
+ *
+ * Inputs: 
+ *  char *catfile         filename for input catalog
+ *  char *outfile         output filename, used to name the blocks
+ *  int format            format of input catalog file
+ *  int blockrows         largest number of data lines in a block
+ *  int *nblock           number of blocks written (set by this function)
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int split_catalog(char *catfile, char *outfile, int format, int blockrows,
+		  int *nblock)
+{
+  int no_error=1;          /* Flag set to 0 on error */
+  int nexp,nskip=0;        /* Number of header lines in the format */
+  int lc=0;                /* Number of lines read */
+  int nrows=0;             /* Number of data lines in the current block */
+  int athead=1;            /* Flag set to 0 once the data begin */
+  int atstart=1;           /* Flag set if line starts a new input line */
+  size_t nhead=0;          /* Length of the header */
+  size_t len;              /* Length of a line */
+  char line[MAXC];         /* General input string */
+  char blkname[MAXC];      /* Name of a block file */
+  char *head=NULL;         /* Header lines */
+  char *tmp;               /* Temporary pointer used to grow head */
+  FILE *ifp=NULL;          /* Input file pointer */
+  FILE *ofp=NULL;          /* Block file pointer */
+
+  *nblock = 0;
+  if(format != 20)
+    secat_format_info(format,&nexp,&nskip);
+
+  if(!(ifp = open_readfile(catfile))) {
+    fprintf(stderr,"ERROR: split_catalog.\n");
+    return 1;
+  }
+
+  while(no_error && fgets(line,MAXC,ifp) != NULL) {
+    len = strlen(line);
+
+    /*
+     * Collect the header lines
+     */
+
+    if(athead && atstart && lc >= nskip && line[0] != '#')
+      athead = 0;
+    if(athead) {
+      if(!(tmp = (char *) realloc(head,nhead + len + 1))) {
+	fprintf(stderr,"ERROR: split_catalog.  Insufficient memory.\n");
+	no_error = 0;
+	break;
+      }
+      head = tmp;
+      memcpy(head+nhead,line,len+1);
+      nhead += len;
+    }
+
+    /*
+     * Start a new block if the current one is full, and copy the 
+     *  data line into it
+     */
+
+    else {
+      if(atstart && (!ofp || nrows == blockrows)) {
+	if(ofp && fclose(ofp) != 0)
+	  no_error = 0;
+	sprintf(blkname,"%s.blk%d",outfile,*nblock);
+	if(!(ofp = fopen(blkname,"w"))) {
+	  fprintf(stderr,"ERROR: split_catalog.  Cannot open %s\n",blkname);
+	  no_error = 0;
+	  break;
+	}
+	(*nblock)++;
+	nrows = 0;
+	if(nhead > 0 && fwrite(head,1,nhead,ofp) != nhead)
+	  no_error = 0;
+      }
+      if(fputs(line,ofp) == EOF)
+	no_error = 0;
+      if(atstart && line[0] != '#')
+	nrows++;
     }
 
     /*
-     * Calculate the offsets
+     * Lines longer than the input string come in more than one piece
      */
 
-    if(!(offsets = dspos2xy(centpos->skypos,skypos,ncat)))
+    if((atstart = (len > 0 && line[len-1] == '\n')))
+      lc++;
+  }
+
+  if(ferror(ifp)) {
+    fprintf(stderr,"ERROR: split_catalog.  Error reading %s\n",catfile);
+    no_error = 0;
+  }
+  if(ofp && fclose(ofp) != 0)
+    no_error = 0;
+  fclose(ifp);
+  free(head);
+
+  if(no_error) {
+    printf("split_catalog: Split %s into %d blocks\n",catfile,*nblock);
+    return 0;
+  }
+  else {
+    fprintf(stderr,"ERROR: split_catalog\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function sort_block
+ *
+ * Reads one block of a catalog, purges it, calculates the offsets of its
+ *  members from the central position, sorts it and writes it to a 
+ *  binary run file (see put_run_row).  With the maxnum and maxrad 
+ *  limits, only the members of the block that pass them are written.
+ *
+ * Inputs: 
+ *  char *blkname         filename of the block
+ *  char *runname         filename of the sorted run
+ *  int format            format of the block
+ *  Secat *centpos        central position
+ *  int maxnum            most members to keep (0 ==> all)
+ *  double maxrad         largest offset to keep (0 ==> no limit)
+ *  int *nrows            number of rows in the run (set by this function)
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int sort_block(char *blkname, char *runname, int format, Secat *centpos, 
+	       int maxnum, double maxrad, int *nrows)
+{
+  int i;                   /* Looping variable */
+  int no_error=1;          /* Flag set to 0 on error */
+  int ninit;               /* Number of lines in the block */
+  int ncat=0;              /* Number of lines after purging */
+  Secat *initcat=NULL;     /* Data array from the block */
+  Secat *secat=NULL;       /* Data array from the block, after purging */
+  Secat *sptr;             /* Pointer to navigate secat */
+  FILE *ofp=NULL;          /* Run file pointer */
+
+  /*
+   * Read and purge the block
+   */
+
+  if(!(initcat = read_secat_mode(blkname,'#',&ninit,format,READ_STDIO)))
+    no_error = 0;
+
+  if(no_error)
+    if(!(secat = purge_cat(initcat,ninit,blkname,&ncat,MASTERLIM)))
+      no_error = 0;
+  initcat = del_secat(initcat);
+
+  if(no_error && maxrad > 0.0)
+    ncat = sky_cut_secat(secat,ncat,centpos->skypos,maxrad);
+
+  /*
+   * Calculate the offsets
+   */
+
+  if(no_error)
+    if(offset_secat(secat,ncat,centpos->skypos))
+      no_error = 0;
+
+  /*
+   * Sort the block and write it out
+   */
+
+  if(no_error) {
+    if(maxnum > 0 || maxrad > 0.0) {
+      if(nearest_secat(secat,&ncat,maxnum,maxrad))
+	no_error = 0;
+    }
+    else if(sort_secat_key(secat,ncat,SORT_DPOS))
+      no_error = 0;
+  }
+
+  if(no_error) {
+    if(!(ofp = fopen(runname,"wb"))) {
+      fprintf(stderr,"ERROR: sort_block.  Cannot open %s\n",runname);
+      no_error = 0;
+    }
+  }
+  if(no_error) {
+    for(i=0,sptr=secat; i<ncat && no_error; i++,sptr++)
+      if(put_run_row(ofp,sptr))
+	no_error = 0;
+    if(fclose(ofp) != 0)
       no_error = 0;
   }
 
   /*
-   * Put the offsets into the catalog structure
+   * Clean up and exit
+   */
+
+  *nrows = ncat;
+  secat = del_secat(secat);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: sort_block\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function merge_runs
+ *
+ * Merges the sorted runs outfile.run[lo] ... outfile.run[hi-1] in order
+ *  of increasing dpos, using a heap that holds the next row of each run.
+ *  If format is negative the merged rows go to the run file mergename.
+ *  Otherwise the rows are renumbered and written to mergename as a 
+ *  catalog of the given format, as write_secat would write them.  The
+ *  merge stops after maxrows rows, if maxrows is positive.  The merged 
+ *  runs are removed.
+ *
+ * Inputs: 
+ *  char *outfile         output filename, used to name the runs
+ *  int lo                first run to merge
+ *  int hi                one past the last run to merge
+ *  char *mergename       filename for the merged rows
+ *  int format            output format, or -1 for a run file
+ *  int maxrows           most rows to merge (<= 0 ==> all)
+ *  int *nrows            number of rows merged (set by this function)
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int merge_runs(char *outfile, int lo, int hi, char *mergename, int format,
+	       int maxrows, int *nrows)
+{
+  int i;                   /* Looping variable */
+  int no_error=1;          /* Flag set to 0 on error */
+  int nrun=0;              /* Number of runs with rows left */
+  int parent,child;        /* Heap positions */
+  int top;                 /* Run at the top of the heap */
+  int heap[MERGEWAY];      /* Runs ordered by the dpos of their next row */
+  char runname[MAXC];      /* Name of a sorted run */
+  Secat *heads=NULL;       /* Next row of each run */
+  FILE *ifp[MERGEWAY];     /* Run file pointers */
+  FILE *ofp=NULL;          /* Output file pointer */
+  Outbuf *ob=NULL;         /* Output buffer for the final catalog */
+
+  *nrows = 0;
+  for(i=0; i<hi-lo; i++)
+    ifp[i] = NULL;
+  if(!(heads = new_secat(MERGEWAY)))
+    return 1;
+
+  /*
+   * Open the runs and put their first rows into the heap
+   */
+
+  for(i=0; i<hi-lo && no_error; i++) {
+    sprintf(runname,"%s.run%d",outfile,lo+i);
+    if(!(ifp[i] = fopen(runname,"rb"))) {
+      fprintf(stderr,"ERROR: merge_runs.  Cannot open %s\n",runname);
+      no_error = 0;
+    }
+    else if(get_run_row(ifp[i],heads+i) == 0) {
+      for(child=nrun++; child > 0; child=parent) {
+	parent = (child - 1) / 2;
+	if(heads[heap[parent]].dpos <= heads[i].dpos)
+	  break;
+	heap[child] = heap[parent];
+      }
+      heap[child] = i;
+    }
+  }
+
+  /*
+   * Open the output
    */
 
   if(no_error) {
-    for(i=0,sptr=scat,pptr=offsets; i<ncat; i++,sptr++,pptr++) {
-      sptr->dx = pptr->x;
-      sptr->dy = pptr->y;
-      sptr->dpos = sqrt(pptr->x * pptr->x + pptr->y * pptr->y);
+    if(format < 0)
+      ofp = fopen(mergename,"wb");
+    else
+      ofp = open_writefile(mergename);
+    if(!ofp) {
+      fprintf(stderr,"ERROR: merge_runs.  Cannot open %s\n",mergename);
+      no_error = 0;
+    }
+    else if(format >= 0) {
+      if(!(ob = new_outbuf(ofp,OUTBUFSIZE)))
+	no_error = 0;
+      else if(format == 4)
+	ob_puts(ob,".\n.\n.\n",0,0);
+    }
+  }
+
+  /*
+   * Repeatedly write out the row at the top of the heap, and replace it
+   *  with the next row from the same run
+   */
+
+  while(no_error && nrun > 0 && (maxrows <= 0 || *nrows < maxrows)) {
+    top = heap[0];
+    if(format < 0) {
+      if(put_run_row(ofp,heads+top))
+	no_error = 0;
+    }
+    else {
+      heads[top].id = *nrows + 1;
+      if(print_secat_rows(ob,heads+top,1,format))
+	no_error = 0;
+    }
+    (*nrows)++;
+    if(get_run_row(ifp[top],heads+top)) {
+      if(ferror(ifp[top]))
+	no_error = 0;
+      top = heap[--nrun];
+    }
+    for(parent=0; (child = 2*parent + 1) < nrun; parent=child) {
+      if(child + 1 < nrun && 
+	 heads[heap[child+1]].dpos < heads[heap[child]].dpos)
+	child++;
+      if(heads[top].dpos <= heads[heap[child]].dpos)
+	break;
+      heap[parent] = heap[child];
+    }
+    heap[parent] = top;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  if(ob && del_outbuf(ob))
+    no_error = 0;
+  if(ofp && fclose(ofp) != 0)
+    no_error = 0;
+  for(i=0; i<hi-lo; i++) {
+    if(ifp[i]) {
+      fclose(ifp[i]);
+      sprintf(runname,"%s.run%d",outfile,lo+i);
+      remove(runname);
     }
   }
+  heads = del_secat(heads);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: merge_runs\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function put_run_row
+ *
+ * Writes one catalog member to a binary run file.  Only the scalar 
+ *  members that a Colcat keeps (see colcat_colinfo), the apertures and
+ *  the name are written, so that a row takes a few hundred bytes rather
+ *  than the size of a Secat.
+ *
+ * Inputs: FILE *ofp          run file
+ *         Secat *secat       catalog member
+ *
+ * Output: int (0 or 1)       0 ==> success, 1 ==> error
+ */
+
+int put_run_row(FILE *ofp, Secat *secat)
+{
+  int i;                   /* Looping variable */
+  int ncols;               /* Number of scalar members */
+  int len;                 /* Length of the name */
+  size_t naper;            /* Number of apertures, as an fwrite count */
+  size_t elsize;           /* Size of a scalar member */
+  Colinfo *cptr;           /* Pointer to navigate the column descriptions */
+
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    if(fwrite((char *) secat + cptr->secoff,elsize,1,ofp) != 1)
+      return 1;
+  }
+  len = strlen(secat->name);
+  if(fwrite(&secat->naper,sizeof(int),1,ofp) != 1 ||
+     fwrite(&len,sizeof(int),1,ofp) != 1)
+    return 1;
+  if(secat->naper > 0) {
+    naper = (size_t) secat->naper;
+    if(fwrite(secat->maper,sizeof(float),naper,ofp) != naper ||
+       fwrite(secat->mapererr,sizeof(float),naper,ofp) != naper ||
+       fwrite(secat->faper,sizeof(float),naper,ofp) != naper ||
+       fwrite(secat->fapererr,sizeof(float),naper,ofp) != naper)
+      return 1;
+  }
+  if(len > 0 && fwrite(secat->name,1,len,ofp) != (size_t) len)
+    return 1;
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function get_run_row
+ *
+ * Reads the next catalog member from a binary run file written by
+ *  put_run_row.  Members that are not kept in the run file are set to
+ *  their init_secat values.
+ *
+ * Inputs: FILE *ifp          run file
+ *         Secat *secat       catalog member (filled by this function)
+ *
+ * Output: int (0 or 1)       0 ==> success, 1 ==> end of file or error
+ */
+
+int get_run_row(FILE *ifp, Secat *secat)
+{
+  int i;                   /* Looping variable */
+  int ncols;               /* Number of scalar members */
+  int len;                 /* Length of the name */
+  size_t naper;            /* Number of apertures, as an fwrite count */
+  size_t elsize;           /* Size of a scalar member */
+  Colinfo *cptr;           /* Pointer to navigate the column descriptions */
+
+  init_secat(secat);
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    if(fread((char *) secat + cptr->secoff,elsize,1,ifp) != 1)
+      return 1;
+  }
+  if(fread(&secat->naper,sizeof(int),1,ifp) != 1 ||
+     fread(&len,sizeof(int),1,ifp) != 1 ||
+     secat->naper < 0 || secat->naper > 100 || len < 0 || len >= MAXC)
+    return 1;
+  if(secat->naper > 0) {
+    naper = (size_t) secat->naper;
+    if(fread(secat->maper,sizeof(float),naper,ifp) != naper ||
+       fread(secat->mapererr,sizeof(float),naper,ifp) != naper ||
+       fread(secat->faper,sizeof(float),naper,ifp) != naper ||
+       fread(secat->fapererr,sizeof(float),naper,ifp) != naper)
+      return 1;
+  }
+  if(len > 0 && fread(secat->name,1,len,ifp) != (size_t) len)
+    return 1;
+  secat->name[len] = '\0';
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function sort_sdss
+ *
+ * Here, the input file is a SExtractor output file, or at least a file that
+ *  has a format compatible with a SExtractor format, in contrast to a
+ *  SDSS-like file that has magnitudes for multiple bands all in one file.
+ *  This function does the sorting and creates the output for a Secat 
+ *  structure.
+ *
+ * Inputs: 
+ *  char *catfile         filename for input catalog
+ *  char *posfile         file containing central position
+ *  char *outfile         output filename
+ *  int format            format of input catalog file
+ *  int maxnum            most members to output (0 ==> all)
+ *  double maxrad         largest offset to output (0 ==> no limit)
+ *  int nthread           threads used to read and sort the catalog 
+ *                         (1 ==> serial, 0 ==> one per processor)
+ */
+
+int sort_sdss(char *catfile, char *posfile, char *outfile, int format,
+	      int maxnum, double maxrad, int nthread)
+{
+  int i;                   /* Looping variable */
+  int no_error=1;          /* Flag set to 0 on error */
+  int ncat;                /* Number of lines in the final catalog */
+  int ncent;               /* Number of lines in posfile (should be 1) */
+  Secat *centpos=NULL;     /* Central position for distance calculations */
+  SDSScat *scat=NULL;      /* Data array from catalog, after purging */
+  SDSScat *sptr;           /* Pointer to navigate secat */
+
+  /*
+   * Fill the data structure
+   */
+
+  if(no_error)
+    if(!(scat = read_sdss_method(catfile,'#',&ncat,format,
+				 nthread == 1 ? READ_STDIO : READ_PAR,nthread)))
+      no_error = 0;
+
+  /*
+   * Read the central position
+   */
+
+  if(no_error)
+    if(!(centpos = read_distcalc(posfile,'#',&ncent,0)))
+      no_error = 0;
+
+  /*
+   * With a radius limit, drop the members that are clearly outside it
+   *  before any offsets are calculated
+   */
+
+  if(no_error && maxrad > 0.0)
+    ncat = sky_cut_sdss(scat,ncat,centpos->skypos,maxrad);
+
+  /*
+   * Calculate the offsets and put them into the catalog structure
+   */
+
+  if(no_error)
+    if(offset_sdss(scat,ncat,centpos->skypos))
+      no_error = 0;
 
   /*
    * Sort the catalog in order of
@@ -374,8 +1039,18 @@ int sort_sdss(char *catfile, char *posfile, char *outfile, int format)
   if(no_error) {
     printf("\nSorting the catalog in order of increasing distance ");
     printf("from the central position...");
-    qsort(scat,ncat,sizeof(scat[0]),dposcmp_sdss);
-    printf(" Done.\n");
+    if(maxnum > 0 || maxrad > 0.0) {
+      if(nearest_sdss(scat,&ncat,maxnum,maxrad))
+	no_error = 0;
+    }
+    else if(nthread != 1) {
+      if(sort_sdss_key_par(scat,ncat,SORT_DPOS,nthread))
+	no_error = 0;
+    }
+    else if(sort_sdss_key(scat,ncat,SORT_DPOS))
+      no_error = 0;
+    if(no_error)
+      printf(" Done.\n");
   }
 
   /*
@@ -401,8 +1076,6 @@ int sort_sdss(char *catfile, char *posfile, char *outfile, int format)
 
   scat = del_sdsscat(scat);
   centpos = del_secat(centpos);
-  skypos = del_skypos(skypos);
-  offsets = del_pos(offsets);
 
   if(no_error)
     return 0;
@@ -412,6 +1085,302 @@ int sort_sdss(char *catfile, char *posfile, char *outfile, int format)
   }
 }
 
+/*.......................................................................
+ *
+ * Function sky_cut_secat
+ *
+ * Moves the members of a catalog that may be within maxrad arcsec of the
+ *  central position to the front of the catalog, keeping their order,
+ *  and returns how many there are.  The test is a dot product of unit 
+ *  vectors against the offset2cos threshold, which is cheap and never
+ *  rejects a member that is within the radius, so that the offsets 
+ *  only need to be calculated for the members that are kept.
+ *
+ * Inputs: 
+ *  Secat *secat          catalog
+ *  int ncat              number of members in secat
+ *  Skypos cent           central position
+ *  double maxrad         radius, in arcsec
+ *
+ * Output: int nkeep      number of members kept
+ */
+
+int sky_cut_secat(Secat *secat, int ncat, Skypos cent, double maxrad)
+{
+  int i;                   /* Looping variable */
+  int nkeep=0;             /* Number of members kept */
+  double cosmin;           /* Dot product threshold for maxrad */
+  double cvec[3];          /* Unit vector of the central position */
+  double vec[3];           /* Unit vector of a member */
+
+  spos2vec(cent,cvec);
+  cosmin = offset2cos(maxrad);
+  for(i=0; i<ncat; i++) {
+    spos2vec(secat[i].skypos,vec);
+    if(vec[0] * cvec[0] + vec[1] * cvec[1] + vec[2] * cvec[2] >= cosmin) {
+      if(nkeep < i)
+	secat[nkeep] = secat[i];
+      nkeep++;
+    }
+  }
+
+  printf("sky_cut_secat: %d of %d members may be within %.2f arcsec\n",
+	 nkeep,ncat,maxrad);
+  return nkeep;
+}
+
+/*.......................................................................
+ *
+ * Function sky_cut_sdss
+ *
+ * The same as sky_cut_secat, but for a SDSScat array.
+ *
+ * Inputs: 
+ *  SDSScat *scat         catalog
+ *  int ncat              number of members in scat
+ *  Skypos cent           central position
+ *  double maxrad         radius, in arcsec
+ *
+ * Output: int nkeep      number of members kept
+ */
+
+int sky_cut_sdss(SDSScat *scat, int ncat, Skypos cent, double maxrad)
+{
+  int i;                   /* Looping variable */
+  int nkeep=0;             /* Number of members kept */
+  double cosmin;           /* Dot product threshold for maxrad */
+  double cvec[3];          /* Unit vector of the central position */
+  double vec[3];           /* Unit vector of a member */
+
+  spos2vec(cent,cvec);
+  cosmin = offset2cos(maxrad);
+  for(i=0; i<ncat; i++) {
+    spos2vec(scat[i].skypos,vec);
+    if(vec[0] * cvec[0] + vec[1] * cvec[1] + vec[2] * cvec[2] >= cosmin) {
+      if(nkeep < i)
+	scat[nkeep] = scat[i];
+      nkeep++;
+    }
+  }
+
+  printf("sky_cut_sdss: %d of %d members may be within %.2f arcsec\n",
+	 nkeep,ncat,maxrad);
+  return nkeep;
+}
+
+/*.......................................................................
+ *
+ * Function offset_secat
+ *
+ * Calculates the (x,y) offsets, in arcsec, of the members of a catalog
+ *  from the central position and puts them, and their lengths, into the
+ *  dx, dy and dpos members.  The positions are converted to radians 
+ *  once and passed to rad2xy in a single call.
+ *
+ * Inputs: 
+ *  Secat *secat          catalog (dx, dy and dpos set by function)
+ *  int ncat              number of members in secat
+ *  Skypos cent           central position
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int offset_secat(Secat *secat, int ncat, Skypos cent)
+{
+  int i;                   /* Looping variable */
+  double alpha0,delta0;    /* Central position in radians */
+  double *rad=NULL;        /* RAs, Decs, x and y offsets, ncat of each */
+  double *x,*y;            /* Offsets within rad */
+  Secat *sptr;             /* Pointer to navigate secat */
+
+  if(ncat < 1)
+    return 0;
+
+  if(!(rad = (double *) malloc(4 * ncat * sizeof(double)))) {
+    fprintf(stderr,"ERROR: offset_secat.  Insufficient memory.\n");
+    return 1;
+  }
+  x = rad + 2 * ncat;
+  y = rad + 3 * ncat;
+
+  spos2rad(cent,&alpha0,&delta0);
+  for(i=0,sptr=secat; i<ncat; i++,sptr++)
+    spos2rad(sptr->skypos,rad+i,rad+ncat+i);
+  rad2xy(alpha0,delta0,rad,rad+ncat,ncat,x,y);
+
+  for(i=0,sptr=secat; i<ncat; i++,sptr++) {
+    sptr->dx = x[i];
+    sptr->dy = y[i];
+    sptr->dpos = sqrt(x[i] * x[i] + y[i] * y[i]);
+  }
+
+  free(rad);
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function offset_sdss
+ *
+ * The same as offset_secat, but for a SDSScat array.
+ *
+ * Inputs: 
+ *  SDSScat *scat         catalog (dx, dy and dpos set by function)
+ *  int ncat              number of members in scat
+ *  Skypos cent           central position
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int offset_sdss(SDSScat *scat, int ncat, Skypos cent)
+{
+  int i;                   /* Looping variable */
+  double alpha0,delta0;    /* Central position in radians */
+  double *rad=NULL;        /* RAs, Decs, x and y offsets, ncat of each */
+  double *x,*y;            /* Offsets within rad */
+  SDSScat *sptr;           /* Pointer to navigate scat */
+
+  if(ncat < 1)
+    return 0;
+
+  if(!(rad = (double *) malloc(4 * ncat * sizeof(double)))) {
+    fprintf(stderr,"ERROR: offset_sdss.  Insufficient memory.\n");
+    return 1;
+  }
+  x = rad + 2 * ncat;
+  y = rad + 3 * ncat;
+
+  spos2rad(cent,&alpha0,&delta0);
+  for(i=0,sptr=scat; i<ncat; i++,sptr++)
+    spos2rad(sptr->skypos,rad+i,rad+ncat+i);
+  rad2xy(alpha0,delta0,rad,rad+ncat,ncat,x,y);
+
+  for(i=0,sptr=scat; i<ncat; i++,sptr++) {
+    sptr->dx = x[i];
+    sptr->dy = y[i];
+    sptr->dpos = sqrt(x[i] * x[i] + y[i] * y[i]);
+  }
+
+  free(rad);
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function nearest_secat
+ *
+ * Replaces a catalog, whose dpos values have been set, with its maxnum
+ *  members closest to the central position that are within maxrad of
+ *  it, in order of increasing distance.  The members are chosen with 
+ *  nearest_index, so the rest of the catalog is never sorted, and only
+ *  the chosen members are copied.
+ *
+ * Inputs: 
+ *  Secat *secat          catalog (first *ncat members set by function)
+ *  int *ncat             number of members in secat (set by function)
+ *  int maxnum            most members to keep (0 ==> all)
+ *  double maxrad         largest offset to keep (0 ==> no limit)
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int nearest_secat(Secat *secat, int *ncat, int maxnum, double maxrad)
+{
+  int i;                   /* Looping variable */
+  int no_error=1;          /* Flag set to 0 on error */
+  int nkeep=0;             /* Number of members kept */
+  int *index=NULL;         /* Order of the kept members */
+  double *key=NULL;        /* Offsets of the members */
+  Secat *near=NULL;        /* Kept members */
+
+  if(!(key = secat_sortkeys(secat,*ncat,SORT_DPOS)))
+    no_error = 0;
+  if(no_error)
+    if(!(index = nearest_index(key,*ncat,maxnum,maxrad,&nkeep)))
+      no_error = 0;
+  if(no_error)
+    if(!(near = (Secat *) malloc((nkeep + 1) * sizeof(Secat))))
+      no_error = 0;
+
+  if(no_error) {
+    for(i=0; i<nkeep; i++)
+      near[i] = secat[index[i]];
+    for(i=0; i<nkeep; i++)
+      secat[i] = near[i];
+    *ncat = nkeep;
+  }
+
+  if(key)
+    free(key);
+  if(index)
+    free(index);
+  if(near)
+    free(near);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: nearest_secat\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function nearest_sdss
+ *
+ * The same as nearest_secat, but for a SDSScat array.
+ *
+ * Inputs: 
+ *  SDSScat *scat         catalog (first *ncat members set by function)
+ *  int *ncat             number of members in scat (set by function)
+ *  int maxnum            most members to keep (0 ==> all)
+ *  double maxrad         largest offset to keep (0 ==> no limit)
+ *
+ * Output: int (0 or 1)   0 ==> success, 1 ==> error
+ */
+
+int nearest_sdss(SDSScat *scat, int *ncat, int maxnum, double maxrad)
+{
+  int i;                   /* Looping variable */
+  int no_error=1;          /* Flag set to 0 on error */
+  int nkeep=0;             /* Number of members kept */
+  int *index=NULL;         /* Order of the kept members */
+  double *key=NULL;        /* Offsets of the members */
+  SDSScat *near=NULL;      /* Kept members */
+
+  if(!(key = sdss_sortkeys(scat,*ncat,SORT_DPOS)))
+    no_error = 0;
+  if(no_error)
+    if(!(index = nearest_index(key,*ncat,maxnum,maxrad,&nkeep)))
+      no_error = 0;
+  if(no_error)
+    if(!(near = (SDSScat *) malloc((nkeep + 1) * sizeof(SDSScat))))
+      no_error = 0;
+
+  if(no_error) {
+    for(i=0; i<nkeep; i++)
+      near[i] = scat[index[i]];
+    for(i=0; i<nkeep; i++)
+      scat[i] = near[i];
+    *ncat = nkeep;
+  }
+
+  if(key)
+    free(key);
+  if(index)
+    free(index);
+  if(near)
+    free(near);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: nearest_sdss\n");
+    return 1;
+  }
+}
+
 /*.......................................................................
  *
  * Function catsort_help
@@ -427,8 +1396,9 @@ void catsort_help()
 {
   char line[MAXC];  /* General string */
 
-  fprintf(stderr,"\nUsage: catsort [posfile] [catfile] [outfile] ");
-  fprintf(stderr,"[calcmethod] ([format])\n\n");
+  fprintf(stderr,"\nUsage: catsort (-n maxnum) (-r maxrad) (-t nthread) ");
+  fprintf(stderr,"[posfile] [catfile] [outfile]\n");
+  fprintf(stderr,"         [calcmethod] ([format]) ([memory_MB])\n\n");
   fprintf(stderr,"  catfile is the file containing the catalog\n");
   fprintf(stderr,"  posfile is the file containing the RA, Dec of the");
   fprintf(stderr," central object.\n");
@@ -439,7 +1409,18 @@ void catsort_help()
   fprintf(stderr,"    For calcmethod = xy distances are based on");
   fprintf(stderr," (x,y) coordinates.\n");
   fprintf(stderr,"    For calcmethod = radec distances are based on");
-  fprintf(stderr," (RA,Dec) coordinates.\n\n");
+  fprintf(stderr," (RA,Dec) coordinates.\n");
+  fprintf(stderr,"  memory_MB, if given, limits the memory used to sort a");
+  fprintf(stderr," secat-style\n");
+  fprintf(stderr,"    catalog, which is then sorted in blocks on disk");
+  fprintf(stderr," (calcmethod = radec only).\n");
+  fprintf(stderr,"  -n maxnum, if given, outputs only the maxnum members");
+  fprintf(stderr," closest to the\n    central position.\n");
+  fprintf(stderr,"  -r maxrad, if given, outputs only the members within");
+  fprintf(stderr," maxrad of the\n    central position (arcsec for");
+  fprintf(stderr," radec, pixels for xy).\n");
+  fprintf(stderr,"  -t nthread, if given, reads and sorts the catalog with");
+  fprintf(stderr," nthread\n    threads (0 ==> one per processor).\n\n");
   fprintf(stderr," The optional format flag indicates the format of the");
   fprintf(stderr," input file:\n");
   fprintf(stderr,"Hit return to see the format options: ");
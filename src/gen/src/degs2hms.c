@@ -7,10 +7,15 @@
  *               converts them to RA,Dec format (hms).  
  *
  * 17Nov2004, CDF  A inversion of hms2degs.c
+ * v16Oct2026, AGT Positions are now printed with format_ra and format_dec,
+ *                  which round the seconds once (no more 60.000) and keep
+ *                  the sign of Decs between 0 and -1.  Batch output goes
+ *                  through an Outbuf and the input is read with strtod.
  *
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include "structdef.h"
@@ -112,7 +117,8 @@ int degs2hms_interactive()
   double alphadeg;  /* RA in decimal format */
   double deltadeg;  /* Dec in decimal format */
   char line[MAXC];  /* General string for reading input */
-  Skypos skypos;    /* Sky position in hh mm ss.sss dd mm ss.sss format */
+  char ra[HMSLEN];  /* RA in hh:mm:ss.ssss format */
+  char dec[HMSLEN]; /* Dec in dd:mm:ss.sss format */
 
   /*
    * Loop until the user wants to quit
@@ -134,19 +140,12 @@ int degs2hms_interactive()
     }
 
     /*
-     * Convert to hms format
+     * Convert to hms format and print out results
      */
 
-    deg2spos(alphadeg,deltadeg,&skypos);
-
-    /*
-     * Print out results
-     */
-
-    printf("\n%9.5f %9.5f ---> %02d:%02d:%07.4f %+03d:%02d:%06.3f\n",
-	   alphadeg,deltadeg,
-	   skypos.hr,skypos.min,skypos.sec,
-	   skypos.deg,skypos.amin,skypos.asec);
+    format_ra(alphadeg,':',4,ra);
+    format_dec(deltadeg,':',3,dec);
+    printf("\n%9.5f %9.5f ---> %s %s\n",alphadeg,deltadeg,ra,dec);
 
     /*
      * Check if further runs are required
@@ -183,13 +182,18 @@ int degs2hms_batch(char *inname, char *outname)
 {
   int no_error = 1;    /* Flag set to 0 on error */
   int nlines;          /* Number of lines in the input file */
+  size_t len;          /* Length of the label */
   double alphadeg;     /* RA in decimal format */
   double deltadeg;     /* Dec in decimal format */
   char line[MAXC];     /* General string for reading input */
   char newname[MAXC];  /* New name for output file */
-  Skypos skypos;       /* First sky position entered */
+  char label[MAXC];    /* Label of the position */
+  char radec[HMSLEN];  /* RA or Dec in sexagesimal format */
+  char *lptr;          /* Start of the label in line */
+  char *ptr,*end;      /* Pointers used to read the numbers in line */
   FILE *ifp=NULL;      /* Optional input file */
   FILE *ofp=NULL;      /* Optional output file */
+  Outbuf *ob=NULL;     /* Buffer for the output lines */
 
  
   /*
@@ -251,6 +255,14 @@ int degs2hms_batch(char *inname, char *outname)
     printf("----------   ------------- -------------\n");
   }
 
+  /*
+   * Set up the output buffer
+   */
+
+  if(no_error)
+    if(!(ob = new_outbuf(ofp ? ofp : stdout,OUTBUFSIZE)))
+      no_error = 0;
+
   /*
    * Now cycle through the input file, reading in a pair of coordinates
    *  for each line and calculating the offset between them.
@@ -258,7 +270,15 @@ int degs2hms_batch(char *inname, char *outname)
 
   while(fgets(line, MAXC, ifp) != NULL && no_error) {
     if(line[0] != '!') {
-      if(sscanf(line,"%s %lf %lf",skypos.label,&alphadeg,&deltadeg) != 3) {
+      lptr = line + strspn(line," \t");
+      len = strcspn(lptr," \t\r\n");
+      ptr = lptr + len;
+      alphadeg = strtod(ptr,&end);
+      if(end != ptr) {
+	ptr = end;
+	deltadeg = strtod(ptr,&end);
+      }
+      if(len == 0 || end == ptr) {
 	fprintf(stderr,"ERROR.  Bad input file format.\n");
 	fprintf(stderr,"This program requires the following format:\n");
 	fprintf(stderr," label alpha delta.\n");
@@ -268,23 +288,19 @@ int degs2hms_batch(char *inname, char *outname)
       if(no_error) {
 
 	/*
-	 * Convert to RA, Dec
+	 * Print out the position in RA, Dec
 	 */
 
-	deg2spos(alphadeg,deltadeg,&skypos);
-
-	/*
-	 * Print out the offsets
-	 */
-
-	if(ofp)
-	  fprintf(ofp,"%-12s %02d %02d %07.4f %+03d %02d %06.3f\n",skypos.label,
-		  skypos.hr,skypos.min,skypos.sec,
-		  skypos.deg,skypos.amin,skypos.asec);
-	else
-	  printf("%-12s %02d %02d %07.4f %+03d %02d %06.3f\n",skypos.label,
-		 skypos.hr,skypos.min,skypos.sec,
-		 skypos.deg,skypos.amin,skypos.asec);
+	memcpy(label,lptr,len);
+	label[len] = '\0';
+	ob_puts(ob,label,12,OB_LEFT);
+	ob_putc(ob,' ');
+	format_ra(alphadeg,' ',4,radec);
+	ob_puts(ob,radec,0,0);
+	ob_putc(ob,' ');
+	format_dec(deltadeg,' ',3,radec);
+	ob_puts(ob,radec,0,0);
+	ob_putc(ob,'\n');
       }
     }
   }
@@ -293,6 +309,9 @@ int degs2hms_batch(char *inname, char *outname)
    * Clean up and exit
    */
 
+  if(ob)
+    if(del_outbuf(ob))
+      no_error = 0;
   if(ifp)
     fclose(ifp);
   if(ofp)
@@ -185,7 +185,7 @@ int calc_interactive()
 {
   int no_error = 1;     /* Flag set to 0 on error */
   char line[MAXC];      /* General string for reading input */
-  Pos *offsets=NULL;    /* Output list of position offsets */
+  Lpos *offsets=NULL;   /* Output list of position offsets */
   Skypos cent;          /* First sky position entered */
   Skypos *skypos=NULL;  /* List of all other sky positions */
 
@@ -252,7 +252,7 @@ int calc_interactive()
    * Clean up and exit
    */
 
-  offsets = del_pos(offsets);
+  offsets = del_lpos(offsets);
   skypos = del_skypos(skypos);
 
   if(no_error)
@@ -283,7 +283,7 @@ int calc_cent(char *inname, char *outname)
   int nlines;           /* Number of lines in the input file */
   char newoutn[MAXC];   /* New output name on error */
   char line[MAXC];      /* General string for reading input */
-  Pos *offsets=NULL;    /* Output list of position offsets */
+  Lpos *offsets=NULL;   /* Output list of position offsets */
   Skypos cent;          /* First sky position entered */
   Skypos *skypos=NULL;  /* List of all other sky positions */
   Skypos *sptr;         /* Pointer used to navigate skypos */
@@ -413,7 +413,7 @@ int calc_cent(char *inname, char *outname)
     fclose(ifp);
   if(ofp)
     fclose(ofp);
-  offsets = del_pos(offsets);
+  offsets = del_lpos(offsets);
   skypos = del_skypos(skypos);
 
   if(no_error)
@@ -446,7 +446,7 @@ int calc_pair(char *inname, char *outname)
   int nlines;           /* Number of lines in the input file */
   char newoutn[MAXC];   /* New output name on error */
   char line[MAXC];      /* General string for reading input */
-  Pos *offsets=NULL;    /* Output list of position offsets */
+  Lpos *offsets=NULL;   /* Output list of position offsets */
   Skypos cent;          /* First sky position entered */
   Skypos *skypos=NULL;  /* List of all other sky positions */
   FILE *ifp=NULL;       /* Input file pointer */
@@ -557,7 +557,7 @@ int calc_pair(char *inname, char *outname)
     fclose(ifp);
   if(ofp)
     fclose(ofp);
-  offsets = del_pos(offsets);
+  offsets = del_lpos(offsets);
   skypos = del_skypos(skypos);
 
   if(no_error)
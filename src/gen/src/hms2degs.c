@@ -13,6 +13,10 @@
  * v04Feb2000, CDF Fixed a bug in the processing when no output file is
  *                  desired.
  * v17Nov2004, CDF Added label to output in batch mode
+ * v16Oct2026, AGT Positions are now read with parse_hms and printed with
+ *                  format_ra and format_dec, so there is no Skypos and 
+ *                  no sscanf per line.  Batch output goes through an 
+ *                  Outbuf.  Colons are now accepted as separators.
  *
  */
 
@@ -118,7 +122,8 @@ int hms2degs_interactive()
   double alphadeg;  /* RA in decimal format */
   double deltadeg;  /* Dec in decimal format */
   char line[MAXC];  /* General string for reading input */
-  Skypos skypos;    /* Sky position in hh mm ss.sss dd mm ss.sss format */
+  char ra[HMSLEN];  /* RA in hh:mm:ss.ssss format */
+  char dec[HMSLEN]; /* Dec in dd:mm:ss.sss format */
 
   /*
    * Loop until the user wants to quit
@@ -133,28 +138,19 @@ int hms2degs_interactive()
     printf("Enter the RA and Dec to be converted.\n");
     printf(" (format is hh mm ss.sss dd mm ss.ss):  ");
     fgets(line,MAXC,stdin);
-    while(sscanf(line,"%d %d %lf %d %d %lf",
-		 &skypos.hr,&skypos.min,&skypos.sec,
-		 &skypos.deg,&skypos.amin,&skypos.asec) != 6) {
+    while(parse_hms(line,&alphadeg,&deltadeg,NULL)) {
       fprintf(stderr,"ERROR: bad input\n");
       fprintf(stderr,"Enter coordinates again:  ");
       fgets(line,MAXC,stdin);
     }
 
-    /*
-     * Convert to decimal degrees
-     */
-
-    spos2deg(skypos,&alphadeg,&deltadeg);
-
     /*
      * Print out results
      */
 
-    printf("\n%02d:%02d:%07.4f %+03d:%02d:%06.3f ---> %9.5f %9.5f\n",
-	   skypos.hr,skypos.min,skypos.sec,
-	   skypos.deg,skypos.amin,skypos.asec,
-	   alphadeg,deltadeg);
+    format_ra(alphadeg,':',4,ra);
+    format_dec(deltadeg,':',3,dec);
+    printf("\n%s %s ---> %9.5f %9.5f\n",ra,dec,alphadeg,deltadeg);
 
     /*
      * Check if further runs are required
@@ -191,13 +187,16 @@ int hms2degs_batch(char *inname, char *outname)
 {
   int no_error = 1;    /* Flag set to 0 on error */
   int nlines,ncol;     /* Number of lines and columns in the input file  */
+  size_t len;          /* Length of the label */
   double alphadeg;     /* RA in decimal format */
   double deltadeg;     /* Dec in decimal format */
   char line[MAXC];     /* General string for reading input */
   char newname[MAXC];  /* New name for output file */
-  Skypos skypos;       /* First sky position entered */
+  char label[MAXC];    /* Label of the position */
+  char *lptr;          /* Start of the label in line */
   FILE *ifp=NULL;      /* Optional input file */
   FILE *ofp=NULL;      /* Optional output file */
+  Outbuf *ob=NULL;     /* Buffer for the output lines */
 
  
   /*
@@ -259,6 +258,14 @@ int hms2degs_batch(char *inname, char *outname)
     printf("---------- ----------- -----------\n");
   }
 
+  /*
+   * Set up the output buffer
+   */
+
+  if(no_error)
+    if(!(ob = new_outbuf(ofp ? ofp : stdout,OUTBUFSIZE)))
+      no_error = 0;
+
   /*
    * Now cycle through the input file, reading in a pair of coordinates
    *  for each line and calculating the offset between them.
@@ -266,10 +273,10 @@ int hms2degs_batch(char *inname, char *outname)
 
   while(fgets(line, MAXC, ifp) != NULL && no_error) {
     if(line[0] != '!' && line[0] != '#') {
-      ncol = sscanf(line,"%s %d %d %lf %d %d %lf",
-		    skypos.label,&skypos.hr,&skypos.min,&skypos.sec,
-		    &skypos.deg,&skypos.amin,&skypos.asec);
-      if(ncol != 7) {
+      lptr = line + strspn(line," \t");
+      len = strcspn(lptr," \t\r\n");
+      if(len == 0 || parse_hms(lptr+len,&alphadeg,&deltadeg,NULL)) {
+	ncol = n_cols(line,'#',0);
 	fprintf(stderr,"\n");
 	fprintf(stderr,"ERROR.  Bad input file format.\n");
 	fprintf(stderr,"This program requires the following format:\n");
@@ -283,19 +290,17 @@ int hms2degs_batch(char *inname, char *outname)
       if(no_error) {
 
 	/*
-	 * Convert to decimal degrees
+	 * Print out the position in decimal degrees
 	 */
 
-	spos2deg(skypos,&alphadeg,&deltadeg);
-
-	/*
-	 * Print out the offsets
-	 */
-
-	if(ofp)
-	  fprintf(ofp,"%-12s %11.7f %11.7f\n",skypos.label,alphadeg,deltadeg);
-	else
-	  printf("%-12s %11.7f %11.7f\n",skypos.label,alphadeg,deltadeg);
+	memcpy(label,lptr,len);
+	label[len] = '\0';
+	ob_puts(ob,label,12,OB_LEFT);
+	ob_putc(ob,' ');
+	ob_fixed(ob,alphadeg,11,7,0);
+	ob_putc(ob,' ');
+	ob_fixed(ob,deltadeg,11,7,0);
+	ob_putc(ob,'\n');
       }
     }
   }
@@ -304,6 +309,9 @@ int hms2degs_batch(char *inname, char *outname)
    * Clean up and exit
    */
 
+  if(ob)
+    if(del_outbuf(ob))
+      no_error = 0;
   if(ifp)
     fclose(ifp);
   if(ofp)
@@ -54,6 +54,11 @@
  * v20Jul03 CDF, Added printout of RA and Dec of catalog sources.
  * v29Jul03 CDF, Moved purge_cat, find_lens, and dposcmp functions into
  *                the new catlib.c/catlib.h library files.
+ * v2026Oct16 AGT, print_matchcat now writes the catalog rows through an
+ *                Outbuf.
+ *               run_match now finds the closest source with a Kdtree
+ *                built over each comparison catalog.
+ * v2026Oct16 AGT, The master catalog is now sorted with sort_secat_key.
  *
  */
 
@@ -72,12 +77,13 @@
  *
  */
 
-int run_match(Secat *masterval, Secat *compcat, int ncompcat, 
+int run_match(Secat *masterval, Secat *compcat, Kdtree *comptree, 
 	      Secat *matchptr, double match_thresh, int switchcolor);
 int print_matchcat(char *root, char *ext1, char *ext2, char *ext3, 
 		   Secat *mastercat, int nmaster, Secat *match12,
 		   int nmatch1, Secat *match23, int nmatch2, 
 		   int nmatchall);
+void print_matchmags(Outbuf *ob, Secat *sptr, int color);
 
 /*.......................................................................
  *
@@ -118,6 +124,8 @@ int main(int argc, char *argv[])
   Secat *mstrptr;           /* Pointer to navigate mastercat */
   Secat *mptr1;             /* Pointer to navigate match12 */
   Secat *mptr2;             /* Pointer to navigate match23 */
+  Kdtree *tree1=NULL;       /* Positional index of catalog 1 */
+  Kdtree *tree3=NULL;       /* Positional index of catalog 3 */
 
   /*
    * Check the command line invocation
@@ -236,8 +244,10 @@ int main(int argc, char *argv[])
   if(no_error) {
     printf("\nSorting the master catalog in order of increasing distance ");
     printf("from lens...");
-    qsort(mastercat,nmaster,sizeof(mastercat[0]),dposcmp);
-    printf(" Done.\n");
+    if(sort_secat_key(mastercat,nmaster,SORT_DPOS))
+      no_error = 0;
+    else
+      printf(" Done.\n");
   }
 
   /*
@@ -260,6 +270,11 @@ int main(int argc, char *argv[])
    * Fill match arrays by comparing catalogs
    */
 
+  if(no_error) {
+    if(!(tree1 = new_kdtree(cat1,ncat1)) || !(tree3 = new_kdtree(cat3,ncat3)))
+      no_error = 0;
+  }
+
   if(no_error) {
 
     /*
@@ -275,14 +290,14 @@ int main(int argc, char *argv[])
        * First compare to catalog 1
        */
 
-      if((mflag1 = run_match(mstrptr,cat1,ncat1,mptr1,match_thresh,1)) == 1)
+      if((mflag1 = run_match(mstrptr,cat1,tree1,mptr1,match_thresh,1)) == 1)
 	nmatch1++;
 
       /*
        * Now compare to catalog 3
        */
 
-      if((mflag2 = run_match(mstrptr,cat3,ncat3,mptr2,match_thresh,-1)) == 1)
+      if((mflag2 = run_match(mstrptr,cat3,tree3,mptr2,match_thresh,-1)) == 1)
 	nmatch2++;
 
       /*
@@ -315,6 +330,8 @@ int main(int argc, char *argv[])
   mastercat = del_secat(mastercat);
   match12 = del_secat(match12);
   match23 = del_secat(match23);
+  tree1 = del_kdtree(tree1);
+  tree3 = del_kdtree(tree3);
 
   if(no_error) {
     printf("\nProgram matchcat finished.\n\n");
@@ -338,7 +355,7 @@ int main(int argc, char *argv[])
  *
  * Inputs: Secat *masterval    value of entry in master catalog
  *         Secat *compcat      comparison catalog
- *         int ncompcat        number of entries in comparison catalog
+ *         Kdtree *comptree    positional index of compcat (see new_kdtree)
  *         Secat *matchptr     pointer to current position in match catalog
  *         double match_thresh threshold for a valid positional match
  *         int switchcolor     constant set to +1 if color is defined as
@@ -349,37 +366,21 @@ int main(int argc, char *argv[])
  *
  */
 
-int run_match(Secat *masterval, Secat *compcat, int ncompcat, 
+int run_match(Secat *masterval, Secat *compcat, Kdtree *comptree, 
 	      Secat *matchptr, double match_thresh, int switchcolor)
 {
-  int j;              /* Looping variable */
   int matchflag=0;    /* Flag set to 1 if a match is found */
-  double dx,dy;       /* Difference between x and y positions */
-  double sep;         /* Position separation */
+  int cindex;         /* Index of the closest match in compcat */
   double minsep;      /* Minimum separation between catalog positions */
-  Secat closest;      /* Closest match between catalog sources */
-  Secat *cptr;        /* Pointer to navigate compcat */
+  Secat *closest;     /* Closest match between catalog sources */
   
   /*
-   * Run through the comparison catalog looking for the closest 
-   *  positional match.  All info from this match is put into the
-   *  "closest" structure.
+   * Find the closest positional match within match_thresh in the 
+   *  comparison catalog.
    */
 
-  minsep = 50.0 * match_thresh;
-  closest = *masterval;
-  matchflag = 0;
-  for(j=0,cptr=compcat; j<ncompcat; j++,cptr++) {
-    if((dx = cptr->x - masterval->x) < match_thresh &&
-       (dy = cptr->y - masterval->y) < match_thresh) {
-      sep = sqrt(dx*dx + dy*dy);
-      if(sep < minsep) {
-	minsep = sep;
-	closest = *cptr;
-	closest.sep = sep;
-      }
-    }
-  }
+  cindex = kd_nearest(comptree,masterval->x,masterval->y,match_thresh,
+		      &minsep);
 
   /*
    * If we've got a match, put color and compcat magnitude into the
@@ -389,12 +390,13 @@ int run_match(Secat *masterval, Secat *compcat, int ncompcat,
    *  error code).
    */
 
-  if(minsep < match_thresh && closest.fitflag < COMPLIM &&
-     fabs(closest.miso - 99.0) > 1.0) {
+  closest = (cindex >= 0) ? compcat + cindex : NULL;
+  if(closest && closest->fitflag < COMPLIM &&
+     fabs(closest->miso - 99.0) > 1.0) {
     matchflag = 1;
     *matchptr = *masterval;
-    matchptr->matchflag = 1;
-    matchptr->sep = closest.sep;
+    matchptr->matchflag[0] = 1;
+    matchptr->sep[0] = minsep;
 
     /*
      * Put relevant info from the comparison catalog into the match 
@@ -403,15 +405,15 @@ int run_match(Secat *masterval, Secat *compcat, int ncompcat,
      *  goes into the miso and ma* containers.
      */
 
-    matchptr->mtot = closest.mtot;
-    matchptr->merr = closest.merr;
-    matchptr->misoerr = closest.misoerr;
-    matchptr->miso = switchcolor * (closest.miso - masterval->miso);
-    matchptr->ma1 = switchcolor * (closest.ma1 - masterval->ma1);
-    matchptr->ma2 = switchcolor * (closest.ma2 - masterval->ma2);
-    matchptr->ma3 = switchcolor * (closest.ma3 - masterval->ma3);
-    matchptr->fwhm = closest.fwhm;
-    matchptr->fitflag = closest.fitflag;
+    matchptr->mtot = closest->mtot;
+    matchptr->merr = closest->merr;
+    matchptr->misoerr = closest->misoerr;
+    matchptr->miso = switchcolor * (closest->miso - masterval->miso);
+    matchptr->ma1 = switchcolor * (closest->ma1 - masterval->ma1);
+    matchptr->ma2 = switchcolor * (closest->ma2 - masterval->ma2);
+    matchptr->ma3 = switchcolor * (closest->ma3 - masterval->ma3);
+    matchptr->fwhm = closest->fwhm;
+    matchptr->fitflag = closest->fitflag;
   }
 
   /*
@@ -419,7 +421,7 @@ int run_match(Secat *masterval, Secat *compcat, int ncompcat,
    */
 
   else {
-    matchptr->matchflag = 0;
+    matchptr->matchflag[0] = 0;
     matchptr->miso = -99.0;
     matchptr->ma1 = -99.0;
     matchptr->ma2 = -99.0;
@@ -467,6 +469,7 @@ int print_matchcat(char *root, char *ext1, char *ext2, char *ext3,
   Secat *mstrptr;           /* Pointer to navigate mastercat */
   Secat *mptr1;             /* Pointer to navigate match12 */
   Secat *mptr2;             /* Pointer to navigate match23 */
+  Outbuf *ob=NULL;          /* Output buffer */
   FILE *ofp=NULL;           /* Pointer to output file */
 
   /*
@@ -497,24 +500,29 @@ int print_matchcat(char *root, char *ext1, char *ext2, char *ext3,
     fprintf(ofp,"---- ------ ----- ------ ------ ------ ");
     fprintf(ofp,"---- ------ ----- -------- -------- ------ ");
     fprintf(ofp,"---- ------ ----- -------- -------- ------\n");
-    for(i=0,mstrptr=mastercat,mptr1=match12,mptr2=match23; i<nmaster; 
-	i++,mstrptr++,mptr1++,mptr2++) {
-      fprintf(ofp,
-	      "%04d %4.0f %8.2f %8.2f %5.2f ",
-	      i+1,mstrptr->dpos,mstrptr->x,mstrptr->y,mstrptr->class);
-      fprintf(ofp,"%3d  %6.2f %5.2f %6.2f %6.2f %6.2f ",
-	      mstrptr->fitflag,mstrptr->mtot,mstrptr->merr,mstrptr->miso,
-	      mstrptr->ma2,mstrptr->fwhm);
-      fprintf(ofp,"%3d  %6.2f %5.2f  %6.2f   %6.2f  %6.2f ",
-	      mptr1->fitflag,mptr1->mtot,mptr1->merr,mptr1->miso,
-	      mptr1->ma2,mptr1->fwhm);
-      fprintf(ofp,"%3d  %6.2f %5.2f  %6.2f   %6.2f  %6.2f  ",
-	      mptr2->fitflag,mptr2->mtot,mptr2->merr,mptr2->miso,
-	      mptr2->ma2,mptr2->fwhm);
-      fprintf(ofp,"%02d %02d %07.4f %+03d %02d %06.3f\n",
-	      mptr2->skypos.hr,mptr2->skypos.min,mptr2->skypos.sec,
-	      mptr2->skypos.deg,mptr2->skypos.amin,mptr2->skypos.asec);
+    if(!(ob = new_outbuf(ofp,OUTBUFSIZE)))
+      no_error = 0;
+    for(i=0,mstrptr=mastercat,mptr1=match12,mptr2=match23; 
+	i<nmaster && no_error; i++,mstrptr++,mptr1++,mptr2++) {
+      ob_int(ob,i+1,4,OB_ZERO);
+      ob_putc(ob,' ');
+      ob_fixed(ob,mstrptr->dpos,4,0,0);
+      ob_putc(ob,' ');
+      ob_fixed(ob,mstrptr->x,8,2,0);
+      ob_putc(ob,' ');
+      ob_fixed(ob,mstrptr->y,8,2,0);
+      ob_putc(ob,' ');
+      ob_fixed(ob,mstrptr->class,5,2,0);
+      ob_putc(ob,' ');
+      print_matchmags(ob,mstrptr,0);
+      print_matchmags(ob,mptr1,1);
+      print_matchmags(ob,mptr2,1);
+      ob_putc(ob,' ');
+      ob_skypos(ob,&mptr2->skypos,' ',4,3);
+      ob_putc(ob,'\n');
     }
+    if(ob && del_outbuf(ob))
+      no_error = 0;
   }
 
   /*
@@ -524,5 +532,42 @@ int print_matchcat(char *root, char *ext1, char *ext2, char *ext3,
   if(ofp)
     fclose(ofp);
 
-  return 0;
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: print_matchcat.\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function print_matchmags
+ *
+ * Prints the flags, magnitudes and FWHM of one band of a matched catalog
+ *  row, i.e., "%3d  %6.2f %5.2f %6.2f %6.2f %6.2f " for the reference band
+ *  and "%3d  %6.2f %5.2f  %6.2f   %6.2f  %6.2f " for the color bands.
+ *
+ * Inputs: Outbuf *ob          output buffer
+ *         Secat *sptr         catalog member
+ *         int color           1 ==> color band spacing
+ *
+ * Output: (none)
+ *
+ */
+
+void print_matchmags(Outbuf *ob, Secat *sptr, int color)
+{
+  ob_int(ob,sptr->fitflag,3,0);
+  ob_puts(ob,"  ",0,0);
+  ob_fixed(ob,sptr->mtot,6,2,0);
+  ob_putc(ob,' ');
+  ob_fixed(ob,sptr->merr,5,2,0);
+  ob_puts(ob,color ? "  " : " ",0,0);
+  ob_fixed(ob,sptr->miso,6,2,0);
+  ob_puts(ob,color ? "   " : " ",0,0);
+  ob_fixed(ob,sptr->ma2,6,2,0);
+  ob_puts(ob,color ? "  " : " ",0,0);
+  ob_fixed(ob,sptr->fwhm,6,2,0);
+  ob_putc(ob,' ');
 }
@@ -159,6 +159,9 @@
  *                 Created a new read_fluxrec_2curves to handle a single input
  *                  file that contains two light curves.
  * v03Jan2014 CDF, Moved set_tau_grid and set_mu_grid to lc_setup.c
+ * v2026Oct16 AGT, write_fluxrec now writes through an Outbuf.
+ *                 new_fluxrec takes its memory from the current Arena, if
+ *                  there is one.
  */
 
 #include <stdio.h>
@@ -245,7 +248,7 @@ Fluxrec *new_fluxrec(int size)
   Fluxrec *newinfo;
   Fluxrec *fptr;
  
-  newinfo = (Fluxrec *) malloc(sizeof(Fluxrec) * size);
+  newinfo = (Fluxrec *) arena_malloc(sizeof(Fluxrec) * size);
   if(!newinfo) {
     fprintf(stderr,"Insufficient memory for data array.\n");
     return NULL;
@@ -276,8 +279,7 @@ Fluxrec *new_fluxrec(int size)
 
 Fluxrec *del_fluxrec(Fluxrec *fluxrec)
 {
-  if(fluxrec)
-    free(fluxrec);
+  arena_free(fluxrec);
  
   return NULL;
 }
@@ -607,6 +609,31 @@ int read_fluxrec_2curves(Fluxrec **lc, char *inname, char comment,
   }
 }
 
+/*.......................................................................
+ *
+ * Function print_fluxrec_line
+ *
+ * Formats one fluxrec point as "%7.2f %10.4f %8.5f %d\n".
+ *
+ * Inputs: Outbuf *ob          output buffer
+ *         Fluxrec *fptr       point to print
+ *
+ * Output: (none)
+ *
+ */
+
+static void print_fluxrec_line(Outbuf *ob, Fluxrec *fptr)
+{
+  ob_fixed(ob,fptr->day,7,2,0);
+  ob_putc(ob,' ');
+  ob_fixed(ob,fptr->flux,10,4,0);
+  ob_putc(ob,' ');
+  ob_fixed(ob,fptr->err,8,5,0);
+  ob_putc(ob,' ');
+  ob_int(ob,fptr->match,0,0);
+  ob_putc(ob,'\n');
+}
+
 /*.......................................................................
  *
  * Function write_fluxrec
@@ -632,6 +659,7 @@ int write_fluxrec(Fluxrec *fluxrec, int npoints, char *outfile,
   int ndelete=0;   /* Number of duplicate days deleted */
   Fluxrec *fptr;   /* Pointer to navigate fluxrec */
   Fluxrec *fhold;  /* Another pointer to navigate fluxrec */
+  Outbuf *ob=NULL; /* Output buffer */
   FILE *ofp=NULL;  /* Output file pointer */
 
   /*
@@ -643,6 +671,11 @@ int write_fluxrec(Fluxrec *fluxrec, int npoints, char *outfile,
     fprintf(stderr,"ERROR: write_fluxrec.\n");
     return 1;
   }
+  if(!(ob = new_outbuf(ofp,OUTBUFSIZE))) {
+    fprintf(stderr,"ERROR: write_fluxrec.\n");
+    fclose(ofp);
+    return 1;
+  }
 
   /*
    * Initialize
@@ -668,8 +701,7 @@ int write_fluxrec(Fluxrec *fluxrec, int npoints, char *outfile,
 	ndelete++;
       }
       else {
-	fprintf(ofp,"%7.2f %10.4f %8.5f %d\n",fptr->day,fptr->flux,fptr->err,
-		fptr->match);
+	print_fluxrec_line(ob,fptr);
 	fhold = fptr;
       }
     }
@@ -683,14 +715,18 @@ int write_fluxrec(Fluxrec *fluxrec, int npoints, char *outfile,
 
   else {
     for(i=0,fptr=fluxrec; i<npoints; i++,fptr++)
-      fprintf(ofp,"%7.2f %10.4f %8.5f %d\n",fptr->day,fptr->flux,fptr->err,
-	      fptr->match);
+      print_fluxrec_line(ob,fptr);
   }
 
   /*
    * Clean up and exit
    */
 
+  if(del_outbuf(ob)) {
+    fprintf(stderr,"ERROR: write_fluxrec.\n");
+    fclose(ofp);
+    return 1;
+  }
   if(ofp)
     fclose(ofp);
 
@@ -611,6 +611,8 @@ int disp_setup(Fluxrec *flux[], int ncurves, int *npoints,
  *                disp_d2 into this function.
  * v31Aug02 CDF, Changed npoints to an array.  Got rid of nbad array
  *                a passed parameter (no longer needed for make_compos).
+ * v16Oct26 AGT, The composite curve for each grid point now comes from
+ *                an Arena that is reset after every point.
  */
 
 int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
@@ -629,6 +631,8 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
   LCdisp *d2min=NULL;       /* Absolute min value of D^2 */
   LCdisp *d2arr=NULL;       /* Array containing dispersion values */
   LCdisp *dptr;             /* Pointer to navigate d2arr */
+  Arena *arena=NULL;        /* Scratch memory for the composite curves */
+  Arenamark mark;           /* Start of the scratch memory for one point */
   FILE *ofp=NULL;           /* Output file pointer */
 
   /*
@@ -675,6 +679,13 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
   if(!(d2arr = new_lcdisp(2 * tau0->nval + 1)))
     no_error = 0;
 
+  /*
+   * The composite curve made at each grid point is scratch memory
+   */
+
+  if(!(arena = new_arena(0)))
+    no_error = 0;
+
   /*
    * Outer loop on flux density ratio
    */
@@ -703,6 +714,7 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
 	 *  the dispersion.
 	 */
 
+	mark = arena_begin(arena);
 	switch(setup->dispchoice) {
 	case D21:
 	  if(!(compos = make_compos(flux,ncurves,npoints,index,tau,mu,
@@ -731,6 +743,7 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
 	  dptr->disp = disp_d1(compos,ncompos,setup->d2delta);
 	  compos = del_fluxrec(compos);
 	}
+	arena_end(arena,mark);
 
 	/*
 	 * Print output if desired
@@ -794,6 +807,7 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
        *  the dispersion.
        */
 
+      mark = arena_begin(arena);
       switch(setup->dispchoice) {
       case D21:
 	if(!(compos = make_compos(flux,ncurves,npoints,index,tau,mu,
@@ -822,6 +836,7 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
   	dptr->disp = disp_d1(compos,ncompos,setup->d2delta);
 	compos = del_fluxrec(compos);
       }
+      arena_end(arena,mark);
     }
 
     /*
@@ -848,6 +863,7 @@ int two_curve_disp_new(Fluxrec *flux[], int *npoints, int *index,
 
   d2min = del_lcdisp(d2min);
   d2arr = del_lcdisp(d2arr);
+  arena = del_arena(arena);
   if(ofp)
     fclose(ofp);
 
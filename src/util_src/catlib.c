@@ -4,16 +4,56 @@
  * This is a library of functions to process catalog (Secat) structures.
  *  purge_cat       - deletes members of a catalog with flag values
  *                     greater than a given limit
+ *  purge_colcat    - the same as purge_cat, but for a Colcat catalog
+ *  secat2colcat    - converts a Secat array into a Colcat
+ *  colcat2secat    - converts a Colcat into a Secat array
  *  find_closest    - finds the closest catalog member to the given (x,y)
                        position
+ *  find_closest_kd - the same as find_closest, using a Kdtree
+ *  new_kdtree      - builds a k-d tree over the (x,y) positions of a catalog
+ *  del_kdtree      - frees a k-d tree
+ *  kd_nearest      - finds the nearest catalog member with a k-d tree
+ *  kd_radius       - finds the catalog members within a radius with a 
+ *                     k-d tree
+ *  new_skytree     - builds a k-d tree over the sky positions of a catalog
+ *  sky_cone        - finds the catalog members within a radius of a sky
+ *                     position with a sky tree
+ *  new_skyzones    - sorts the sky positions of a catalog into declination
+ *                     zones
+ *  del_skyzones    - frees a set of declination zones
+ *  zone_cone       - the same as sky_cone, using declination zones
+ *  bright_index    - orders the members of a catalog by magnitude
+ *  match_asterisms - finds the scale, rotation and shift between two
+ *                     position lists by matching triangles
+ *  apply_simtrans  - applies a transform from match_asterisms
+ *  secat_sortkeys  - copies the dpos, mtot or alpha members of a catalog
+ *                     into an array of sort keys
+ *  sdss_sortkeys   - the same as secat_sortkeys, for a SDSScat array
+ *  radix_bits      - maps a double onto an integer with the same ordering
+ *  radix_index     - finds the order of an array of sort keys with a 
+ *                     radix sort
+ *  permute_secat   - puts the rows of a catalog into a given order
+ *  permute_sdss    - the same as permute_secat, for a SDSScat array
+ *  sort_secat_key  - sorts a catalog by dpos, mtot or alpha
+ *  sort_sdss_key   - the same as sort_secat_key, for a SDSScat array
+ *  nearest_index   - finds the order of the smallest of an array of sort
+ *                     keys, e.g., the members closest to a position
+ *  select_kth      - finds the k'th smallest of an array in O(n) time
+ *  median_select   - finds the median of an array in O(n) time
+ *  weighted_median - finds the weighted median of an array in O(n) time
+ *  init_medstream  - starts a running approximate median
+ *  add_medstream   - adds a value to a running approximate median
+ *  medstream_value - returns the value of a running approximate median
  *  find_lens       - finds the closest source in the catalog to a given 
  *                     position
  *  dposcmp         - compares the dpos members of two Secat structures --
  *                     used in sorting catalogs.
+ *  intcmp          - compares two ints -- used in sorting index lists
  */
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "structdef.h"
 #include "dataio.h"
@@ -85,6 +125,121 @@ Secat *purge_cat(Secat *in_cat, int nincat, char *catname, int *npurged,
   return out_cat;
 }
 
+/*.......................................................................
+ *
+ * Function purge_colcat
+ *
+ * The Colcat version of purge_cat.  Creates a new catalog containing only
+ *  the members of the input catalog with SExtractor flags less than
+ *  purgeflag.
+ *
+ * Inputs: Colcat *in_cat      input catalog
+ *         char *catname       input catalog name
+ *         int purgeflag       flag cutoff value.
+ *
+ * Output: Colcat *out_cat     purged output catalog (out_cat->ncat set)
+ *
+ */
+
+Colcat *purge_colcat(Colcat *in_cat, char *catname, int purgeflag)
+{
+  int i;                 /* Looping variable */
+  int *fptr;             /* Pointer to navigate the fitflag column */
+  Colcat *out_cat=NULL;  /* Purged output catalog */
+
+  printf("\npurge_colcat: Purging %s catalog based on flag value....\n",
+	 catname);
+  printf("purge_colcat: Rejecting sources with flags >= %d\n",purgeflag);
+
+  if(!(out_cat = new_colcat(in_cat->ncat,in_cat->naper))) {
+    fprintf(stderr,"\n\nERROR: purge_colcat\n");
+    return NULL;
+  }
+
+  for(i=0,fptr=in_cat->fitflag; i<in_cat->ncat; i++,fptr++) {
+    if(*fptr < purgeflag) {
+      if(colcat_copyrow(in_cat,i,out_cat,out_cat->ncat)) {
+	fprintf(stderr,"\n\nERROR: purge_colcat\n");
+	return del_colcat(out_cat);
+      }
+      out_cat->ncat++;
+    }
+  }
+
+  printf("   ....Done\n");
+  printf("purge_colcat: New catalog contains %d out of %d original members.\n",
+	 out_cat->ncat,in_cat->ncat);
+  return out_cat;
+}
+
+/*.......................................................................
+ *
+ * Function secat2colcat
+ *
+ * Converts a Secat array into a Colcat structure.
+ *
+ * Inputs: Secat *secat        input catalog
+ *         int ncat            number of members in secat
+ *         int naper           number of apertures to keep (0 ==> none)
+ *
+ * Output: Colcat *colcat      new catalog.  NULL on error
+ *
+ */
+
+Colcat *secat2colcat(Secat *secat, int ncat, int naper)
+{
+  int i;                 /* Looping variable */
+  Secat *sptr;           /* Pointer to navigate secat */
+  Colcat *colcat=NULL;   /* Output catalog */
+
+  if(!(colcat = new_colcat(ncat,naper))) {
+    fprintf(stderr,"ERROR: secat2colcat\n");
+    return NULL;
+  }
+
+  for(i=0,sptr=secat; i<ncat; i++,sptr++) {
+    if(colcat_setrow(colcat,i,sptr)) {
+      fprintf(stderr,"ERROR: secat2colcat\n");
+      return del_colcat(colcat);
+    }
+  }
+  colcat->ncat = ncat;
+
+  return colcat;
+}
+
+/*.......................................................................
+ *
+ * Function colcat2secat
+ *
+ * Converts a Colcat structure into a Secat array, for use by code that
+ *  has not yet been converted to the column-ordered catalogs.
+ *
+ * Inputs: Colcat *colcat      input catalog
+ *         int *ncat           number of members in output (set here)
+ *
+ * Output: Secat *secat        new catalog.  NULL on error
+ *
+ */
+
+Secat *colcat2secat(Colcat *colcat, int *ncat)
+{
+  int i;                 /* Looping variable */
+  Secat *secat=NULL;     /* Output catalog */
+  Secat *sptr;           /* Pointer to navigate secat */
+
+  *ncat = colcat->ncat;
+  if(!(secat = new_secat(colcat->ncat))) {
+    fprintf(stderr,"ERROR: colcat2secat\n");
+    return NULL;
+  }
+
+  for(i=0,sptr=secat; i<colcat->ncat; i++,sptr++)
+    colcat_getrow(colcat,i,sptr);
+
+  return secat;
+}
+
 /*.......................................................................
  *
  * Function find_lens
@@ -190,6 +345,8 @@ int find_lens(Secat *cat, int ncat, int *lensindex)
  * Finds the object giving the closest match between the input (x,y) postion
  *  and  the members of a SExtractor catalog.
  *  The closest matching positions are returned in a Secat structure.
+ * For many positions matched against the same catalog, build a Kdtree
+ *  once and use find_closest_kd instead.
  *
  * Inputs: Pos cpos            input position
  *         Secat *secat        catalog based on fits image (x,y) positions
@@ -198,11 +355,14 @@ int find_lens(Secat *cat, int ncat, int *lensindex)
  *
  * Output: Secat bestmatch     best match
  *
+ * v16Oct26 AGT, Keep track of the index of the best match instead of
+ *                copying each better candidate into bestmatch.
  */
 
 Secat find_closest(Pos cpos, Secat *secat, int ncat, int verbose)
 {
-  int i,j;                /* Looping variables */
+  int i;                  /* Looping variable */
+  int best=0;             /* Index of the best match */
   double dx,dy,dpos;      /* Offsets between (x,y) pairs */
   double mindpos;         /* Running minimum position offset */
   Secat bestmatch;        /* Container for best-matching xy object */
@@ -212,18 +372,19 @@ Secat find_closest(Pos cpos, Secat *secat, int ncat, int verbose)
    * Loop through catalog
    */
 
-  bestmatch = *secat;
   dx = cpos.x - secat->x;
   dy = cpos.y - secat->y;
-  bestmatch.dpos = sqrt(dx*dx + dy*dy);
+  mindpos = sqrt(dx*dx + dy*dy);
   for(i=0,sptr=secat; i < ncat; i++,sptr++) {
     dx = cpos.x - sptr->x;
     dy = cpos.y - sptr->y;
-    if((dpos = sqrt(dx*dx + dy*dy)) < bestmatch.dpos) {
-      bestmatch = *sptr;
-      bestmatch.dpos = dpos;
+    if((dpos = sqrt(dx*dx + dy*dy)) < mindpos) {
+      mindpos = dpos;
+      best = i;
     }
   }
+  bestmatch = secat[best];
+  bestmatch.dpos = mindpos;
 
   if(verbose) {
     printf("For this position, the best match is ID=%d at",
@@ -240,100 +401,2466 @@ Secat find_closest(Pos cpos, Secat *secat, int ncat, int verbose)
 
 /*.......................................................................
  *
- * Function dposcmp
+ * Function find_closest_kd
  *
- * Compares the dpos field for two Secat structures and returns 1
- *  if the first is greater than the second, 0 if they're equal, and
- *  -1 if the first is less than the second.  This function is called
- *  by qsort.
+ * The same as find_closest, but the search uses a Kdtree built over the
+ *  catalog with new_kdtree.
  *
- * Inputs: void *v1            first structure (cast to void)
- *         void *v2            second structure (cast to void)
+ * Inputs: Pos cpos            input position
+ *         Secat *secat        catalog based on fits image (x,y) positions
+ *         Kdtree *tree        tree built over secat
+ *         int verbose         flag set to 1 for verbose output
  *
- * Output: int (-1,0,1)        as described above
+ * Output: Secat bestmatch     best match
  *
  */
 
-int dposcmp(const void *v1, const void *v2)
+Secat find_closest_kd(Pos cpos, Secat *secat, Kdtree *tree, int verbose)
 {
-  Secat *s1 = (Secat *) v1;  /* Secat casting of v1 */
-  Secat *s2 = (Secat *) v2;  /* Secat casting of v2 */
+  int best;               /* Index of the best match */
+  double mindpos;         /* Offset of the best match */
+  Secat bestmatch;        /* Container for best-matching xy object */
 
-  /*
-   * Do the comparison
-   */
+  if((best = kd_nearest(tree,cpos.x,cpos.y,HUGE_VAL,&mindpos)) < 0) {
+    best = 0;
+    mindpos = HUGE_VAL;
+  }
+  bestmatch = secat[best];
+  bestmatch.dpos = mindpos;
 
-  if(s1->dpos > s2->dpos)
-    return 1;
-  else if(s1->dpos == s2->dpos)
-    return 0;
-  else
-    return -1;
+  if(verbose) {
+    printf("For this position, the best match is ID=%d at",
+	   bestmatch.id);
+    printf(" mindpos = %6.3f pix\n",bestmatch.dpos);
+  }
+
+  return bestmatch;
 }
 
 /*.......................................................................
  *
- * Function dposcmp_sdss
+ * Function kd_swap
  *
- * Compares the dpos field for two SDSScat structures and returns 1
- *  if the first is greater than the second, 0 if they're equal, and
- *  -1 if the first is less than the second.  This function is called
- *  by qsort.
+ * Swaps two points of a Kdtree.  Called by kd_build.
  *
- * Inputs: void *v1            first structure (cast to void)
- *         void *v2            second structure (cast to void)
+ */
+
+static void kd_swap(Kdtree *tree, int i, int j)
+{
+  int k;                  /* Looping variable */
+  int itmp;               /* Temporary index */
+  double dtmp;            /* Temporary coordinate */
+
+  itmp = tree->index[i];
+  tree->index[i] = tree->index[j];
+  tree->index[j] = itmp;
+  for(k=0; k<tree->ndim; k++) {
+    dtmp = tree->pos[k][i];
+    tree->pos[k][i] = tree->pos[k][j];
+    tree->pos[k][j] = dtmp;
+  }
+}
+
+/*.......................................................................
  *
- * Output: int (-1,0,1)        as described above
+ * Function kd_build
+ *
+ * Recursively arranges the points lo to hi-1 of a Kdtree into the node
+ *  layout described in new_kdtree.  The median along the splitting axis
+ *  is put at mid by quickselect.
+ *
+ * Inputs: Kdtree *tree        tree
+ *         int lo              first point of the range
+ *         int hi              one past the last point of the range
+ *
+ * Output: (none)
  *
  */
 
-int dposcmp_sdss(const void *v1, const void *v2)
+static void kd_build(Kdtree *tree, int lo, int hi)
 {
-  SDSScat *s1 = (SDSScat *) v1;  /* SDSScat casting of v1 */
-  SDSScat *s2 = (SDSScat *) v2;  /* SDSScat casting of v2 */
+  int i,j,k;              /* Looping variables */
+  int l,r;                /* Range still to be partitioned */
+  int mid;                /* Position of the node */
+  double cmin,cmax;       /* Spread along an axis */
+  double spread;          /* Largest spread so far */
+  double pivot;           /* Partitioning value */
+  double *coord;          /* Coordinates along the splitting axis */
 
-  /*
-   * Do the comparison
-   */
+  while(hi - lo > KDLEAF) {
 
-  if(s1->dpos > s2->dpos)
-    return 1;
-  else if(s1->dpos == s2->dpos)
-    return 0;
-  else
-    return -1;
+    /*
+     * Split along the axis with the largest spread
+     */
+
+    mid = (lo + hi) / 2;
+    tree->axis[mid] = 0;
+    spread = -1.0;
+    for(k=0; k<tree->ndim; k++) {
+      coord = tree->pos[k];
+      cmin = cmax = coord[lo];
+      for(i=lo+1; i<hi; i++) {
+	if(coord[i] < cmin)
+	  cmin = coord[i];
+	else if(coord[i] > cmax)
+	  cmax = coord[i];
+      }
+      if(cmax - cmin > spread) {
+	spread = cmax - cmin;
+	tree->axis[mid] = k;
+      }
+    }
+    coord = tree->pos[(int) tree->axis[mid]];
+
+    /*
+     * Quickselect the median into mid
+     */
+
+    l = lo;
+    r = hi - 1;
+    while(l < r) {
+      pivot = coord[(l + r) / 2];
+      i = l;
+      j = r;
+      while(i <= j) {
+	while(coord[i] < pivot)
+	  i++;
+	while(coord[j] > pivot)
+	  j--;
+	if(i <= j)
+	  kd_swap(tree,i++,j--);
+      }
+      if(mid <= j)
+	r = j;
+      else if(mid >= i)
+	l = i;
+      else
+	break;
+    }
+
+    /*
+     * Build the low side, then carry on with the high side
+     */
+
+    kd_build(tree,lo,mid);
+    lo = mid + 1;
+  }
 }
 
 /*.......................................................................
  *
- * Function dcmp
+ * Function alloc_kdtree
  *
- * Compares two doubles and returns 1
- *  if the first is greater than the second, 0 if they're equal, and
- *  -1 if the first is less than the second.  This function is called
- *  by qsort.
+ * Allocates an empty Kdtree of npts points in ndim dimensions.  Called
+ *  by new_kdtree and new_skytree.
  *
- * Inputs: void *v1            first structure (cast to void)
- *         void *v2            second structure (cast to void)
+ */
+
+static Kdtree *alloc_kdtree(int npts, int ndim)
+{
+  int k;                  /* Looping variable */
+  int nalloc;             /* Number of points to allocate */
+  Kdtree *tree;           /* New tree */
+
+  if(!(tree = (Kdtree *) malloc(sizeof(Kdtree)))) {
+    fprintf(stderr,"ERROR: new_kdtree.  Insufficient memory.\n");
+    return NULL;
+  }
+  nalloc = (npts > 0) ? npts : 1;
+  tree->npts = npts;
+  tree->ndim = ndim;
+  tree->index = (int *) malloc(nalloc * sizeof(int));
+  tree->axis = (char *) malloc(nalloc);
+  for(k=0; k<3; k++)
+    tree->pos[k] = (k < ndim) ? (double *) malloc(nalloc * sizeof(double)) :
+      NULL;
+  if(!tree->index || !tree->axis || !tree->pos[0] || !tree->pos[1] ||
+     (ndim > 2 && !tree->pos[2])) {
+    fprintf(stderr,"ERROR: new_kdtree.  Insufficient memory.\n");
+    return del_kdtree(tree);
+  }
+  return tree;
+}
+
+/*.......................................................................
  *
- * Output: int (-1,0,1)        as described above
+ * Function new_kdtree
+ *
+ * Builds a 2-dimensional k-d tree over the (x,y) positions of the members
+ *  of a catalog.  The tree is implicit: the points are reordered so that
+ *  the node covering points lo to hi-1 is the point at mid = (lo+hi)/2,
+ *  with the points on the low side of its splitting axis before it and
+ *  the others after it.  Ranges of KDLEAF points or fewer are not split
+ *  further.  Each node is split along the axis with the larger spread.
+ *  The tree holds copies of the positions, so the catalog may be 
+ *  reordered or freed without affecting it, and returns catalog indices.
+ *
+ * Inputs: Secat *secat        catalog
+ *         int ncat            number of members in secat
+ *
+ * Output: Kdtree *tree        new tree, NULL on error
  *
  */
 
-int dcmp(const void *v1, const void *v2)
+Kdtree *new_kdtree(Secat *secat, int ncat)
 {
-  double *s1 = (double *) v1;  /* double casting of v1 */
-  double *s2 = (double *) v2;  /* double casting of v2 */
+  int i;                  /* Looping variable */
+  Kdtree *tree;           /* New tree */
 
-  /*
-   * Do the comparison
-   */
+  if(!(tree = alloc_kdtree(ncat,2)))
+    return NULL;
 
-  if(*s1 > *s2)
-    return 1;
-  else if(*s1 == *s2)
-    return 0;
-  else
-    return -1;
+  for(i=0; i<ncat; i++) {
+    tree->index[i] = i;
+    tree->pos[0][i] = secat[i].x;
+    tree->pos[1][i] = secat[i].y;
+  }
+  kd_build(tree,0,ncat);
+
+  return tree;
+}
+
+/*.......................................................................
+ *
+ * Function new_skytree
+ *
+ * Builds a 3-dimensional k-d tree over the unit vectors (see secat2vec)
+ *  of the sky positions of the members of a catalog.  Distances between
+ *  unit vectors do not depend on where the positions are on the sky, so
+ *  the tree has no trouble with the 24h/0h boundary or the poles.  The
+ *  tree is searched with sky_cone.
+ *
+ * Inputs: double *vec         unit vectors of the members, from secat2vec
+ *         int ncat            number of members
+ *
+ * Output: Kdtree *tree        new tree, NULL on error
+ *
+ */
+
+Kdtree *new_skytree(double *vec, int ncat)
+{
+  int i;                  /* Looping variable */
+  Kdtree *tree;           /* New tree */
+
+  if(!(tree = alloc_kdtree(ncat,3)))
+    return NULL;
+
+  for(i=0; i<ncat; i++) {
+    tree->index[i] = i;
+    tree->pos[0][i] = vec[3*i];
+    tree->pos[1][i] = vec[3*i+1];
+    tree->pos[2][i] = vec[3*i+2];
+  }
+  kd_build(tree,0,ncat);
+
+  return tree;
+}
+
+/*.......................................................................
+ *
+ * Function del_kdtree
+ *
+ * Frees a Kdtree.
+ *
+ * Inputs: Kdtree *tree        tree to be freed
+ *
+ * Output: NULL
+ *
+ */
+
+Kdtree *del_kdtree(Kdtree *tree)
+{
+  int k;                  /* Looping variable */
+
+  if(tree) {
+    free(tree->index);
+    free(tree->axis);
+    for(k=0; k<3; k++)
+      free(tree->pos[k]);
+    free(tree);
+  }
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function kd_dist
+ *
+ * Returns the distance between point i of a Kdtree and a position.
+ *
+ */
+
+static double kd_dist(Kdtree *tree, int i, double *pos)
+{
+  int k;                  /* Looping variable */
+  double d;               /* Offset along one axis */
+  double sum=0.0;         /* Sum of squared offsets */
+
+  for(k=0; k<tree->ndim; k++) {
+    d = tree->pos[k][i] - pos[k];
+    sum += d*d;
+  }
+  return sqrt(sum);
+}
+
+/*.......................................................................
+ *
+ * Function kd_near_range
+ *
+ * Recursive part of kd_nearest.  Searches the points lo to hi-1 for one
+ *  closer than *minsep, updating *best and *minsep.  Ties go to the
+ *  lower catalog index, so that the result is the same as that of a
+ *  linear search through the catalog with a "<" test.
+ *
+ */
+
+static void kd_near_range(Kdtree *tree, int lo, int hi, double *pos,
+			  int *best, double *minsep)
+{
+  int i;                  /* Looping variable */
+  int mid;                /* Position of the node */
+  double sep;             /* Distance from the position */
+  double d;               /* Offset from the splitting plane */
+
+  while(hi - lo > KDLEAF) {
+    mid = (lo + hi) / 2;
+    sep = kd_dist(tree,mid,pos);
+    if(sep < *minsep || (sep == *minsep && tree->index[mid] < *best)) {
+      *minsep = sep;
+      *best = tree->index[mid];
+    }
+    d = tree->pos[(int) tree->axis[mid]][mid] - pos[(int) tree->axis[mid]];
+    if(d > 0.0) {
+      kd_near_range(tree,lo,mid,pos,best,minsep);
+      if(d > *minsep)
+	return;
+      lo = mid + 1;
+    }
+    else {
+      kd_near_range(tree,mid+1,hi,pos,best,minsep);
+      if(-d > *minsep)
+	return;
+      hi = mid;
+    }
+  }
+
+  for(i=lo; i<hi; i++) {
+    sep = kd_dist(tree,i,pos);
+    if(sep < *minsep || (sep == *minsep && tree->index[i] < *best)) {
+      *minsep = sep;
+      *best = tree->index[i];
+    }
+  }
+}
+
+/*.......................................................................
+ *
+ * Function kd_nearest
+ *
+ * Finds the catalog member closest to an (x,y) position, provided that
+ *  it is closer than maxsep (use HUGE_VAL for no limit).  If several
+ *  members are equally close, the one with the lowest index is returned.
+ *
+ * Inputs: Kdtree *tree        tree built by new_kdtree
+ *         double x            x position
+ *         double y            y position
+ *         double maxsep       separation limit
+ *         double *sep         separation of the closest member (set by
+ *                              this function)
+ *
+ * Output: int best            catalog index of the closest member, or
+ *                              -1 if there is none closer than maxsep
+ *
+ */
+
+int kd_nearest(Kdtree *tree, double x, double y, double maxsep, double *sep)
+{
+  int best=-1;            /* Index of the closest member */
+  double pos[2];          /* Position */
+
+  pos[0] = x;
+  pos[1] = y;
+  *sep = maxsep;
+  kd_near_range(tree,0,tree->npts,pos,&best,sep);
+  return best;
 }
 
+/*.......................................................................
+ *
+ * Function kd_radius_range
+ *
+ * Recursive part of kd_radius and sky_cone.  Adds the points lo to hi-1
+ *  that are closer than radius to the list.
+ *
+ */
+
+static int kd_radius_range(Kdtree *tree, int lo, int hi, double *pos,
+			   double radius, int **list, int *nalloc, int *nfound)
+{
+  int i;                  /* Looping variable */
+  int mid;                /* Position of the node */
+  double d;               /* Offset from the splitting plane */
+
+  while(lo < hi) {
+
+    /*
+     * Check the node itself, or all of the points of a leaf
+     */
+
+    mid = (hi - lo > KDLEAF) ? (lo + hi) / 2 : -1;
+    for(i=(mid < 0 ? lo : mid); i<(mid < 0 ? hi : mid+1); i++) {
+      if(kd_dist(tree,i,pos) < radius) {
+	if(!(*list = (int *) grow_array(*list,nalloc,*nfound+1,sizeof(int))))
+	  return 1;
+	(*list)[(*nfound)++] = tree->index[i];
+      }
+    }
+    if(mid < 0)
+      return 0;
+
+    /*
+     * Descend into the sides that reach within radius of the position
+     */
+
+    d = tree->pos[(int) tree->axis[mid]][mid] - pos[(int) tree->axis[mid]];
+    if(d > -radius)
+      if(kd_radius_range(tree,lo,mid,pos,radius,list,nalloc,nfound))
+	return 1;
+    if(d >= radius)
+      return 0;
+    lo = mid + 1;
+  }
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function kd_radius
+ *
+ * Finds all the catalog members closer than radius to an (x,y) position.
+ *  Their catalog indices are put, in increasing order, into *list, which
+ *  is grown as needed with grow_array and can be reused between calls.
+ *
+ * Inputs: Kdtree *tree        tree built by new_kdtree
+ *         double x            x position
+ *         double y            y position
+ *         double radius       search radius
+ *         int **list          list of indices (grown by this function)
+ *         int *nalloc         number of elements allocated in *list
+ *
+ * Output: int nfound          number of members found, -1 on error
+ *
+ */
+
+int kd_radius(Kdtree *tree, double x, double y, double radius, int **list,
+	      int *nalloc)
+{
+  int nfound=0;           /* Number of members found */
+  double pos[2];          /* Position */
+
+  pos[0] = x;
+  pos[1] = y;
+  if(kd_radius_range(tree,0,tree->npts,pos,radius,list,nalloc,&nfound)) {
+    fprintf(stderr,"ERROR: kd_radius\n");
+    return -1;
+  }
+  if(nfound > 1)
+    qsort(*list,nfound,sizeof(int),intcmp);
+  return nfound;
+}
+
+/*.......................................................................
+ *
+ * Function sky_cone_chord
+ *
+ * Returns the chord length between unit vectors that sky_cone and 
+ *  zone_cone search within, for a search radius in arcsec.  The cone is
+ *  opened to asin(radius), plus a little to allow for rounding, since the
+ *  SIN-projection length of an offset from dspos2xy is sin(theta) for an
+ *  angular separation theta.  The opening angle is returned in *theta.
+ *
+ */
+
+static double sky_cone_chord(double radius, double *theta)
+{
+  *theta = radius * PI / (180.0 * 3600.0);
+  *theta = (*theta < 1.0) ? asin(*theta) : PI / 2.0;
+  *theta = *theta * (1.0 + 1.0e-9) + 1.0e-12;
+  return 2.0 * sin(*theta / 2.0);
+}
+
+/*.......................................................................
+ *
+ * Function sky_cone
+ *
+ * Finds the catalog members that may lie within radius arcsec of a sky
+ *  position, using a tree built by new_skytree.  The search is meant to
+ *  select the candidates for a match that is then tested with the 
+ *  offsets from dspos2xy (see sky_cone_chord).  Every member in the same 
+ *  hemisphere as the position with a dspos2xy offset less than radius 
+ *  is returned, along with a few that are slightly further away.  The 
+ *  catalog indices are put into *list in increasing order, as for 
+ *  kd_radius.
+ *
+ * Inputs: Kdtree *tree        tree built by new_skytree
+ *         double *vec         unit vector of the sky position
+ *         double radius       search radius in arcsec
+ *         int **list          list of indices (grown by this function)
+ *         int *nalloc         number of elements allocated in *list
+ *
+ * Output: int nfound          number of members found, -1 on error
+ *
+ */
+
+int sky_cone(Kdtree *tree, double *vec, double radius, int **list, 
+	     int *nalloc)
+{
+  int nfound=0;           /* Number of members found */
+  double theta;           /* Cone opening angle in radians */
+
+  if(kd_radius_range(tree,0,tree->npts,vec,sky_cone_chord(radius,&theta),
+		     list,nalloc,&nfound)) {
+    fprintf(stderr,"ERROR: sky_cone\n");
+    return -1;
+  }
+  if(nfound > 1)
+    qsort(*list,nfound,sizeof(int),intcmp);
+  return nfound;
+}
+
+typedef struct {
+  int zone;          /* Declination zone */
+  int index;         /* Catalog index */
+  double ra;         /* RA in radians */
+} Zonekey;           /* Sort key used by new_skyzones */
+
+/*.......................................................................
+ *
+ * Function zonecmp
+ *
+ * Orders the members of a Skyzones by zone, then RA, then catalog index.
+ *  Called by qsort in new_skyzones.
+ *
+ */
+
+static int zonecmp(const void *v1, const void *v2)
+{
+  Zonekey *k1 = (Zonekey *) v1;  /* Zonekey casting of v1 */
+  Zonekey *k2 = (Zonekey *) v2;  /* Zonekey casting of v2 */
+
+  if(k1->zone != k2->zone)
+    return (k1->zone > k2->zone) ? 1 : -1;
+  else if(k1->ra != k2->ra)
+    return (k1->ra > k2->ra) ? 1 : -1;
+  else if(k1->index != k2->index)
+    return (k1->index > k2->index) ? 1 : -1;
+  else
+    return 0;
+}
+
+/*.......................................................................
+ *
+ * Function sky_zone
+ *
+ * Returns the declination zone of a declination in radians.
+ *
+ */
+
+static int sky_zone(Skyzones *zones, double delta)
+{
+  if(delta < -PI / 2.0)
+    delta = -PI / 2.0;
+  return (int) floor((delta + PI / 2.0) / zones->zheight);
+}
+
+/*.......................................................................
+ *
+ * Function vec2rad
+ *
+ * Gets the RA, in the range 0 to 2pi, and the Dec of a unit vector.  The
+ *  zones are built and searched with these, rather than with the catalog
+ *  coordinates, so that positions given with Dec beyond a pole or with
+ *  negative RA land where secat2vec puts them.
+ *
+ * Inputs: double *vec         unit vector
+ *         double *alpha       RA in radians (set by this function)
+ *         double *delta       Dec in radians (set by this function)
+ *
+ * Output: (none)
+ *
+ */
+
+static void vec2rad(double *vec, double *alpha, double *delta)
+{
+  *delta = asin((vec[2] > 1.0) ? 1.0 : (vec[2] < -1.0) ? -1.0 : vec[2]);
+  *alpha = atan2(vec[1],vec[0]);
+  if(*alpha < 0.0)
+    *alpha += 2.0 * PI;
+}
+
+/*.......................................................................
+ *
+ * Function new_skyzones
+ *
+ * Sorts the sky positions of the members of a catalog into declination
+ *  zones, and by RA within each zone, for zone_cone searches.  The zones
+ *  are as high as the cone that zone_cone opens for the given search 
+ *  radius, so that each search looks at no more than three zones.  The
+ *  members are stored in zone order along with their unit vectors, so 
+ *  that a search reads a few runs of consecutive memory.  This is the 
+ *  "zones" matching method, an alternative to new_skytree.
+ *
+ * Inputs: double *vec         unit vectors of the members, from secat2vec
+ *         int ncat            number of members
+ *         double radius       search radius to be used, in arcsec
+ *
+ * Output: Skyzones *zones     sorted catalog, NULL on error
+ *
+ */
+
+Skyzones *new_skyzones(double *vec, int ncat, double radius)
+{
+  int i,k;                /* Looping variables */
+  int nalloc;             /* Number of points to allocate */
+  double theta;           /* Cone opening angle */
+  double alpha,delta;     /* Position in radians */
+  Zonekey *keys=NULL;     /* Sort keys */
+  Skyzones *zones;        /* New zones */
+
+  if(!(zones = (Skyzones *) malloc(sizeof(Skyzones)))) {
+    fprintf(stderr,"ERROR: new_skyzones.  Insufficient memory.\n");
+    return NULL;
+  }
+  nalloc = (ncat > 0) ? ncat : 1;
+  sky_cone_chord(radius,&theta);
+  zones->npts = ncat;
+  zones->zheight = (theta > 1.0e-8) ? theta : 1.0e-8;
+  zones->zone = (int *) malloc(nalloc * sizeof(int));
+  zones->index = (int *) malloc(nalloc * sizeof(int));
+  zones->ra = (double *) malloc(nalloc * sizeof(double));
+  for(k=0; k<3; k++)
+    zones->pos[k] = (double *) malloc(nalloc * sizeof(double));
+  keys = (Zonekey *) malloc(nalloc * sizeof(Zonekey));
+  if(!zones->zone || !zones->index || !zones->ra || !zones->pos[0] ||
+     !zones->pos[1] || !zones->pos[2] || !keys) {
+    fprintf(stderr,"ERROR: new_skyzones.  Insufficient memory.\n");
+    free(keys);
+    return del_skyzones(zones);
+  }
+
+  /*
+   * Sort the members by zone and RA
+   */
+
+  for(i=0; i<ncat; i++) {
+    vec2rad(vec+3*i,&alpha,&delta);
+    keys[i].zone = sky_zone(zones,delta);
+    keys[i].index = i;
+    keys[i].ra = alpha;
+  }
+  qsort(keys,ncat,sizeof(Zonekey),zonecmp);
+
+  for(i=0; i<ncat; i++) {
+    zones->zone[i] = keys[i].zone;
+    zones->index[i] = keys[i].index;
+    zones->ra[i] = keys[i].ra;
+    for(k=0; k<3; k++)
+      zones->pos[k][i] = vec[3*keys[i].index+k];
+  }
+  free(keys);
+
+  return zones;
+}
+
+/*.......................................................................
+ *
+ * Function del_skyzones
+ *
+ * Frees a Skyzones.
+ *
+ * Inputs: Skyzones *zones     zones to be freed
+ *
+ * Output: NULL
+ *
+ */
+
+Skyzones *del_skyzones(Skyzones *zones)
+{
+  int k;                  /* Looping variable */
+
+  if(zones) {
+    free(zones->zone);
+    free(zones->index);
+    free(zones->ra);
+    for(k=0; k<3; k++)
+      free(zones->pos[k]);
+    free(zones);
+  }
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function zone_sweep
+ *
+ * Adds the members of one zone with RAs between ralo and rahi whose unit
+ *  vectors are closer than chord to vec to the list.  The first member 
+ *  is found by bisection, and the rest by stepping along in RA.  Called 
+ *  by zone_cone.
+ *
+ */
+
+static int zone_sweep(Skyzones *zones, int zone, double ralo, double rahi,
+		      double *vec, double chord, int **list, int *nalloc,
+		      int *nfound)
+{
+  int i,k;                /* Looping variables */
+  int lo,hi,mid;          /* Bisection limits */
+  double d;               /* Offset along one axis */
+  double sum;             /* Sum of squared offsets */
+
+  lo = 0;
+  hi = zones->npts;
+  while(lo < hi) {
+    mid = (lo + hi) / 2;
+    if(zones->zone[mid] < zone || 
+       (zones->zone[mid] == zone && zones->ra[mid] < ralo))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  for(i=lo; i<zones->npts && zones->zone[i] == zone && zones->ra[i] <= rahi;
+      i++) {
+    sum = 0.0;
+    for(k=0; k<3; k++) {
+      d = zones->pos[k][i] - vec[k];
+      sum += d*d;
+    }
+    if(sqrt(sum) < chord) {
+      if(!(*list = (int *) grow_array(*list,nalloc,*nfound+1,sizeof(int))))
+	return 1;
+      (*list)[(*nfound)++] = zones->index[i];
+    }
+  }
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function zone_cone
+ *
+ * The zones version of sky_cone: finds the same catalog members, using 
+ *  the sorted catalog from new_skyzones.  The search covers the zones 
+ *  that the cone reaches, and in each of them the range of RA that the 
+ *  cone spans at the zone edge nearest the pole, split in two where it
+ *  crosses RA = 0.  Cones that reach a pole search the whole of the 
+ *  zones concerned.
+ *
+ * Inputs: Skyzones *zones     zones built by new_skyzones
+ *         double *vec         unit vector of the sky position
+ *         double radius       search radius in arcsec
+ *         int **list          list of indices (grown by this function)
+ *         int *nalloc         number of elements allocated in *list
+ *
+ * Output: int nfound          number of members found, -1 on error
+ *
+ */
+
+int zone_cone(Skyzones *zones, double *vec, double radius, int **list, 
+	      int *nalloc)
+{
+  int no_error=1;         /* Flag set to 0 on error */
+  int zone;               /* Looping variable over zones */
+  int nfound=0;           /* Number of members found */
+  double theta;           /* Cone opening angle in radians */
+  double chord;           /* Chord length of theta */
+  double alpha,delta;     /* Position in radians */
+  double dra;             /* Half-width of the cone in RA */
+
+  chord = sky_cone_chord(radius,&theta);
+  vec2rad(vec,&alpha,&delta);
+
+  /*
+   * Find the half-width in RA of the cone
+   */
+
+  if(fabs(delta) + theta >= PI / 2.0 || 
+     (dra = sin(theta) / cos(fabs(delta) + theta)) >= 1.0)
+    dra = PI;
+  else
+    dra = asin(dra) * (1.0 + 1.0e-9) + 1.0e-12;
+
+  /*
+   * Search the zones
+   */
+
+  for(zone=sky_zone(zones,delta-theta); 
+      no_error && zone<=sky_zone(zones,delta+theta); zone++) {
+    if(dra >= PI) {
+      if(zone_sweep(zones,zone,0.0,2.0*PI,vec,chord,list,nalloc,&nfound))
+	no_error = 0;
+    }
+    else if(alpha - dra < 0.0) {
+      if(zone_sweep(zones,zone,0.0,alpha+dra,vec,chord,list,nalloc,
+		    &nfound) ||
+	 zone_sweep(zones,zone,alpha-dra+2.0*PI,2.0*PI,vec,chord,list,
+		    nalloc,&nfound))
+	no_error = 0;
+    }
+    else if(alpha + dra >= 2.0 * PI) {
+      if(zone_sweep(zones,zone,0.0,alpha+dra-2.0*PI,vec,chord,list,nalloc,
+		    &nfound) ||
+	 zone_sweep(zones,zone,alpha-dra,2.0*PI,vec,chord,list,nalloc,
+		    &nfound))
+	no_error = 0;
+    }
+    else {
+      if(zone_sweep(zones,zone,alpha-dra,alpha+dra,vec,chord,list,nalloc,
+		    &nfound))
+	no_error = 0;
+    }
+  }
+
+  if(!no_error) {
+    fprintf(stderr,"ERROR: zone_cone\n");
+    return -1;
+  }
+  if(nfound > 1)
+    qsort(*list,nfound,sizeof(int),intcmp);
+  return nfound;
+}
+
+typedef struct {
+  float mag;         /* Magnitude */
+  int index;         /* Catalog index */
+} Brightkey;         /* Sort key used by bright_index */
+
+/*.......................................................................
+ *
+ * Function brightkeycmp
+ *
+ * Orders Brightkeys by magnitude, brightest first, and then by catalog 
+ *  index.  Called by qsort in bright_index.
+ *
+ */
+
+static int brightkeycmp(const void *v1, const void *v2)
+{
+  Brightkey *k1 = (Brightkey *) v1;  /* Brightkey casting of v1 */
+  Brightkey *k2 = (Brightkey *) v2;  /* Brightkey casting of v2 */
+
+  if(k1->mag != k2->mag)
+    return (k1->mag > k2->mag) ? 1 : -1;
+  else if(k1->index != k2->index)
+    return (k1->index > k2->index) ? 1 : -1;
+  else
+    return 0;
+}
+
+/*.......................................................................
+ *
+ * Function bright_index
+ *
+ * Returns the indices of the members of a catalog, ordered by total 
+ *  magnitude with the brightest first.  Members with equal magnitudes
+ *  keep their catalog order, so a catalog without magnitudes (e.g., an
+ *  astrometric list) comes back in its original order.
+ *
+ * Inputs: Secat *secat        catalog
+ *         int ncat            number of members in secat
+ *
+ * Output: int *index          ordered indices, NULL on error
+ *
+ */
+
+int *bright_index(Secat *secat, int ncat)
+{
+  int i;                  /* Looping variable */
+  int *index=NULL;        /* Ordered indices */
+  Brightkey *keys=NULL;   /* Sort keys */
+
+  index = (int *) malloc((ncat + 1) * sizeof(int));
+  keys = (Brightkey *) malloc((ncat + 1) * sizeof(Brightkey));
+  if(!index || !keys) {
+    fprintf(stderr,"ERROR: bright_index.  Insufficient memory.\n");
+    free(index);
+    free(keys);
+    return NULL;
+  }
+
+  for(i=0; i<ncat; i++) {
+    keys[i].mag = secat[i].mtot;
+    keys[i].index = i;
+  }
+  qsort(keys,ncat,sizeof(Brightkey),brightkeycmp);
+  for(i=0; i<ncat; i++)
+    index[i] = keys[i].index;
+
+  free(keys);
+  return index;
+}
+
+typedef struct {
+  int vert[3];       /* Vertices opposite the shortest, middle and longest
+			 sides */
+  int sense;         /* 1 ==> vertices run counterclockwise, -1 ==> not */
+  int cell;          /* Hash cell of the side ratios */
+  double r1;         /* Shortest side / longest side */
+  double r2;         /* Middle side / longest side */
+  double side;       /* Length of the longest side */
+  double angle;      /* Direction of the longest side, in degrees */
+} Triangle;          /* Triangle descriptor used by match_asterisms */
+
+/*.......................................................................
+ *
+ * Function tri_cell
+ *
+ * Returns the hash cell, along one axis, of a triangle side ratio.  The 
+ *  cells are ASTERTOL wide, so that matching triangles lie in the same 
+ *  or adjacent cells.
+ *
+ */
+
+static int tri_cell(double r, int ncell)
+{
+  int cell;               /* Hash cell */
+
+  cell = (int) (r / ASTERTOL);
+  return (cell < 0) ? 0 : (cell >= ncell) ? ncell - 1 : cell;
+}
+
+/*.......................................................................
+ *
+ * Function make_triangles
+ *
+ * Makes the descriptors of all of the triangles that can be formed from 
+ *  a list of positions.  Each triangle is described by the ratios of its 
+ *  shorter sides to its longest side, which do not change under a shift,
+ *  rotation, or change of scale.  Its vertices are labeled by the sides
+ *  they face, so that matching triangles also give matching vertices.
+ *  Triangles that are too elongated, or that have two sides of nearly
+ *  the same length (and thus ambiguous vertex labels), are skipped.
+ *  Called by match_asterisms.
+ *
+ * Inputs: Lpos *pos           positions
+ *         int npos            number of positions
+ *         int ncell           number of hash cells along each axis
+ *         int *ntri           number of triangles (set by this function)
+ *
+ * Output: Triangle *tri       triangle descriptors, NULL on error
+ *
+ */
+
+static Triangle *make_triangles(Lpos *pos, int npos, int ncell, int *ntri)
+{
+  int i,j,k,m;            /* Looping variables */
+  int tmp;                /* Used to sort the sides */
+  int v[3];               /* Vertices of the current triangle */
+  int ord[3];             /* Sides in order of increasing length */
+  double side[3];         /* Side opposite each vertex */
+  double cross;           /* Cross product giving the vertex sense */
+  Lpos *p0,*p1,*p2;       /* Labeled vertices */
+  Triangle *tri=NULL;     /* Triangle descriptors */
+  Triangle *tptr;         /* Pointer to navigate tri */
+
+  if(!(tri = (Triangle *) malloc((npos * (npos-1) * (npos-2) / 6 + 1) *
+				 sizeof(Triangle)))) {
+    fprintf(stderr,"ERROR: make_triangles.  Insufficient memory.\n");
+    return NULL;
+  }
+
+  tptr = tri;
+  for(i=0; i<npos; i++)
+    for(j=i+1; j<npos; j++)
+      for(k=j+1; k<npos; k++) {
+	v[0] = i;
+	v[1] = j;
+	v[2] = k;
+	side[0] = hypot(pos[j].x - pos[k].x,pos[j].y - pos[k].y);
+	side[1] = hypot(pos[i].x - pos[k].x,pos[i].y - pos[k].y);
+	side[2] = hypot(pos[i].x - pos[j].x,pos[i].y - pos[j].y);
+	ord[0] = 0;
+	ord[1] = 1;
+	ord[2] = 2;
+	for(m=0; m<3; m++)       /* Compare-exchange sides 0-1, 1-2, 0-1 */
+	  if(side[ord[m%2]] > side[ord[m%2+1]]) {
+	    tmp = ord[m%2];
+	    ord[m%2] = ord[m%2+1];
+	    ord[m%2+1] = tmp;
+	  }
+	if(side[ord[0]] * ASTERMAXRATIO < side[ord[2]])
+	  continue;
+	tptr->r1 = side[ord[0]] / side[ord[2]];
+	tptr->r2 = side[ord[1]] / side[ord[2]];
+	if(tptr->r2 - tptr->r1 < ASTERTOL || 1.0 - tptr->r2 < ASTERTOL)
+	  continue;
+	for(m=0; m<3; m++)
+	  tptr->vert[m] = v[ord[m]];
+	p0 = pos + tptr->vert[0];
+	p1 = pos + tptr->vert[1];
+	p2 = pos + tptr->vert[2];
+	cross = (p1->x - p0->x) * (p2->y - p0->y) - 
+	  (p1->y - p0->y) * (p2->x - p0->x);
+	tptr->sense = (cross > 0.0) ? 1 : -1;
+	tptr->side = side[ord[2]];
+	tptr->angle = atan2(p1->y - p0->y,p1->x - p0->x) * 180.0 / PI;
+	tptr->cell = tri_cell(tptr->r1,ncell) * ncell + 
+	  tri_cell(tptr->r2,ncell);
+	tptr++;
+      }
+
+  *ntri = tptr - tri;
+  return tri;
+}
+
+/*.......................................................................
+ *
+ * Function tri_pair
+ *
+ * Checks whether two triangles match, and if they do gets the ln(scale)
+ *  and the rotation (0 to 360 degrees) that take the first onto the 
+ *  second.  Returns 1 for a match and 0 otherwise.  Called by 
+ *  match_asterisms.
+ *
+ */
+
+static int tri_pair(Triangle *t1, Triangle *t2, double *lscale, double *rot)
+{
+  if(t1->sense != t2->sense || fabs(t1->r1 - t2->r1) > ASTERTOL ||
+     fabs(t1->r2 - t2->r2) > ASTERTOL)
+    return 0;
+  *lscale = log(t2->side / t1->side);
+  if(fabs(*lscale) >= ASTERLSCALE)
+    return 0;
+  *rot = fmod(t2->angle - t1->angle + 720.0,360.0);
+  return 1;
+}
+
+/*.......................................................................
+ *
+ * Function fit_simtrans
+ *
+ * Does a least-squares fit of a similarity transform to a set of 
+ *  position pairs.  Called by match_asterisms.
+ *
+ */
+
+static void fit_simtrans(Lpos *pos1, Lpos *pos2, int *p1, int *p2, int npair,
+			 Simtrans *trans)
+{
+  int i;                  /* Looping variable */
+  double x1,y1,x2,y2;     /* Centroids of the two lists */
+  double dx1,dy1,dx2,dy2; /* Offsets from the centroids */
+  double sxx=0.0;         /* Sum of the squared list 1 offsets */
+  double sa=0.0,sb=0.0;   /* Sums giving the rotation and scale */
+  double a,b;             /* scale * cos(rot) and scale * sin(rot) */
+  double sr2=0.0;         /* Sum of the squared residuals */
+  double x,y;             /* Transformed position */
+
+  x1 = y1 = x2 = y2 = 0.0;
+  for(i=0; i<npair; i++) {
+    x1 += pos1[p1[i]].x;
+    y1 += pos1[p1[i]].y;
+    x2 += pos2[p2[i]].x;
+    y2 += pos2[p2[i]].y;
+  }
+  x1 /= npair;
+  y1 /= npair;
+  x2 /= npair;
+  y2 /= npair;
+
+  for(i=0; i<npair; i++) {
+    dx1 = pos1[p1[i]].x - x1;
+    dy1 = pos1[p1[i]].y - y1;
+    dx2 = pos2[p2[i]].x - x2;
+    dy2 = pos2[p2[i]].y - y2;
+    sxx += dx1 * dx1 + dy1 * dy1;
+    sa += dx1 * dx2 + dy1 * dy2;
+    sb += dx1 * dy2 - dy1 * dx2;
+  }
+  a = (sxx > 0.0) ? sa / sxx : 1.0;
+  b = (sxx > 0.0) ? sb / sxx : 0.0;
+  trans->scale = hypot(a,b);
+  trans->rot = atan2(b,a) * 180.0 / PI;
+  trans->dx = x2 - a * x1 + b * y1;
+  trans->dy = y2 - b * x1 - a * y1;
+
+  for(i=0; i<npair; i++) {
+    apply_simtrans(trans,pos1[p1[i]].x,pos1[p1[i]].y,&x,&y);
+    sr2 += (x - pos2[p2[i]].x) * (x - pos2[p2[i]].x) + 
+      (y - pos2[p2[i]].y) * (y - pos2[p2[i]].y);
+  }
+  trans->rms = sqrt(sr2 / npair);
+  trans->nmatch = npair;
+}
+
+/*.......................................................................
+ *
+ * Function clip_pairs
+ *
+ * Gets the residual of each position pair from a transform and drops 
+ *  the pairs with residuals more than three times the robust sigma, 
+ *  or more than minclip if that is larger.  If maxcut is positive, it is
+ *  used as the limit instead.  Returns the number of pairs kept.  Called
+ *  by match_asterisms.
+ *
+ */
+
+static int clip_pairs(Lpos *pos1, Lpos *pos2, int *p1, int *p2, int npair,
+		      Simtrans *trans, double maxcut, double minclip, 
+		      double *resid)
+{
+  int i;                  /* Looping variable */
+  int nkeep=0;            /* Number of pairs kept */
+  double x,y;             /* Transformed position */
+  double cut;             /* Clipping limit */
+
+  for(i=0; i<npair; i++) {
+    apply_simtrans(trans,pos1[p1[i]].x,pos1[p1[i]].y,&x,&y);
+    resid[i] = resid[npair+i] = hypot(x - pos2[p2[i]].x,y - pos2[p2[i]].y);
+  }
+  qsort(resid+npair,npair,sizeof(double),dcmp);
+  cut = 3.0 * 1.4826 * resid[npair + npair/2];
+  if(cut < minclip)
+    cut = minclip;
+  if(maxcut > 0.0)
+    cut = maxcut;
+
+  for(i=0; i<npair; i++)
+    if(resid[i] <= cut) {
+      p1[nkeep] = p1[i];
+      p2[nkeep] = p2[i];
+      nkeep++;
+    }
+  return nkeep;
+}
+
+/*.......................................................................
+ *
+ * Function match_asterisms
+ *
+ * Finds the similarity transform (scale, rotation and shift) that takes
+ *  one list of positions onto another, with no starting guess, by 
+ *  matching the triangles formed by the first NASTER positions of each
+ *  list.  The lists should therefore be ordered with the brightest 
+ *  objects first (see bright_index).  The method is:
+ *   1. The triangles of the second list are hashed by their side ratios.
+ *   2. Each triangle of the first list is looked up in the hash, and 
+ *      each match votes for the ln(scale) and rotation it implies.  The
+ *      peak of the vote histogram is then refined with the mean of the
+ *      matches around it.
+ *   3. The matches close to the refined peak vote for the position pairs
+ *      at their vertices.  Pairs that are the best choice for both of 
+ *      their positions are kept.
+ *   4. At the peak scale and rotation, the shift is the one shared by 
+ *      the most pairs.  Least-squares fits to the pairs that agree with
+ *      it, with outliers clipped, then give the final transform.
+ *
+ * Inputs: Lpos *pos1          first list of positions
+ *         int n1              number of positions in pos1
+ *         Lpos *pos2          second list of positions
+ *         int n2              number of positions in pos2
+ *         Simtrans *trans     transform from pos1 to pos2 (set by this
+ *                              function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error or no match
+ *
+ */
+
+int match_asterisms(Lpos *pos1, int n1, Lpos *pos2, int n2, Simtrans *trans)
+{
+  int i,j,k,m,pass;       /* Looping variables */
+  int no_error=1;         /* Flag set to 0 on error */
+  int ncell;              /* Number of hash cells along each axis */
+  int ntri1=0,ntri2=0;    /* Numbers of triangles */
+  int c1,c2;              /* Hash cells along each axis */
+  int nlbin;              /* Number of ln(scale) histogram bins */
+  int ir,il;              /* Histogram bin */
+  int box,maxbox=0;       /* Votes in a 3x3 box of bins and their peak,
+			     and later pairs sharing a shift */
+  int npeak=0;            /* Number of matches used to refine the peak */
+  int npair=0;            /* Number of position pairs */
+  int nkeep;              /* Number of pairs kept after clipping */
+  int *cellstart=NULL;    /* Start of each hash cell in order */
+  int *order=NULL;        /* List 2 triangles in hash cell order */
+  int *hist=NULL;         /* ln(scale) and rotation vote histogram */
+  int *vote=NULL;         /* Votes for each position pair */
+  int *p1=NULL,*p2=NULL;  /* Position pairs */
+  double rbin;            /* Width of the rotation bins in degrees */
+  double lscale,rot;      /* ln(scale) and rotation of a triangle pair */
+  double peakr=0.0;       /* Rotation at the vote peak */
+  double peakl=0.0;       /* ln(scale) at the vote peak */
+  double dr,dl;           /* Offsets from the peak */
+  double sumr=0.0;        /* Sum of the rotation offsets near the peak */
+  double suml=0.0;        /* Sum of the ln(scale) offsets near the peak */
+  double minclip;         /* Smallest residual clipping limit */
+  double x,y;             /* Centroid of pos2 or transformed position */
+  double *resid=NULL;     /* Residuals and shifts of the pairs */
+  Triangle *tri1=NULL;    /* Triangles from the first list */
+  Triangle *tri2=NULL;    /* Triangles from the second list */
+  Triangle *t1,*t2;       /* Pointers to navigate tri1 and tri2 */
+
+  /*
+   * Make the triangles and hash the second list
+   */
+
+  if(n1 > NASTER)
+    n1 = NASTER;
+  if(n2 > NASTER)
+    n2 = NASTER;
+  if(n1 < 3 || n2 < 3) {
+    fprintf(stderr,"ERROR: match_asterisms.  Too few positions.\n");
+    return 1;
+  }
+  ncell = (int) (1.0 / ASTERTOL) + 1;
+  rbin = 360.0 / NROTBIN;
+  nlbin = (int) (2.0 * ASTERLSCALE / LSCALEBIN) + 1;
+
+  if(!(tri1 = make_triangles(pos1,n1,ncell,&ntri1)))
+    no_error = 0;
+  if(no_error)
+    if(!(tri2 = make_triangles(pos2,n2,ncell,&ntri2)))
+      no_error = 0;
+  if(no_error) {
+    cellstart = (int *) calloc(ncell * ncell + 1,sizeof(int));
+    order = (int *) malloc((ntri2 + 1) * sizeof(int));
+    hist = (int *) calloc(NROTBIN * nlbin,sizeof(int));
+    vote = (int *) calloc(n1 * n2,sizeof(int));
+    p1 = (int *) malloc(n1 * sizeof(int));
+    p2 = (int *) malloc(n1 * sizeof(int));
+    resid = (double *) malloc(2 * n1 * sizeof(double));
+    if(!cellstart || !order || !hist || !vote || !p1 || !p2 || !resid) {
+      fprintf(stderr,"ERROR: match_asterisms.  Insufficient memory.\n");
+      no_error = 0;
+    }
+  }
+
+  if(no_error) {
+    for(j=0; j<ntri2; j++)
+      cellstart[tri2[j].cell+1]++;
+    for(k=0; k<ncell*ncell; k++)
+      cellstart[k+1] += cellstart[k];
+    for(j=0; j<ntri2; j++)
+      order[cellstart[tri2[j].cell]++] = j;
+    for(k=ncell*ncell; k>0; k--)
+      cellstart[k] = cellstart[k-1];
+    cellstart[0] = 0;
+  }
+
+  /*
+   * Look up each triangle of the first list.  The first pass fills the
+   *  vote histogram, the second refines its peak, and in the third the
+   *  matches close to the peak vote for the vertex pairs.
+   */
+
+  for(pass=0; pass<3 && no_error; pass++) {
+    for(i=0,t1=tri1; i<ntri1; i++,t1++) {
+      for(c1=t1->cell/ncell-1; c1<=t1->cell/ncell+1; c1++) {
+	if(c1 < 0 || c1 >= ncell)
+	  continue;
+	for(c2=t1->cell%ncell-1; c2<=t1->cell%ncell+1; c2++) {
+	  if(c2 < 0 || c2 >= ncell)
+	    continue;
+	  k = c1 * ncell + c2;
+	  for(j=cellstart[k]; j<cellstart[k+1]; j++) {
+	    t2 = tri2 + order[j];
+	    if(!tri_pair(t1,t2,&lscale,&rot))
+	      continue;
+	    if(pass == 0) {
+	      ir = (int) (rot / rbin) % NROTBIN;
+	      il = (int) ((lscale + ASTERLSCALE) / LSCALEBIN);
+	      hist[il * NROTBIN + ir]++;
+	      continue;
+	    }
+	    dr = fmod(rot - peakr + 540.0,360.0) - 180.0;
+	    dl = lscale - peakl;
+	    if(pass == 1) {
+	      if(fabs(dr) <= 1.5 * rbin && fabs(dl) <= 1.5 * LSCALEBIN) {
+		sumr += dr;
+		suml += dl;
+		npeak++;
+	      }
+	    }
+	    else if(fabs(dr) <= 0.5 * rbin && fabs(dl) <= 0.5 * LSCALEBIN) {
+	      for(m=0; m<3; m++)
+		vote[t1->vert[m] * n2 + t2->vert[m]]++;
+	    }
+	  }
+	}
+      }
+    }
+
+    /*
+     * After the first pass, find the 3x3 box of bins with the most votes.
+     *  After the second, move the peak to the mean of the matches in it.
+     */
+
+    if(pass == 0) {
+      for(il=0; il<nlbin; il++)
+	for(ir=0; ir<NROTBIN; ir++) {
+	  box = 0;
+	  for(k=il-1; k<=il+1; k++)
+	    for(m=ir-1; m<=ir+1; m++)
+	      if(k >= 0 && k < nlbin)
+		box += hist[k * NROTBIN + (m + NROTBIN) % NROTBIN];
+	  if(box > maxbox) {
+	    maxbox = box;
+	    peakr = (ir + 0.5) * rbin;
+	    peakl = (il + 0.5) * LSCALEBIN - ASTERLSCALE;
+	  }
+	}
+      if(maxbox == 0) {
+	fprintf(stderr,"ERROR: match_asterisms.  No matching triangles.\n");
+	no_error = 0;
+      }
+    }
+    else if(pass == 1) {
+      peakr += sumr / npeak;
+      peakl += suml / npeak;
+    }
+  }
+
+  /*
+   * Keep the pairs with at least two votes that are the best choice for
+   *  both of their positions
+   */
+
+  if(no_error) {
+    for(i=0; i<n1; i++) {
+      k = 0;
+      for(j=1; j<n2; j++)
+	if(vote[i * n2 + j] > vote[i * n2 + k])
+	  k = j;
+      if(vote[i * n2 + k] < 2)
+	continue;
+      for(m=0; m<n1; m++)
+	if(m != i && vote[m * n2 + k] >= vote[i * n2 + k])
+	  break;
+      if(m == n1) {
+	p1[npair] = i;
+	p2[npair] = k;
+	npair++;
+      }
+    }
+    if(npair < 3) {
+      fprintf(stderr,"ERROR: match_asterisms.  Too few matching positions.\n");
+      no_error = 0;
+    }
+  }
+
+  /*
+   * Start from the peak scale and rotation, with the shift shared by the
+   *  most pairs, and then fit and clip until no more pairs are dropped.
+   *  The smallest clipping limit, minclip, is the position error implied
+   *  by the side ratio tolerance.
+   */
+
+  if(no_error) {
+    x = y = minclip = 0.0;
+    for(j=0; j<n2; j++) {
+      x += pos2[j].x;
+      y += pos2[j].y;
+    }
+    x /= n2;
+    y /= n2;
+    for(j=0; j<n2; j++)
+      minclip += hypot(pos2[j].x - x,pos2[j].y - y);
+    minclip *= 0.5 * ASTERTOL / n2;
+
+    trans->scale = exp(peakl);
+    trans->rot = peakr;
+    trans->dx = trans->dy = 0.0;
+    for(i=0; i<npair; i++) {
+      apply_simtrans(trans,pos1[p1[i]].x,pos1[p1[i]].y,&x,&y);
+      resid[i] = pos2[p2[i]].x - x;
+      resid[npair+i] = pos2[p2[i]].y - y;
+    }
+    for(i=0,maxbox=0; i<npair; i++) {
+      for(j=0,box=0; j<npair; j++)
+	if(hypot(resid[i] - resid[j],resid[npair+i] - resid[npair+j]) <= 
+	   minclip)
+	  box++;
+      if(box > maxbox) {
+	maxbox = box;
+	trans->dx = resid[i];
+	trans->dy = resid[npair+i];
+      }
+    }
+
+    nkeep = clip_pairs(pos1,pos2,p1,p2,npair,trans,minclip,minclip,resid);
+    while(nkeep >= 3) {
+      npair = nkeep;
+      fit_simtrans(pos1,pos2,p1,p2,npair,trans);
+      if((nkeep = clip_pairs(pos1,pos2,p1,p2,npair,trans,-1.0,minclip,
+			     resid)) == npair)
+	break;
+    }
+    if(nkeep < 3 || trans->rms > minclip) {
+      fprintf(stderr,"ERROR: match_asterisms.  No consistent transform.\n");
+      no_error = 0;
+    }
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  free(tri1);
+  free(tri2);
+  free(cellstart);
+  free(order);
+  free(hist);
+  free(vote);
+  free(p1);
+  free(p2);
+  free(resid);
+
+  if(no_error) {
+    if(trans->rot > 180.0)
+      trans->rot -= 360.0;
+    printf("match_asterisms: %d pairs give scale = %.5f, rot = %.3f deg,",
+	   trans->nmatch,trans->scale,trans->rot);
+    printf(" shift = %.2f %.2f, rms = %.3f\n",trans->dx,trans->dy,
+	   trans->rms);
+    return 0;
+  }
+  else
+    return 1;
+}
+
+/*.......................................................................
+ *
+ * Function apply_simtrans
+ *
+ * Applies a similarity transform, e.g., from match_asterisms, to a 
+ *  position.
+ *
+ * Inputs: Simtrans *trans     transform
+ *         double x1,y1        input position
+ *         double *x2,*y2      transformed position (set by this function)
+ *
+ * Output: (none)
+ *
+ */
+
+void apply_simtrans(Simtrans *trans, double x1, double y1, double *x2, 
+		    double *y2)
+{
+  double a,b;             /* scale * cos(rot) and scale * sin(rot) */
+
+  a = trans->scale * cos(trans->rot * PI / 180.0);
+  b = trans->scale * sin(trans->rot * PI / 180.0);
+  *x2 = a * x1 - b * y1 + trans->dx;
+  *y2 = b * x1 + a * y1 + trans->dy;
+}
+
+/*.......................................................................
+ *
+ * Function secat_sortkeys
+ *
+ * Copies one member of each row of a catalog into an array of sort keys
+ *  for radix_index.
+ *
+ * Inputs: Secat *secat        catalog
+ *         int ncat            number of members in secat
+ *         int sortkey         member to be copied: SORT_DPOS, SORT_MTOT or
+ *                              SORT_ALPHA
+ *
+ * Output: double *key         sort keys, NULL on error
+ *
+ */
+
+double *secat_sortkeys(Secat *secat, int ncat, int sortkey)
+{
+  int i;                  /* Looping variable */
+  double *key;            /* Sort keys */
+  Secat *sptr;            /* Pointer to navigate secat */
+
+  if(!(key = (double *) malloc((ncat + 1) * sizeof(double)))) {
+    fprintf(stderr,"ERROR: secat_sortkeys.  Insufficient memory.\n");
+    return NULL;
+  }
+
+  for(i=0,sptr=secat; i<ncat; i++,sptr++) {
+    switch(sortkey) {
+    case SORT_MTOT:
+      key[i] = sptr->mtot;
+      break;
+    case SORT_ALPHA:
+      key[i] = sptr->alpha;
+      break;
+    default:
+      key[i] = sptr->dpos;
+      break;
+    }
+  }
+
+  return key;
+}
+
+/*.......................................................................
+ *
+ * Function sdss_sortkeys
+ *
+ * The same as secat_sortkeys, but for a SDSScat array.  For SORT_MTOT the
+ *  r-band magnitude is used.
+ *
+ * Inputs: SDSScat *scat       catalog
+ *         int ncat            number of members in scat
+ *         int sortkey         member to be copied: SORT_DPOS, SORT_MTOT or
+ *                              SORT_ALPHA
+ *
+ * Output: double *key         sort keys, NULL on error
+ *
+ */
+
+double *sdss_sortkeys(SDSScat *scat, int ncat, int sortkey)
+{
+  int i;                  /* Looping variable */
+  double *key;            /* Sort keys */
+  SDSScat *sptr;          /* Pointer to navigate scat */
+
+  if(!(key = (double *) malloc((ncat + 1) * sizeof(double)))) {
+    fprintf(stderr,"ERROR: sdss_sortkeys.  Insufficient memory.\n");
+    return NULL;
+  }
+
+  for(i=0,sptr=scat; i<ncat; i++,sptr++) {
+    switch(sortkey) {
+    case SORT_MTOT:
+      key[i] = sptr->r;
+      break;
+    case SORT_ALPHA:
+      key[i] = sptr->alpha;
+      break;
+    default:
+      key[i] = sptr->dpos;
+      break;
+    }
+  }
+
+  return key;
+}
+
+/*.......................................................................
+ *
+ * Function radix_bits
+ *
+ * Maps a double onto an unsigned 64-bit integer with the same ordering,
+ *  so that the keys can be radix sorted: the sign bit is set for 
+ *  positive numbers, and all of the bits are flipped for negative ones.
+ *  Negative zero is treated as zero.
+ *
+ * Inputs: double key          key
+ *
+ * Output: unsigned long long bits  ordered bit pattern
+ *
+ */
+
+unsigned long long radix_bits(double key)
+{
+  union {
+    double d;
+    unsigned long long u;
+  } val;                  /* The two views of the key */
+
+  val.d = (key == 0.0) ? 0.0 : key;
+  if(val.u >> 63)
+    return ~val.u;
+  else
+    return val.u | (1ULL << 63);
+}
+
+/*.......................................................................
+ *
+ * Function radix_index
+ *
+ * Returns the order of an array of sort keys, i.e., the index of the 
+ *  smallest key, then of the next smallest, and so on.  The keys are
+ *  sorted with a least-significant-digit radix sort, RADIXBITS bits at a
+ *  time, which only moves the keys and their indices, and skips the 
+ *  passes in which all keys have the same digit.  Equal keys stay in
+ *  their original order.  The order can then be applied to the catalog 
+ *  with permute_secat or permute_sdss, so that each row moves only once.
+ *  See radix_index_par in catpar.c for a multi-threaded version.
+ *
+ * Inputs: double *key         sort keys
+ *         int n               number of keys
+ *
+ * Output: int *index          order of the keys, NULL on error
+ *
+ */
+
+int *radix_index(double *key, int n)
+{
+  int i,b;                  /* Looping variables */
+  int shift;                /* Position of the current digit */
+  int count[1<<RADIXBITS];  /* Keys with each digit, then their offsets */
+  int *index=NULL;          /* Order of the keys */
+  int *itmp=NULL;           /* Indices being sorted */
+  int *iswap;               /* Used to swap index and itmp */
+  unsigned long long mask;  /* Digit mask */
+  unsigned long long *bits=NULL;  /* Keys being sorted */
+  unsigned long long *btmp=NULL;  /* Scatter space for bits */
+  unsigned long long *bswap;      /* Used to swap bits and btmp */
+
+  index = (int *) malloc((n + 1) * sizeof(int));
+  itmp = (int *) malloc((n + 1) * sizeof(int));
+  bits = (unsigned long long *) malloc((n + 1) * sizeof(unsigned long long));
+  btmp = (unsigned long long *) malloc((n + 1) * sizeof(unsigned long long));
+  if(!index || !itmp || !bits || !btmp) {
+    fprintf(stderr,"ERROR: radix_index.  Insufficient memory.\n");
+    free(index);
+    free(itmp);
+    free(bits);
+    free(btmp);
+    return NULL;
+  }
+
+  for(i=0; i<n; i++) {
+    bits[i] = radix_bits(key[i]);
+    index[i] = i;
+  }
+
+  /*
+   * Sort one digit at a time, starting with the least significant
+   */
+
+  mask = (1ULL << RADIXBITS) - 1;
+  for(shift=0; shift<64 && n>1; shift+=RADIXBITS) {
+    memset(count,0,sizeof(count));
+    for(i=0; i<n; i++)
+      count[(bits[i] >> shift) & mask]++;
+    if(count[(bits[0] >> shift) & mask] == n)
+      continue;
+    for(b=0,i=0; b<(1<<RADIXBITS); b++) {
+      i += count[b];
+      count[b] = i - count[b];
+    }
+    for(i=0; i<n; i++) {
+      b = count[(bits[i] >> shift) & mask]++;
+      btmp[b] = bits[i];
+      itmp[b] = index[i];
+    }
+    bswap = bits;
+    bits = btmp;
+    btmp = bswap;
+    iswap = index;
+    index = itmp;
+    itmp = iswap;
+  }
+
+  free(itmp);
+  free(bits);
+  free(btmp);
+  return index;
+}
+
+/*.......................................................................
+ *
+ * Function permute_secat
+ *
+ * Puts the rows of a catalog into the order given by an index, e.g., from
+ *  radix_index, so that row i becomes the old row index[i].  The rows are
+ *  moved in place by following the cycles of the permutation, which 
+ *  moves each row once and needs room for only one extra row.  The 
+ *  index is used up: it is returned holding 0, 1, 2, ...
+ *
+ * Inputs: Secat *secat        catalog
+ *         int *index          new order of the rows
+ *         int ncat            number of members in secat
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int permute_secat(Secat *secat, int *index, int ncat)
+{
+  int i,j,k;              /* Looping variables */
+  Secat *tmp;             /* Row being moved around a cycle */
+
+  if(!(tmp = (Secat *) malloc(sizeof(Secat)))) {
+    fprintf(stderr,"ERROR: permute_secat.  Insufficient memory.\n");
+    return 1;
+  }
+
+  for(i=0; i<ncat; i++) {
+    if(index[i] == i)
+      continue;
+    *tmp = secat[i];
+    for(j=i; index[j] != i; j=k) {
+      k = index[j];
+      secat[j] = secat[k];
+      index[j] = j;
+    }
+    secat[j] = *tmp;
+    index[j] = j;
+  }
+
+  free(tmp);
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function permute_sdss
+ *
+ * The same as permute_secat, but for a SDSScat array.
+ *
+ * Inputs: SDSScat *scat       catalog
+ *         int *index          new order of the rows
+ *         int ncat            number of members in scat
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int permute_sdss(SDSScat *scat, int *index, int ncat)
+{
+  int i,j,k;              /* Looping variables */
+  SDSScat *tmp;           /* Row being moved around a cycle */
+
+  if(!(tmp = (SDSScat *) malloc(sizeof(SDSScat)))) {
+    fprintf(stderr,"ERROR: permute_sdss.  Insufficient memory.\n");
+    return 1;
+  }
+
+  for(i=0; i<ncat; i++) {
+    if(index[i] == i)
+      continue;
+    *tmp = scat[i];
+    for(j=i; index[j] != i; j=k) {
+      k = index[j];
+      scat[j] = scat[k];
+      index[j] = j;
+    }
+    scat[j] = *tmp;
+    index[j] = j;
+  }
+
+  free(tmp);
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function sort_secat_key
+ *
+ * Sorts a catalog in order of increasing dpos, mtot or alpha with 
+ *  radix_index and permute_secat.  This gives the same order as qsort
+ *  with dposcmp, except that rows with equal keys keep their order, but
+ *  only moves each row once.  See sort_secat_key_par in catpar.c for a
+ *  multi-threaded version.
+ *
+ * Inputs: Secat *secat        catalog
+ *         int ncat            number of members in secat
+ *         int sortkey         SORT_DPOS, SORT_MTOT or SORT_ALPHA
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int sort_secat_key(Secat *secat, int ncat, int sortkey)
+{
+  int no_error=1;         /* Flag set to 0 on error */
+  int *index=NULL;        /* New order of the rows */
+  double *key=NULL;       /* Sort keys */
+
+  if(!(key = secat_sortkeys(secat,ncat,sortkey)))
+    no_error = 0;
+  if(no_error)
+    if(!(index = radix_index(key,ncat)))
+      no_error = 0;
+  if(no_error)
+    if(permute_secat(secat,index,ncat))
+      no_error = 0;
+
+  free(key);
+  free(index);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: sort_secat_key\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function sort_sdss_key
+ *
+ * The same as sort_secat_key, but for a SDSScat array.
+ *
+ * Inputs: SDSScat *scat       catalog
+ *         int ncat            number of members in scat
+ *         int sortkey         SORT_DPOS, SORT_MTOT or SORT_ALPHA
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int sort_sdss_key(SDSScat *scat, int ncat, int sortkey)
+{
+  int no_error=1;         /* Flag set to 0 on error */
+  int *index=NULL;        /* New order of the rows */
+  double *key=NULL;       /* Sort keys */
+
+  if(!(key = sdss_sortkeys(scat,ncat,sortkey)))
+    no_error = 0;
+  if(no_error)
+    if(!(index = radix_index(key,ncat)))
+      no_error = 0;
+  if(no_error)
+    if(permute_sdss(scat,index,ncat))
+      no_error = 0;
+
+  free(key);
+  free(index);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: sort_sdss_key\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function near_above
+ *
+ * Returns 1 if key a comes after key b in the order of radix_index, i.e.,
+ *  if it is larger, or equal with a larger index.  Used by the heap in
+ *  nearest_index.
+ *
+ */
+
+static int near_above(double *key, int a, int b)
+{
+  return key[a] > key[b] || (key[a] == key[b] && a > b);
+}
+
+/*.......................................................................
+ *
+ * Function nearest_index
+ *
+ * Returns the order of the smallest of an array of sort keys, e.g., the 
+ *  dpos values of a catalog, for when only the closest members are 
+ *  wanted.  Keys larger than maxrad are skipped, and only the maxnum 
+ *  smallest of the rest are kept, using a heap of maxnum keys so that 
+ *  the other keys are never sorted.  The kept keys are returned in the 
+ *  same order as radix_index would give them, i.e., equal keys in their
+ *  original order.
+ *
+ * Inputs: double *key         sort keys
+ *         int n               number of keys
+ *         int maxnum          most keys to keep (<= 0 ==> no limit)
+ *         double maxrad       largest key to keep (<= 0 ==> no limit)
+ *         int *nkeep          number of keys kept (set by this function)
+ *
+ * Output: int *index          order of the kept keys, NULL on error
+ *
+ */
+
+int *nearest_index(double *key, int n, int maxnum, double maxrad, 
+		   int *nkeep)
+{
+  int i,j;                /* Looping variables */
+  int nheap=0;            /* Number of keys in the heap */
+  int parent,child;       /* Heap positions */
+  int top;                /* Index being moved through the heap */
+  int *index=NULL;        /* Kept indices, then their order */
+  int *order=NULL;        /* Order of the kept keys from radix_index */
+  double *subkey=NULL;    /* Kept keys */
+
+  *nkeep = 0;
+  if(maxnum <= 0 || maxnum > n)
+    maxnum = n;
+  if(!(index = (int *) malloc((maxnum + 1) * sizeof(int)))) {
+    fprintf(stderr,"ERROR: nearest_index.  Insufficient memory.\n");
+    return NULL;
+  }
+
+  /*
+   * With no limit on the number, keep every key within maxrad and sort
+   *  them with radix_index
+   */
+
+  if(maxnum == n) {
+    for(i=0; i<n; i++)
+      if(maxrad <= 0.0 || key[i] <= maxrad)
+	index[nheap++] = i;
+    if(!(subkey = (double *) malloc((nheap + 1) * sizeof(double)))) {
+      fprintf(stderr,"ERROR: nearest_index.  Insufficient memory.\n");
+      free(index);
+      return NULL;
+    }
+    for(j=0; j<nheap; j++)
+      subkey[j] = key[index[j]];
+    if(!(order = radix_index(subkey,nheap))) {
+      free(subkey);
+      free(index);
+      return NULL;
+    }
+    for(j=0; j<nheap; j++)
+      order[j] = index[order[j]];
+    free(subkey);
+    free(index);
+    *nkeep = nheap;
+    return order;
+  }
+
+  /*
+   * Otherwise keep the maxnum smallest keys in a heap with the largest 
+   *  key (or, for equal keys, the last index) at the top
+   */
+
+  for(i=0; i<n; i++) {
+    if(maxrad > 0.0 && !(key[i] <= maxrad))
+      continue;
+    if(nheap < maxnum) {
+      for(child=nheap++; child > 0; child=parent) {
+	parent = (child - 1) / 2;
+	if(!near_above(key,i,index[parent]))
+	  break;
+	index[child] = index[parent];
+      }
+      index[child] = i;
+    }
+    else if(near_above(key,index[0],i)) {
+      for(parent=0; (child = 2*parent + 1) < nheap; parent=child) {
+	if(child + 1 < nheap && near_above(key,index[child+1],index[child]))
+	  child++;
+	if(!near_above(key,index[child],i))
+	  break;
+	index[parent] = index[child];
+      }
+      index[parent] = i;
+    }
+  }
+
+  /*
+   * Take the largest key off the top of the heap until it is empty, 
+   *  leaving the keys in increasing order
+   */
+
+  *nkeep = nheap;
+  while(nheap > 1) {
+    top = index[--nheap];
+    index[nheap] = index[0];
+    for(parent=0; (child = 2*parent + 1) < nheap; parent=child) {
+      if(child + 1 < nheap && near_above(key,index[child+1],index[child]))
+	child++;
+      if(!near_above(key,index[child],top))
+	break;
+      index[parent] = index[child];
+    }
+    index[parent] = top;
+  }
+
+  return index;
+}
+
+/*.......................................................................
+ *
+ * Function select_kth
+ *
+ * Finds the k'th smallest (counting from 0) of an array of doubles, 
+ *  without sorting the array.  The array is reordered in place so that
+ *  element k holds the answer, the elements before it are no larger, and 
+ *  the elements after it are no smaller.  This is a quickselect with a
+ *  median-of-three pivot, which takes O(n) time on average.  If the 
+ *  partitions are too uneven for too long, the rest of the range is 
+ *  sorted with qsort, which limits the worst case to O(n log n).
+ *
+ * Inputs: double *x           array (reordered by this function)
+ *         int n               number of elements in x
+ *         int k               rank of the element wanted (0 to n-1)
+ *
+ * Output: double xk           k'th smallest element
+ *
+ */
+
+double select_kth(double *x, int n, int k)
+{
+  int i,j;                /* Partition positions */
+  int lo=0,hi=n-1;        /* Range that still holds element k */
+  int mid;                /* Middle of the range */
+  int depth;              /* Number of partitions left before qsort */
+  double pivot;           /* Pivot value */
+  double tmp;             /* Used to swap elements */
+
+  for(depth=2,i=n; i>1; i/=2)
+    depth += 2;
+
+  while(hi > lo) {
+
+    /*
+     * Give up on the partitions if they are too uneven
+     */
+
+    if(depth-- == 0) {
+      qsort(x+lo,hi-lo+1,sizeof(double),dcmp);
+      break;
+    }
+
+    /*
+     * Put the median of the first, middle and last elements in the 
+     *  middle and use it as the pivot
+     */
+
+    mid = lo + (hi - lo) / 2;
+    if(x[mid] < x[lo]) {
+      tmp = x[mid];  x[mid] = x[lo];  x[lo] = tmp;
+    }
+    if(x[hi] < x[mid]) {
+      tmp = x[hi];  x[hi] = x[mid];  x[mid] = tmp;
+      if(x[mid] < x[lo]) {
+	tmp = x[mid];  x[mid] = x[lo];  x[lo] = tmp;
+      }
+    }
+    pivot = x[mid];
+
+    /*
+     * Partition the range, and keep the part that holds element k
+     */
+
+    i = lo;
+    j = hi;
+    while(i <= j) {
+      while(x[i] < pivot)
+	i++;
+      while(x[j] > pivot)
+	j--;
+      if(i <= j) {
+	tmp = x[i];  x[i] = x[j];  x[j] = tmp;
+	i++;
+	j--;
+      }
+    }
+    if(k <= j)
+      hi = j;
+    else if(k >= i)
+      lo = i;
+    else
+      break;
+  }
+
+  return x[k];
+}
+
+/*.......................................................................
+ *
+ * Function median_select
+ *
+ * Returns the median of an array of doubles, in O(n) time, using 
+ *  select_kth.  For an even number of elements the two middle values are
+ *  averaged, as they would be after a sort.  The array is reordered in 
+ *  place, so no memory is allocated.
+ *
+ * Inputs: double *x           array (reordered by this function)
+ *         int n               number of elements in x
+ *
+ * Output: double median       median, 0 if n is 0
+ *
+ */
+
+double median_select(double *x, int n)
+{
+  int i;                  /* Looping variable */
+  int k;                  /* Rank of the upper middle element */
+  double upper;           /* Upper middle element */
+  double lower;           /* Lower middle element */
+
+  if(n < 1)
+    return 0.0;
+
+  k = n / 2;
+  upper = select_kth(x,n,k);
+  if(n % 2)
+    return upper;
+
+  /*
+   * After select_kth the lower middle element is the largest of the 
+   *  elements before element k
+   */
+
+  lower = x[0];
+  for(i=1; i<k; i++)
+    if(x[i] > lower)
+      lower = x[i];
+
+  return (lower + upper) / 2.0;
+}
+
+/*.......................................................................
+ *
+ * Function weighted_median
+ *
+ * Returns the weighted median of an array of doubles, i.e., the smallest
+ *  value for which the elements no larger than it hold at least half of 
+ *  the total weight.  It is found in O(n) time on average by a 
+ *  quickselect on the values, which keeps track of the weight of the 
+ *  elements that have been passed.  The values and weights are reordered
+ *  together in place.  With equal weights this gives the lower middle 
+ *  value for an even number of elements.
+ *
+ * Inputs: double *x           values (reordered by this function)
+ *         double *w           weights, >= 0 (reordered by this function)
+ *         int n               number of elements in x and w
+ *
+ * Output: double median       weighted median, 0 if n is 0
+ *
+ */
+
+double weighted_median(double *x, double *w, int n)
+{
+  int i;                  /* Looping variable */
+  int lo=0,hi=n-1;        /* Range that still holds the median */
+  int lt,gt;              /* Ends of the elements equal to the pivot */
+  int mid;                /* Middle of the range */
+  double half=0.0;        /* Half of the total weight */
+  double wbelow=0.0;      /* Weight of the elements before lo */
+  double wless,wequal;    /* Weight below and equal to the pivot */
+  double pivot;           /* Pivot value */
+  double tmp;             /* Used to swap elements */
+
+  if(n < 1)
+    return 0.0;
+
+  for(i=0; i<n; i++)
+    half += w[i];
+  half /= 2.0;
+
+  while(lo <= hi) {
+
+    /*
+     * Use the median of the first, middle and last elements as the pivot
+     */
+
+    mid = lo + (hi - lo) / 2;
+    if((x[lo] <= x[mid]) == (x[mid] <= x[hi]))
+      pivot = x[mid];
+    else if((x[mid] <= x[lo]) == (x[lo] <= x[hi]))
+      pivot = x[lo];
+    else
+      pivot = x[hi];
+
+    /*
+     * Split the range into the elements less than, equal to and greater
+     *  than the pivot, adding up the weights of the first two parts
+     */
+
+    lt = lo;
+    gt = hi;
+    i = lo;
+    wless = wequal = 0.0;
+    while(i <= gt) {
+      if(x[i] < pivot) {
+	wless += w[i];
+	tmp = x[i];  x[i] = x[lt];  x[lt] = tmp;
+	tmp = w[i];  w[i] = w[lt];  w[lt] = tmp;
+	lt++;
+	i++;
+      }
+      else if(x[i] > pivot) {
+	tmp = x[i];  x[i] = x[gt];  x[gt] = tmp;
+	tmp = w[i];  w[i] = w[gt];  w[gt] = tmp;
+	gt--;
+      }
+      else {
+	wequal += w[i];
+	i++;
+      }
+    }
+
+    /*
+     * Keep the part that holds the median
+     */
+
+    if(lt > lo && wbelow + wless >= half)
+      hi = lt - 1;
+    else if(wbelow + wless + wequal >= half || gt == hi)
+      return pivot;
+    else {
+      wbelow += wless + wequal;
+      lo = gt + 1;
+    }
+  }
+
+  return x[lo < n ? lo : n - 1];
+}
+
+/*.......................................................................
+ *
+ * Function init_medstream
+ *
+ * Starts a running approximate median (see add_medstream).
+ *
+ * Inputs: Medstream *ms       running median (set by this function)
+ *
+ * Output: (none)
+ *
+ */
+
+void init_medstream(Medstream *ms)
+{
+  int i;                  /* Looping variable */
+
+  ms->count = 0;
+  for(i=0; i<5; i++) {
+    ms->n[i] = i + 1;
+    ms->q[i] = 0.0;
+  }
+  ms->np[0] = 1.0;
+  ms->np[1] = 2.0;
+  ms->np[2] = 3.0;
+  ms->np[3] = 4.0;
+  ms->np[4] = 5.0;
+}
+
+/*.......................................................................
+ *
+ * Function add_medstream
+ *
+ * Adds a value to a running approximate median.  This is the P-squared
+ *  method of Jain & Chlamtac (1985), which keeps five markers at the 
+ *  minimum, the quartiles, the median and the maximum of the values seen
+ *  so far and moves them along a parabola as values arrive.  It needs
+ *  no memory for the values themselves, so it can be used on catalogs 
+ *  that are too large to be held in memory, or read as they stream in.
+ *
+ * Inputs: Medstream *ms       running median (updated by this function)
+ *         double x            new value
+ *
+ * Output: (none)
+ *
+ */
+
+void add_medstream(Medstream *ms, double x)
+{
+  int i,j,k;              /* Looping variables */
+  int d;                  /* Direction in which a marker moves */
+  double dn[5]={0.0,0.25,0.5,0.75,1.0};  /* Increments of np */
+  double qp;              /* New marker height */
+  double tmp;             /* Used to sort the first values */
+
+  /*
+   * The first five values are the markers themselves
+   */
+
+  if(ms->count < 5) {
+    ms->q[ms->count++] = x;
+    for(i=ms->count-1; i>0 && ms->q[i] < ms->q[i-1]; i--) {
+      tmp = ms->q[i];
+      ms->q[i] = ms->q[i-1];
+      ms->q[i-1] = tmp;
+    }
+    return;
+  }
+  ms->count++;
+
+  /*
+   * Find the cell that holds the new value, and move the markers above it
+   */
+
+  if(x < ms->q[0]) {
+    ms->q[0] = x;
+    k = 0;
+  }
+  else if(x >= ms->q[4]) {
+    ms->q[4] = x;
+    k = 3;
+  }
+  else
+    for(k=0; k<3 && x >= ms->q[k+1]; k++);
+  for(i=k+1; i<5; i++)
+    ms->n[i]++;
+  for(i=0; i<5; i++)
+    ms->np[i] += dn[i];
+
+  /*
+   * Move the middle markers toward their desired positions
+   */
+
+  for(i=1; i<4; i++) {
+    tmp = ms->np[i] - ms->n[i];
+    if((tmp >= 1.0 && ms->n[i+1] - ms->n[i] > 1) ||
+       (tmp <= -1.0 && ms->n[i-1] - ms->n[i] < -1)) {
+      d = (tmp > 0.0) ? 1 : -1;
+      qp = ms->q[i] + d / (double) (ms->n[i+1] - ms->n[i-1]) *
+	((ms->n[i] - ms->n[i-1] + d) * (ms->q[i+1] - ms->q[i]) /
+	 (ms->n[i+1] - ms->n[i]) +
+	 (ms->n[i+1] - ms->n[i] - d) * (ms->q[i] - ms->q[i-1]) /
+	 (ms->n[i] - ms->n[i-1]));
+      if(qp <= ms->q[i-1] || qp >= ms->q[i+1]) {
+	j = i + d;
+	qp = ms->q[i] + d * (ms->q[j] - ms->q[i]) / (ms->n[j] - ms->n[i]);
+      }
+      ms->q[i] = qp;
+      ms->n[i] += d;
+    }
+  }
+}
+
+/*.......................................................................
+ *
+ * Function medstream_value
+ *
+ * Returns the current estimate of a running median.  Up to five values
+ *  the median is exact.
+ *
+ * Inputs: Medstream *ms       running median
+ *
+ * Output: double median       estimated median, 0 if no values were added
+ *
+ */
+
+double medstream_value(Medstream *ms)
+{
+  if(ms->count < 1)
+    return 0.0;
+  else if(ms->count < 5) {
+    if(ms->count % 2)
+      return ms->q[ms->count / 2];
+    else
+      return (ms->q[ms->count / 2 - 1] + ms->q[ms->count / 2]) / 2.0;
+  }
+  else
+    return ms->q[2];
+}
+
+/*.......................................................................
+ *
+ * Function dposcmp
+ *
+ * Compares the dpos field for two Secat structures and returns 1
+ *  if the first is greater than the second, 0 if they're equal, and
+ *  -1 if the first is less than the second.  This function is called
+ *  by qsort.
+ *
+ * Inputs: void *v1            first structure (cast to void)
+ *         void *v2            second structure (cast to void)
+ *
+ * Output: int (-1,0,1)        as described above
+ *
+ */
+
+int dposcmp(const void *v1, const void *v2)
+{
+  Secat *s1 = (Secat *) v1;  /* Secat casting of v1 */
+  Secat *s2 = (Secat *) v2;  /* Secat casting of v2 */
+
+  /*
+   * Do the comparison
+   */
+
+  if(s1->dpos > s2->dpos)
+    return 1;
+  else if(s1->dpos == s2->dpos)
+    return 0;
+  else
+    return -1;
+}
+
+/*.......................................................................
+ *
+ * Function dposcmp_sdss
+ *
+ * Compares the dpos field for two SDSScat structures and returns 1
+ *  if the first is greater than the second, 0 if they're equal, and
+ *  -1 if the first is less than the second.  This function is called
+ *  by qsort.
+ *
+ * Inputs: void *v1            first structure (cast to void)
+ *         void *v2            second structure (cast to void)
+ *
+ * Output: int (-1,0,1)        as described above
+ *
+ */
+
+int dposcmp_sdss(const void *v1, const void *v2)
+{
+  SDSScat *s1 = (SDSScat *) v1;  /* SDSScat casting of v1 */
+  SDSScat *s2 = (SDSScat *) v2;  /* SDSScat casting of v2 */
+
+  /*
+   * Do the comparison
+   */
+
+  if(s1->dpos > s2->dpos)
+    return 1;
+  else if(s1->dpos == s2->dpos)
+    return 0;
+  else
+    return -1;
+}
+
+/*.......................................................................
+ *
+ * Function dcmp
+ *
+ * Compares two doubles and returns 1
+ *  if the first is greater than the second, 0 if they're equal, and
+ *  -1 if the first is less than the second.  This function is called
+ *  by qsort.
+ *
+ * Inputs: void *v1            first structure (cast to void)
+ *         void *v2            second structure (cast to void)
+ *
+ * Output: int (-1,0,1)        as described above
+ *
+ */
+
+int dcmp(const void *v1, const void *v2)
+{
+  double *s1 = (double *) v1;  /* double casting of v1 */
+  double *s2 = (double *) v2;  /* double casting of v2 */
+
+  /*
+   * Do the comparison
+   */
+
+  if(*s1 > *s2)
+    return 1;
+  else if(*s1 == *s2)
+    return 0;
+  else
+    return -1;
+}
+
+
+/*.......................................................................
+ *
+ * Function intcmp
+ *
+ * Compares two ints and returns 1
+ *  if the first is greater than the second, 0 if they're equal, and
+ *  -1 if the first is less than the second.  This function is called
+ *  by qsort.
+ *
+ * Inputs: void *v1            first int (cast to void)
+ *         void *v2            second int (cast to void)
+ *
+ * Output: int (-1,0,1)        as described above
+ *
+ */
+
+int intcmp(const void *v1, const void *v2)
+{
+  int *s1 = (int *) v1;  /* int casting of v1 */
+  int *s2 = (int *) v2;  /* int casting of v2 */
+
+  /*
+   * Do the comparison
+   */
+
+  if(*s1 > *s2)
+    return 1;
+  else if(*s1 == *s2)
+    return 0;
+  else
+    return -1;
+}
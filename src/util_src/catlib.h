@@ -5,13 +5,103 @@
 
 #define MASTERLIM 64
 #define COMPLIM 64
+#define KDLEAF 8     /* Largest number of points in an unsplit Kdtree node */
+#define NASTER 50          /* Most positions used by match_asterisms */
+#define ASTERTOL 0.01      /* Tolerance on the triangle side ratios */
+#define ASTERMAXRATIO 10.0 /* Largest longest/shortest side ratio used */
+#define ASTERLSCALE 2.3    /* Largest |ln(scale)| considered (scale 0.1-10) */
+#define NROTBIN 180        /* Number of rotation bins in the vote histogram */
+#define LSCALEBIN 0.02     /* Width of the ln(scale) bins in the histogram */
+#define RADIXBITS 11       /* Bits sorted per pass by radix_index */
+
+typedef struct {
+  int npts;          /* Number of points */
+  int ndim;          /* 2 ==> (x,y) positions, 3 ==> sky unit vectors */
+  int *index;        /* Catalog index of each point, in tree order */
+  double *pos[3];    /* Coordinates along each axis, in tree order */
+  char *axis;        /* Splitting axis of each node */
+} Kdtree;            /* k-d tree over catalog positions (see new_kdtree) */
+
+typedef struct {
+  int npts;          /* Number of points */
+  double zheight;    /* Zone height in radians */
+  int *zone;         /* Zone of each point, in zone order */
+  int *index;        /* Catalog index of each point, in zone order */
+  double *ra;        /* RA of each point in radians, in zone order */
+  double *pos[3];    /* Unit vector coordinates, in zone order */
+} Skyzones;          /* Catalog sorted into Dec zones (see new_skyzones) */
+
+typedef struct {
+  double scale;      /* Scale factor, list 2 length per list 1 length */
+  double rot;        /* Rotation from list 1 to list 2, in degrees, 
+			 measured counterclockwise */
+  double dx,dy;      /* Shift, in list 2 units */
+  double rms;        /* rms residual of the fit, in list 2 units */
+  int nmatch;        /* Number of position pairs used in the fit */
+} Simtrans;          /* Similarity transform (see match_asterisms) */
+
+typedef struct {
+  int count;         /* Number of values added */
+  int n[5];          /* Marker positions */
+  double np[5];      /* Desired marker positions */
+  double q[5];       /* Marker heights */
+} Medstream;         /* Running approximate median (see add_medstream) */
+
+enum {
+  SKY_TREE,
+  SKY_ZONES
+}; /* Enumeration for the sky matching method (sky_cone or zone_cone) */
+
+enum {
+  SORT_DPOS,
+  SORT_MTOT,
+  SORT_ALPHA
+}; /* Enumeration for the catalog member used as a sort key */
 
 int find_lens(Secat *cat, int ncat, int *lensindex);
 Secat find_closest(Pos cpos, Secat *secat, int ncat, int verbose);
+Secat find_closest_kd(Pos cpos, Secat *secat, Kdtree *tree, int verbose);
+Kdtree *new_kdtree(Secat *secat, int ncat);
+Kdtree *new_skytree(double *vec, int ncat);
+Kdtree *del_kdtree(Kdtree *tree);
+int kd_nearest(Kdtree *tree, double x, double y, double maxsep, double *sep);
+int kd_radius(Kdtree *tree, double x, double y, double radius, int **list,
+	      int *nalloc);
+int sky_cone(Kdtree *tree, double *vec, double radius, int **list, 
+	     int *nalloc);
+Skyzones *new_skyzones(double *vec, int ncat, double radius);
+Skyzones *del_skyzones(Skyzones *zones);
+int zone_cone(Skyzones *zones, double *vec, double radius, int **list, 
+	      int *nalloc);
+int *bright_index(Secat *secat, int ncat);
+int match_asterisms(Lpos *pos1, int n1, Lpos *pos2, int n2,
+		    Simtrans *trans);
+void apply_simtrans(Simtrans *trans, double x1, double y1, double *x2, 
+		    double *y2);
+double *secat_sortkeys(Secat *secat, int ncat, int sortkey);
+double *sdss_sortkeys(SDSScat *scat, int ncat, int sortkey);
+unsigned long long radix_bits(double key);
+int *radix_index(double *key, int n);
+int permute_secat(Secat *secat, int *index, int ncat);
+int permute_sdss(SDSScat *scat, int *index, int ncat);
+int sort_secat_key(Secat *secat, int ncat, int sortkey);
+int sort_sdss_key(SDSScat *scat, int ncat, int sortkey);
+int *nearest_index(double *key, int n, int maxnum, double maxrad, 
+		   int *nkeep);
+double select_kth(double *x, int n, int k);
+double median_select(double *x, int n);
+double weighted_median(double *x, double *w, int n);
+void init_medstream(Medstream *ms);
+void add_medstream(Medstream *ms, double x);
+double medstream_value(Medstream *ms);
 Secat *purge_cat(Secat *in_cat, int nincat, char *catname, int *npurged, 
 		 int purgeflag);
+Colcat *purge_colcat(Colcat *in_cat, char *catname, int purgeflag);
+Colcat *secat2colcat(Secat *secat, int ncat, int naper);
+Secat *colcat2secat(Colcat *colcat, int *ncat);
 int dposcmp(const void *v1, const void *v2);
 int dposcmp_sdss(const void *v1, const void *v2);
 int dcmp(const void *v1, const void *v2);
+int intcmp(const void *v1, const void *v2);
 
 #endif
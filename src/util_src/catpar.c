@@ -0,0 +1,1316 @@
+/*
+ * catpar.c
+ *
+ * This is a library of multi-threaded versions of the catalog functions.
+ *  It is kept apart from dataio.c and catlib.c so that only the programs
+ *  that use it have to be linked with -lpthread.
+ *
+ * Functions included in this library:
+ * -----------------------------------
+ *  default_nthread - returns the number of threads to use by default
+ *  read_secat_par  - reads a secat-style catalog with several threads
+ *  read_sdss_par   - reads a SDSS-style catalog with several threads
+ *  read_secat_method - reads a secat-style catalog with a chosen input
+ *                     method (READ_STDIO, READ_MMAP or READ_PAR)
+ *  read_sdss_method - reads a SDSS-style catalog with a chosen input
+ *                     method
+ *  write_secat_par - writes a secat-style catalog with several threads
+ *  sky_match_par   - finds the matches of the sources in one catalog
+ *                     among the members of another with several threads
+ *  del_matchlist   - frees the matches found by sky_match_par
+ *  radix_index_par - finds the order of an array of sort keys with a 
+ *                     radix sort, using several threads
+ *  sort_secat_key_par - sorts a catalog by dpos, mtot or alpha, using
+ *                     radix_index_par
+ *  sort_sdss_key_par - the same as sort_secat_key_par, for a SDSScat
+ *                     array
+ *
+ *-----------------------------------------------------------------------
+ * Revision history:
+ * -----------------
+ * v2026Oct16 AGT, First version, with read_secat_par and read_sdss_par
+ * v2026Oct16 AGT, Added write_secat_par
+ * v2026Oct16 AGT, Added sky_match_par and del_matchlist
+ * v2026Oct16 AGT, Added radix_index_par
+ * v2026Oct16 AGT, Added read_secat_method and read_sdss_method, through
+ *                  which programs select the READ_PAR reader
+ *                  with a thread count
+ * v2026Oct16 AGT, Added sort_secat_key_par and sort_sdss_key_par
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <math.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "structdef.h"
+#include "dataio.h"
+#include "coords.h"
+#include "catlib.h"
+#include "catpar.h"
+
+/*.......................................................................
+ *
+ * The piece of a memory-mapped catalog handled by one thread.  The
+ *  pieces start and end on line boundaries.
+ */
+
+typedef struct {
+  char *start;       /* Start of the piece */
+  char *end;         /* End of the piece */
+  char comment;      /* Comment character */
+  int format;        /* Secat format code, or -1 for a SDSS catalog */
+  int nphys;         /* Number of lines in the piece */
+  int ndata;         /* Number of data lines in the piece */
+  int count;         /* Number of data lines before the piece */
+  int lc;            /* Number of lines before the piece; bad line on error */
+  int ncols;         /* Number of columns in the last (or bad) line */
+  int status;        /* 0 ==> OK, 1 ==> error */
+  void *data;        /* Part of the output array for this piece */
+  Outbuf *ob;        /* Formatted rows of this piece (write_secat_par) */
+} Parchunk;
+
+/*.......................................................................
+ *
+ * Function default_nthread
+ *
+ * Returns the number of threads to use when the caller does not say, i.e.,
+ *  the number of online processors, up to MAXTHREAD.
+ *
+ * Inputs: (none)
+ *
+ * Output: int nthread         number of threads
+ *
+ */
+
+int default_nthread()
+{
+  long ncpu=1;              /* Number of processors */
+
+#ifdef _SC_NPROCESSORS_ONLN
+  ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if(ncpu < 1)
+    ncpu = 1;
+  if(ncpu > MAXTHREAD)
+    ncpu = MAXTHREAD;
+
+  return (int) ncpu;
+}
+
+/*.......................................................................
+ *
+ * Functions count_worker, parse_worker and print_worker
+ *
+ * Thread bodies for the two passes over a mapped catalog.  The first
+ *  counts the lines in a piece, the second parses them into the piece's
+ *  part of the output array.  Function print_worker does the opposite
+ *  for write_secat_par, formatting a block of rows into the piece's
+ *  output buffer.
+ *
+ * Inputs: void *arg           the Parchunk for this thread
+ *
+ * Output: NULL
+ *
+ */
+
+static void *count_worker(void *arg)
+{
+  Parchunk *chunk = (Parchunk *) arg;
+
+  chunk->ndata = count_data_lines(chunk->start,chunk->end,chunk->comment,
+				  &chunk->nphys);
+  return NULL;
+}
+
+static void *parse_worker(void *arg)
+{
+  Parchunk *chunk = (Parchunk *) arg;
+
+  if(chunk->format < 0)
+    chunk->status = parse_sdss_chunk(chunk->start,chunk->end,chunk->comment,
+				     (SDSScat *) chunk->data,&chunk->lc,
+				     &chunk->ncols);
+  else
+    chunk->status = parse_secat_chunk(chunk->start,chunk->end,
+				      chunk->comment,chunk->format,
+				      chunk->count,(Secat *) chunk->data,
+				      &chunk->lc,&chunk->ncols);
+  return NULL;
+}
+
+static void *print_worker(void *arg)
+{
+  Parchunk *chunk = (Parchunk *) arg;
+
+  chunk->ob->used = 0;
+  chunk->status = print_secat_rows(chunk->ob,(Secat *) chunk->data,
+				   chunk->ndata,chunk->format);
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function run_chunks
+ *
+ * Runs a worker on each piece of a file, one thread per piece.  The last
+ *  piece is done by the calling thread, as is any piece for which a
+ *  thread cannot be started.
+ *
+ * Inputs: Parchunk *chunks    pieces
+ *         int nchunk          number of pieces
+ *         void *(*worker)(void *)  thread body
+ *
+ * Output: (none)
+ *
+ */
+
+static void run_chunks(Parchunk *chunks, int nchunk, void *(*worker)(void *))
+{
+  int i;                    /* Looping variable */
+  int started[MAXTHREAD];   /* Flag set to 1 if a thread was started */
+  pthread_t tid[MAXTHREAD]; /* Thread IDs */
+
+  for(i=0; i<nchunk-1; i++)
+    started[i] = (pthread_create(&tid[i],NULL,worker,chunks+i) == 0);
+  worker(chunks+nchunk-1);
+  for(i=0; i<nchunk-1; i++) {
+    if(started[i])
+      pthread_join(tid[i],NULL);
+    else
+      worker(chunks+i);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function split_catalog
+ *
+ * Maps a catalog, skips its header lines, splits the rest into
+ *  newline-aligned pieces and counts the lines in each piece in
+ *  parallel.  On return each piece knows how many data lines and lines
+ *  precede it, so the pieces can be parsed independently.
+ *
+ * Inputs: char *inname        name of input file
+ *         char *funcname      name of calling function (for messages)
+ *         char comment        comment character
+ *         int format          format code, or -1 for a SDSS catalog
+ *         int nskip           number of header lines to skip
+ *         int nthread         number of threads (<= 0 ==> default_nthread)
+ *         char **data         mapped file (set by function)
+ *         size_t *size        size of mapped file (set by function)
+ *         Parchunk *chunks    pieces (room for MAXTHREAD, set by function)
+ *         int *nchunk         number of pieces (set by function)
+ *         int *ndata          total number of data lines (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+static int split_catalog(char *inname, char *funcname, char comment,
+			 int format, int nskip, int nthread, char **data,
+			 size_t *size, Parchunk *chunks, int *nchunk,
+			 int *ndata)
+{
+  int i;                    /* Looping variable */
+  int lc=0;                 /* Running counter for line number */
+  size_t piece;             /* Nominal size of each piece */
+  ptrdiff_t maxchunk;       /* Most pieces that the data can be split into */
+  char *ptr;                /* Start of the data */
+  char *end;                /* End of mapped file */
+  char *nl;                 /* Newline ending a piece */
+  FILE *ifp=NULL;           /* Input file pointer */
+
+  /*
+   * Map the input file
+   */
+
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: %s.\n",funcname);
+    return 1;
+  }
+  if(map_readfile(ifp,data,size)) {
+    fprintf(stderr,"ERROR: %s.\n",funcname);
+    fclose(ifp);
+    return 1;
+  }
+  fclose(ifp);
+  end = *data + *size;
+
+  /* Have to skip the first nskip lines */
+  for(ptr=*data; lc < nskip && ptr < end; lc++) {
+    if(!(nl = memchr(ptr,'\n',end - ptr)))
+      ptr = end;
+    else
+      ptr = nl + 1;
+  }
+  if(nskip > 0 && *size > 0 && ptr == end) {
+    fprintf(stderr,"ERROR: %s. Bad file format for %s\n",funcname,inname);
+    unmap_file(*data,*size);
+    return 1;
+  }
+
+  /*
+   * Split the data into pieces that end on newlines
+   */
+
+  maxchunk = (end - ptr) / PARMINCHUNK + 1;
+  if(nthread <= 0)
+    nthread = default_nthread();
+  if(nthread > MAXTHREAD)
+    nthread = MAXTHREAD;
+  if(nthread > maxchunk)
+    nthread = (int) maxchunk;
+  piece = (end - ptr) / nthread;
+
+  for(i=0,*nchunk=0; i<nthread && ptr < end; i++,(*nchunk)++) {
+    memset(chunks+i,0,sizeof(Parchunk));
+    chunks[i].start = ptr;
+    if(i == nthread - 1 || (size_t) (end - ptr) <= piece)
+      chunks[i].end = end;
+    else if(!(nl = memchr(ptr+piece,'\n',end - (ptr+piece))))
+      chunks[i].end = end;
+    else
+      chunks[i].end = nl + 1;
+    chunks[i].comment = comment;
+    chunks[i].format = format;
+    ptr = chunks[i].end;
+  }
+
+  /*
+   * Count the lines in each piece and work out where each piece starts
+   */
+
+  run_chunks(chunks,*nchunk,count_worker);
+  *ndata = 0;
+  for(i=0; i<*nchunk; i++) {
+    chunks[i].count = *ndata;
+    chunks[i].lc = lc;
+    *ndata += chunks[i].ndata;
+    lc += chunks[i].nphys;
+  }
+
+  if(*ndata == 0) {
+    fprintf(stderr,"ERROR: %s.  No valid data in input file.\n",funcname);
+    unmap_file(*data,*size);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function read_secat_par
+ *
+ * A multi-threaded version of read_secat.  The input file is mapped,
+ *  split into newline-aligned pieces, and each piece is parsed by its own
+ *  thread straight into its part of the output array, so that the row
+ *  order and the IDs given to formats without an ID column are the
+ *  same as from read_secat.  The values are identical to those from
+ *  read_secat, except that the binary cache (see write_bcat) is neither
+ *  used nor written.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         int format          flag describing format of input file
+ *                              (for up-to-date listing, see the
+ *                               secat_format function)
+ *         int nthread         number of threads (<= 0 ==> one per
+ *                              processor)
+ *
+ * Output: Secat *newdata      filled array, or NULL on error
+ *
+ */
+
+Secat *read_secat_par(char *inname, char comment, int *nlines, int format,
+		      int nthread)
+{
+  int i;                    /* Looping variable */
+  int no_error=1;           /* Flag set to 0 on error */
+  int nexp,nskip;           /* Expected columns and header lines */
+  int nchunk;               /* Number of pieces */
+  int ncols=0;              /* Number of columns in the last line */
+  size_t size;              /* Size of mapped file */
+  char *data;               /* Mapped file */
+  Parchunk chunks[MAXTHREAD]; /* Pieces of the file */
+  Secat *newdata=NULL;      /* Filled secat array */
+
+  /*
+   * Formats with their own readers (e.g., distcalc, FITS tables and
+   *  header-described catalogs) are read serially.  read_secat also
+   *  reports a format that is not valid.
+   */
+
+  if(secat_format_info(format,&nexp,&nskip))
+    return read_secat(inname,comment,nlines,format);
+
+  printf("read_secat_par: Input file: %s. Input format = %d\n",inname,
+	 format);
+
+  /*
+   * Split the file, then parse the pieces into the output array
+   */
+
+  if(split_catalog(inname,"read_secat_par",comment,format,nskip,nthread,
+		   &data,&size,chunks,&nchunk,nlines))
+    return NULL;
+
+  if(!(newdata = new_secat(*nlines)))
+    no_error = 0;
+  else {
+    for(i=0; i<nchunk; i++)
+      chunks[i].data = newdata + chunks[i].count;
+    run_chunks(chunks,nchunk,parse_worker);
+  }
+
+  /*
+   * Report the first bad line, if any
+   */
+
+  for(i=0; i<nchunk && no_error; i++) {
+    if(chunks[i].status) {
+      fprintf(stderr,
+	      "ERROR: read_secat_par.  Bad input format in %s. (line = %d)\n",
+	      inname,chunks[i].lc);
+      fprintf(stderr," File must contain at least %d columns.",nexp);
+      fprintf(stderr," --  it contained %d columns.\n",chunks[i].ncols);
+      no_error = 0;
+    }
+    else if(chunks[i].ndata > 0)
+      ncols = chunks[i].ncols;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  unmap_file(data,size);
+
+  if(no_error) {
+    printf("read_secat_par: %s has %d columns and %d lines\n",inname,
+	   ncols,*nlines);
+    return newdata;
+  }
+  else {
+    fprintf(stderr,"ERROR: read_secat_par.\n");
+    return del_secat(newdata);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function read_sdss_par
+ *
+ * A multi-threaded version of read_sdss.  See read_secat_par.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         int nthread         number of threads (<= 0 ==> one per
+ *                              processor)
+ *
+ * Output: SDSScat *newdata    filled array, or NULL on error
+ *
+ */
+
+SDSScat *read_sdss_par(char *inname, char comment, int *nlines, int nthread)
+{
+  int i;                    /* Looping variable */
+  int no_error=1;           /* Flag set to 0 on error */
+  int nchunk;               /* Number of pieces */
+  int ncols=0;              /* Number of columns in the last line */
+  size_t size;              /* Size of mapped file */
+  char *data;               /* Mapped file */
+  Parchunk chunks[MAXTHREAD]; /* Pieces of the file */
+  SDSScat *newdata=NULL;    /* Filled SDSS array */
+
+  /*
+   * Split the file, then parse the pieces into the output array
+   */
+
+  if(split_catalog(inname,"read_sdss_par",comment,-1,0,nthread,
+		   &data,&size,chunks,&nchunk,nlines))
+    return NULL;
+
+  if(!(newdata = new_sdsscat(*nlines)))
+    no_error = 0;
+  else {
+    for(i=0; i<nchunk; i++)
+      chunks[i].data = newdata + chunks[i].count;
+    run_chunks(chunks,nchunk,parse_worker);
+  }
+
+  /*
+   * Report the first bad line, if any
+   */
+
+  for(i=0; i<nchunk && no_error; i++) {
+    if(chunks[i].status) {
+      fprintf(stderr,
+	      "ERROR: read_sdss_par.  Bad input format in %s. (line = %d)\n",
+	      inname,chunks[i].lc);
+      fprintf(stderr," File must contain at least 8 columns.");
+      fprintf(stderr," --  it contained %d columns.\n",chunks[i].ncols);
+      no_error = 0;
+    }
+    else if(chunks[i].ndata > 0)
+      ncols = chunks[i].ncols;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  unmap_file(data,size);
+
+  if(no_error) {
+    printf("read_sdss_par: %s has %d columns and %d lines\n",inname,
+	   ncols,*nlines);
+    return newdata;
+  }
+  else {
+    fprintf(stderr,"ERROR: read_sdss_par.\n");
+    return del_sdsscat(newdata);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function read_secat_method
+ *
+ * Reads a secat-style catalog with the input method given by readmode.
+ *  READ_PAR reads it with read_secat_par on nthread threads, READ_MMAP
+ *  with the memory-mapped read_secat_mode, and READ_STDIO with
+ *  read_secat, so that the binary cache is still used (see write_bcat).
+ *  All three give identical values.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         int format          flag describing format of input file
+ *                              (see secat_format)
+ *         int readmode        READ_STDIO, READ_MMAP or READ_PAR
+ *         int nthread         number of threads for READ_PAR (<= 0 ==>
+ *                              one per processor)
+ *
+ * Output: Secat *newdata      filled array, or NULL on error
+ *
+ */
+
+Secat *read_secat_method(char *inname, char comment, int *nlines, 
+			 int format, int readmode, int nthread)
+{
+  switch(readmode) {
+  case READ_PAR:
+    return read_secat_par(inname,comment,nlines,format,nthread);
+  case READ_MMAP:
+    return read_secat_mode(inname,comment,nlines,format,READ_MMAP);
+  default:
+    return read_secat(inname,comment,nlines,format);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function read_sdss_method
+ *
+ * Reads a SDSS-style catalog with the input method given by readmode.
+ *  READ_PAR reads it with read_sdss_par on nthread threads; the other
+ *  methods use read_sdss.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         int format          format code passed on to read_sdss
+ *         int readmode        READ_STDIO, READ_MMAP or READ_PAR
+ *         int nthread         number of threads for READ_PAR (<= 0 ==>
+ *                              one per processor)
+ *
+ * Output: SDSScat *newdata    filled array, or NULL on error
+ *
+ */
+
+SDSScat *read_sdss_method(char *inname, char comment, int *nlines, 
+			  int format, int readmode, int nthread)
+{
+  if(readmode == READ_PAR)
+    return read_sdss_par(inname,comment,nlines,nthread);
+  else
+    return read_sdss(inname,comment,nlines,format);
+}
+
+/*.......................................................................
+ *
+ * Function write_secat_par
+ *
+ * A multi-threaded version of write_secat.  The rows are formatted in
+ *  rounds: in each round every thread formats a block of PARWRITEROWS
+ *  rows into its own memory buffer, and the buffers are then written
+ *  out in order by the calling thread.  The output is byte-for-byte the
+ *  same as from write_secat, and the memory used does not grow with the
+ *  size of the catalog.
+ *
+ * Inputs: Secat *secat        secat array
+ *         int ncat            number of catalog members
+ *         char *outname       name of output file
+ *         int format          flag describing format of output file
+ *                              (see secat_format)
+ *         int nthread         number of threads (<= 0 ==> one per
+ *                              processor)
+ *
+ * Output: int (0 or 1)        0 ==> OK.  1 ==> error.
+ *
+ */
+
+int write_secat_par(Secat *secat, int ncat, char *outname, int format,
+		    int nthread)
+{
+  int i;                    /* Looping variable */
+  int no_error=1;           /* Flag set to 0 on error */
+  int nchunk;               /* Number of pieces in a round */
+  int row;                  /* First row of the current round */
+  Parchunk chunks[MAXTHREAD]; /* Blocks of rows */
+  FILE *ofp=NULL;           /* Output file pointer */
+
+  /*
+   * Small catalogs are not worth the threads
+   */
+
+  if(nthread <= 0)
+    nthread = default_nthread();
+  if(nthread > MAXTHREAD)
+    nthread = MAXTHREAD;
+  if(nthread > ncat / PARWRITEROWS)
+    nthread = ncat / PARWRITEROWS;
+  if(nthread < 2)
+    return write_secat(secat,ncat,outname,format);
+
+  /*
+   * Open output file and set up one buffer per thread
+   */
+
+  if(!(ofp = open_writefile(outname))) {
+    fprintf(stderr,"ERROR: write_secat_par.\n");
+    return 1;
+  }
+  for(i=0; i<nthread; i++) {
+    memset(chunks+i,0,sizeof(Parchunk));
+    chunks[i].format = format;
+    if(no_error && !(chunks[i].ob = new_outbuf(NULL,OUTBUFSIZE)))
+      no_error = 0;
+  }
+
+  /*
+   * Add header for format 4 --> format 8
+   */
+
+  if(no_error && format == 4 && fputs(".\n.\n.\n",ofp) == EOF)
+    no_error = 0;
+
+  /*
+   * Format the rows a round at a time and write them out in order
+   */
+
+  for(row=0; row<ncat && no_error; ) {
+    for(nchunk=0; nchunk<nthread && row<ncat; nchunk++) {
+      chunks[nchunk].data = secat + row;
+      chunks[nchunk].ndata = (ncat - row < PARWRITEROWS) ?
+	ncat - row : PARWRITEROWS;
+      row += chunks[nchunk].ndata;
+    }
+    run_chunks(chunks,nchunk,print_worker);
+    for(i=0; i<nchunk && no_error; i++) {
+      if(chunks[i].status)
+	no_error = 0;
+      else if(fwrite(chunks[i].ob->buf,1,chunks[i].ob->used,ofp) !=
+	      chunks[i].ob->used) {
+	fprintf(stderr,"ERROR: write_secat_par.  Could not write output.\n");
+	no_error = 0;
+      }
+    }
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  for(i=0; i<nthread; i++)
+    if(chunks[i].ob)
+      del_outbuf(chunks[i].ob);
+  if(fclose(ofp) == EOF)
+    no_error = 0;
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: write_secat_par.\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * The state shared by the threads of sky_match_par, and the results for
+ *  one block of PARMATCHROWS sources.  The threads take the blocks in
+ *  turn, and each block is written by one thread only, so the results do
+ *  not depend on which thread did which block.
+ */
+
+typedef struct {
+  int nmatch;        /* Number of matches in the block */
+  int nalloc;        /* Number of elements allocated in match */
+  Skymatch *match;   /* Matches of the sources in the block */
+} Matchblock;
+
+typedef struct {
+  Kdtree *tree;      /* Sky tree of the reference catalog, or NULL */
+  Skyzones *zones;   /* Zones of the reference catalog, used if no tree */
+  double *refvec;    /* Unit vectors of the reference catalog */
+  double *refrad;    /* RAs then Decs of the reference catalog in radians */
+  int nref;          /* Number of members in the reference catalog */
+  Secat *srccat;     /* Catalog of sources to be matched */
+  double *srcvec;    /* Unit vectors of the sources */
+  int nsrc;          /* Number of sources */
+  double radius;     /* Match radius in arcsec */
+  double cosmin;     /* Dot product threshold for the radius */
+  int *count;        /* Number of matches of each source */
+  Matchblock *block; /* Results for each block */
+  int nblock;        /* Number of blocks */
+  int next;          /* Next block to be taken */
+  int status;        /* 0 ==> OK, 1 ==> error */
+  pthread_mutex_t lock; /* Guards next and status */
+} Matchpool;
+
+/*.......................................................................
+ *
+ * Function skymatchcmp
+ *
+ * Compares two Skymatch structures by offset and then by index, so that
+ *  the order of a source's matches does not depend on the sort.  Called
+ *  by qsort in match_block.
+ *
+ */
+
+static int skymatchcmp(const void *v1, const void *v2)
+{
+  const Skymatch *m1 = (const Skymatch *) v1;
+  const Skymatch *m2 = (const Skymatch *) v2;
+
+  if(m1->dpos < m2->dpos)
+    return -1;
+  else if(m1->dpos > m2->dpos)
+    return 1;
+  else
+    return (m1->index > m2->index) - (m1->index < m2->index);
+}
+
+/*.......................................................................
+ *
+ * Function match_block
+ *
+ * Finds the matches of the sources in one block for sky_match_par.  The 
+ *  candidates come from a cone search of the reference index, are 
+ *  checked with a dot product of the unit vectors, and are then accepted
+ *  if their offset from rad2xy is within the radius.
+ *
+ * Inputs: Matchpool *pool     shared state
+ *         int iblock          block number
+ *         int **cand          candidate list (grown by this function)
+ *         int *candalloc      number of elements allocated in *cand
+ *         double **candrad    candidate positions and offsets (grown by
+ *                              this function)
+ *         int *cralloc        number of elements allocated in *candrad
+ *
+ * Output: int (0 or 1)        0 ==> OK.  1 ==> error.
+ *
+ */
+
+static int match_block(Matchpool *pool, int iblock, int **cand, 
+		       int *candalloc, double **candrad, int *cralloc)
+{
+  int j,c;                  /* Looping variables */
+  int jend;                 /* End of the block */
+  int ncand;                /* Number of candidates */
+  int naccept;              /* Number of candidates passing the dot product */
+  int nmatch0;              /* Number of matches of one source */
+  double alpha0,delta0;     /* Source position in radians */
+  double tmpd;              /* Offset */
+  double *vec0,*vec1;       /* Unit vectors of a candidate pair */
+  double *cx,*cy;           /* Candidate offsets, in *candrad */
+  Matchblock *blk = pool->block + iblock; /* Results for this block */
+
+  jend = (iblock + 1) * PARMATCHROWS;
+  if(jend > pool->nsrc)
+    jend = pool->nsrc;
+
+  for(j=iblock*PARMATCHROWS; j<jend; j++) {
+    vec0 = pool->srcvec + 3*j;
+    if(pool->tree)
+      ncand = sky_cone(pool->tree,vec0,pool->radius,cand,candalloc);
+    else
+      ncand = zone_cone(pool->zones,vec0,pool->radius,cand,candalloc);
+    if(ncand < 0)
+      return 1;
+    for(c=0,naccept=0; c<ncand; c++) {
+      vec1 = pool->refvec + 3*(*cand)[c];
+      if(vec0[0] * vec1[0] + vec0[1] * vec1[1] + vec0[2] * vec1[2] > 
+	 pool->cosmin)
+	(*cand)[naccept++] = (*cand)[c];
+    }
+    ncand = naccept;
+
+    pool->count[j] = 0;
+    if(ncand == 0)
+      continue;
+
+    /*
+     * Compute the offsets of the candidates and keep those in the radius
+     */
+
+    if(!(*candrad = (double *) grow_array(*candrad,cralloc,4*ncand,
+					  sizeof(double))))
+      return 1;
+    if(!(blk->match = (Skymatch *) grow_array(blk->match,&blk->nalloc,
+					      blk->nmatch+ncand,
+					      sizeof(Skymatch))))
+      return 1;
+    cx = *candrad + 2*ncand;
+    cy = *candrad + 3*ncand;
+    for(c=0; c<ncand; c++) {
+      (*candrad)[c] = pool->refrad[(*cand)[c]];
+      (*candrad)[ncand+c] = pool->refrad[pool->nref+(*cand)[c]];
+    }
+    spos2rad(pool->srccat[j].skypos,&alpha0,&delta0);
+    rad2xy(alpha0,delta0,*candrad,*candrad+ncand,ncand,cx,cy);
+    nmatch0 = 0;
+    for(c=0; c<ncand; c++) {
+      if((tmpd = sqrt(cx[c] * cx[c] + cy[c] * cy[c])) < pool->radius) {
+	blk->match[blk->nmatch+nmatch0].index = (*cand)[c];
+	blk->match[blk->nmatch+nmatch0].dpos = tmpd;
+	nmatch0++;
+      }
+    }
+    if(nmatch0 > 1)
+      qsort(blk->match+blk->nmatch,nmatch0,sizeof(Skymatch),skymatchcmp);
+    blk->nmatch += nmatch0;
+    pool->count[j] = nmatch0;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function match_worker
+ *
+ * Thread body for sky_match_par.  Takes blocks of sources until there 
+ *  are none left or some thread has failed.
+ *
+ * Inputs: void *arg           the Matchpool
+ *
+ * Output: NULL
+ *
+ */
+
+static void *match_worker(void *arg)
+{
+  int iblock;               /* Block being matched */
+  int status=0;             /* 0 ==> OK, 1 ==> error */
+  int ncandalloc=0;         /* Number of elements allocated in cand */
+  int cralloc=0;            /* Number of elements allocated in candrad */
+  int *cand=NULL;           /* Candidate list */
+  double *candrad=NULL;     /* Candidate positions and offsets */
+  Matchpool *pool = (Matchpool *) arg;
+
+  while(1) {
+    pthread_mutex_lock(&pool->lock);
+    if(status)
+      pool->status = 1;
+    iblock = (pool->status) ? pool->nblock : pool->next++;
+    pthread_mutex_unlock(&pool->lock);
+    if(iblock >= pool->nblock)
+      break;
+    status = match_block(pool,iblock,&cand,&ncandalloc,&candrad,&cralloc);
+  }
+
+  if(cand)
+    free(cand);
+  if(candrad)
+    free(candrad);
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function sky_match_par
+ *
+ * Finds, for each source in one catalog, all the members of a reference
+ *  catalog whose dspos2xy offset from the source is less than radius
+ *  arcsec, using several threads.  The reference catalog has been 
+ *  indexed with new_skytree or new_skyzones, and is only read.  The 
+ *  matches of each source are returned in order of increasing offset,
+ *  with ties in order of reference index, so the results are the same 
+ *  for any number of threads.  
+ *
+ * Inputs: Kdtree *tree        sky tree of the reference catalog, or NULL
+ *         Skyzones *zones     zones of the reference catalog, used if
+ *                              tree is NULL
+ *         double *refvec      unit vectors of the reference catalog (see
+ *                              secat2vec)
+ *         double *refrad      RAs of the reference catalog in radians,
+ *                              followed by the Decs (2*nref elements)
+ *         int nref            number of members in the reference catalog
+ *         Secat *srccat       catalog of sources to be matched
+ *         double *srcvec      unit vectors of the sources
+ *         int nsrc            number of sources
+ *         double radius       match radius in arcsec
+ *         int nthread         number of threads (<= 0 ==> one per
+ *                              processor)
+ *
+ * Output: Matchlist *matches  matches of the sources, NULL on error
+ *
+ */
+
+Matchlist *sky_match_par(Kdtree *tree, Skyzones *zones, double *refvec, 
+			double *refrad, int nref, Secat *srccat, 
+			double *srcvec, int nsrc, double radius, int nthread)
+{
+  int i,j;                  /* Looping variables */
+  int no_error=1;           /* Flag set to 0 on error */
+  int started[MAXTHREAD];   /* Flag set to 1 if a thread was started */
+  pthread_t tid[MAXTHREAD]; /* Thread IDs */
+  Matchpool pool;           /* Shared state */
+  Matchlist *matches;       /* Matches of all the sources */
+
+  if(!(matches = (Matchlist *) malloc(sizeof(Matchlist)))) {
+    fprintf(stderr,"ERROR: sky_match_par.  Insufficient memory.\n");
+    return NULL;
+  }
+  matches->nsrc = nsrc;
+  matches->match = NULL;
+
+  pool.tree = tree;
+  pool.zones = zones;
+  pool.refvec = refvec;
+  pool.refrad = refrad;
+  pool.nref = nref;
+  pool.srccat = srccat;
+  pool.srcvec = srcvec;
+  pool.nsrc = nsrc;
+  pool.radius = radius;
+  pool.cosmin = offset2cos(radius);
+  pool.nblock = (nsrc + PARMATCHROWS - 1) / PARMATCHROWS;
+  pool.next = 0;
+  pool.status = 0;
+  matches->first = (int *) malloc((nsrc + 1) * sizeof(int));
+  pool.count = matches->first + 1;
+  pool.block = (Matchblock *) calloc((pool.nblock > 0) ? pool.nblock : 1,
+				     sizeof(Matchblock));
+  if(!matches->first || !pool.block) {
+    fprintf(stderr,"ERROR: sky_match_par.  Insufficient memory.\n");
+    if(pool.block)
+      free(pool.block);
+    return del_matchlist(matches);
+  }
+
+  /*
+   * Match the blocks of sources, in the calling thread and nthread-1 
+   *  others
+   */
+
+  if(nthread <= 0)
+    nthread = default_nthread();
+  if(nthread > MAXTHREAD)
+    nthread = MAXTHREAD;
+  if(nthread > pool.nblock)
+    nthread = pool.nblock;
+  pthread_mutex_init(&pool.lock,NULL);
+  for(i=0; i<nthread-1; i++)
+    started[i] = (pthread_create(&tid[i],NULL,match_worker,&pool) == 0);
+  match_worker(&pool);
+  for(i=0; i<nthread-1; i++)
+    if(started[i])
+      pthread_join(tid[i],NULL);
+  pthread_mutex_destroy(&pool.lock);
+  if(pool.status)
+    no_error = 0;
+
+  /*
+   * Put the blocks together in order
+   */
+
+  if(no_error) {
+    matches->first[0] = 0;
+    for(j=0; j<nsrc; j++)
+      matches->first[j+1] += matches->first[j];
+    if(!(matches->match = (Skymatch *) 
+	 malloc((matches->first[nsrc] + 1) * sizeof(Skymatch)))) {
+      fprintf(stderr,"ERROR: sky_match_par.  Insufficient memory.\n");
+      no_error = 0;
+    }
+  }
+  for(i=0,j=0; i<pool.nblock; i++) {
+    if(no_error) {
+      memcpy(matches->match+j,pool.block[i].match,
+	     pool.block[i].nmatch * sizeof(Skymatch));
+      j += pool.block[i].nmatch;
+    }
+    if(pool.block[i].match)
+      free(pool.block[i].match);
+  }
+  free(pool.block);
+
+  if(no_error)
+    return matches;
+  else {
+    fprintf(stderr,"ERROR: sky_match_par.\n");
+    return del_matchlist(matches);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function del_matchlist
+ *
+ * Frees a Matchlist.
+ *
+ * Inputs: Matchlist *matches  matches to be freed
+ *
+ * Output: NULL
+ *
+ */
+
+Matchlist *del_matchlist(Matchlist *matches)
+{
+  if(matches) {
+    if(matches->first)
+      free(matches->first);
+    if(matches->match)
+      free(matches->match);
+    free(matches);
+  }
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * The piece of an array of sort keys handled by one thread in 
+ *  radix_index_par.  Each pass counts the digits in every piece, and 
+ *  the calling thread then turns the counts into the place where each 
+ *  piece puts its first key with each digit.  Since the pieces are in 
+ *  order, the sort is stable and the result is the same as for 
+ *  radix_index.
+ */
+
+typedef struct {
+  int lo;            /* First key of the piece */
+  int hi;            /* One past the last key of the piece */
+  int shift;         /* Position of the current digit */
+  double *key;       /* Sort keys */
+  unsigned long long *bits;  /* Keys being sorted */
+  unsigned long long *btmp;  /* Scatter space for bits */
+  int *index;        /* Indices being sorted */
+  int *itmp;         /* Scatter space for index */
+  int count[1<<RADIXBITS];  /* Keys with each digit, then their offsets */
+} Radixchunk;
+
+/*.......................................................................
+ *
+ * Functions encode_worker, digit_worker and scatter_worker
+ *
+ * Thread bodies for radix_index_par.  The first sets up the keys and
+ *  indices of a piece, the second counts the keys in the piece with each
+ *  value of the current digit, and the third moves them to their places
+ *  for this pass.
+ *
+ * Inputs: void *arg           the Radixchunk for this thread
+ *
+ * Output: NULL
+ *
+ */
+
+static void *encode_worker(void *arg)
+{
+  int i;                    /* Looping variable */
+  Radixchunk *chunk = (Radixchunk *) arg;
+
+  for(i=chunk->lo; i<chunk->hi; i++) {
+    chunk->bits[i] = radix_bits(chunk->key[i]);
+    chunk->index[i] = i;
+  }
+  return NULL;
+}
+
+static void *digit_worker(void *arg)
+{
+  int i;                    /* Looping variable */
+  unsigned long long mask = (1ULL << RADIXBITS) - 1;  /* Digit mask */
+  Radixchunk *chunk = (Radixchunk *) arg;
+
+  memset(chunk->count,0,sizeof(chunk->count));
+  for(i=chunk->lo; i<chunk->hi; i++)
+    chunk->count[(chunk->bits[i] >> chunk->shift) & mask]++;
+  return NULL;
+}
+
+static void *scatter_worker(void *arg)
+{
+  int i,b;                  /* Looping variables */
+  unsigned long long mask = (1ULL << RADIXBITS) - 1;  /* Digit mask */
+  Radixchunk *chunk = (Radixchunk *) arg;
+
+  for(i=chunk->lo; i<chunk->hi; i++) {
+    b = chunk->count[(chunk->bits[i] >> chunk->shift) & mask]++;
+    chunk->btmp[b] = chunk->bits[i];
+    chunk->itmp[b] = chunk->index[i];
+  }
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function run_radix
+ *
+ * The same as run_chunks, but for the pieces of radix_index_par.
+ *
+ * Inputs: Radixchunk *chunks  pieces
+ *         int nchunk          number of pieces
+ *         void *(*worker)(void *)  thread body
+ *
+ * Output: (none)
+ *
+ */
+
+static void run_radix(Radixchunk *chunks, int nchunk, 
+		      void *(*worker)(void *))
+{
+  int i;                    /* Looping variable */
+  int started[MAXTHREAD];   /* Flag set to 1 if a thread was started */
+  pthread_t tid[MAXTHREAD]; /* Thread IDs */
+
+  for(i=0; i<nchunk-1; i++)
+    started[i] = (pthread_create(&tid[i],NULL,worker,chunks+i) == 0);
+  worker(chunks+nchunk-1);
+  for(i=0; i<nchunk-1; i++) {
+    if(started[i])
+      pthread_join(tid[i],NULL);
+    else
+      worker(chunks+i);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function radix_index_par
+ *
+ * A multi-threaded version of radix_index in catlib.c.  The keys are 
+ *  split into one piece per thread, and each pass of the sort counts 
+ *  and then moves the keys of all the pieces at once.  The returned
+ *  order is the same as from radix_index, i.e., equal keys stay in 
+ *  their original order, for any number of threads.  Fewer than 
+ *  PARSORTROWS keys per thread are not worth a thread.
+ *
+ * Inputs: double *key         sort keys
+ *         int n               number of keys
+ *         int nthread         number of threads (<= 0 ==> default_nthread)
+ *
+ * Output: int *index          order of the keys, NULL on error
+ *
+ */
+
+int *radix_index_par(double *key, int n, int nthread)
+{
+  int i,b,t;                /* Looping variables */
+  int nchunk;               /* Number of pieces */
+  int shift;                /* Position of the current digit */
+  int offset;               /* Running position in the output */
+  int *index=NULL;          /* Order of the keys */
+  int *itmp=NULL;           /* Scatter space for index */
+  int *iswap;               /* Used to swap index and itmp */
+  unsigned long long *bits=NULL;  /* Keys being sorted */
+  unsigned long long *btmp=NULL;  /* Scatter space for bits */
+  unsigned long long *bswap;      /* Used to swap bits and btmp */
+  Radixchunk *chunks=NULL;  /* Pieces */
+
+  /*
+   * Choose the number of pieces
+   */
+
+  if(nthread <= 0)
+    nthread = default_nthread();
+  if(nthread > MAXTHREAD)
+    nthread = MAXTHREAD;
+  nchunk = n / PARSORTROWS;
+  if(nchunk > nthread)
+    nchunk = nthread;
+  if(nchunk < 2)
+    return radix_index(key,n);
+
+  index = (int *) malloc((n + 1) * sizeof(int));
+  itmp = (int *) malloc((n + 1) * sizeof(int));
+  bits = (unsigned long long *) malloc((n + 1) * sizeof(unsigned long long));
+  btmp = (unsigned long long *) malloc((n + 1) * sizeof(unsigned long long));
+  chunks = (Radixchunk *) malloc(nchunk * sizeof(Radixchunk));
+  if(!index || !itmp || !bits || !btmp || !chunks) {
+    fprintf(stderr,"ERROR: radix_index_par.  Insufficient memory.\n");
+    free(index);
+    free(itmp);
+    free(bits);
+    free(btmp);
+    free(chunks);
+    return NULL;
+  }
+
+  for(t=0; t<nchunk; t++) {
+    chunks[t].lo = (int) ((long) n * t / nchunk);
+    chunks[t].hi = (int) ((long) n * (t + 1) / nchunk);
+    chunks[t].key = key;
+  }
+
+  /*
+   * Sort one digit at a time, starting with the least significant
+   */
+
+  for(t=0; t<nchunk; t++) {
+    chunks[t].bits = bits;
+    chunks[t].index = index;
+  }
+  run_radix(chunks,nchunk,encode_worker);
+
+  for(shift=0; shift<64; shift+=RADIXBITS) {
+    for(t=0; t<nchunk; t++) {
+      chunks[t].shift = shift;
+      chunks[t].bits = bits;
+      chunks[t].btmp = btmp;
+      chunks[t].index = index;
+      chunks[t].itmp = itmp;
+    }
+    run_radix(chunks,nchunk,digit_worker);
+
+    /*
+     * Skip the pass if all keys have the same digit, otherwise find
+     *  where each piece starts putting the keys with each digit
+     */
+
+    for(b=0; b<(1<<RADIXBITS); b++) {
+      for(t=0,i=0; t<nchunk; t++)
+	i += chunks[t].count[b];
+      if(i == n)
+	break;
+    }
+    if(b < (1<<RADIXBITS))
+      continue;
+    for(b=0,offset=0; b<(1<<RADIXBITS); b++)
+      for(t=0; t<nchunk; t++) {
+	i = chunks[t].count[b];
+	chunks[t].count[b] = offset;
+	offset += i;
+      }
+
+    run_radix(chunks,nchunk,scatter_worker);
+    bswap = bits;
+    bits = btmp;
+    btmp = bswap;
+    iswap = index;
+    index = itmp;
+    itmp = iswap;
+  }
+
+  free(itmp);
+  free(bits);
+  free(btmp);
+  free(chunks);
+  return index;
+}
+
+/*.......................................................................
+ *
+ * Function sort_secat_key_par
+ *
+ * A multi-threaded version of sort_secat_key, which finds the new order
+ *  of the rows with radix_index_par.  The order is the same as from 
+ *  sort_secat_key for any number of threads.
+ *
+ * Inputs: Secat *secat        catalog
+ *         int ncat            number of members in secat
+ *         int sortkey         SORT_DPOS, SORT_MTOT or SORT_ALPHA
+ *         int nthread         number of threads (<= 0 ==> default_nthread)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int sort_secat_key_par(Secat *secat, int ncat, int sortkey, int nthread)
+{
+  int no_error=1;         /* Flag set to 0 on error */
+  int *index=NULL;        /* New order of the rows */
+  double *key=NULL;       /* Sort keys */
+
+  if(!(key = secat_sortkeys(secat,ncat,sortkey)))
+    no_error = 0;
+  if(no_error)
+    if(!(index = radix_index_par(key,ncat,nthread)))
+      no_error = 0;
+  if(no_error)
+    if(permute_secat(secat,index,ncat))
+      no_error = 0;
+
+  free(key);
+  free(index);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: sort_secat_key_par\n");
+    return 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function sort_sdss_key_par
+ *
+ * The same as sort_secat_key_par, but for a SDSScat array.
+ *
+ * Inputs: SDSScat *scat       catalog
+ *         int ncat            number of members in scat
+ *         int sortkey         SORT_DPOS, SORT_MTOT or SORT_ALPHA
+ *         int nthread         number of threads (<= 0 ==> default_nthread)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int sort_sdss_key_par(SDSScat *scat, int ncat, int sortkey, int nthread)
+{
+  int no_error=1;         /* Flag set to 0 on error */
+  int *index=NULL;        /* New order of the rows */
+  double *key=NULL;       /* Sort keys */
+
+  if(!(key = sdss_sortkeys(scat,ncat,sortkey)))
+    no_error = 0;
+  if(no_error)
+    if(!(index = radix_index_par(key,ncat,nthread)))
+      no_error = 0;
+  if(no_error)
+    if(permute_sdss(scat,index,ncat))
+      no_error = 0;
+
+  free(key);
+  free(index);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: sort_sdss_key_par\n");
+    return 1;
+  }
+}
@@ -0,0 +1,43 @@
+#ifndef catpar_h
+#define catpar_h
+
+#include "structdef.h"
+#include "catlib.h"
+
+#define MAXTHREAD 64         /* Maximum number of worker threads */
+#define PARMINCHUNK 1048576  /* Smallest piece of a file given to a thread */
+#define PARWRITEROWS 16384   /* Rows formatted by a thread at a time */
+#define PARMATCHROWS 1024    /* Sources matched by a thread at a time */
+#define PARSORTROWS 65536    /* Fewest keys sorted by a thread */
+
+typedef struct {
+  int index;         /* Reference catalog index of the matched member */
+  double dpos;       /* Offset between the pair in arcsec */
+} Skymatch;          /* One match found by sky_match_par */
+
+typedef struct {
+  int nsrc;          /* Number of sources */
+  int *first;        /* Position in match of the first match of each
+			 source (nsrc+1 elements) */
+  Skymatch *match;   /* Matches, by source and then by increasing offset */
+} Matchlist;         /* Matches of a catalog (see sky_match_par) */
+
+Secat *read_secat_par(char *inname, char comment, int *nlines, int format,
+		      int nthread);
+SDSScat *read_sdss_par(char *inname, char comment, int *nlines, int nthread);
+Secat *read_secat_method(char *inname, char comment, int *nlines, 
+			 int format, int readmode, int nthread);
+SDSScat *read_sdss_method(char *inname, char comment, int *nlines, 
+			  int format, int readmode, int nthread);
+int write_secat_par(Secat *secat, int ncat, char *outname, int format,
+		    int nthread);
+int default_nthread();
+Matchlist *sky_match_par(Kdtree *tree, Skyzones *zones, double *refvec, 
+			double *refrad, int nref, Secat *srccat, 
+			double *srcvec, int nsrc, double radius, int nthread);
+Matchlist *del_matchlist(Matchlist *matches);
+int *radix_index_par(double *key, int n, int nthread);
+int sort_secat_key_par(Secat *secat, int ncat, int sortkey, int nthread);
+int sort_sdss_key_par(SDSScat *scat, int ncat, int sortkey, int nthread);
+
+#endif
@@ -22,11 +22,23 @@
  *                                  offsets from a central position.
  * v24Jan2009 CDF, Fixed a bug in secat2offset
  * v20Mar2013 CDF, Fixed a bug in rad2offset
+ * v16Oct2026 AGT, Added spos2vec, to convert a sky position to a unit vector
+ *                 Added rad2xy, a batched version of dspos2xy that works on
+ *                  arrays of positions in radians
+ *                 Added secat2vec and offset2cos, so that separation tests
+ *                  can be made with dot products of cached unit vectors
+ *                 Added parse_hms, format_ra, format_dec, parse_hms_array
+ *                  and format_hms_array, to read and write sexagesimal
+ *                  positions without going through a Skypos
+ *                 Offsets are now Lpos rather than Pos, so that arrays of
+ *                  them (e.g., from dspos2xy) no longer carry a MAXC label
+ *                  for every point.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
 #include <string.h>
 #include "structdef.h"
 #include "coords.h"
@@ -130,7 +142,7 @@ Pos read_skypos()
  *
  * Inputs: float r             radial distance from center IN ARCSEC
  *         float theta         position angle IN DEGREES
- *         Pos *pos            position in (x,y) (set by this function)
+ *         Lpos *pos           position in (x,y) (set by this function)
  *         int isastro         flag set to 1 if using astronomical conventions,
  *                              i.e., with the angle measured from N through E,
  *                              and with the E-W axis flipped.
@@ -139,7 +151,7 @@ Pos read_skypos()
  *
  */
 
-void rth2xy(double r, double theta, Pos *pos, int isastro)
+void rth2xy(double r, double theta, Lpos *pos, int isastro)
 {
   /*
    * Convert theta to radians
@@ -172,7 +184,7 @@ void rth2xy(double r, double theta, Pos *pos, int isastro)
  *
  * Converts a postion in (x,y) to a position in r and theta 
  *
- * Inputs: Pos pos             position in (x,y) 
+ * Inputs: Lpos pos            position in (x,y) 
  *         double *r           radial distance from center IN ARCSEC (set
  *                               by this function)
  *         double *theta       position angle IN DEGREES (set by function)
@@ -184,7 +196,7 @@ void rth2xy(double r, double theta, Pos *pos, int isastro)
  *
  */
 
-void xy2rth(Pos pos, double *r, double *theta, int isastro)
+void xy2rth(Lpos pos, double *r, double *theta, int isastro)
 {
   *r = sqrt(pos.x * pos.x + pos.y * pos.y);
 
@@ -255,6 +267,94 @@ void spos2rad(Skypos spos, double *alpha, double *delta)
     *delta = PI * (spos.deg + spos.amin/60.0 + spos.asec/3600.0)/180.0;
 }
 
+/*.......................................................................
+ *
+ * Function spos2vec
+ *
+ * Converts a sky position (RA,Dec) into a unit vector, with the x axis
+ *  towards (0h,0d), the y axis towards (6h,0d) and the z axis towards the
+ *  north pole.
+ *
+ * Inputs: Skypos spos         sky position
+ *         double *vec         unit vector, 3 elements (set by this 
+ *                              function)
+ *
+ * Output: None
+ *
+ */
+
+void spos2vec(Skypos spos, double *vec)
+{
+  double alpha,delta;    /* Position in radians */
+
+  spos2rad(spos,&alpha,&delta);
+  vec[0] = cos(delta) * cos(alpha);
+  vec[1] = cos(delta) * sin(alpha);
+  vec[2] = sin(delta);
+}
+
+/*.......................................................................
+ *
+ * Function secat2vec
+ *
+ * Converts the sky positions of the members of a catalog into unit vectors
+ *  (see spos2vec), to be computed once when the catalog is loaded rather
+ *  than for every comparison.  The vector for member i is in elements
+ *  3i to 3i+2 of the returned array.
+ *
+ * Inputs: Secat *secat        catalog
+ *         int ncat            number of members in secat
+ *
+ * Output: double *vec         unit vectors, NULL on error
+ *
+ */
+
+double *secat2vec(Secat *secat, int ncat)
+{
+  int i;                 /* Looping variable */
+  double *vec;           /* Unit vectors */
+
+  if(!(vec = (double *) malloc(3 * (ncat > 0 ? ncat : 1) * sizeof(double)))) {
+    fprintf(stderr,"ERROR: secat2vec.  Insufficient memory.\n");
+    return NULL;
+  }
+
+  for(i=0; i<ncat; i++)
+    spos2vec(secat[i].skypos,vec+3*i);
+
+  return vec;
+}
+
+/*.......................................................................
+ *
+ * Function offset2cos
+ *
+ * Returns the threshold on the dot product of two unit vectors for the
+ *  offset between them (see dspos2xy) to be less than radius arcsec.
+ *  The SIN-projection offset is sin(theta) for an angle theta, so pairs
+ *  are within the radius when cos(theta) > cos(asin(radius)).  The
+ *  threshold is lowered by a few rounding errors, so that no pair within
+ *  the radius is rejected; the exact offsets of the accepted pairs should
+ *  still be checked.  As with the other matching functions, only pairs in 
+ *  the same hemisphere are accepted.
+ *
+ * Inputs: double radius       offset in arcsec
+ *
+ * Output: double cosmin       dot product threshold
+ *
+ */
+
+double offset2cos(double radius)
+{
+  double r;              /* Radius in radians */
+
+  r = radius * PI / (180.0 * 3600.0);
+  if(r >= 1.0)
+    return -4.0 * DBL_EPSILON;
+  else
+    return sqrt(1.0 - r * r) - 4.0 * DBL_EPSILON;
+}
+
 /*.......................................................................
  *
  * Function rad2spos
@@ -375,6 +475,377 @@ void deg2spos(double alphdeg, double deltdeg, Skypos *spos)
   }
 }
 
+/*.......................................................................
+ *
+ * Function sexa_field
+ *
+ * Reads one unsigned sexagesimal field (e.g., "12" or "34.5678") from a
+ *  string.  The digits are collected into an integer and divided by a 
+ *  power of ten, which gives the correctly rounded value (the same as
+ *  strtod) without any of the locale and format handling of the library
+ *  functions.  Fields with too many digits for that are passed to strtod.
+ *
+ * Inputs: char **s            string (advanced past the field)
+ *         double *val         value (set by this function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> no digits found
+ *
+ */
+
+static int sexa_field(char **s, double *val)
+{
+  int ndig=0;               /* Number of digits */
+  int nfrac=0;              /* Number of digits after the decimal point */
+  unsigned long long mant=0;  /* Digits as an integer */
+  char *start = *s;         /* Start of the field */
+  char *p = *s;             /* Pointer to navigate the string */
+  static const double pow10[] = {1.0,1.0e1,1.0e2,1.0e3,1.0e4,1.0e5,1.0e6,
+				 1.0e7,1.0e8,1.0e9,1.0e10,1.0e11,1.0e12,
+				 1.0e13,1.0e14,1.0e15};
+
+  for(; *p >= '0' && *p <= '9'; p++,ndig++)
+    mant = 10 * mant + (*p - '0');
+  if(*p == '.')
+    for(p++; *p >= '0' && *p <= '9'; p++,ndig++,nfrac++)
+      mant = 10 * mant + (*p - '0');
+  if(ndig == 0)
+    return 1;
+
+  if(ndig <= 15)
+    *val = (double) mant / pow10[nfrac];
+  else
+    *val = strtod(start,NULL);
+  *s = p;
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function sexa_sep
+ *
+ * Skips the separator between two sexagesimal fields, i.e., any spaces 
+ *  and tabs, and at most one colon.  
+ *
+ * Inputs: char **s            string (advanced past the separator)
+ *         int colon           1 ==> a colon may be part of the separator
+ *
+ * Output: (none)
+ *
+ */
+
+static void sexa_sep(char **s, int colon)
+{
+  char *p = *s;             /* Pointer to navigate the string */
+
+  while(*p == ' ' || *p == '\t')
+    p++;
+  if(colon && *p == ':')
+    for(p++; *p == ' ' || *p == '\t'; p++);
+  *s = p;
+}
+
+/*.......................................................................
+ *
+ * Function parse_hms
+ *
+ * Reads a position in the form "hh mm ss.sss +dd mm ss.ss" from a string
+ *  and converts it to decimal degrees, as spos2deg would.  The fields may
+ *  also be separated by colons, and the sign of the Dec is taken from 
+ *  the string, so that Decs between 0 and -1 degrees keep their sign.
+ *  Unlike sscanf into a Skypos, no label is filled, so this can be used
+ *  on large files of positions (see also parse_hms_array).
+ *
+ * Inputs: char *s             string
+ *         double *alphadeg    RA in degrees (set by this function)
+ *         double *deltadeg    Dec in degrees (set by this function)
+ *         char **end          first character after the position (set by
+ *                              this function, if not NULL)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> bad format
+ *
+ */
+
+int parse_hms(char *s, double *alphadeg, double *deltadeg, char **end)
+{
+  int i;                    /* Looping variable */
+  int negative=0;           /* Flag set to 1 for a negative Dec */
+  double val[6];            /* Fields */
+
+  sexa_sep(&s,0);
+  for(i=0; i<6; i++) {
+    if(i == 3) {
+      sexa_sep(&s,0);
+      if(*s == '-' || *s == '+') {
+	negative = (*s == '-');
+	s++;
+      }
+    }
+    else if(i > 0)
+      sexa_sep(&s,1);
+    if(sexa_field(&s,val+i))
+      return 1;
+  }
+
+  *alphadeg = 15.0 * (val[0] + val[1]/60.0 + val[2]/3600.0);
+  if(negative)
+    *deltadeg = -val[3] - val[4]/60.0 - val[5]/3600.0;
+  else
+    *deltadeg = val[3] + val[4]/60.0 + val[5]/3600.0;
+  if(end)
+    *end = s;
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function sexa_digits
+ *
+ * Writes a non-negative integer with exactly ndig digits, padded with 
+ *  zeros.
+ *
+ * Inputs: char *buf           output string
+ *         long long val       value
+ *         int ndig            number of digits
+ *
+ * Output: char *end           position after the digits
+ *
+ */
+
+static char *sexa_digits(char *buf, long long val, int ndig)
+{
+  int i;                    /* Looping variable */
+
+  for(i=ndig-1; i>=0; i--) {
+    buf[i] = '0' + (char) (val % 10);
+    val /= 10;
+  }
+  return buf + ndig;
+}
+
+/*.......................................................................
+ *
+ * Function sexa_write
+ *
+ * Writes a number of units of 10^-prec seconds in the form 
+ *  dd[sep]mm[sep]ss.sss, for format_ra and format_dec.
+ *
+ * Inputs: char *buf           output string
+ *         long long units     value, in units of 10^-prec seconds
+ *         long long scale     10^prec
+ *         char sep            field separator
+ *         int prec            number of decimal places of the seconds
+ *
+ * Output: char *end           position after the last character written
+ *
+ */
+
+static char *sexa_write(char *buf, long long units, long long scale, 
+			char sep, int prec)
+{
+  long long secs;           /* Whole seconds */
+
+  secs = units / scale;
+  buf = sexa_digits(buf,secs/3600,2);
+  *buf++ = sep;
+  buf = sexa_digits(buf,(secs/60)%60,2);
+  *buf++ = sep;
+  buf = sexa_digits(buf,secs%60,2);
+  if(prec > 0) {
+    *buf++ = '.';
+    buf = sexa_digits(buf,units%scale,prec);
+  }
+  *buf = '\0';
+  return buf;
+}
+
+/*.......................................................................
+ *
+ * Function sexa_round
+ *
+ * Returns x*k rounded to the nearest integer, with ties going to the 
+ *  even integer as in printf, for x >= 0 and an integer k.  The rounding
+ *  error of the product is found with fma, so the result is that of the
+ *  exact product rather than of the rounded one.
+ *
+ * Inputs: double x            value
+ *         double k            integer scale factor
+ *
+ * Output: long long n         rounded product
+ *
+ */
+
+static long long sexa_round(double x, double k)
+{
+  double p;                 /* Rounded product */
+  double err;               /* Rounding error of p */
+  double r;                 /* Integer part of p */
+  double frac;              /* Fractional part of the exact product */
+  long long n;              /* Rounded product */
+
+  p = x * k;
+  err = fma(x,k,-p);
+  r = floor(p);
+  frac = (p - r) + err;
+  n = (long long) r;
+  if(frac > 0.5 || (frac == 0.5 && (n % 2)))
+    n++;
+  else if(frac < 0.0 && frac + 1.0 < 0.5)
+    n--;
+  return n;
+}
+
+/*.......................................................................
+ *
+ * Function format_ra
+ *
+ * Writes an RA in decimal degrees as hh[sep]mm[sep]ss.ssss, i.e., the
+ *  same as printf with "%02d %02d %07.4f" for prec=4.  The RA is rounded
+ *  once, to the last digit printed, and the carry is passed up to the
+ *  minutes and hours, so the seconds can never be printed as 60.  The
+ *  rounding is that of the exact value, as in printf (see sexa_round).
+ *  The RA is wrapped into 0-24 hours.
+ *
+ * Inputs: double alphadeg     RA in degrees
+ *         char sep            field separator (e.g., ' ' or ':')
+ *         int prec            number of decimal places of the seconds (0-9)
+ *         char *buf           output string (at least HMSLEN characters)
+ *
+ * Output: int len             number of characters written
+ *
+ */
+
+int format_ra(double alphadeg, char sep, int prec, char *buf)
+{
+  int i;                    /* Looping variable */
+  long long scale=1;        /* 10^prec */
+  long long units;          /* RA in units of 10^-prec seconds of time */
+
+  if(prec < 0)
+    prec = 0;
+  if(prec > 9)
+    prec = 9;
+  for(i=0; i<prec; i++)
+    scale *= 10;
+
+  alphadeg = fmod(alphadeg,360.0);
+  if(alphadeg < 0.0)
+    alphadeg += 360.0;
+  units = sexa_round(alphadeg,240.0 * scale);
+  if(units >= 86400LL * scale)
+    units -= 86400LL * scale;
+
+  return (int) (sexa_write(buf,units,scale,sep,prec) - buf);
+}
+
+/*.......................................................................
+ *
+ * Function format_dec
+ *
+ * Writes a Dec in decimal degrees as +dd[sep]mm[sep]ss.sss, i.e., the
+ *  same as printf with "%+03d %02d %06.3f" for prec=3, rounding in the
+ *  same way as format_ra.  Decs between 0 and -1 degrees keep their 
+ *  sign.
+ *
+ * Inputs: double deltadeg     Dec in degrees
+ *         char sep            field separator (e.g., ' ' or ':')
+ *         int prec            number of decimal places of the seconds (0-9)
+ *         char *buf           output string (at least HMSLEN characters)
+ *
+ * Output: int len             number of characters written
+ *
+ */
+
+int format_dec(double deltadeg, char sep, int prec, char *buf)
+{
+  int i;                    /* Looping variable */
+  long long scale=1;        /* 10^prec */
+  long long units;          /* |Dec| in units of 10^-prec arcsec */
+
+  if(prec < 0)
+    prec = 0;
+  if(prec > 9)
+    prec = 9;
+  for(i=0; i<prec; i++)
+    scale *= 10;
+
+  units = sexa_round(fabs(deltadeg),3600.0 * scale);
+  buf[0] = (deltadeg < 0.0 && units > 0) ? '-' : '+';
+
+  return 1 + (int) (sexa_write(buf+1,units,scale,sep,prec) - (buf+1));
+}
+
+/*.......................................................................
+ *
+ * Function parse_hms_array
+ *
+ * Reads npos positions in the form used by parse_hms, one after the 
+ *  other, from a block of text such as a mapped file of coordinates.
+ *  Any white space, including line ends, may separate the positions.
+ *
+ * Inputs: char **text         text (advanced past the last position)
+ *         int npos            number of positions to read
+ *         double *alphadeg    RAs in degrees (set by this function)
+ *         double *deltadeg    Decs in degrees (set by this function)
+ *
+ * Output: int nread           number of positions read, which is less
+ *                              than npos if a bad position was found
+ *
+ */
+
+int parse_hms_array(char **text, int npos, double *alphadeg, 
+		    double *deltadeg)
+{
+  int i;                    /* Looping variable */
+  char *p = *text;          /* Pointer to navigate the text */
+
+  for(i=0; i<npos; i++) {
+    while(*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')
+      p++;
+    if(parse_hms(p,alphadeg+i,deltadeg+i,&p))
+      break;
+  }
+
+  *text = p;
+  return i;
+}
+
+/*.......................................................................
+ *
+ * Function format_hms_array
+ *
+ * Writes npos positions in decimal degrees as lines of the form 
+ *  "hh mm ss.ssss +dd mm ss.sss", using format_ra and format_dec.
+ *
+ * Inputs: double *alphadeg    RAs in degrees
+ *         double *deltadeg    Decs in degrees
+ *         int npos            number of positions
+ *         char sep            field separator (e.g., ' ' or ':')
+ *         int secprec         decimal places of the RA seconds
+ *         int asecprec        decimal places of the Dec seconds
+ *         char *buf           output text (at least npos*HMSLEN 
+ *                              characters)
+ *
+ * Output: size_t len          number of characters written
+ *
+ */
+
+size_t format_hms_array(double *alphadeg, double *deltadeg, int npos,
+			char sep, int secprec, int asecprec, char *buf)
+{
+  int i;                    /* Looping variable */
+  char *p = buf;            /* Pointer to navigate buf */
+
+  for(i=0; i<npos; i++) {
+    p += format_ra(alphadeg[i],sep,secprec,p);
+    *p++ = ' ';
+    p += format_dec(deltadeg[i],sep,asecprec,p);
+    *p++ = '\n';
+  }
+  *p = '\0';
+
+  return (size_t) (p - buf);
+}
+
 /*.......................................................................
  *
  * Function dspos2xy
@@ -388,19 +859,19 @@ void deg2spos(double alphdeg, double deltdeg, Skypos *spos)
  *         Skypos *spos        array of other postions
  *         int npos            number of positions in spos array
  *
- * Output: Pos *pos            array of (x,y) offsets.  NULL on error
+ * Output: Lpos *pos           array of (x,y) offsets.  NULL on error
  *
  * v29Jul03 CDF, Moved actual calculation of offsets into the new
  *                rad2offset function.
  */
 
-Pos *dspos2xy(Skypos cent, Skypos *spos, int npos)
+Lpos *dspos2xy(Skypos cent, Skypos *spos, int npos)
 {
   int i;                  /* Looping variable */
   double alpha0,delta0;   /* RA and Dec of central position in radians */
   double alpha2,delta2;   /* RA and Dec of offset positions in radians */
-  Pos *pos;               /* Array of x,y offsets */
-  Pos *pptr;              /* Pointer to navigate pos */
+  Lpos *pos;              /* Array of x,y offsets */
+  Lpos *pptr;             /* Pointer to navigate pos */
   Skypos *sptr;           /* Pointer to navigate spos */
 
   /*
@@ -410,10 +881,10 @@ Pos *dspos2xy(Skypos cent, Skypos *spos, int npos)
   spos2rad(cent,&alpha0,&delta0);
 
   /*
-   * Allocate memory for Pos array
+   * Allocate memory for Lpos array
    */
 
-  if(!(pos = new_pos(npos,1))) {
+  if(!(pos = new_lpos(npos))) {
     fprintf(stderr,"ERROR: dspos2xy\n");
     return NULL;
   }
@@ -441,6 +912,52 @@ Pos *dspos2xy(Skypos cent, Skypos *spos, int npos)
   return pos;
 }
 
+/*.......................................................................
+ *
+ * Function rad2xy
+ *
+ * A batched version of dspos2xy for use in inner loops.  Takes a central 
+ *  position and arrays of other positions, all in radians, and computes 
+ *  the x and y offsets between them in arcsec, using the same formulae 
+ *  as rad2offset.  The trig functions of the central declination are
+ *  computed once, nothing is allocated, and the loop has no branches or
+ *  calls other than to the math library, so that the compiler is free to 
+ *  vectorize it.
+ *
+ * Inputs: double alpha0       central RA in radians
+ *         double delta0       central Dec in radians
+ *         double *alpha       array of RAs in radians
+ *         double *delta       array of Decs in radians
+ *         int npos            number of positions in the arrays
+ *         double *x           x offsets in arcsec, npos elements (set by
+ *                              this function)
+ *         double *y           y offsets in arcsec, npos elements (set by
+ *                              this function)
+ *
+ * Output: (none)
+ *
+ */
+
+void rad2xy(double alpha0, double delta0, double *alpha, double *delta,
+	    int npos, double *x, double *y)
+{
+  int i;                  /* Looping variable */
+  double cosd0,sind0;     /* Trig functions of the central Dec */
+  double cosd;            /* Cosine of the offset Dec */
+  double dalpha;          /* RA difference */
+
+  cosd0 = cos(delta0);
+  sind0 = sin(delta0);
+
+  for(i=0; i<npos; i++) {
+    dalpha = alpha[i] - alpha0;
+    cosd = cos(delta[i]);
+    x[i] = cosd * sin(dalpha) * 180.0 * 3600.0 / PI;
+    y[i] = (sin(delta[i]) * cosd0 - cosd * sind0 * cos(dalpha)) * 
+      180.0 * 3600.0 / PI;
+  }
+}
+
 /*.......................................................................
  *
  * Function ddeg2xy
@@ -455,16 +972,16 @@ Pos *dspos2xy(Skypos cent, Skypos *spos, int npos)
  *  double alphadeg            other RA in decimal degrees
  *  double deltadeg            other Dec in decimal degrees
  *
- * Output: Pos pos             (x,y) offset in arcsec
+ * Output: Lpos pos            (x,y) offset in arcsec
  *
  */
 
-Pos ddeg2xy(double alphadeg0, double deltadeg0, double alphadeg,
-	    double deltadeg)
+Lpos ddeg2xy(double alphadeg0, double deltadeg0, double alphadeg,
+	     double deltadeg)
 {
   double alpha0,delta0; /* Central position in decimal degrees */
   double alpha,delta;   /* Other position in decimal degrees */
-  Pos pos;              /* Offset between the two positions, in arcsec */
+  Lpos pos;             /* Offset between the two positions, in arcsec */
 
   /*
    * Convert positions to radians
@@ -497,21 +1014,22 @@ Pos ddeg2xy(double alphadeg0, double deltadeg0, double alphadeg,
  *         double alpha2       position 2 right ascension in radians
  *         double delta2       position 2 declination in radians
  *
- * Output: Pos offset          offset in arcseconds
+ * Output: Lpos offset         offset in arcseconds
  *
  */
 
-Pos rad2offset(double alpha1, double delta1, double alpha2, double delta2)
+Lpos rad2offset(double alpha1, double delta1, double alpha2, double delta2)
 {
   double L,M;    /* RA and Dec shifts */
-  Pos offset;    /* Offset in arcsec */
+  Lpos offset;   /* Offset in arcsec */
 
   /*
    * Initialize, just in case
    */
 
-  offset.x = 0.0;
-  offset.y = 0.0;
+  offset.x = offset.y = offset.xerr = offset.yerr = 0.0;
+  offset.flag = 0;
+  offset.labid = -1;
 
   /*
    * Use the formulae from Memo 27
@@ -521,7 +1039,7 @@ Pos rad2offset(double alpha1, double delta1, double alpha2, double delta2)
   M = sin(delta2)*cos(delta1) - cos(delta2)*sin(delta1)*cos(alpha2-alpha1);
 
   /*
-   * Convert L and M to arcsec and put them into Pos container
+   * Convert L and M to arcsec and put them into Lpos container
    */
 
   offset.x = L * 180.0 * 3600.0 / PI;
@@ -542,7 +1060,7 @@ Pos rad2offset(double alpha1, double delta1, double alpha2, double delta2)
  * Inputs:
  *  double alpha0              central RA in radians
  *  double delta0              central Dec in radians
- *  Pos offset                 offset in arcseconds
+ *  Lpos offset                offset in arcseconds
  *  double *alpha              output RA in radians
  *  double *delta              output Dec in radians
  *
@@ -551,7 +1069,7 @@ Pos rad2offset(double alpha1, double delta1, double alpha2, double delta2)
  *
  */
 
-int offset2rad(double alpha0, double delta0, Pos offset, double *alpha,
+int offset2rad(double alpha0, double delta0, Lpos offset, double *alpha,
 	       double *delta)
 {
   double L,M;         /* Offset positions in radians */
@@ -590,14 +1108,14 @@ int offset2rad(double alpha0, double delta0, Pos offset, double *alpha,
  *  function uses the formulae in AIPS Memo 27 with the SIN geometry
  *
  * Inputs: Skypos cent         central position
- *         Pos *pos            offsets from the central position
+ *         Lpos *pos           offsets from the central position
  *         int npos            number of offsets
  *
  * Output: Skypos *spos        RAs and Decs off the offset positions,
  *                              NULL on error
  */
 
-Skypos *dspos2spos(Skypos cent, Pos *pos, int npos)
+Skypos *dspos2spos(Skypos cent, Lpos *pos, int npos)
 {
   int i;              /* Looping variable */
   double alpha0;      /* RA of center in radians */
@@ -606,7 +1124,7 @@ Skypos *dspos2spos(Skypos cent, Pos *pos, int npos)
   double delta;       /* Dec of offset position in radians */
   Skypos *spos=NULL;  /* Array of RA and Dec positions */
   Skypos *sptr;       /* Pointer to navigate spos array */
-  Pos *pptr;          /* Pointer to navigate pos array */
+  Lpos *pptr;         /* Pointer to navigate pos array */
 
   /*
    * Convert center position to radians
@@ -657,15 +1175,15 @@ Skypos *dspos2spos(Skypos cent, Pos *pos, int npos)
  *  positions.  This function uses the formulae in AIPS Memo 27 with the SIN 
  *  geometry
  *
- * Inputs: Pos cent            central position in decimal degrees
- *         Pos *pos            offsets from the central position in arcsec
+ * Inputs: Lpos cent           central position in decimal degrees
+ *         Lpos *pos           offsets from the central position in arcsec
  *         int npos            number of offsets
  *
- * Output: Pos *adpos          RAs and Decs off the offset positions, in
+ * Output: Lpos *adpos         RAs and Decs off the offset positions, in
  *                              decimal degrees.  NULL on error
  */
 
-Pos *ddeg2deg(Pos cent, Pos *pos, int npos)
+Lpos *ddeg2deg(Lpos cent, Lpos *pos, int npos)
 {
   int i;              /* Looping variable */
   double L,M;         /* Offset positions in radians */
@@ -674,9 +1192,9 @@ Pos *ddeg2deg(Pos cent, Pos *pos, int npos)
   double alpha;       /* RA of offset position in radians */
   double delta0;      /* Dec of center in radians */
   double delta;       /* Dec of offset position in radians */
-  Pos *adpos=NULL;    /* Array of RA and Dec positions in decimal degrees */
-  Pos *aptr;          /* Pointer to navigate adpos array */
-  Pos *pptr;          /* Pointer to navigate pos array */
+  Lpos *adpos=NULL;   /* Array of RA and Dec positions in decimal degrees */
+  Lpos *aptr;         /* Pointer to navigate adpos array */
+  Lpos *pptr;         /* Pointer to navigate pos array */
 
   /*
    * Convert center position to radians
@@ -689,7 +1207,7 @@ Pos *ddeg2deg(Pos cent, Pos *pos, int npos)
    * Allocate memory for Skypos array
    */
 
-  if(!(adpos = new_pos(npos,1))) {
+  if(!(adpos = new_lpos(npos))) {
     fprintf(stderr,"ERROR:  ddeg2deg\n");
     return NULL;
   }
@@ -706,7 +1224,7 @@ Pos *ddeg2deg(Pos cent, Pos *pos, int npos)
 
     if(offset2rad(alpha0,delta0,*pptr,&alpha,&delta)) {
       fprintf(stderr,"ERROR: dspos2spos.\n");
-      return del_pos(adpos);
+      return del_lpos(adpos);
     }
 
     /*
@@ -813,7 +1331,7 @@ int secat2offset(Secat *secat, int ncat, int posformat, Secat centpos,
   int ncent;               /* Number of lines in posfile (should be 1) */
   double alpha0,delta0;    /* Central position in radians */
   double alpha_i,delta_i;  /* Catalog object position in radians */
-  Pos tmpoffset;           /* Temporary holder for offsets */
+  Lpos tmpoffset;          /* Temporary holder for offsets */
   Secat *sptr;             /* Pointer to navigate secat */
 
   /*
@@ -3,6 +3,7 @@
 
 #include "structdef.h"
 #define CMAXC 200
+#define HMSLEN 48  /* Room for a position written by format_ra/format_dec */
 
 /*.......................................................................
  *
@@ -20,21 +21,33 @@ Skypos *new_skypos(int size);
 Skypos *del_skypos(Skypos *skypos);
 void print_skypos(FILE *fp, Skypos pos);
 Pos read_skypos();
-void rth2xy(double r, double theta, Pos *pos, int isastro);
-void xy2rth(Pos pos, double *r, double *theta, int isastro);
+void rth2xy(double r, double theta, Lpos *pos, int isastro);
+void xy2rth(Lpos pos, double *r, double *theta, int isastro);
 void deg2rad(double dalpha, double ddelta, double *ralpha, double *rdelta);
 void spos2rad(Skypos spos, double *alpha, double *delta);
+void spos2vec(Skypos spos, double *vec);
+double *secat2vec(Secat *secat, int ncat);
+double offset2cos(double radius);
 void rad2spos(double alpha, double delta, Skypos *spos);
 void spos2deg(Skypos spos, double *alphadeg, double *deltadeg);
 void deg2spos(double alphdeg, double deltdeg, Skypos *spos);
-Pos *dspos2xy(Skypos cent, Skypos *spos, int npos);
-Pos ddeg2xy(double alphadeg0, double deltadeg0, double alphadeg,
-	    double deltadeg);
-Pos rad2offset(double alpha1, double delta1, double alpha2, double delta2);
-int offset2rad(double alpha0, double delta0, Pos offset, double *alpha,
+int parse_hms(char *s, double *alphadeg, double *deltadeg, char **end);
+int format_ra(double alphadeg, char sep, int prec, char *buf);
+int format_dec(double deltadeg, char sep, int prec, char *buf);
+int parse_hms_array(char **text, int npos, double *alphadeg, 
+		    double *deltadeg);
+size_t format_hms_array(double *alphadeg, double *deltadeg, int npos,
+			char sep, int secprec, int asecprec, char *buf);
+Lpos *dspos2xy(Skypos cent, Skypos *spos, int npos);
+void rad2xy(double alpha0, double delta0, double *alpha, double *delta,
+	    int npos, double *x, double *y);
+Lpos ddeg2xy(double alphadeg0, double deltadeg0, double alphadeg,
+	     double deltadeg);
+Lpos rad2offset(double alpha1, double delta1, double alpha2, double delta2);
+int offset2rad(double alpha0, double delta0, Lpos offset, double *alpha,
 	       double *delta);
-Skypos *dspos2spos(Skypos cent, Pos *pos, int npos);
-Pos *ddeg2deg(Pos cent, Pos *pos, int npos);
+Skypos *dspos2spos(Skypos cent, Lpos *pos, int npos);
+Lpos *ddeg2deg(Lpos cent, Lpos *pos, int npos);
 int mod_center(FILE *ifp, Skypos *center);
 int secat2offset(Secat *secat, int ncat, int posformat, Secat centpos,
 		 int centformat);
@@ -11,13 +11,39 @@
  *  open_appendfile - opens a file for appending
  *  n_lines         - counts the number of data lines in a file
  *  n_cols          - counts the number of columns in a line
+ *  grow_array      - grows an array geometrically while a file is read
+ *  shrink_array    - trims an array filled by grow_array to its used size
+ *  map_readfile    - maps an input file into memory for in-place parsing
+ *  unmap_file      - releases a file mapped by map_readfile
+ *  new_outbuf, del_outbuf, ob_* - buffered output with printf-identical
+ *                    fixed-point and sexagesimal formatting
  *  read_datastruct - creates a Datastruct array and fills it from a file.
  *  read_difmap     - reads a difmap model file
  *  read_secat      - reads a SExtractor catalog
+ *  read_secat_mode - read_secat with a choice of stdio or memory-mapped input
+ *  write_bcat      - writes a catalog to a binary cache (.bcat) file
+ *  read_bcat       - maps a binary cache file as a Colcat
  *  read_secat2     - a more generalized version of read_secat that will
  *                    not (hopefully) need a format flag.  Not yet
  *                    functional.
  *  write_secat     - writes a Secat array to an output file
+ *  print_secat_rows - writes a block of Secat members to an output buffer
+ *  secat_format_info - gives the number of columns and header lines of a
+ *                    secat format
+ *  count_data_lines  - counts the lines in a piece of a mapped file
+ *  parse_secat_chunk - parses a piece of a mapped secat-style catalog
+ *  parse_sdss_chunk  - parses a piece of a mapped SDSS-style catalog
+ *  sext_member     - finds the Secat member for a SExtractor parameter name
+ *  find_sheader_column - looks up a column by name in a catalog header
+ *  read_secat_header - reads the column definitions from a SExtractor
+ *                    ASCII_HEAD header
+ *  read_fitscat    - reads a SExtractor FITS_LDAC / FITS binary table catalog
+ *  read_sexthead   - reads a SExtractor catalog using its column header
+ *  read_colcat     - reads a SExtractor catalog into a column-ordered Colcat
+ *  read_colcat_cols - reads only the chosen columns of a catalog into a Colcat
+ *  colcat_need     - returns a Colcat column, loading it from the file if
+ *                    read_colcat_cols left it out
+ *  write_colcat    - writes a Colcat to an output file
  *  secat_format    - describes the formats acceptable by the secat functions
  *  read_distcalc   - reads the output file produced by distcalc.c
  *  read_sdss       - reads a SDSS-style file, in which magnitudes in multiple
@@ -60,16 +86,55 @@
  * v2007Aug02 CDF, Added format=15 to read_secat, write_secat, and secat_format
  * v2008Jun26 CDF, Modified format 15 to match the new redshift catalog format
  * v2009Jan24 CDF, Changed format 0 from id,x,y to id,alpha,delta
+ * v2026Oct16 AGT, Split the per-line parsing and printing out of read_secat
+ *                  and write_secat.  Added read_colcat and write_colcat for
+ *                  the column-ordered Colcat structure.
+ *                 Added read_secat_mode, which can parse a memory-mapped
+ *                  input file in place with a locale-free tokenizer.
+ *                 Added the .bcat binary cache, written and used by
+ *                  read_secat and read_colcat.
+ *                 Added count_data_lines and the parse_*_chunk functions,
+ *                  which let catpar.c parse a catalog in parallel.
+ *                 Added read_fitscat for SExtractor FITS catalogs (format 19)
+ *                 Added read_colcat_cols and colcat_need for reading only
+ *                  the columns that a program uses.
+ *                 Implemented read_secat_header and added read_sexthead,
+ *                  which builds a column layout from a catalog header
+ *                  (format 20).
+ *                 Added the Outbuf output buffers, used by write_secat,
+ *                  write_colcat and write_sdss.
+ *                 open_readfile and open_writefile now handle gzip, bzip2,
+ *                  xz and zstd compressed files.
+ *                 print_offsets now prints positions with format_ra and
+ *                  format_dec, and takes its offsets as an Lpos array.
+ *                 The .bcat cache is now only used when BCAT_CACHE is set,
+ *                  and also checks the nanosecond modification time and a
+ *                  hash of the two ends of the text file.
  */
 
+#define _GNU_SOURCE        /* For fopencookie */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <float.h>
 #include <math.h>
 #include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include "structdef.h"
 #include "coords.h"
 #include "dataio.h"
 
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
 /*.......................................................................
  *
  * Function file_exists
@@ -106,12 +171,518 @@ int file_exists(char *filename)
   return exists;
 }
 
+/*.......................................................................
+ *
+ * Compressed files
+ *
+ * Files compressed with gzip, bzip2, xz or zstd are read and written
+ *  through the matching command-line tool, which runs as a separate
+ *  process connected to the program by a pipe.  The pipe is wrapped in
+ *  a stdio stream, so that the callers of open_readfile and
+ *  open_writefile see an ordinary FILE and the data are decompressed
+ *  as they are parsed, without a scratch copy on disk.  A compressed
+ *  input stream can be rewound (the tool is simply restarted), which
+ *  is all that the readers in this library need.
+ * Compressed input is recognized by its magic number, compressed
+ *  output by the suffix of the file name.
+ *
+ */
+
+typedef struct {
+  char *suffix;             /* File name suffix */
+  unsigned char magic[6];   /* Magic number at the start of the file */
+  int nmagic;               /* Number of bytes in the magic number */
+  char *unzip[4];           /* Command to decompress stdin to stdout */
+  char *zip[4];             /* Command to compress stdin to stdout */
+} Zcodec;
+
+static Zcodec zcodecs[] = {
+  {".gz",  {0x1f,0x8b},                  2, {"gzip","-dc",NULL},
+   {"gzip","-c",NULL}},
+  {".bz2", {'B','Z','h'},                3, {"bzip2","-dc",NULL},
+   {"bzip2","-c",NULL}},
+  {".xz",  {0xfd,'7','z','X','Z',0x00},  6, {"xz","-dc",NULL},
+   {"xz","-c",NULL}},
+  {".zst", {0x28,0xb5,0x2f,0xfd},        4, {"zstd","-dcq",NULL},
+   {"zstd","-cq",NULL}},
+  {NULL,   {0},                          0, {NULL}, {NULL}}
+};
+
+typedef struct {
+  Zcodec *codec;     /* Compression format */
+  char *name;        /* Name of the compressed file */
+  int writing;       /* 0 ==> stream is read, 1 ==> stream is written */
+  int filefd;        /* The compressed file */
+  int pipefd;        /* Our end of the pipe to the (de)compressor */
+  pid_t pid;         /* The (de)compressor, or 0 once it has been reaped */
+  off_t pos;         /* Bytes read or written so far */
+} Zstream;
+
+/*.......................................................................
+ *
+ * Function zcodec_magic
+ *
+ * Checks the first few bytes of an open file for the magic number of a
+ *  compressed format.  The file offset is left at the start of the file.
+ *
+ * Inputs: int fd              file descriptor of a regular file
+ *
+ * Output: Zcodec *codec       compression format, or NULL if the file is
+ *                              not compressed
+ *
+ */
+
+static Zcodec *zcodec_magic(int fd)
+{
+  ssize_t nread;            /* Number of bytes read */
+  unsigned char buf[8];     /* Start of the file */
+  Zcodec *codec;            /* Pointer to navigate zcodecs */
+
+  nread = read(fd,buf,sizeof(buf));
+  lseek(fd,0,SEEK_SET);
+  for(codec=zcodecs; codec->suffix; codec++)
+    if(nread >= codec->nmagic && memcmp(buf,codec->magic,codec->nmagic) == 0)
+      return codec;
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function zcodec_suffix
+ *
+ * Returns the compression format named by the suffix of a file name.
+ *
+ * Inputs: char *filename      file name
+ *
+ * Output: Zcodec *codec       compression format, or NULL if the name has
+ *                              no compression suffix
+ *
+ */
+
+static Zcodec *zcodec_suffix(char *filename)
+{
+  size_t len=strlen(filename); /* Length of file name */
+  size_t slen;                 /* Length of suffix */
+  Zcodec *codec;               /* Pointer to navigate zcodecs */
+
+  for(codec=zcodecs; codec->suffix; codec++) {
+    slen = strlen(codec->suffix);
+    if(len > slen && strcmp(filename+len-slen,codec->suffix) == 0)
+      return codec;
+  }
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function zs_start
+ *
+ * Starts the (de)compressor for a stream, with the compressed file on
+ *  one side of it and a new pipe on the other.  The file is read from
+ *  (or written at) its current offset.  A second, close-on-exec pipe
+ *  carries the errno back if the command cannot be run.
+ *
+ * Inputs: Zstream *zs         stream
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+static int zs_start(Zstream *zs)
+{
+  int err=0;                /* errno from a failed exec */
+  int p[2];                 /* Data pipe */
+  int ep[2];                /* Exec status pipe */
+  char **argv;              /* Command to run */
+
+  argv = zs->writing ? zs->codec->zip : zs->codec->unzip;
+  if(pipe(p) != 0)
+    return 1;
+  if(pipe(ep) != 0) {
+    close(p[0]);
+    close(p[1]);
+    return 1;
+  }
+  fcntl(ep[1],F_SETFD,FD_CLOEXEC);
+
+  if((zs->pid = fork()) < 0) {
+    close(p[0]);
+    close(p[1]);
+    close(ep[0]);
+    close(ep[1]);
+    zs->pid = 0;
+    return 1;
+  }
+
+  /*
+   * Child: the file and the pipe become stdin and stdout (or the other
+   *  way round when writing)
+   */
+
+  if(zs->pid == 0) {
+    close(ep[0]);
+    if(zs->writing) {
+      dup2(p[0],0);
+      dup2(zs->filefd,1);
+    }
+    else {
+      dup2(zs->filefd,0);
+      dup2(p[1],1);
+    }
+    close(p[0]);
+    close(p[1]);
+    close(zs->filefd);
+    execvp(argv[0],argv);
+    err = errno;
+    write(ep[1],&err,sizeof(err));
+    _exit(127);
+  }
+
+  /*
+   * Parent: keep our end of the pipe and wait for the exec
+   */
+
+  close(ep[1]);
+  if(zs->writing) {
+    close(p[0]);
+    zs->pipefd = p[1];
+  }
+  else {
+    close(p[1]);
+    zs->pipefd = p[0];
+  }
+  fcntl(zs->pipefd,F_SETFD,FD_CLOEXEC);
+  zs->pos = 0;
+
+  while(read(ep[0],&err,sizeof(err)) < 0 && errno == EINTR)
+    ;
+  close(ep[0]);
+  if(err) {
+    fprintf(stderr,"ERROR: zs_start.  Could not run %s for %s: %s\n",
+	    argv[0],zs->name,strerror(err));
+    close(zs->pipefd);
+    waitpid(zs->pid,NULL,0);
+    zs->pid = 0;
+    return 1;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function zs_stop
+ *
+ * Closes our end of the pipe and waits for the (de)compressor to exit.
+ *
+ * Inputs: Zstream *zs         stream
+ *
+ * Output: int (0 or 1)        0 ==> the command finished successfully,
+ *                              1 ==> it failed
+ *
+ */
+
+static int zs_stop(Zstream *zs)
+{
+  int status;               /* Exit status of the command */
+
+  if(zs->pipefd >= 0) {
+    close(zs->pipefd);
+    zs->pipefd = -1;
+  }
+  if(zs->pid == 0)
+    return 0;
+  while(waitpid(zs->pid,&status,0) < 0)
+    if(errno != EINTR) {
+      zs->pid = 0;
+      return 1;
+    }
+  zs->pid = 0;
+
+  return !(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+/*.......................................................................
+ *
+ * Functions zs_read, zs_write, zs_seek and zs_close
+ *
+ * The stdio hooks of a compressed stream.  Reads that reach the end of
+ *  the data check that the decompressor finished cleanly, so that a
+ *  truncated or corrupt file gives a read error rather than a short
+ *  catalog.  The only seeks allowed are to the start of an input stream
+ *  and to the current position (i.e., rewind and ftell).
+ *
+ */
+
+static ssize_t zs_read(void *cookie, char *buf, size_t size)
+{
+  ssize_t nread;            /* Number of bytes read */
+  Zstream *zs = (Zstream *) cookie;
+
+  if(zs->pipefd < 0)
+    return 0;
+  while((nread = read(zs->pipefd,buf,size)) < 0 && errno == EINTR)
+    ;
+  if(nread > 0)
+    zs->pos += nread;
+  else if(nread == 0 && zs_stop(zs)) {
+    fprintf(stderr,"ERROR: zs_read.  %s failed on %s\n",
+	    zs->codec->unzip[0],zs->name);
+    return -1;
+  }
+  return nread;
+}
+
+static ssize_t zs_write(void *cookie, const char *buf, size_t size)
+{
+  ssize_t nwrite;           /* Number of bytes written in one call */
+  size_t done=0;            /* Number of bytes written so far */
+  Zstream *zs = (Zstream *) cookie;
+
+  while(done < size) {
+    if((nwrite = write(zs->pipefd,buf+done,size-done)) < 0) {
+      if(errno == EINTR)
+	continue;
+      return -1;
+    }
+    done += nwrite;
+  }
+  zs->pos += done;
+  return (ssize_t) done;
+}
+
+static int zs_seek(void *cookie, off_t *offset, int whence)
+{
+  Zstream *zs = (Zstream *) cookie;
+
+  if(whence == SEEK_CUR && *offset == 0) {
+    *offset = zs->pos;
+    return 0;
+  }
+  if(zs->writing || whence != SEEK_SET || *offset != 0) {
+    errno = ESPIPE;
+    return -1;
+  }
+
+  /*
+   * Rewind by restarting the decompressor at the start of the file
+   */
+
+  zs_stop(zs);
+  if(lseek(zs->filefd,0,SEEK_SET) != 0 || zs_start(zs))
+    return -1;
+  *offset = 0;
+  return 0;
+}
+
+static int zs_close(void *cookie)
+{
+  int error=0;              /* Flag set to 1 if the compressor failed */
+  Zstream *zs = (Zstream *) cookie;
+
+  if(zs_stop(zs) && zs->writing) {
+    fprintf(stderr,"ERROR: zs_close.  %s failed on %s\n",
+	    zs->codec->zip[0],zs->name);
+    error = 1;
+  }
+  close(zs->filefd);
+  free(zs->name);
+  free(zs);
+  return error ? EOF : 0;
+}
+
+#if defined(__GLIBC__)
+static int zs_seek64(void *cookie, off64_t *offset, int whence)
+{
+  off_t off = (off_t) *offset;   /* Offset in the type used by zs_seek */
+
+  if(zs_seek(cookie,&off,whence))
+    return -1;
+  *offset = (off64_t) off;
+  return 0;
+}
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) || \
+  defined(__OpenBSD__)
+#define HAVE_FUNOPEN
+static int zs_readfn(void *cookie, char *buf, int size)
+{
+  return (int) zs_read(cookie,buf,(size_t) size);
+}
+
+static int zs_writefn(void *cookie, const char *buf, int size)
+{
+  return (int) zs_write(cookie,buf,(size_t) size);
+}
+
+static fpos_t zs_seekfn(void *cookie, fpos_t offset, int whence)
+{
+  off_t off = (off_t) offset;    /* Offset in the type used by zs_seek */
+
+  if(zs_seek(cookie,&off,whence))
+    return -1;
+  return (fpos_t) off;
+}
+#endif
+
+/*.......................................................................
+ *
+ * Function zs_open
+ *
+ * Replaces a stream opened on a compressed file with one that reads the
+ *  decompressed data (or compresses what is written to it).  The
+ *  original stream is closed in either case, and an output file that
+ *  cannot be compressed is removed.
+ *
+ * Inputs: FILE *fp            stream opened on the compressed file
+ *         char *filename      name of the file
+ *         Zcodec *codec       compression format
+ *         int writing         0 ==> read the file, 1 ==> write it
+ *
+ * Output: FILE *zfp           new stream, or NULL on error
+ *
+ */
+
+static FILE *zs_open(FILE *fp, char *filename, Zcodec *codec, int writing)
+{
+  FILE *zfp=NULL;           /* Compressed stream */
+  Zstream *zs=NULL;         /* State of the compressed stream */
+#if defined(__GLIBC__)
+  cookie_io_functions_t hooks = {zs_read,zs_write,zs_seek64,zs_close};
+#endif
+
+  /*
+   * Take over the file descriptor of the original stream
+   */
+
+  if(!(zs = (Zstream *) calloc(1,sizeof(Zstream))) ||
+     !(zs->name = strdup(filename))) {
+    fprintf(stderr,"ERROR: zs_open.  Insufficient memory.\n");
+    free(zs);
+    fclose(fp);
+    return NULL;
+  }
+  fflush(fp);
+  zs->codec = codec;
+  zs->writing = writing;
+  zs->pipefd = -1;
+  zs->filefd = dup(fileno(fp));
+  fclose(fp);
+  if(zs->filefd < 0) {
+    fprintf(stderr,"ERROR: zs_open.  Cannot reopen %s\n",filename);
+    free(zs->name);
+    free(zs);
+    return NULL;
+  }
+  fcntl(zs->filefd,F_SETFD,FD_CLOEXEC);
+
+  /*
+   * Start the (de)compressor and wrap the pipe in a stream
+   */
+
+  if(zs_start(zs) == 0) {
+#if defined(__GLIBC__)
+    zfp = fopencookie(zs,writing ? "w" : "r",hooks);
+#elif defined(HAVE_FUNOPEN)
+    zfp = funopen(zs,writing ? NULL : zs_readfn,writing ? zs_writefn : NULL,
+		  zs_seekfn,zs_close);
+#else
+    fprintf(stderr,"ERROR: zs_open.  Compressed files are not supported ");
+    fprintf(stderr,"on this system.\n");
+#endif
+  }
+  if(!zfp) {
+    zs_close(zs);
+    if(writing)
+      unlink(filename);
+    return NULL;
+  }
+
+  return zfp;
+}
+
+/*.......................................................................
+ *
+ * Function slurp_readfile
+ *
+ * The version of map_readfile for streams that are not plain files
+ *  (e.g., compressed files).  The stream is read to the end into
+ *  anonymous memory, which is trimmed to whole pages and made read-only,
+ *  so that it can be released with unmap_file like a real map.
+ *
+ * Inputs: FILE *ifp           input stream
+ *         char **data         start of the data (set by function)
+ *         size_t *size        number of bytes of data (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+static int slurp_readfile(FILE *ifp, char **data, size_t *size)
+{
+  size_t used=0;            /* Bytes read so far */
+  size_t alloc=SLURPSIZE;   /* Size of the memory */
+  size_t keep;              /* Size of memory kept at the end */
+  size_t page;              /* Memory page size */
+  size_t nread;             /* Bytes read in one call */
+  char *map;                /* Memory */
+  char *newmap;             /* Larger memory */
+
+  map = (char *) mmap(NULL,alloc,PROT_READ | PROT_WRITE,
+		      MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+  if(map == (char *) MAP_FAILED) {
+    fprintf(stderr,"ERROR: map_readfile.  Insufficient memory.\n");
+    return 1;
+  }
+
+  while((nread = fread(map+used,1,alloc-used,ifp)) > 0) {
+    used += nread;
+    if(used < alloc)
+      continue;
+    newmap = (char *) mmap(NULL,2*alloc,PROT_READ | PROT_WRITE,
+			   MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+    if(newmap == (char *) MAP_FAILED) {
+      fprintf(stderr,"ERROR: map_readfile.  Insufficient memory.\n");
+      munmap(map,alloc);
+      return 1;
+    }
+    memcpy(newmap,map,used);
+    munmap(map,alloc);
+    map = newmap;
+    alloc *= 2;
+  }
+  if(ferror(ifp)) {
+    fprintf(stderr,"ERROR: map_readfile.  Error reading input.\n");
+    munmap(map,alloc);
+    return 1;
+  }
+
+  /*
+   * Give back the unused pages
+   */
+
+  if(used == 0) {
+    munmap(map,alloc);
+    return 0;
+  }
+  page = (size_t) sysconf(_SC_PAGESIZE);
+  keep = (used + page - 1) / page * page;
+  if(keep < alloc)
+    munmap(map+keep,alloc-keep);
+  mprotect(map,keep,PROT_READ);
+
+  *data = map;
+  *size = used;
+  return 0;
+}
+
 /*.......................................................................
  *
  * Function open_readfile
  *
  * Checks for existence of an input file and, if the file exists opens it.
- *  Returns the file pointer.
+ *  Returns the file pointer.  A file compressed with gzip, bzip2, xz or
+ *  zstd is decompressed on the fly as it is read (see "Compressed
+ *  files" above).
  *
  * Inputs: char *filename      input file name
  *
@@ -122,6 +693,8 @@ int file_exists(char *filename)
 FILE *open_readfile(char *filename)
 {
   char line[MAX];  /* General string for reading input */
+  struct stat sbuf; /* File status */
+  Zcodec *codec;   /* Compression format of the file */
   FILE *ifp=NULL;  /* File pointer for opened file */
 
   /*
@@ -139,6 +712,21 @@ FILE *open_readfile(char *filename)
     }
   }
 
+  /*
+   * Read compressed files through a decompressor
+   */
+
+  if(fstat(fileno(ifp),&sbuf) == 0 && S_ISREG(sbuf.st_mode) &&
+     (codec = zcodec_magic(fileno(ifp)))) {
+    if(!(ifp = zs_open(ifp,filename,codec,0))) {
+      fprintf(stderr,"ERROR: open_readfile.  Cannot decompress %s\n",
+	      filename);
+      return NULL;
+    }
+    printf("open_readfile: %s now open (%s)\n",filename,codec->unzip[0]);
+    return ifp;
+  }
+
   printf("open_readfile: %s now open\n",filename);
   return ifp;
 }
@@ -148,7 +736,8 @@ FILE *open_readfile(char *filename)
  * Function open_writefile
  *
  * Opens an output file for writing.
- *  Returns the file pointer.
+ *  Returns the file pointer.  If the file name ends in .gz, .bz2, .xz or
+ *  .zst the output is compressed on the fly.
  *
  * Inputs: char *filename      input file name
  *
@@ -160,12 +749,15 @@ FILE *open_writefile(char *filename)
 {
   char line[MAX];    /* General string for reading input */
   char newname[MAX]; /* New name needed if error opening file */
+  char *name;        /* Name of the file actually opened */
+  Zcodec *codec;     /* Compression format of the file */
   FILE *ofp=NULL;    /* File pointer for opened file */
 
   /*
    * Try to open file
    */
 
+  name = filename;
   if((ofp = fopen(filename,"w")) == NULL) {
     fprintf(stderr,"ERROR: open_writefile.  Cannot open %s.\n",filename);
     fprintf(stderr," Enter new file name:  ");
@@ -175,6 +767,20 @@ FILE *open_writefile(char *filename)
       fprintf(stderr,"ERROR: bad input.  Enter filename again: ");
       fgets(line,MAX,stdin);
     }
+    name = newname;
+  }
+
+  /*
+   * Write compressed files through a compressor
+   */
+
+  if((codec = zcodec_suffix(name))) {
+    if(!(ofp = zs_open(ofp,name,codec,1))) {
+      fprintf(stderr,"ERROR: open_writefile.  Cannot compress %s\n",name);
+      return NULL;
+    }
+    printf("open_writefile: %s now open (%s)\n",filename,codec->zip[0]);
+    return ofp;
   }
   
   printf("open_writefile: %s now open\n",filename);
@@ -340,87 +946,589 @@ int n_cols(char *line, char comchar, int verbose)
   return ncols;
 }
 
-/*.......................................................................,
+/*.......................................................................
  *
- * Function read_datastruct
+ * Function grow_array
  *
- * Reads a 2 or 3 column input file and puts results into a Datastruct array,
- *  which has its memory allocation performed in the function.
- * NB:  This function requires input in the form %f %f %f %d %s
+ * Makes sure that a dynamically allocated array has room for at least
+ *  nneed elements, growing it geometrically (by factors of two) when it
+ *  does not.  This lets the file readers fill their output arrays in a
+ *  single pass through the input file, instead of first counting the
+ *  lines with n_lines and then rewinding the file.
+ *  The array may be NULL on the first call, in which case *nalloc
+ *  should be 0.  On error the old array is freed and NULL is returned.
  *
- * Inputs: char *inname        name of input file
- *         char comment        comment character
- *         int *nlines         number of lines in input file -- set by
- *         int format          format of input file
- *                              1: %f %f %f %d %s
- *                              2: %d %f %f %f %s
- *                              3: %f %f %f
- *                              this function.
- *         
- * Output: Datastruct *newdata filled array
+ * Inputs: void *array         array to grow (may be NULL)
+ *         int *nalloc         number of elements allocated (updated here)
+ *         int nneed           number of elements needed
+ *         size_t elsize       size of one element
+ *
+ * Output: void *newarray      (possibly moved) array.  NULL on error
  *
- * v07Jun2006 CDF, Added a new format for reading files of form x y z.
  */
 
-Datastruct *read_datastruct(char *inname, char comment, int *nlines,
-			    int format)
+void *grow_array(void *array, int *nalloc, int nneed, size_t elsize)
 {
-  int no_error=1;           /* Flag set to 0 on error */
-  int ncols;                /* Number of columns in input file */
-  char line[MAXC];          /* General input string */
-  Datastruct *newdata=NULL; /* Filled datastruct array */
-  Datastruct *dptr;         /* Pointer to navigate datastruct */
-  FILE *ifp=NULL;           /* Input file pointer */
-
-  /*
-   * Check the input format
-   */
-
-  if(format<1 || format>3) {
-    fprintf(stderr,"ERROR: read_datastruct.  Format %d is not supported.\n",
-	    format);
+  int newalloc;      /* New number of allocated elements */
+  void *newarray;    /* Reallocated array */
+
+  if(array && nneed <= *nalloc)
+    return array;
+
+  newalloc = (*nalloc > GROWMIN) ? *nalloc : GROWMIN;
+  while(newalloc < nneed)
+    newalloc *= 2;
+
+  if(!(newarray = realloc(array,newalloc * elsize))) {
+    fprintf(stderr,"ERROR: grow_array.  Insufficient memory for %d ",
+	    newalloc);
+    fprintf(stderr,"array elements.\n");
+    if(array)
+      free(array);
+    *nalloc = 0;
     return NULL;
   }
 
-  /*
-   * Open input file
-   */
+  *nalloc = newalloc;
+  return newarray;
+}
 
-  if(!(ifp = open_readfile(inname))) {
-    fprintf(stderr,"ERROR: read_datastruct.\n");
-    return NULL;
-  }
+/*.......................................................................
+ *
+ * Function shrink_array
+ *
+ * Releases the unused part of an array that was filled with grow_array.
+ *  If the reallocation fails, the original (larger) array is returned,
+ *  since it still holds valid data.
+ *
+ * Inputs: void *array         array to shrink
+ *         int *nalloc         number of elements allocated (updated here)
+ *         int nused           number of elements actually used
+ *         size_t elsize       size of one element
+ *
+ * Output: void *newarray      (possibly moved) array
+ *
+ */
 
-  /*
-   * Get number of lines in input file
-   */
+void *shrink_array(void *array, int *nalloc, int nused, size_t elsize)
+{
+  void *newarray;    /* Reallocated array */
 
-  if((*nlines = n_lines(ifp,comment)) == 0) {
-    fprintf(stderr,"ERROR: read_datastruct.  No valid data in input file.\n");
-    no_error = 0;
+  if(!array || nused >= *nalloc || nused < 1)
+    return array;
+
+  if(!(newarray = realloc(array,nused * elsize)))
+    return array;
+
+  *nalloc = nused;
+  return newarray;
+}
+
+/*.......................................................................
+ *
+ * Function map_readfile
+ *
+ * Maps the contents of an open input file into memory, read-only, so
+ *  that it can be parsed in place.  An empty file gives a NULL map of
+ *  size zero.  The map stays valid after the file is closed, and is
+ *  released with unmap_file.  A stream that is not a plain file (e.g.,
+ *  a compressed file) is read into memory instead.
+ *
+ * Inputs: FILE *ifp           input file pointer
+ *         char **data         start of the mapped file (set by function)
+ *         size_t *size        size of the file in bytes (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int map_readfile(FILE *ifp, char **data, size_t *size)
+{
+  void *map;                /* Mapped file */
+  struct stat sbuf;         /* File status */
+
+  *data = NULL;
+  *size = 0;
+
+  if(fileno(ifp) < 0)
+    return slurp_readfile(ifp,data,size);
+  if(fstat(fileno(ifp),&sbuf) != 0) {
+    fprintf(stderr,"ERROR: map_readfile.  Could not get file size.\n");
+    return 1;
+  }
+  if(sbuf.st_size == 0)
+    return 0;
+
+  map = mmap(NULL,(size_t) sbuf.st_size,PROT_READ,MAP_PRIVATE,fileno(ifp),0);
+  if(map == MAP_FAILED) {
+    fprintf(stderr,"ERROR: map_readfile.  Could not map file.\n");
+    return 1;
+  }
+#ifdef MADV_SEQUENTIAL
+  madvise(map,(size_t) sbuf.st_size,MADV_SEQUENTIAL);
+#endif
+
+  *data = (char *) map;
+  *size = (size_t) sbuf.st_size;
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function unmap_file
+ *
+ * Releases a file mapped by map_readfile.
+ *
+ * Inputs: char *data          start of the mapped file
+ *         size_t size         size of the map
+ *
+ * Output: (none)
+ *
+ */
+
+void unmap_file(char *data, size_t size)
+{
+  if(data && size > 0)
+    munmap(data,size);
+}
+
+/*.......................................................................
+ *
+ * Output buffers
+ *
+ * An Outbuf collects formatted output in a large buffer that is written
+ *  out with one fwrite when it fills, instead of going through fprintf
+ *  for every field.  The ob_* functions format integers, strings and
+ *  fixed-precision numbers themselves, and give exactly the same
+ *  characters as the equivalent printf conversions, so that files
+ *  written this way are byte-identical to the old ones.  An Outbuf
+ *  without a file just grows, which lets rows be formatted into memory
+ *  (e.g., by several threads) and written out later.
+ *
+ * Functions:
+ *    new_outbuf   -  allocates a buffer for an open output file (or none)
+ *    del_outbuf   -  flushes and frees a buffer
+ *    ob_flush     -  writes the contents of a buffer to its file
+ *    ob_putc      -  adds one character
+ *    ob_puts      -  adds a string, like %s, %Ns or %-Ns
+ *    ob_int       -  adds an integer, like %Nd, %0Nd or %+0Nd
+ *    ob_fixed     -  adds a number, like %N.Pf, %0N.Pf or %+N.Pf
+ *    ob_skypos    -  adds an RA,Dec pair in sexagesimal form
+ *    ob_printf    -  adds anything else, through vsnprintf
+ *
+ */
+
+/*.......................................................................
+ *
+ * Function new_outbuf
+ *
+ * Allocates an output buffer.
+ *
+ * Inputs: FILE *ofp           output file, or NULL for a buffer that just
+ *                              grows in memory
+ *         size_t size         initial size of the buffer (OUTBUFSIZE is
+ *                              a good choice)
+ *
+ * Output: Outbuf *ob          new buffer, or NULL on error
+ *
+ */
+
+Outbuf *new_outbuf(FILE *ofp, size_t size)
+{
+  Outbuf *ob;        /* New buffer */
+
+  if(size < OBMAXFIELD)
+    size = OBMAXFIELD;
+  if(!(ob = (Outbuf *) malloc(sizeof(Outbuf)))) {
+    fprintf(stderr,"ERROR: new_outbuf.  Insufficient memory.\n");
+    return NULL;
+  }
+  if(!(ob->buf = (char *) malloc(size))) {
+    fprintf(stderr,"ERROR: new_outbuf.  Insufficient memory.\n");
+    free(ob);
+    return NULL;
+  }
+  ob->ofp = ofp;
+  ob->size = size;
+  ob->used = 0;
+  ob->error = 0;
+
+  return ob;
+}
+
+/*.......................................................................
+ *
+ * Function del_outbuf
+ *
+ * Writes out anything left in a buffer and frees it.  The file is not
+ *  closed.
+ *
+ * Inputs: Outbuf *ob          buffer
+ *
+ * Output: int (0 or 1)        0 ==> all output was written, 1 ==> error
+ *
+ */
+
+int del_outbuf(Outbuf *ob)
+{
+  int error;         /* Error flag of the buffer */
+
+  if(!ob)
+    return 1;
+  ob_flush(ob);
+  error = ob->error;
+  free(ob->buf);
+  free(ob);
+
+  return error;
+}
+
+/*.......................................................................
+ *
+ * Function ob_flush
+ *
+ * Writes the contents of a buffer to its file and empties it.  Does
+ *  nothing for a buffer without a file.
+ *
+ * Inputs: Outbuf *ob          buffer
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> write error
+ *
+ */
+
+int ob_flush(Outbuf *ob)
+{
+  if(!ob->ofp)
+    return ob->error;
+  if(ob->used > 0 && fwrite(ob->buf,1,ob->used,ob->ofp) != ob->used) {
+    fprintf(stderr,"ERROR: ob_flush.  Could not write output.\n");
+    ob->error = 1;
+  }
+  ob->used = 0;
+
+  return ob->error;
+}
+
+/*.......................................................................
+ *
+ * Function ob_room
+ *
+ * Makes sure that there is room for n more characters in a buffer, by
+ *  writing it out or, for a buffer without a file, by growing it.
+ *
+ * Inputs: Outbuf *ob          buffer
+ *         size_t n            number of characters needed
+ *
+ * Output: char *ptr           where to put them, or NULL on error
+ *
+ */
+
+static char *ob_room(Outbuf *ob, size_t n)
+{
+  size_t newsize;    /* New size of the buffer */
+  char *newbuf;      /* Reallocated buffer */
+
+  if(ob->used + n <= ob->size)
+    return ob->buf + ob->used;
+
+  if(ob->ofp) {
+    ob_flush(ob);
+    if(n <= ob->size)
+      return ob->buf;
+  }
+  for(newsize=2*ob->size; newsize < ob->used + n; newsize*=2);
+  if(!(newbuf = (char *) realloc(ob->buf,newsize))) {
+    fprintf(stderr,"ERROR: ob_room.  Insufficient memory.\n");
+    ob->error = 1;
+    return NULL;
+  }
+  ob->buf = newbuf;
+  ob->size = newsize;
+
+  return ob->buf + ob->used;
+}
+
+/*.......................................................................
+ *
+ * Function ob_pad
+ *
+ * Adds a field that has already been formatted, padded out to a width.
+ *  This is the common tail of ob_puts, ob_int and ob_fixed.
+ *
+ * Inputs: Outbuf *ob          buffer
+ *         char sign           sign character, or '\0' for none
+ *         const char *s       digits or string
+ *         int len             length of s
+ *         int width           minimum field width
+ *         int flags           OB_ZERO, OB_LEFT
+ *
+ * Output: (none)
+ *
+ */
+
+static void ob_pad(Outbuf *ob, char sign, const char *s, int len, int width,
+		   int flags)
+{
+  int npad;          /* Number of padding characters */
+  char *ptr;         /* Where to put the field */
+
+  npad = width - len - (sign ? 1 : 0);
+  if(npad < 0)
+    npad = 0;
+  if(!(ptr = ob_room(ob,npad + len + 1)))
+    return;
+
+  if(!(flags & (OB_LEFT | OB_ZERO))) {
+    memset(ptr,' ',npad);
+    ptr += npad;
+  }
+  if(sign)
+    *ptr++ = sign;
+  if(flags & OB_ZERO && !(flags & OB_LEFT)) {
+    memset(ptr,'0',npad);
+    ptr += npad;
+  }
+  memcpy(ptr,s,len);
+  ptr += len;
+  if(flags & OB_LEFT) {
+    memset(ptr,' ',npad);
+    ptr += npad;
+  }
+
+  ob->used = ptr - ob->buf;
+}
+
+void ob_putc(Outbuf *ob, char c)
+{
+  char *ptr;         /* Where to put c */
+
+  if((ptr = ob_room(ob,1))) {
+    *ptr = c;
+    ob->used++;
+  }
+}
+
+void ob_puts(Outbuf *ob, const char *s, int width, int flags)
+{
+  ob_pad(ob,'\0',s,strlen(s),width,flags & OB_LEFT);
+}
+
+void ob_int(Outbuf *ob, int val, int width, int flags)
+{
+  int n;             /* Number of digits */
+  unsigned int u;    /* Magnitude of val */
+  char sign='\0';    /* Sign character */
+  char digits[16];   /* Digits, filled from the end */
+
+  if(val < 0) {
+    sign = '-';
+    u = -(unsigned int) val;
   }
   else {
-    rewind(ifp);
+    if(flags & OB_PLUS)
+      sign = '+';
+    u = val;
+  }
+
+  n = 0;
+  do {
+    digits[15-n++] = '0' + u % 10;
+    u /= 10;
+  } while(u > 0);
+
+  ob_pad(ob,sign,digits+16-n,n,width,flags);
+}
+
+/*.......................................................................
+ *
+ * Function ob_fixed
+ *
+ * Adds a number in fixed-point notation, with the same result as the
+ *  printf conversion %[+][0]<width>.<prec>f.  The value is scaled by
+ *  10^prec and rounded to an integer, which gives the printf digits
+ *  unless the scaled value is too close to a half-integer for the
+ *  rounding of the multiplication to be ruled out (or is huge, or not
+ *  finite).  Those rare values are passed on to snprintf.
+ *
+ * Inputs: Outbuf *ob          buffer
+ *         double val          number
+ *         int width           minimum field width
+ *         int prec            digits after the decimal point (<= 9)
+ *         int flags           OB_PLUS, OB_ZERO, OB_LEFT
+ *
+ * Output: (none)
+ *
+ */
+
+void ob_fixed(Outbuf *ob, double val, int width, int prec, int flags)
+{
+  int i;                    /* Looping variable */
+  int n=0;                  /* Number of characters in digits */
+  unsigned long long u;     /* Scaled and rounded magnitude */
+  double x=0.0;             /* Scaled magnitude */
+  double r=0.0;             /* Integer part of x */
+  char sign='\0';           /* Sign character */
+  char digits[32];          /* Digits, filled from the end */
+  char fmt[16];             /* printf format for the slow path */
+  static double pow10[] = {1.0, 1.0e1, 1.0e2, 1.0e3, 1.0e4, 1.0e5, 1.0e6,
+			   1.0e7, 1.0e8, 1.0e9};
+
+  if(prec >= 0 && prec <= 9) {
+    x = fabs(val) * pow10[prec];
+    r = floor(x);
+  }
+  if(prec < 0 || prec > 9 || !(x < 1.0e15) ||
+     fabs(x - r - 0.5) <= 4.5e-16 * x) {
+    sprintf(fmt,"%%%s%s%s%d.%df",flags & OB_LEFT ? "-" : "",
+	    flags & OB_PLUS ? "+" : "",flags & OB_ZERO ? "0" : "",width,prec);
+    ob_printf(ob,fmt,val);
+    return;
+  }
+
+  u = (unsigned long long) r + (x - r > 0.5 ? 1 : 0);
+  for(i=0; i<prec; i++) {
+    digits[31-n++] = '0' + u % 10;
+    u /= 10;
+  }
+  if(prec > 0)
+    digits[31-n++] = '.';
+  do {
+    digits[31-n++] = '0' + u % 10;
+    u /= 10;
+  } while(u > 0);
+
+  if(signbit(val))
+    sign = '-';
+  else if(flags & OB_PLUS)
+    sign = '+';
+
+  ob_pad(ob,sign,digits+32-n,n,width,flags);
+}
+
+/*.......................................................................
+ *
+ * Function ob_skypos
+ *
+ * Adds the RA and Dec of a Skypos in the form used by the catalog
+ *  writers, i.e., "%02d %02d %08.5f %+03d %02d %07.4f" for secprec = 5,
+ *  asecprec = 4 and sep = ' '.  The seconds fields are always secprec+3
+ *  (asecprec+3) characters wide.
+ *
+ * Inputs: Outbuf *ob          buffer
+ *         Skypos *spos        position
+ *         char sep            separator between the components of RA and
+ *                              of Dec (' ' or ':')
+ *         int secprec         digits after the decimal point for RA sec
+ *         int asecprec        digits after the decimal point for Dec asec
+ *
+ * Output: (none)
+ *
+ */
+
+void ob_skypos(Outbuf *ob, Skypos *spos, char sep, int secprec, int asecprec)
+{
+  ob_int(ob,spos->hr,2,OB_ZERO);
+  ob_putc(ob,sep);
+  ob_int(ob,spos->min,2,OB_ZERO);
+  ob_putc(ob,sep);
+  ob_fixed(ob,spos->sec,secprec+3,secprec,OB_ZERO);
+  ob_putc(ob,' ');
+  ob_int(ob,spos->deg,3,OB_PLUS | OB_ZERO);
+  ob_putc(ob,sep);
+  ob_int(ob,spos->amin,2,OB_ZERO);
+  ob_putc(ob,sep);
+  ob_fixed(ob,spos->asec,asecprec+3,asecprec,OB_ZERO);
+}
+
+void ob_printf(Outbuf *ob, const char *fmt, ...)
+{
+  int len;           /* Length of the formatted output */
+  char *ptr;         /* Where to put it */
+  va_list args;      /* Variable arguments */
+
+  if(!(ptr = ob_room(ob,OBMAXFIELD)))
+    return;
+  va_start(args,fmt);
+  len = vsnprintf(ptr,OBMAXFIELD,fmt,args);
+  va_end(args);
+  if(len >= OBMAXFIELD) {
+    if(!(ptr = ob_room(ob,len + 1)))
+      return;
+    va_start(args,fmt);
+    vsnprintf(ptr,len + 1,fmt,args);
+    va_end(args);
+  }
+  if(len > 0)
+    ob->used += len;
+}
+
+/*.......................................................................,
+ *
+ * Function read_datastruct
+ *
+ * Reads a 2 or 3 column input file and puts results into a Datastruct array,
+ *  which has its memory allocation performed in the function.
+ * NB:  This function requires input in the form %f %f %f %d %s
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *         int format          format of input file
+ *                              1: %f %f %f %d %s
+ *                              2: %d %f %f %f %s
+ *                              3: %f %f %f
+ *                              this function.
+ *         
+ * Output: Datastruct *newdata filled array
+ *
+ * v07Jun2006 CDF, Added a new format for reading files of form x y z.
+ */
+
+Datastruct *read_datastruct(char *inname, char comment, int *nlines,
+			    int format)
+{
+  int no_error=1;           /* Flag set to 0 on error */
+  int ncols;                /* Number of columns in input file */
+  int nalloc=0;             /* Number of elements allocated in newdata */
+  char line[MAXC];          /* General input string */
+  Datastruct *newdata=NULL; /* Filled datastruct array */
+  Datastruct *dptr;         /* Pointer to navigate datastruct */
+  FILE *ifp=NULL;           /* Input file pointer */
+
+  /*
+   * Check the input format
+   */
+
+  if(format<1 || format>3) {
+    fprintf(stderr,"ERROR: read_datastruct.  Format %d is not supported.\n",
+	    format);
+    return NULL;
   }
 
   /*
-   * Allocate memory for datastruct and point dptr at the beginning of
-   *  the array.
+   * Open input file
    */
 
-  if(no_error) {
-    if(!(newdata = new_datastruct(*nlines)))
-      no_error = 0;
-    else
-      dptr = newdata;
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: read_datastruct.\n");
+    return NULL;
   }
 
   /*
-   * Read in data
+   * Read in data in a single pass, growing the array as needed
    */
 
+  *nlines = 0;
   while(no_error && fgets(line,MAXC,ifp) != NULL) {
     if(line[0] != comment) {
+      if(!(newdata = (Datastruct *) grow_array(newdata,&nalloc,*nlines+1,
+					       sizeof(Datastruct)))) {
+	no_error = 0;
+	break;
+      }
+      dptr = newdata + *nlines;
+      dptr->x = dptr->y = dptr->z = 0.0;
+      dptr->dataflag = 0;
       switch(format) {
       case 1:
 	ncols = sscanf(line,"%lf %lf %lf %d %s",&dptr->x,&dptr->y,&dptr->z,
@@ -434,7 +1542,7 @@ Datastruct *read_datastruct(char *inname, char comment, int *nlines,
 	  no_error = 0;
 	}
 	else
-	  dptr++;
+	  (*nlines)++;
 	break;
       case 2:
 	ncols = sscanf(line,"%d %lf %lf %lf %s",
@@ -449,7 +1557,7 @@ Datastruct *read_datastruct(char *inname, char comment, int *nlines,
 	  no_error = 0;
 	}
 	else
-	  dptr++;
+	  (*nlines)++;
 	break;
       case 3:
 	ncols = sscanf(line,"%lf %lf %lf",&dptr->x,&dptr->y,&dptr->z);
@@ -462,7 +1570,7 @@ Datastruct *read_datastruct(char *inname, char comment, int *nlines,
 	  no_error = 0;
 	}
 	else
-	  dptr++;
+	  (*nlines)++;
 	break;
       default:
 	fprintf(stderr,"ERROR: read_datastruct.  Bad format\n");
@@ -471,12 +1579,20 @@ Datastruct *read_datastruct(char *inname, char comment, int *nlines,
     }
   }
 
+  if(no_error && *nlines == 0) {
+    fprintf(stderr,"ERROR: read_datastruct.  No valid data in input file.\n");
+    no_error = 0;
+  }
+
   /*
    * Clean up and exit
    */
 
   if(ifp)
     fclose(ifp);
+  if(no_error)
+    newdata = (Datastruct *) shrink_array(newdata,&nalloc,*nlines,
+					  sizeof(Datastruct));
 
   if(no_error) {
     printf("\nread_datastruct: %s has %d columns and %d lines\n",inname,
@@ -653,164 +1769,3408 @@ Secat *read_difmap(char *inname, char comment, int *nlines, Skypos *pos0)
   }
 }
 
-/*.......................................................................,
+/*.......................................................................
  *
- * Function read_secat
+ * Function secat_format_info
  *
- * Reads the output catalog from a SExtractor run and puts the results
- *  into a Secat array, which has its memory allocation 
- *  performed in the function.
+ * Returns the number of columns expected in a secat-style input file
+ *  and the number of header lines that must be skipped before the data
+ *  begin, for a given format code (see secat_format).
  *
- * Inputs: char *inname        name of input file
- *         char comment        comment character
- *         int *nlines         number of lines in input file -- set by
- *                              this function.
- *         int format          flag describing format of input file
- *                              (for up-to-date listing, see the
- *                               secat_format function)
- *         
- * Output: Secat *newdata filled array
+ * Inputs: int format          format code
+ *         int *nexp           number of expected columns (set by function)
+ *         int *nskip          number of lines to skip (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> valid format, 1 ==> invalid format
+ *
+ */
+
+int secat_format_info(int format, int *nexp, int *nskip)
+{
+  *nskip = 0;
+  switch(format) {
+  case 0:
+    *nexp = 3;
+    break;
+  case 1:
+    *nexp = 2;
+    break;
+  case 2:
+    *nexp = 6;
+    break;
+  case 3:
+    *nexp = 8;
+    break;
+  case 4:
+    *nskip = 14;
+    *nexp = 2;
+    break;
+  case 6:
+    *nexp = 39;
+    break;
+  case 7:
+    *nexp = 48;
+    break;
+  case 8:
+    *nskip = 3;
+    *nexp = 7;
+    break;
+  case 9:
+    *nexp = 7;
+    break;
+  case 10:
+    *nexp = 3;
+    break;
+  case 13:
+    *nexp = 20;
+    break;
+  case 15:
+    *nexp = 5;
+    break;
+  case 16:
+    *nexp = 8;
+    break;
+  case 17:
+    *nexp = 47;
+    break;
+  case 18:
+    *nexp = 6;
+    break;
+  default:
+    return 1;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function secat_format_naper
+ *
+ * Returns the number of apertures per catalog member in a secat format,
+ *  i.e., the naper of a Colcat that holds a catalog in that format.
+ *
+ * Inputs: int format          format code
+ *
+ * Output: int naper           number of apertures
+ *
+ */
+
+static int secat_format_naper(int format)
+{
+  switch(format) {
+  case 6:
+    return 3;
+  case 17:
+    return 20;
+  default:
+    return 0;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function scan_secat_line
+ *
+ * Reads the columns of one data line of a secat-style catalog into a
+ *  Secat structure with sscanf.  The quantities that are derived from
+ *  the columns are filled in afterwards by finish_secat_line.
+ *
+ * Inputs: char *line          input line
+ *         int format          format code (see secat_format)
+ *         Secat *sptr         structure to fill
+ *         double *djunk       holder for a column that is not stored
+ *                              directly (set by function)
+ *
+ * Output: int ncols           number of columns successfully read
+ *
+ */
+
+static int scan_secat_line(char *line, int format, Secat *sptr, double *djunk)
+{
+  int ncols=0;              /* Number of columns read */
+
+  switch(format) {
+  case 0:
+    ncols = sscanf(line,"%lf %lf %lf",djunk,&sptr->alpha,&sptr->delta);
+    break;
+  case 1:
+  case 4:
+    ncols = sscanf(line,"%lf %lf",&sptr->alpha,&sptr->delta);
+    break;
+  case 2:
+    ncols = 
+      sscanf(line,"%d %d %lf %d %d %lf",
+	     &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
+	     &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec);
+    break;
+  case 3:
+    ncols = 
+      sscanf(line,"%lf %lf %d %d %lf %d %d %lf",
+	     &sptr->x,&sptr->y,
+	     &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
+	     &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec);
+    break;
+  case 6:
+    ncols = 
+      sscanf(line,"%d %lf %lf %d %f %f %f %g %g %f %f %g %g %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %lf %lf",
+	     &sptr->id,&sptr->x,&sptr->y,&sptr->fitflag,&sptr->class,
+	     &sptr->miso,&sptr->misoerr,&sptr->fiso,&sptr->fisoerr,
+	     &sptr->mtot,&sptr->merr,&sptr->fauto,&sptr->fautoerr,
+	     &sptr->r_kron,&sptr->bkgd,&sptr->thresh,&sptr->muthresh,
+	     &sptr->isoarea,&sptr->a_im,
+	     &sptr->b_im,&sptr->theta,&sptr->fwhm,
+	     &sptr->maper[0],&sptr->maper[1],&sptr->maper[2],
+	     &sptr->mapererr[0],&sptr->mapererr[1],&sptr->mapererr[2],
+	     &sptr->faper[0],&sptr->faper[1],&sptr->faper[2],
+	     &sptr->fapererr[0],&sptr->fapererr[1],&sptr->fapererr[2],
+	     &sptr->r2,&sptr->r5,&sptr->r8,&sptr->alpha,&sptr->delta);
+    break;
+  case 7:
+    ncols = 
+      sscanf(line,"%d %lf %lf %d %f %f %f %g %g %f %f %g %g %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %lf %lf %lf %lf %lf %d %d %lf %d %d %lf",
+	     &sptr->id,&sptr->x,&sptr->y,&sptr->fitflag,&sptr->class,
+	     &sptr->miso,&sptr->misoerr,&sptr->fiso,&sptr->fisoerr,
+	     &sptr->mtot,&sptr->merr,&sptr->fauto,&sptr->fautoerr,
+	     &sptr->r_kron,&sptr->bkgd,&sptr->thresh,&sptr->muthresh,
+	     &sptr->isoarea,&sptr->a_im,
+	     &sptr->b_im,&sptr->theta,&sptr->fwhm,
+	     &sptr->ma1,&sptr->ma2,&sptr->ma3,
+	     &sptr->ma1err,&sptr->ma2err,&sptr->ma3err,
+	     &sptr->fa1,&sptr->fa2,&sptr->fa3,
+	     &sptr->fa1err,&sptr->fa2err,&sptr->fa3err,
+	     &sptr->r2,&sptr->r5,&sptr->r8,&sptr->alpha,&sptr->delta,
+	     &sptr->dx,&sptr->dy,&sptr->dpos,
+	     &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
+	     &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec);
+    break;
+  case 8:
+    ncols = 
+      sscanf(line,"%d %d %lf %d %d %lf %f",
+	     &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
+	     &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec,
+	     &sptr->mtot);
+    break;
+  case 9:
+    ncols = 
+      sscanf(line,"%s %d %d %lf %d %d %lf %f %f",
+	     sptr->name,
+	     &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
+	     &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec,
+	     &sptr->mtot,&sptr->merr);
+    break;
+  case 10:
+    ncols = 
+      sscanf(line,"%s %lf %lf %f %f",
+	     sptr->name,&sptr->alpha,&sptr->delta,&sptr->mtot,&sptr->merr);
+    break;
+  case 13:
+    ncols = 
+      sscanf(line,
+	     "%d %lf %lf %lf %lf %d %f %f %f %g %g %f %f %f %f %f %f %f %f %f",
+	     &sptr->id,&sptr->alpha,&sptr->delta,
+	     &sptr->x,&sptr->y,&sptr->fitflag,&sptr->class,
+	     &sptr->mtot,&sptr->merr,&sptr->fauto,&sptr->fautoerr,
+	     &sptr->r_kron,&sptr->a_im,&sptr->b_im,&sptr->theta,&sptr->fwhm,
+	     &sptr->bkgd,&sptr->thresh,&sptr->muthresh,&sptr->isoarea);
+    break;
+  case 15:
+    ncols = 
+      sscanf(line,"%s %lf %lf %f %f",
+	     sptr->name,&sptr->alpha,&sptr->delta,&sptr->zspec,
+	     &sptr->zspecerr);
+    break;
+  case 16:
+    ncols = 
+      sscanf(line,"%s %d %d %lf %d %d %lf %f",
+	     sptr->name,
+	     &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
+	     &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec,
+	     &sptr->zspec);
+    break;
+  case 17:
+    ncols = 
+      sscanf(line,"%d %lf %lf %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %d %f",
+	     &sptr->id,&sptr->x,&sptr->y,&sptr->mtot,&sptr->merr,
+	     &sptr->maper[0],&sptr->maper[1],&sptr->maper[2],
+	     &sptr->maper[3],&sptr->maper[4],&sptr->maper[5],
+	     &sptr->maper[6],&sptr->maper[7],&sptr->maper[8],
+	     &sptr->maper[9],&sptr->maper[10],&sptr->maper[11],
+	     &sptr->maper[12],&sptr->maper[13],&sptr->maper[14],
+	     &sptr->maper[15],&sptr->maper[16],&sptr->maper[17],
+	     &sptr->maper[18],&sptr->maper[19],
+	     &sptr->mapererr[0],&sptr->mapererr[1],&sptr->mapererr[2],
+	     &sptr->mapererr[3],&sptr->mapererr[4],&sptr->mapererr[5],
+	     &sptr->mapererr[6],&sptr->mapererr[7],&sptr->mapererr[8],
+	     &sptr->mapererr[9],&sptr->mapererr[10],&sptr->mapererr[11],
+	     &sptr->mapererr[12],&sptr->mapererr[13],&sptr->mapererr[14],
+	     &sptr->mapererr[15],&sptr->mapererr[16],&sptr->mapererr[17],
+	     &sptr->mapererr[18],&sptr->mapererr[19],
+	     &sptr->fitflag,&sptr->class);
+    break;
+  case 18:
+    ncols = sscanf(line,"%lf %lf %f %f %f %f",
+		   &sptr->x,&sptr->y,&sptr->a_im,&sptr->b_im,&sptr->theta,
+		   &sptr->r_kron);
+    break;
+  }
+
+  return ncols;
+}
+
+/*.......................................................................
+ *
+ * Function finish_secat_line
+ *
+ * Fills in the members of a Secat structure that are derived from the
+ *  columns of a secat-style catalog line (IDs, names and the conversions
+ *  between alpha,delta and RA,Dec), once the columns have been read
+ *  by either scan_secat_line or tok_catalog_line.
+ *
+ * Inputs: int format          format code (see secat_format)
+ *         Secat *sptr         structure to fill
+ *         double djunk        column that is not stored directly
+ *         int *count          running count used to set IDs for formats
+ *                              without an ID column (updated here)
+ *
+ * Output: (none)
+ *
+ */
+
+static void finish_secat_line(int format, Secat *sptr, double djunk,
+			      int *count)
+{
+  double rjunk;             /* Unrequired output of xy2rth */
+  Lpos tmppos;              /* Temporary position holder */
+
+  switch(format) {
+  case 0:
+    sptr->id = (int) djunk;
+    sprintf(sptr->name,"%d",sptr->id);
+    break;
+  case 1:
+    (*count)++;
+    sptr->id = *count; 
+    sprintf(sptr->name,"%d",*count);
+    break;
+  case 2:
+    (*count)++;
+    sptr->id = *count; 
+    sprintf(sptr->name,"%d",*count);
+
+    /*
+     * Convert RA,Dec to alpha,delta 
+     */
+
+    spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
+    break;
+  case 3:
+
+    /*
+     * Convert RA,Dec to alpha,delta 
+     */
+
+    spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
+    break;
+  case 4:
+    (*count)++;
+    sptr->id = *count; 
+    sprintf(sptr->name,"%d",sptr->id);
+
+    /*
+     * Convert alpha,delta to RA,Dec
+     */
+
+    deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
+    break;
+  case 6:
+  case 13:
+    sprintf(sptr->name,"%d",sptr->id);
+
+    /*
+     * Convert alpha,delta to RA,Dec
+     */
+
+    deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
+    break;
+  case 7:
+    sprintf(sptr->name,"%d",sptr->id);
+
+    /*
+     * Convert dx,dy to r,theta
+     */
+
+    tmppos.x = -sptr->dx;
+    tmppos.y = sptr->dy;
+    xy2rth(tmppos,&rjunk,&sptr->dpostheta,1);
+    break;
+  case 8:
+    sptr->id = *count + 1; 
+    sprintf(sptr->name,"%d",sptr->id);
+    (*count)++;
+    /*
+     * Convert RA,Dec to alpha,delta 
+     */
+
+    spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
+    break;
+  case 9:
+  case 16:
+    sptr->id = *count + 1; 
+    (*count)++;
+    /*
+     * Convert RA,Dec to alpha,delta 
+     */
+
+    spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
+    break;
+  case 10:
+  case 15:
+    sptr->id = *count + 1; 
+    (*count)++;
+    /*
+     * Convert alpha,delta to RA,Dec
+     */
+
+    deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
+    break;
+  case 17:
+    sprintf(sptr->name,"%d",sptr->id);
+    break;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function parse_secat_line
+ *
+ * Parses one data line of a secat-style catalog into a Secat structure.
+ *  This is the per-line part of read_secat, shared with the other
+ *  catalog readers.
+ *
+ * Inputs: char *line          input line
+ *         int format          format code (see secat_format)
+ *         Secat *sptr         structure to fill
+ *         int *count          running count used to set IDs for formats
+ *                              without an ID column (updated here)
+ *
+ * Output: int ncols           number of columns successfully read
+ *
+ */
+
+static int parse_secat_line(char *line, int format, Secat *sptr, int *count)
+{
+  int ncols;                /* Number of columns read */
+  double djunk=0.0;         /* Variable used to read in unrequired data */
+
+  ncols = scan_secat_line(line,format,sptr,&djunk);
+  finish_secat_line(format,sptr,djunk,count);
+
+  return ncols;
+}
+
+/*.......................................................................
+ *
+ * Function parse_sdss_line
+ *
+ * Parses one data line of a SDSS-style catalog into a SDSScat structure.
+ *  This is the per-line part of read_sdss, shared with parse_sdss_chunk.
+ *
+ * Inputs: char *line          input line
+ *         SDSScat *sptr       structure to fill
+ *
+ * Output: int ncols           number of columns successfully read
+ *
+ */
+
+static int parse_sdss_line(char *line, SDSScat *sptr)
+{
+  int ncols;                /* Number of columns read */
+
+  sptr->alpha = sptr->delta = 0.0;
+  sptr->u = sptr->g = sptr->r = sptr->i = sptr->z = -99.0;
+  ncols = sscanf(line,"%lf %lf %f %f %f %f %f %f",
+		 &sptr->alpha,&sptr->delta,
+		 &sptr->u,&sptr->g,&sptr->r,&sptr->i,&sptr->z,
+		 &sptr->class);
+
+  /*
+   * Convert alpha,delta to RA,Dec
+   */
+
+  deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
+
+  return ncols;
+}
+
+/*.......................................................................
+ *
+ * Column layouts of the secat formats, used by tok_catalog_line.  Each
+ *  entry gives the type of a column ('i' int, 'f' float, 'd' double,
+ *  's' string, 'j' double that is not stored directly) and its byte
+ *  offset within the Secat structure.  A projected layout (see
+ *  project_fields) marks the columns that are not wanted with 'x'.  The layouts must match the sscanf
+ *  formats in scan_secat_line.  The SDSS layout, with offsets within
+ *  SDSScat, matches parse_sdss_line.
+ */
+
+typedef struct {
+  char type;         /* Column type */
+  int offset;        /* Offset of the member within Secat (or SDSScat) */
+} Secfield;
+
+#define SECFIELD(type,member) {type, (int) offsetof(Secat,member)}
+#define SECFIELD_SKYPOS \
+  SECFIELD('i',skypos.hr), SECFIELD('i',skypos.min), \
+  SECFIELD('d',skypos.sec), SECFIELD('i',skypos.deg), \
+  SECFIELD('i',skypos.amin), SECFIELD('d',skypos.asec)
+#define SECFIELD_APER(member) \
+  SECFIELD('f',member[0]), SECFIELD('f',member[1]), SECFIELD('f',member[2])
+#define SECFIELD_APER20(member) \
+  SECFIELD_APER(member), SECFIELD('f',member[3]), SECFIELD('f',member[4]), \
+  SECFIELD('f',member[5]), SECFIELD('f',member[6]), SECFIELD('f',member[7]), \
+  SECFIELD('f',member[8]), SECFIELD('f',member[9]), \
+  SECFIELD('f',member[10]), SECFIELD('f',member[11]), \
+  SECFIELD('f',member[12]), SECFIELD('f',member[13]), \
+  SECFIELD('f',member[14]), SECFIELD('f',member[15]), \
+  SECFIELD('f',member[16]), SECFIELD('f',member[17]), \
+  SECFIELD('f',member[18]), SECFIELD('f',member[19])
+#define SECFIELD_SEXTRACTOR \
+  SECFIELD('i',id), SECFIELD('d',x), SECFIELD('d',y), \
+  SECFIELD('i',fitflag), SECFIELD('f',class), SECFIELD('f',miso), \
+  SECFIELD('f',misoerr), SECFIELD('f',fiso), SECFIELD('f',fisoerr), \
+  SECFIELD('f',mtot), SECFIELD('f',merr), SECFIELD('f',fauto), \
+  SECFIELD('f',fautoerr), SECFIELD('f',r_kron), SECFIELD('f',bkgd), \
+  SECFIELD('f',thresh), SECFIELD('f',muthresh), SECFIELD('f',isoarea), \
+  SECFIELD('f',a_im), SECFIELD('f',b_im), SECFIELD('f',theta), \
+  SECFIELD('f',fwhm)
+
+static Secfield secfields0[] = {
+  {'j', 0}, SECFIELD('d',alpha), SECFIELD('d',delta)
+};
+static Secfield secfields1[] = {
+  SECFIELD('d',alpha), SECFIELD('d',delta)
+};
+static Secfield secfields2[] = {
+  SECFIELD_SKYPOS
+};
+static Secfield secfields3[] = {
+  SECFIELD('d',x), SECFIELD('d',y), SECFIELD_SKYPOS
+};
+static Secfield secfields6[] = {
+  SECFIELD_SEXTRACTOR,
+  SECFIELD_APER(maper), SECFIELD_APER(mapererr),
+  SECFIELD_APER(faper), SECFIELD_APER(fapererr),
+  SECFIELD('f',r2), SECFIELD('f',r5), SECFIELD('f',r8),
+  SECFIELD('d',alpha), SECFIELD('d',delta)
+};
+static Secfield secfields7[] = {
+  SECFIELD_SEXTRACTOR,
+  SECFIELD('f',ma1), SECFIELD('f',ma2), SECFIELD('f',ma3),
+  SECFIELD('f',ma1err), SECFIELD('f',ma2err), SECFIELD('f',ma3err),
+  SECFIELD('f',fa1), SECFIELD('f',fa2), SECFIELD('f',fa3),
+  SECFIELD('f',fa1err), SECFIELD('f',fa2err), SECFIELD('f',fa3err),
+  SECFIELD('f',r2), SECFIELD('f',r5), SECFIELD('f',r8),
+  SECFIELD('d',alpha), SECFIELD('d',delta),
+  SECFIELD('d',dx), SECFIELD('d',dy), SECFIELD('d',dpos),
+  SECFIELD_SKYPOS
+};
+static Secfield secfields8[] = {
+  SECFIELD_SKYPOS, SECFIELD('f',mtot)
+};
+static Secfield secfields9[] = {
+  SECFIELD('s',name), SECFIELD_SKYPOS, SECFIELD('f',mtot), SECFIELD('f',merr)
+};
+static Secfield secfields10[] = {
+  SECFIELD('s',name), SECFIELD('d',alpha), SECFIELD('d',delta),
+  SECFIELD('f',mtot), SECFIELD('f',merr)
+};
+static Secfield secfields13[] = {
+  SECFIELD('i',id), SECFIELD('d',alpha), SECFIELD('d',delta),
+  SECFIELD('d',x), SECFIELD('d',y), SECFIELD('i',fitflag),
+  SECFIELD('f',class), SECFIELD('f',mtot), SECFIELD('f',merr),
+  SECFIELD('f',fauto), SECFIELD('f',fautoerr), SECFIELD('f',r_kron),
+  SECFIELD('f',a_im), SECFIELD('f',b_im), SECFIELD('f',theta),
+  SECFIELD('f',fwhm), SECFIELD('f',bkgd), SECFIELD('f',thresh),
+  SECFIELD('f',muthresh), SECFIELD('f',isoarea)
+};
+static Secfield secfields15[] = {
+  SECFIELD('s',name), SECFIELD('d',alpha), SECFIELD('d',delta),
+  SECFIELD('f',zspec), SECFIELD('f',zspecerr)
+};
+static Secfield secfields16[] = {
+  SECFIELD('s',name), SECFIELD_SKYPOS, SECFIELD('f',zspec)
+};
+static Secfield secfields17[] = {
+  SECFIELD('i',id), SECFIELD('d',x), SECFIELD('d',y),
+  SECFIELD('f',mtot), SECFIELD('f',merr),
+  SECFIELD_APER20(maper), SECFIELD_APER20(mapererr),
+  SECFIELD('i',fitflag), SECFIELD('f',class)
+};
+static Secfield secfields18[] = {
+  SECFIELD('d',x), SECFIELD('d',y), SECFIELD('f',a_im), SECFIELD('f',b_im),
+  SECFIELD('f',theta), SECFIELD('f',r_kron)
+};
+
+static Secfield sdssfields[] = {
+  {'d', (int) offsetof(SDSScat,alpha)}, {'d', (int) offsetof(SDSScat,delta)},
+  {'f', (int) offsetof(SDSScat,u)}, {'f', (int) offsetof(SDSScat,g)},
+  {'f', (int) offsetof(SDSScat,r)}, {'f', (int) offsetof(SDSScat,i)},
+  {'f', (int) offsetof(SDSScat,z)}, {'f', (int) offsetof(SDSScat,class)}
+};
+
+#define NSECFIELDS(table) ((int) (sizeof(table) / sizeof(Secfield)))
+
+/*.......................................................................
+ *
+ * Function secat_fields
+ *
+ * Returns the column layout for a secat format code.
+ *
+ * Inputs: int format          format code (see secat_format)
+ *         int *nfields        number of columns in the layout (set by
+ *                              function)
+ *
+ * Output: Secfield *fields    column layout, or NULL for an invalid format
+ *
+ */
+
+static Secfield *secat_fields(int format, int *nfields)
+{
+  switch(format) {
+  case 0:
+    *nfields = NSECFIELDS(secfields0);
+    return secfields0;
+  case 1:
+  case 4:
+    *nfields = NSECFIELDS(secfields1);
+    return secfields1;
+  case 2:
+    *nfields = NSECFIELDS(secfields2);
+    return secfields2;
+  case 3:
+    *nfields = NSECFIELDS(secfields3);
+    return secfields3;
+  case 6:
+    *nfields = NSECFIELDS(secfields6);
+    return secfields6;
+  case 7:
+    *nfields = NSECFIELDS(secfields7);
+    return secfields7;
+  case 8:
+    *nfields = NSECFIELDS(secfields8);
+    return secfields8;
+  case 9:
+    *nfields = NSECFIELDS(secfields9);
+    return secfields9;
+  case 10:
+    *nfields = NSECFIELDS(secfields10);
+    return secfields10;
+  case 13:
+    *nfields = NSECFIELDS(secfields13);
+    return secfields13;
+  case 15:
+    *nfields = NSECFIELDS(secfields15);
+    return secfields15;
+  case 16:
+    *nfields = NSECFIELDS(secfields16);
+    return secfields16;
+  case 17:
+    *nfields = NSECFIELDS(secfields17);
+    return secfields17;
+  case 18:
+    *nfields = NSECFIELDS(secfields18);
+    return secfields18;
+  default:
+    *nfields = 0;
+    return NULL;
+  }
+}
+
+/*
+ * Exact powers of ten for the fast conversions in tok_double and
+ *  tok_float.  A mantissa below 2^53 (2^24 for floats) times or divided
+ *  by one of these is a single correctly rounded operation, and so gives
+ *  the same bits as strtod (strtof).  That only holds when the arithmetic
+ *  is done in the nominal precision, which FLT_EVAL_METHOD tells us.
+ */
+
+static const double tokpow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+static const float tokpow10f[] = {
+  1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0 || FLT_EVAL_METHOD == 1)
+#define TOK_FASTDOUBLE 1
+#else
+#define TOK_FASTDOUBLE 0
+#endif
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#define TOK_FASTFLOAT 1
+#else
+#define TOK_FASTFLOAT 0
+#endif
+
+#define TOKMAX 64   /* Longest token handed to strtod/strtof */
+
+/*.......................................................................
+ *
+ * Function tok_decimal
+ *
+ * Splits a plain decimal number, [+-]digits[.digits][(e|E)[+-]digits],
+ *  into its sign, an integer mantissa and a power of ten.  Anything else
+ *  (more than 19 significant digits, hex, inf, nan, trailing characters)
+ *  is refused so that the caller can hand it to the C library.
+ *
+ * Inputs: const char *s       start of token
+ *         const char *e       end of token (one past the last character)
+ *         int *neg            1 if the number is negative (set by function)
+ *         unsigned long long *mant  mantissa (set by function)
+ *         int *exp10          power of ten (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> split, 1 ==> not a plain decimal
+ *
+ */
+
+static int tok_decimal(const char *s, const char *e, int *neg,
+		       unsigned long long *mant, int *exp10)
+{
+  int ndig=0;               /* Number of significant digits */
+  int nfrac=0;              /* Number of digits after the decimal point */
+  int seen=0;               /* Set to 1 once a mantissa digit is found */
+  int expo=0;               /* Explicit exponent */
+  int eneg=0;               /* Set to 1 for a negative exponent */
+  unsigned long long m=0;   /* Accumulated mantissa */
+
+  *neg = 0;
+  if(s < e && (*s == '-' || *s == '+'))
+    *neg = (*s++ == '-');
+
+  for(; s < e && *s >= '0' && *s <= '9'; s++) {
+    seen = 1;
+    if(m || *s != '0') {
+      if(++ndig > 19)
+	return 1;
+      m = 10 * m + (*s - '0');
+    }
+  }
+  if(s < e && *s == '.') {
+    for(s++; s < e && *s >= '0' && *s <= '9'; s++) {
+      seen = 1;
+      nfrac++;
+      if(m || *s != '0') {
+	if(++ndig > 19)
+	  return 1;
+	m = 10 * m + (*s - '0');
+      }
+    }
+  }
+  if(!seen)
+    return 1;
+
+  if(s < e && (*s == 'e' || *s == 'E')) {
+    s++;
+    if(s < e && (*s == '-' || *s == '+'))
+      eneg = (*s++ == '-');
+    if(s == e || *s < '0' || *s > '9')
+      return 1;
+    for(; s < e && *s >= '0' && *s <= '9'; s++)
+      if(expo < 10000)
+	expo = 10 * expo + (*s - '0');
+  }
+  if(s != e)
+    return 1;
+
+  *mant = m;
+  *exp10 = (eneg ? -expo : expo) - nfrac;
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function tok_double
+ *
+ * Converts a token to a double, giving the same value as the %lf
+ *  conversion of sscanf.  Plain decimals that can be converted exactly
+ *  are done here; everything else goes through strtod.
+ *
+ * Inputs: const char *s       start of token
+ *         const char *e       end of token
+ *         double *val         converted value (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> converted, 1 ==> token is not a number
+ *
+ */
+
+static int tok_double(const char *s, const char *e, double *val)
+{
+  int neg;                  /* Sign of the number */
+  int exp10;                /* Power of ten */
+  unsigned long long mant;  /* Integer mantissa */
+  char tok[TOKMAX];         /* Terminated copy of the token */
+  char *endptr;             /* End of conversion in tok */
+
+  if(TOK_FASTDOUBLE && !tok_decimal(s,e,&neg,&mant,&exp10) &&
+     mant <= (1ULL << 53) && exp10 >= -22 && exp10 <= 22) {
+    if(exp10 < 0)
+      *val = (double) mant / tokpow10[-exp10];
+    else
+      *val = (double) mant * tokpow10[exp10];
+    if(neg)
+      *val = -*val;
+    return 0;
+  }
+
+  if(e - s >= TOKMAX)
+    return 1;
+  memcpy(tok,s,e-s);
+  tok[e-s] = '\0';
+  *val = strtod(tok,&endptr);
+  return (endptr == tok + (e-s)) ? 0 : 1;
+}
+
+/*.......................................................................
+ *
+ * Function tok_float
+ *
+ * Converts a token to a float, giving the same value as the %f
+ *  conversion of sscanf.  See tok_double.
+ *
+ * Inputs: const char *s       start of token
+ *         const char *e       end of token
+ *         float *val          converted value (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> converted, 1 ==> token is not a number
+ *
+ */
+
+static int tok_float(const char *s, const char *e, float *val)
+{
+  int neg;                  /* Sign of the number */
+  int exp10;                /* Power of ten */
+  unsigned long long mant;  /* Integer mantissa */
+  char tok[TOKMAX];         /* Terminated copy of the token */
+  char *endptr;             /* End of conversion in tok */
+
+  if(TOK_FASTFLOAT && !tok_decimal(s,e,&neg,&mant,&exp10) &&
+     mant <= (1ULL << 24) && exp10 >= -10 && exp10 <= 10) {
+    *val = (float) mant;
+    if(exp10 < 0)
+      *val = *val / tokpow10f[-exp10];
+    else
+      *val = *val * tokpow10f[exp10];
+    if(neg)
+      *val = -*val;
+    return 0;
+  }
+
+  if(e - s >= TOKMAX)
+    return 1;
+  memcpy(tok,s,e-s);
+  tok[e-s] = '\0';
+  *val = strtof(tok,&endptr);
+  return (endptr == tok + (e-s)) ? 0 : 1;
+}
+
+/*.......................................................................
+ *
+ * Function tok_int
+ *
+ * Converts a token of at most 9 digits, with an optional sign, to an int.
+ *  Longer tokens are refused, since sscanf's handling of overflow is
+ *  left to the C library.
+ *
+ * Inputs: const char *s       start of token
+ *         const char *e       end of token
+ *         int *val            converted value (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> converted, 1 ==> not handled
+ *
+ */
+
+static int tok_int(const char *s, const char *e, int *val)
+{
+  int neg=0;                /* Set to 1 for a negative number */
+  int v=0;                  /* Accumulated value */
+
+  if(s < e && (*s == '-' || *s == '+'))
+    neg = (*s++ == '-');
+  if(s == e || e - s > 9)
+    return 1;
+  for(; s < e; s++) {
+    if(*s < '0' || *s > '9')
+      return 1;
+    v = 10 * v + (*s - '0');
+  }
+
+  *val = neg ? -v : v;
+  return 0;
+}
+
+#define TOK_SPACE(c) ((c) == ' ' || (c) == '\t' || (c) == '\r' || \
+		      (c) == '\v' || (c) == '\f')
+
+/*.......................................................................
+ *
+ * Function tok_catalog_line
+ *
+ * Reads the columns of one data line of a catalog directly from a
+ *  memory-mapped file, without copying the line.  The columns are split
+ *  at whitespace and converted according to a layout from secat_fields
+ *  (or sdssfields).  Only rows whose every column converts cleanly are
+ *  handled here; anything else (too few columns, malformed numbers,
+ *  overlong names) is refused, and the caller then passes the row to
+ *  its sscanf parser so that the results are always identical to the
+ *  sscanf path.
+ *
+ * Inputs: const char *s       start of line
+ *         const char *e       end of line (the newline or end of file)
+ *         Secfield *fields    column layout
+ *         int nfields         number of columns in layout
+ *         void *rec           structure to fill (Secat or SDSScat)
+ *         double *djunk       holder for a 'j' column (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> row read, 1 ==> use sscanf instead
+ *
+ */
+
+static int tok_catalog_line(const char *s, const char *e, Secfield *fields,
+			    int nfields, void *rec, double *djunk)
+{
+  int i;                    /* Looping variable */
+  const char *t;            /* End of current token */
+  char *member;             /* Location of the current member */
+
+  for(i=0; i<nfields; i++) {
+    while(s < e && TOK_SPACE(*s))
+      s++;
+    if(s == e)
+      return 1;
+    for(t=s; t < e && !TOK_SPACE(*t); t++);
+
+    member = (char *) rec + fields[i].offset;
+    switch(fields[i].type) {
+    case 'i':
+      if(tok_int(s,t,(int *) member))
+	return 1;
+      break;
+    case 'f':
+      if(tok_float(s,t,(float *) member))
+	return 1;
+      break;
+    case 'd':
+      if(tok_double(s,t,(double *) member))
+	return 1;
+      break;
+    case 'j':
+      if(tok_double(s,t,djunk))
+	return 1;
+      break;
+    case 's':
+      if(t - s >= MAXC)
+	return 1;
+      memcpy(member,s,t-s);
+      member[t-s] = '\0';
+      break;
+    case 'x':
+      break;
+    default:
+      return 1;
+    }
+    s = t;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function parse_mapped_secat
+ *
+ * Parses one data line of a secat-style catalog that lies in a
+ *  memory-mapped file.  The line is read in place by tok_catalog_line if
+ *  possible, and is otherwise copied out and given to parse_secat_line.
+ *
+ * Inputs: const char *s       start of line
+ *         const char *e       end of line (the newline or end of file)
+ *         Secfield *fields    column layout for the format
+ *         int nfields         number of columns in layout
+ *         int format          format code (see secat_format)
+ *         Secat *sptr         structure to fill
+ *         int *count          running count used to set IDs for formats
+ *                              without an ID column (updated here)
+ *
+ * Output: int ncols           number of columns successfully read
+ *
+ */
+
+static int parse_mapped_secat(const char *s, const char *e, Secfield *fields,
+			      int nfields, int format, Secat *sptr,
+			      int *count)
+{
+  size_t len;               /* Length of the copied line */
+  double djunk;             /* Variable used to read in unrequired data */
+  char line[MAXC];          /* Copy of a line that needs sscanf */
+
+  init_secat(sptr);
+  if(tok_catalog_line(s,e,fields,nfields,sptr,&djunk) == 0) {
+    finish_secat_line(format,sptr,djunk,count);
+    return nfields;
+  }
+
+  len = e - s;
+  if(len > MAXC - 1)
+    len = MAXC - 1;
+  memcpy(line,s,len);
+  line[len] = '\0';
+  init_secat(sptr);
+  return parse_secat_line(line,format,sptr,count);
+}
+
+/*.......................................................................
+ *
+ * Function count_data_lines
+ *
+ * Counts the lines, and the data (non-comment) lines, in a piece of a
+ *  memory-mapped file.  Used to split a file between threads (see
+ *  catpar.c), so that each piece can be parsed straight into its own
+ *  part of the output array.
+ *
+ * Inputs: char *start         start of the piece (at the start of a line)
+ *         char *end           end of the piece
+ *         char comment        comment character
+ *         int *nphys          number of lines (set by function)
+ *
+ * Output: int ndata           number of data lines
+ *
+ */
+
+int count_data_lines(char *start, char *end, char comment, int *nphys)
+{
+  int ndata=0;              /* Number of data lines */
+  char *ptr;                /* Start of current line */
+  char *eol;                /* End of current line */
+
+  *nphys = 0;
+  for(ptr=start; ptr < end; ptr = eol + 1) {
+    if(!(eol = memchr(ptr,'\n',end - ptr)))
+      eol = end;
+    (*nphys)++;
+    if(*ptr != comment)
+      ndata++;
+  }
+
+  return ndata;
+}
+
+/*.......................................................................
+ *
+ * Function parse_secat_chunk
+ *
+ * Parses the data lines in a piece of a memory-mapped secat-style
+ *  catalog into a Secat array that already has room for them (see
+ *  count_data_lines).  Any header lines must already have been skipped.
+ *  The results are identical to those of read_secat for the same lines.
+ *
+ * Inputs: char *start         start of the piece (at the start of a line)
+ *         char *end           end of the piece
+ *         char comment        comment character
+ *         int format          format code (see secat_format)
+ *         int count           number of data lines in the file before
+ *                              this piece (used for the IDs of formats
+ *                              without an ID column)
+ *         Secat *secat        array to fill
+ *         int *lc             number of lines in the file before this
+ *                              piece.  On an error, set to the line number
+ *                              of the bad line.
+ *         int *ncols          number of columns read from the last (or
+ *                              bad) line (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> bad line or format
+ *
+ */
+
+int parse_secat_chunk(char *start, char *end, char comment, int format,
+		      int count, Secat *secat, int *lc, int *ncols)
+{
+  int nexp,nskip;           /* Expected columns and header lines */
+  int nfields;              /* Number of columns in the format layout */
+  char *ptr;                /* Start of current line */
+  char *eol;                /* End of current line */
+  Secfield *fields;         /* Column layout for the format */
+  Secat *sptr=secat;        /* Pointer to navigate secat */
+
+  *ncols = 0;
+  if(secat_format_info(format,&nexp,&nskip) ||
+     !(fields = secat_fields(format,&nfields)) || nfields < nexp)
+    return 1;
+
+  for(ptr=start; ptr < end; ptr = eol + 1) {
+    if(!(eol = memchr(ptr,'\n',end - ptr)))
+      eol = end;
+    (*lc)++;
+    if(*ptr == comment)
+      continue;
+    *ncols = parse_mapped_secat(ptr,eol,fields,nfields,format,sptr,&count);
+    if(*ncols < nexp)
+      return 1;
+    sptr++;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function parse_sdss_chunk
+ *
+ * The SDSS version of parse_secat_chunk.  The results are identical to
+ *  those of read_sdss for the same lines.
+ *
+ * Inputs: char *start         start of the piece (at the start of a line)
+ *         char *end           end of the piece
+ *         char comment        comment character
+ *         SDSScat *sdss       array to fill
+ *         int *lc             number of lines in the file before this
+ *                              piece.  On an error, set to the line number
+ *                              of the bad line.
+ *         int *ncols          number of columns read from the last (or
+ *                              bad) line (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> bad line
+ *
+ */
+
+int parse_sdss_chunk(char *start, char *end, char comment, SDSScat *sdss,
+		     int *lc, int *ncols)
+{
+  size_t len;               /* Length of a copied line */
+  double djunk;             /* Not used */
+  char *ptr;                /* Start of current line */
+  char *eol;                /* End of current line */
+  char line[MAXC];          /* Copy of a line that needs sscanf */
+  SDSScat *sptr=sdss;       /* Pointer to navigate sdss */
+
+  *ncols = 0;
+  for(ptr=start; ptr < end; ptr = eol + 1) {
+    if(!(eol = memchr(ptr,'\n',end - ptr)))
+      eol = end;
+    (*lc)++;
+    if(*ptr == comment)
+      continue;
+    if(tok_catalog_line(ptr,eol,sdssfields,NSECFIELDS(sdssfields),sptr,
+			&djunk) == 0) {
+      deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
+      *ncols = NSECFIELDS(sdssfields);
+    }
+    else {
+      len = eol - ptr;
+      if(len > MAXC - 1)
+	len = MAXC - 1;
+      memcpy(line,ptr,len);
+      line[len] = '\0';
+      *ncols = parse_sdss_line(line,sptr);
+    }
+    if(*ncols != NSECFIELDS(sdssfields))
+      return 1;
+    sptr++;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function read_secat_mapped
+ *
+ * The data-reading loop of read_secat_mode for READ_MMAP.  The input file
+ *  is mapped into memory and walked line by line in place, with the
+ *  lines parsed by parse_mapped_secat.  Rows that cannot be read in
+ *  place are copied out and given to parse_secat_line, so the values
+ *  are the same as those from the stdio loop.  Unlike fgets, lines
+ *  longer than MAXC are not split into several rows.
+ *
+ * Inputs: FILE *ifp           open input file
+ *         char *inname        name of input file (for messages)
+ *         char comment        comment character
+ *         int format          format code (see secat_format)
+ *         int nexp            number of expected columns
+ *         int nskip           number of header lines to skip
+ *         Secat **newdata     array being filled (grown by function)
+ *         int *nalloc         number of members allocated in *newdata
+ *         int *nlines         number of rows read (set by function)
+ *         int *ncols          number of columns read from the last row
+ *                              (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+static int read_secat_mapped(FILE *ifp, char *inname, char comment,
+			     int format, int nexp, int nskip, Secat **newdata,
+			     int *nalloc, int *nlines, int *ncols)
+{
+  int lc=0;                 /* Running counter for line number */
+  int count=0;              /* Used to set ID number for catalogs with no IDs */
+  int nfields;              /* Number of columns in the format layout */
+  size_t size;              /* Size of the mapped file */
+  char *data;               /* Mapped file */
+  char *ptr;                /* Start of current line */
+  char *eol;                /* End of current line */
+  char *end;                /* End of mapped file */
+  Secfield *fields;         /* Column layout for the format */
+  Secat *sptr;              /* Pointer to navigate secat */
+
+  if(!(fields = secat_fields(format,&nfields)) || nfields < nexp) {
+    fprintf(stderr,"ERROR: read_secat_mapped. No layout for format %d\n",
+	    format);
+    return 1;
+  }
+  if(map_readfile(ifp,&data,&size)) {
+    fprintf(stderr,"ERROR: read_secat_mapped.\n");
+    return 1;
+  }
+
+  *nlines = 0;
+  end = data + size;
+  for(ptr=data; ptr < end; ptr = eol + 1) {
+    if(!(eol = memchr(ptr,'\n',end - ptr)))
+      eol = end;
+    /* Have to skip the first nskip lines */
+    if(++lc <= nskip || *ptr == comment)
+      continue;
+
+    if(!(*newdata = (Secat *) grow_array(*newdata,nalloc,*nlines+1,
+					 sizeof(Secat)))) {
+      unmap_file(data,size);
+      return 1;
+    }
+    sptr = *newdata + *nlines;
+    *ncols = parse_mapped_secat(ptr,eol,fields,nfields,format,sptr,&count);
+    if(*ncols < nexp) {
+      fprintf(stderr,
+	      "ERROR: read_secat.  Bad input format in %s. (line = %d)\n",
+	      inname,lc);
+      fprintf(stderr," File must contain at least %d columns.",nexp);
+      fprintf(stderr," --  it contained %d columns.\n",*ncols);
+      unmap_file(data,size);
+      return 1;
+    }
+    (*nlines)++;
+  }
+
+  unmap_file(data,size);
+  if(lc > 0 && lc <= nskip) {
+    fprintf(stderr,"ERROR: read_secat. Bad file format for %s\n",inname);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Binary catalog cache (.bcat) files
+ *
+ * A .bcat file holds a catalog that has already been read from a text
+ *  file, laid out as the columns of a Colcat so that it can be mapped
+ *  back into memory without any parsing.  It is written next to the text
+ *  file, with ".bcat" appended to the name, and is only used while the
+ *  text file keeps the size, modification time (to the nanosecond),
+ *  inode and hash of its first and last BCAT_HASHLEN bytes recorded in
+ *  the header.  The cache is only read or written when the BCAT_CACHE
+ *  environment variable is set (to anything but "0"), so that no sidecar
+ *  files appear unless they have been asked for.  The layout is
+ *
+ *   Bcathead              fixed header
+ *   Bcatcol[ncols]        column directory
+ *   columns               each starting on an 8-byte boundary
+ *
+ *  with all numbers little-endian.  The columns are the scalar Colcat
+ *  columns in colcat_colinfo order, then maper, mapererr, faper and
+ *  fapererr if naper > 0, then nameoff and namepool.  On a big-endian
+ *  machine the cache is simply not used.
+ */
+
+#define BCAT_MAGIC "CDFBCAT"
+#define BCAT_VERSION 2
+#define BCAT_HASHLEN 4096  /* Bytes hashed at each end of the text file */
+#define BCAT_ALIGN(n) (((n) + 7) & ~((long long) 7))
+#define MAXBCATCOL 64  /* Room for the scalar, aperture and name columns */
+
+typedef struct {
+  char magic[8];        /* BCAT_MAGIC */
+  int version;          /* BCAT_VERSION */
+  int format;           /* Format code of the text file */
+  int comment;          /* Comment character used to read the text file */
+  int ncat;             /* Number of catalog members */
+  int naper;            /* Apertures per member */
+  int ncols;            /* Number of entries in the column directory */
+  long long srcsize;    /* Size of the text file */
+  long long srcmtime;   /* Modification time of the text file */
+  long long srcino;     /* Inode of the text file */
+  long long srcnsec;    /* Nanosecond part of the modification time */
+  long long srchash;    /* Hash of the ends of the text file */
+} Bcathead;
+
+typedef struct {
+  char name[16];        /* Column name */
+  int type;             /* 'i', 'f', 'd' or 'c' (bytes) */
+  int elsize;           /* Size of one element */
+  long long offset;     /* Offset of the column from the start of the file */
+  long long nbytes;     /* Length of the column */
+} Bcatcol;
+
+/*.......................................................................
+ *
+ * Function bcat_columns
+ *
+ * Fills in the column directory of a .bcat file for a catalog, apart
+ *  from the offsets, and returns the number of columns.  The ncat, naper
+ *  and poolsize members of the catalog must already be set.  colref
+ *  is set to the address of each column pointer within the Colcat, so
+ *  that the columns can be either written out or pointed at a map.
+ *
+ * Inputs: Colcat *colcat      catalog
+ *         Bcatcol *dir        directory to fill (room for MAXBCATCOL)
+ *         void ***colref      column pointer addresses (room for
+ *                              MAXBCATCOL, set by function)
+ *
+ * Output: int ncols           number of columns
+ *
+ */
+
+static int bcat_columns(Colcat *colcat, Bcatcol *dir, void ***colref)
+{
+  int i;                    /* Looping variable */
+  int ncols;                /* Number of scalar columns */
+  int n=0;                  /* Number of columns filled */
+  Colinfo *cptr;            /* Pointer to navigate the column descriptions */
+  static char *apername[4] = {"maper","mapererr","faper","fapererr"};
+
+  memset(dir,0,MAXBCATCOL * sizeof(Bcatcol));
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++,n++) {
+    strcpy(dir[n].name,cptr->name);
+    dir[n].type = cptr->type;
+    dir[n].elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    dir[n].nbytes = (long long) colcat->ncat * dir[n].elsize;
+    colref[n] = (void **) ((char *) colcat + cptr->coloff);
+  }
+
+  if(colcat->naper > 0) {
+    colref[n] = (void **) &colcat->maper;
+    colref[n+1] = (void **) &colcat->mapererr;
+    colref[n+2] = (void **) &colcat->faper;
+    colref[n+3] = (void **) &colcat->fapererr;
+    for(i=0; i<4; i++,n++) {
+      strcpy(dir[n].name,apername[i]);
+      dir[n].type = 'f';
+      dir[n].elsize = sizeof(float);
+      dir[n].nbytes = (long long) colcat->ncat * colcat->naper * sizeof(float);
+    }
+  }
+
+  strcpy(dir[n].name,"nameoff");
+  dir[n].type = 'i';
+  dir[n].elsize = sizeof(int);
+  dir[n].nbytes = (long long) colcat->ncat * sizeof(int);
+  colref[n++] = (void **) &colcat->nameoff;
+
+  strcpy(dir[n].name,"namepool");
+  dir[n].type = 'c';
+  dir[n].elsize = 1;
+  dir[n].nbytes = colcat->poolsize;
+  colref[n++] = (void **) &colcat->namepool;
+
+  return n;
+}
+
+/*.......................................................................
+ *
+ * Function bcat_usable
+ *
+ * Checks that the .bcat format can be used on this machine, i.e., that
+ *  it is little-endian with the expected type sizes.
+ *
+ * Inputs: (none)
+ *
+ * Output: int (0 or 1)        1 ==> usable, 0 ==> not usable
+ *
+ */
+
+static int bcat_usable()
+{
+  int one=1;                /* Used to test the byte order */
+
+  return (*(char *) &one == 1 && sizeof(int) == 4 && sizeof(float) == 4 &&
+	  sizeof(double) == 8 && sizeof(Bcathead) == 72 &&
+	  sizeof(Bcatcol) == 40);
+}
+
+/*.......................................................................
+ *
+ * Function bcat_enabled
+ *
+ * Checks whether the .bcat cache has been turned on by setting the
+ *  BCAT_CACHE environment variable to anything but "0".
+ *
+ * Inputs: (none)
+ *
+ * Output: int (0 or 1)        1 ==> enabled, 0 ==> not enabled
+ *
+ */
+
+static int bcat_enabled()
+{
+  char *val;                /* Value of BCAT_CACHE */
+
+  val = getenv("BCAT_CACHE");
+  return (val && val[0] != '\0' && strcmp(val,"0") != 0);
+}
+
+/*.......................................................................
+ *
+ * Function bcat_srchash
+ *
+ * Computes a 64-bit FNV-1a hash of the first and last BCAT_HASHLEN bytes
+ *  of a text file, which catches an in-place edit that keeps the size
+ *  and lands within the resolution of the modification time.
+ *
+ * Inputs: char *srcname       name of the text file
+ *         long long srcsize   size of the text file
+ *         long long *hash     hash (set by this function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+static int bcat_srchash(char *srcname, long long srcsize, long long *hash)
+{
+  int i;                    /* Looping variable */
+  int nends;                /* Number of ends to hash (1 for short files) */
+  int no_error=1;           /* Flag set to 0 on error */
+  size_t j,n;               /* Bytes hashed and read */
+  long start[2];            /* Offsets of the two ends */
+  unsigned long long h;     /* Running hash */
+  unsigned char buf[BCAT_HASHLEN]; /* One end of the file */
+  FILE *ifp;                /* Text file pointer */
+
+  if(!(ifp = fopen(srcname,"rb")))
+    return 1;
+  start[0] = 0;
+  start[1] = (long) (srcsize - BCAT_HASHLEN);
+  nends = (srcsize > BCAT_HASHLEN) ? 2 : 1;
+
+  h = 14695981039346656037ULL;
+  for(i=0; i<nends && no_error; i++) {
+    if(fseek(ifp,start[i],SEEK_SET) != 0) {
+      no_error = 0;
+      break;
+    }
+    n = fread(buf,1,BCAT_HASHLEN,ifp);
+    if(ferror(ifp))
+      no_error = 0;
+    for(j=0; j<n; j++) {
+      h ^= buf[j];
+      h *= 1099511628211ULL;
+    }
+  }
+  fclose(ifp);
+
+  *hash = (long long) h;
+  return no_error ? 0 : 1;
+}
+
+/*.......................................................................
+ *
+ * Function write_bcat
+ *
+ * Writes a catalog to the .bcat cache file of the text file that it was
+ *  read from.  The file is written under a temporary name and renamed,
+ *  so that a reader never sees a partial cache.  A projected catalog
+ *  (see read_colcat_cols) is not written.  Nothing is written, and no
+ *  error is returned, if the cache is not enabled (see bcat_enabled) or
+ *  the directory of the text file is not writable.
+ *
+ * Inputs: Colcat *colcat      catalog
+ *         char *srcname       name of the text file
+ *         char comment        comment character used to read srcname
+ *         int format          format code used to read srcname
+ *
+ * Output: int (-1, 0 or 1)    0 ==> success, 1 ==> error,
+ *                              -1 ==> cache skipped
+ *
+ */
+
+int write_bcat(Colcat *colcat, char *srcname, char comment, int format)
+{
+  int i;                    /* Looping variable */
+  int no_error=1;           /* Flag set to 0 on error */
+  int ncols;                /* Number of columns */
+  long long offset;         /* Running file offset */
+  long long pos;            /* Current file position */
+  char *cptr2;              /* Last '/' in srcname */
+  char bcatname[MAXC];      /* Name of the cache file */
+  char tmpname[MAXC];       /* Temporary name while writing */
+  char dirname[MAXC];       /* Directory of the text file */
+  static char zeros[8];     /* Padding between columns */
+  void **colref[MAXBCATCOL]; /* Column pointer addresses */
+  struct stat sbuf;         /* Status of the text file */
+  Colinfo *cptr;            /* Pointer to navigate the column descriptions */
+  Bcathead head;            /* File header */
+  Bcatcol dir[MAXBCATCOL];  /* Column directory */
+  FILE *ofp=NULL;           /* Output file pointer */
+
+  if(!bcat_enabled())
+    return -1;
+  if(!bcat_usable() || !colcat || colcat->ncat < 1)
+    return 1;
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++)
+    if(!colcat_column(colcat,cptr))
+      return 1;
+  if(snprintf(bcatname,MAXC,"%s.bcat",srcname) >= MAXC ||
+     snprintf(tmpname,MAXC,"%s.tmp",bcatname) >= MAXC ||
+     stat(srcname,&sbuf) != 0)
+    return 1;
+
+  /*
+   * Skip the cache quietly if the directory of the text file is read-only
+   */
+
+  strcpy(dirname,srcname);
+  if((cptr2 = strrchr(dirname,'/')))
+    *(cptr2 == dirname ? cptr2 + 1 : cptr2) = '\0';
+  else
+    strcpy(dirname,".");
+  if(access(dirname,W_OK) != 0)
+    return -1;
+
+  /*
+   * Fill in the header and the directory
+   */
+
+  memset(&head,0,sizeof(Bcathead));
+  strcpy(head.magic,BCAT_MAGIC);
+  head.version = BCAT_VERSION;
+  head.format = format;
+  head.comment = comment;
+  head.ncat = colcat->ncat;
+  head.naper = colcat->naper;
+  head.srcsize = sbuf.st_size;
+  head.srcmtime = sbuf.st_mtime;
+  head.srcino = sbuf.st_ino;
+  head.srcnsec = sbuf.st_mtim.tv_nsec;
+  if(bcat_srchash(srcname,head.srcsize,&head.srchash))
+    return 1;
+  head.ncols = ncols = bcat_columns(colcat,dir,colref);
+
+  offset = BCAT_ALIGN(sizeof(Bcathead) + ncols * sizeof(Bcatcol));
+  for(i=0; i<ncols; i++) {
+    dir[i].offset = offset;
+    offset = BCAT_ALIGN(offset + dir[i].nbytes);
+  }
+
+  /*
+   * Write the file
+   */
+
+  if(!(ofp = fopen(tmpname,"wb")))
+    return 1;
+
+  if(fwrite(&head,sizeof(Bcathead),1,ofp) != 1 ||
+     fwrite(dir,sizeof(Bcatcol),ncols,ofp) != (size_t) ncols)
+    no_error = 0;
+  pos = sizeof(Bcathead) + ncols * sizeof(Bcatcol);
+  for(i=0; i<ncols && no_error; i++) {
+    if(fwrite(zeros,1,dir[i].offset - pos,ofp) != 
+       (size_t) (dir[i].offset - pos) ||
+       fwrite(*colref[i],1,dir[i].nbytes,ofp) != (size_t) dir[i].nbytes)
+      no_error = 0;
+    pos = dir[i].offset + dir[i].nbytes;
+  }
+
+  if(fclose(ofp) != 0)
+    no_error = 0;
+  if(no_error && rename(tmpname,bcatname) != 0)
+    no_error = 0;
+  if(!no_error) {
+    remove(tmpname);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function read_bcat
+ *
+ * Maps the .bcat cache file of a text catalog into memory and returns it
+ *  as a Colcat whose columns point straight into the map.  The map is
+ *  private, so members can be changed in place; resize_colcat and
+ *  colcat_setname copy the columns out first.  Returns NULL, without
+ *  complaint, if there is no cache or it does not match the text file,
+ *  format code or comment character, so that the caller can fall back
+ *  to reading the text file.
+ *
+ * Inputs: char *srcname       name of the text file
+ *         char comment        comment character used to read srcname
+ *         int format          format code used to read srcname
+ *
+ * Output: Colcat *colcat      mapped catalog, or NULL
+ *
+ */
+
+Colcat *read_bcat(char *srcname, char comment, int format)
+{
+  int i;                    /* Looping variable */
+  int no_error=1;           /* Flag set to 0 on error */
+  int ncols;                /* Number of columns */
+  int fd;                   /* File descriptor of the cache */
+  size_t size;              /* Size of the cache */
+  long long srchash;        /* Hash of the ends of the text file */
+  char bcatname[MAXC];      /* Name of the cache file */
+  char *data;               /* Mapped cache */
+  void **colref[MAXBCATCOL]; /* Column pointer addresses */
+  struct stat sbuf;         /* Status of the text file */
+  struct stat bbuf;         /* Status of the cache */
+  Bcathead *head;           /* File header */
+  Bcatcol *dir;             /* Column directory */
+  Bcatcol expect[MAXBCATCOL]; /* Expected column directory */
+  Colcat *colcat;           /* Mapped catalog */
+
+  if(!bcat_enabled() || !bcat_usable() ||
+     snprintf(bcatname,MAXC,"%s.bcat",srcname) >= MAXC)
+    return NULL;
+  if(stat(srcname,&sbuf) != 0 || stat(bcatname,&bbuf) != 0 ||
+     bbuf.st_size < (off_t) sizeof(Bcathead))
+    return NULL;
+
+  /*
+   * Map the cache and check its header against the text file
+   */
+
+  if((fd = open(bcatname,O_RDONLY)) < 0)
+    return NULL;
+  size = (size_t) bbuf.st_size;
+  data = (char *) mmap(NULL,size,PROT_READ | PROT_WRITE,MAP_PRIVATE,fd,0);
+  close(fd);
+  if(data == (char *) MAP_FAILED)
+    return NULL;
+
+  head = (Bcathead *) data;
+  if(strncmp(head->magic,BCAT_MAGIC,8) || head->version != BCAT_VERSION ||
+     head->format != format || head->comment != comment ||
+     head->srcsize != (long long) sbuf.st_size ||
+     head->srcmtime != (long long) sbuf.st_mtime ||
+     head->srcino != (long long) sbuf.st_ino ||
+     head->srcnsec != (long long) sbuf.st_mtim.tv_nsec ||
+     bcat_srchash(srcname,head->srcsize,&srchash) ||
+     head->srchash != srchash ||
+     head->ncat < 1 || head->naper < 0 || head->naper > 100 ||
+     head->ncols < 1 || head->ncols > MAXBCATCOL ||
+     sizeof(Bcathead) + head->ncols * sizeof(Bcatcol) > size) {
+    munmap(data,size);
+    return NULL;
+  }
+  dir = (Bcatcol *) (data + sizeof(Bcathead));
+
+  /*
+   * Check the directory against the columns that the catalog should
+   *  have, and point the columns into the map
+   */
+
+  if(!(colcat = (Colcat *) calloc(1,sizeof(Colcat)))) {
+    munmap(data,size);
+    return NULL;
+  }
+  colcat->ncat = colcat->nalloc = head->ncat;
+  colcat->naper = head->naper;
+  colcat->poolsize = colcat->poolalloc = (int) dir[head->ncols-1].nbytes;
+  colcat->mapdata = data;
+  colcat->mapsize = size;
+
+  ncols = bcat_columns(colcat,expect,colref);
+  if(ncols != head->ncols)
+    no_error = 0;
+  for(i=0; i<ncols && no_error; i++) {
+    if(strncmp(dir[i].name,expect[i].name,16) || 
+       dir[i].type != expect[i].type || dir[i].elsize != expect[i].elsize ||
+       dir[i].nbytes != expect[i].nbytes || dir[i].offset % 8 != 0 ||
+       dir[i].offset < 0 || dir[i].nbytes > (long long) size - dir[i].offset)
+      no_error = 0;
+    else
+      *colref[i] = data + dir[i].offset;
+  }
+
+  /*
+   * Make sure that the names stay within the pool
+   */
+
+  if(no_error && (colcat->poolsize < 1 || 
+		  colcat->namepool[colcat->poolsize-1] != '\0'))
+    no_error = 0;
+  for(i=0; i<colcat->ncat && no_error; i++)
+    if(colcat->nameoff[i] < 0 || colcat->nameoff[i] >= colcat->poolsize)
+      no_error = 0;
+
+  if(!no_error)
+    return del_colcat(colcat);
+
+  return colcat;
+}
+
+/*.......................................................................,
+ *
+ * Function read_secat
+ *
+ * Reads the output catalog from a SExtractor run and puts the results
+ *  into a Secat array, which has its memory allocation 
+ *  performed in the function.  The text file is read by read_secat_mode
+ *  with the standard stdio input.  If BCAT_CACHE is set, the catalog is
+ *  then saved in a binary cache file (see write_bcat), and later reads
+ *  of the same, unchanged, file take the catalog from the cache instead.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         int format          flag describing format of input file
+ *                              (for up-to-date listing, see the
+ *                               secat_format function)
+ *         
+ * Output: Secat *newdata filled array
  *
- * v20Jul2003 CDF, Added read-in of alpha, delta pairs and the
- *                  conversion into RA, Dec pairs.
- * v20Jul2005 CDF, Added a version for the output from the USNO star catalog
- * v06Jan2007 CDF, Added a another input format
- * v19Jun2007 CDF, Added a another input format
- * v09Jul2007 CDF, Changed format 3
- * v2009Jan24 CDF, Modified format 0 to be ID, alpha, delta
- * v2010Dec19 CDF, Added format 17 for photometry
  */
 
 Secat *read_secat(char *inname, char comment, int *nlines, int format)
 {
+  int i;                    /* Looping variable */
+  int nexp,nskip;           /* Not used */
+  Secat *newdata=NULL;      /* Filled secat array */
+  Colcat *colcat=NULL;      /* Catalog in the binary cache */
+
+  /*
+   * Formats with their own readers (e.g., distcalc) are not cached
+   */
+
+  if(secat_format_info(format,&nexp,&nskip))
+    return read_secat_mode(inname,comment,nlines,format,READ_STDIO);
+
+  /*
+   * Use the binary cache if there is a current one.  The text readers
+   *  leave naper at zero, so do the same here.
+   */
+
+  if((colcat = read_bcat(inname,comment,format))) {
+    if((newdata = new_secat(colcat->ncat))) {
+      for(i=0; i<colcat->ncat; i++) {
+	init_secat(newdata+i);
+	colcat_getrow(colcat,i,newdata+i);
+	newdata[i].naper = 0;
+      }
+      *nlines = colcat->ncat;
+      printf("read_secat: %s has %d lines (from %s.bcat)\n",inname,
+	     *nlines,inname);
+    }
+    colcat = del_colcat(colcat);
+    if(newdata)
+      return newdata;
+  }
+
+  /*
+   * Otherwise read the text file and save it in the cache
+   */
+
+  if(!(newdata = read_secat_mode(inname,comment,nlines,format,READ_STDIO)))
+    return NULL;
+
+  if((colcat = new_colcat(*nlines,secat_format_naper(format)))) {
+    for(i=0; i<*nlines; i++)
+      if(colcat_setrow(colcat,i,newdata+i))
+	break;
+    colcat->ncat = i;
+    if(i < *nlines || write_bcat(colcat,inname,comment,format) > 0)
+      printf("read_secat: Could not write binary cache %s.bcat\n",inname);
+    colcat = del_colcat(colcat);
+  }
+
+  return newdata;
+}
+
+/*.......................................................................,
+ *
+ * Function read_secat_mode
+ *
+ * Reads the output catalog from a SExtractor run and puts the results
+ *  into a Secat array, which has its memory allocation 
+ *  performed in the function.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         int format          flag describing format of input file
+ *                              (for up-to-date listing, see the
+ *                               secat_format function)
+ *         int readmode        READ_STDIO to read the file line by line
+ *                              with fgets and sscanf, or READ_MMAP to
+ *                              parse a memory-mapped copy in place
+ *                              (see read_secat_mapped).  Both give
+ *                              identical values.  For the
+ *                              multi-threaded READ_PAR, see
+ *                              read_secat_method in catpar.c.
+ *         
+ * Output: Secat *newdata filled array
+ *
+ * v20Jul2003 CDF, Added read-in of alpha, delta pairs and the
+ *                  conversion into RA, Dec pairs.
+ * v20Jul2005 CDF, Added a version for the output from the USNO star catalog
+ * v06Jan2007 CDF, Added a another input format
+ * v19Jun2007 CDF, Added a another input format
+ * v09Jul2007 CDF, Changed format 3
+ * v2009Jan24 CDF, Modified format 0 to be ID, alpha, delta
+ * v2010Dec19 CDF, Added format 17 for photometry
+ * v2026Oct16 AGT, Added the readmode argument and the memory-mapped reader
+ *                 Format 19 is passed on to read_fitscat
+ *                 Format 20 is passed on to read_sexthead
+ */
+
+Secat *read_secat_mode(char *inname, char comment, int *nlines, int format,
+		       int readmode)
+{
+  int no_error=1;           /* Flag set to 0 on error */
+  int lc=0;                 /* Running counter for line number */
+  int nskip;                /* Nubmer of header lines to skip when reading in */
+  int ncols;                /* Number of columns in input file */
+  int nexp;                 /* Number of columns expected in input file */
+  int count=0;              /* Used to set ID number for catalogs with no IDs */
+  int nalloc=0;             /* Number of members allocated in newdata */
+  int rahr,ramin,decamin;   /* Components of hms format */
+  double rasec,decasec;     /* Components of hms format */
+  char line[MAXC];          /* General input string */
+  char outformat[MAXC];     /* Output format string */
+  char decdeg[3];           /* Degrees of declination, in hms format */
+  Secat *newdata=NULL;      /* Filled secat array */
+  Secat *sptr;              /* Pointer to navigate secat */
+  FILE *ifp=NULL;           /* Input file pointer */
+
+  printf("read_secat: Input file: %s. Input format = %d\n",inname,format);
+
+  /*
+   * If file is in distcalc format, call read_distcalc
+   */
+
+  if(format == 5) {
+    if(!(newdata = (read_distcalc(inname,'#',nlines,0)))) {
+      fprintf(stderr,"ERROR: read_secat");
+      return NULL;
+    }
+    else
+      return newdata;
+  }
+
+  /*
+   * FITS binary tables also have their own reader
+   */
+
+  if(format == 19)
+    return read_fitscat(inname,nlines);
+
+  /*
+   * As do catalogs whose columns are given by their header
+   */
+
+  if(format == 20)
+    return read_sexthead(inname,comment,nlines);
+
+  /*
+   * Set up number of expected columns and number of lines to
+   *  skip when reading in data
+   */
+
+  if(secat_format_info(format,&nexp,&nskip)) {
+    fprintf(stderr,"ERROR: read_secat. Not a valid format\n");
+    return NULL;
+  }
+
+  /*
+   * Open input file
+   */
+
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: read_secat.\n");
+    return NULL;
+  }
+
+  /*
+   * Read in data in a single pass, growing the array as needed
+   */
+
+  *nlines = 0;
+  if(readmode == READ_MMAP) {
+    if(read_secat_mapped(ifp,inname,comment,format,nexp,nskip,&newdata,
+			  &nalloc,nlines,&ncols))
+      no_error = 0;
+  }
+  else {
+    while(no_error && fgets(line,MAXC,ifp) != NULL) {
+      /* Have to skip the first nskip lines */
+      while(lc < nskip) {
+	lc++;
+	if(fgets(line,MAXC,ifp) == NULL) {
+	  fprintf(stderr,"ERROR: read_secat. Bad file format for %s\n",
+		  inname);
+	  return(del_secat(newdata));
+	}
+      }
+      lc++;
+      if(line[0] != comment) {
+	if(!(newdata = (Secat *) grow_array(newdata,&nalloc,*nlines+1,
+					    sizeof(Secat)))) {
+	  no_error = 0;
+	  break;
+	}
+	sptr = newdata + *nlines;
+	init_secat(sptr);
+	ncols = parse_secat_line(line,format,sptr,&count);
+	if(ncols < nexp) {
+	  fprintf(stderr,
+		  "ERROR: read_secat.  Bad input format in %s. (line = %d)\n",
+		  inname,lc);
+	  fprintf(stderr," File must contain at least %d columns.",nexp);
+	  fprintf(stderr," --  it contained %d columns.\n",ncols);
+	  no_error = 0;
+	}
+	else
+	  (*nlines)++;
+      }
+    }
+  }
+
+  if(no_error && ferror(ifp)) {
+    fprintf(stderr,"ERROR: read_secat.  Error reading %s\n",inname);
+    no_error = 0;
+  }
+  if(no_error && *nlines == 0) {
+    fprintf(stderr,"ERROR: read_secat.  No valid data in input file.\n");
+    no_error = 0;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  if(ifp)
+    fclose(ifp);
+  if(no_error)
+    newdata = (Secat *) shrink_array(newdata,&nalloc,*nlines,sizeof(Secat));
+
+  if(no_error) {
+    printf("read_secat: %s has %d columns and %d lines\n",inname,
+	   ncols,*nlines);
+    return newdata;
+  }
+  else {
+    fprintf(stderr,"ERROR: read_secat.\n");
+    return del_secat(newdata);
+  }
+}
+
+/*.......................................................................,
+ *
+ * Function read_secat2
+ *
+ * Reads the output catalog from a SExtractor run and puts the results
+ *  into a Secat array, which has its memory allocation 
+ *  performed in the function.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int *nlines         number of lines in input file -- set by
+ *                              this function.
+ *         
+ * Output: Secat *newdata filled array
+ *
+ * v23Apr2006 CDF, First attempt to generalize read_secat
+ */
+
+Secat *read_secat2(char *inname, char comment, int *nlines)
+{
+  int no_error=1;           /* Flag set to 0 on error */
+  int lc=0;                 /* Running counter for line number */
+  int nskip;                /* Nubmer of header lines to skip when reading in */
+  int ncols;                /* Number of columns in input file */
+  int nexp;                 /* Number of columns expected in input file */
+  int count=0;              /* Used to set ID number for catalogs with no IDs */
+  double djunk;             /* Variable used to read in unrequired data */
+  char line[MAXC];          /* General input string */
+  char outformat[MAXC];     /* Output format string */
+  Pos tmppos;               /* Temporary position holder */
+  Secat *newdata=NULL;      /* Filled secat array */
+  Secat *sptr;              /* Pointer to navigate secat */
+  FILE *ifp=NULL;           /* Input file pointer */
+
+  /*
+   * Open input file
+   */
+
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: read_secat.\n");
+    return NULL;
+  }
+
+  /*
+   * Get number of lines in input file
+   */
+
+  if((*nlines = n_lines(ifp,comment)) == 0) {
+    fprintf(stderr,"ERROR: read_secat.  No valid data in input file.\n");
+    no_error = 0;
+  }
+  else {
+    rewind(ifp);
+  }
+#if 0
+  /*
+   * Read in header information
+   */
+
+  while(no_error && fgets(line,MAXC,ifp) != NULL) {
+    if(line[0] == comment) {
+      if(sscanf(line,"%s %d %s",junk,&col,keyword) != 3) {
+	fprintf(stderr,"ERROR: read_secat.  Bad format in header for %s\n",
+		inname);
+	no_error = 0;
+      }
+    }
+  }
+
+
+  /*
+   * Allocate memory for secat and point sptr at the beginning of
+   *  the array.
+   */
+
+  if(no_error) {
+    if(!(newdata = new_secat(*nlines)))
+      no_error = 0;
+    else
+      sptr = newdata;
+  }
+#endif
+  /*
+   * Clean up and exit
+   */
+
+  if(ifp)
+    fclose(ifp);
+
+  if(no_error) {
+    printf("read_secat2: %s has %d columns and %d lines\n",inname,
+	   ncols,*nlines);
+    return newdata;
+  }
+  else {
+    fprintf(stderr,"ERROR: read_secat2.\n");
+    return del_secat(newdata);
+  }
+}
+
+/*.......................................................................
+ *
+ * SExtractor column names
+ *
+ * Maps the names of SExtractor output parameters onto Secat members, for
+ *  readers that find their columns by name (read_fitscat).  Each entry
+ *  gives the type of the member and its offset within Secat, and the
+ *  number of consecutive members that the elements of a vector column
+ *  fill.  The elements of FLUX_RADIUS go to r2, r5 and r8 in turn, as
+ *  for PHOT_FLUXFRAC = 0.2,0.5,0.8.
+ */
+
+typedef struct {
+  char *name;        /* SExtractor parameter name */
+  char type;         /* Member type ('i', 'f' or 'd') */
+  int offset;        /* Offset of the (first) member within Secat */
+  int nelem;         /* Number of members available for vector elements */
+} Sextcol;
+
+#define SEXTCOL(name,type,member,nelem) \
+  {name, type, (int) offsetof(Secat,member), nelem}
+
+static Sextcol sextcols[] = {
+  SEXTCOL("NUMBER",'i',id,1),
+  SEXTCOL("X_IMAGE",'d',x,1),
+  SEXTCOL("Y_IMAGE",'d',y,1),
+  SEXTCOL("FLAGS",'i',fitflag,1),
+  SEXTCOL("CLASS_STAR",'f',class,1),
+  SEXTCOL("MAG_ISO",'f',miso,1),
+  SEXTCOL("MAGERR_ISO",'f',misoerr,1),
+  SEXTCOL("FLUX_ISO",'f',fiso,1),
+  SEXTCOL("FLUXERR_ISO",'f',fisoerr,1),
+  SEXTCOL("MAG_AUTO",'f',mtot,1),
+  SEXTCOL("MAGERR_AUTO",'f',merr,1),
+  SEXTCOL("FLUX_AUTO",'f',fauto,1),
+  SEXTCOL("FLUXERR_AUTO",'f',fautoerr,1),
+  SEXTCOL("KRON_RADIUS",'f',r_kron,1),
+  SEXTCOL("BACKGROUND",'f',bkgd,1),
+  SEXTCOL("THRESHOLD",'f',thresh,1),
+  SEXTCOL("MU_THRESHOLD",'f',muthresh,1),
+  SEXTCOL("ISOAREA_IMAGE",'f',isoarea,1),
+  SEXTCOL("A_IMAGE",'f',a_im,1),
+  SEXTCOL("B_IMAGE",'f',b_im,1),
+  SEXTCOL("THETA_IMAGE",'f',theta,1),
+  SEXTCOL("FWHM_IMAGE",'f',fwhm,1),
+  SEXTCOL("MAG_APER",'f',maper,100),
+  SEXTCOL("MAGERR_APER",'f',mapererr,100),
+  SEXTCOL("FLUX_APER",'f',faper,100),
+  SEXTCOL("FLUXERR_APER",'f',fapererr,100),
+  SEXTCOL("FLUX_RADIUS",'f',r2,3),
+  SEXTCOL("ALPHA_J2000",'d',alpha,1),
+  SEXTCOL("DELTA_J2000",'d',delta,1)
+};
+
+/*.......................................................................
+ *
+ * Function sext_member
+ *
+ * Finds the Secat member that holds one element of a SExtractor output
+ *  parameter.
+ *
+ * Inputs: char *colname       SExtractor parameter name (e.g., MAG_APER)
+ *         int elem            element of a vector parameter (0 for scalars)
+ *         char *type          member type, 'i', 'f' or 'd' (set by
+ *                              function)
+ *         int *offset         offset of the member within Secat (set by
+ *                              function)
+ *
+ * Output: int (0 or 1)        0 ==> found, 1 ==> not a Secat member
+ *
+ */
+
+int sext_member(char *colname, int elem, char *type, int *offset)
+{
+  int i;                    /* Looping variable */
+  int size;                 /* Size of the member type */
+
+  for(i=0; i<(int) (sizeof(sextcols) / sizeof(Sextcol)); i++) {
+    if(strcmp(colname,sextcols[i].name) == 0) {
+      if(elem < 0 || elem >= sextcols[i].nelem)
+	return 1;
+      *type = sextcols[i].type;
+      size = (*type == 'd') ? sizeof(double) : 
+	(*type == 'f' ? sizeof(float) : sizeof(int));
+      *offset = sextcols[i].offset + elem * size;
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/*.......................................................................
+ *
+ * Function find_sheader_column
+ *
+ * Looks up a column by name in a catalog header.
+ *
+ * Inputs: SHeader *sheader    column definitions
+ *         int nhead           number of columns
+ *         char *colname       name to look for
+ *
+ * Output: int index           index of the column in sheader, or -1
+ *
+ */
+
+int find_sheader_column(SHeader *sheader, int nhead, char *colname)
+{
+  int i;                    /* Looping variable */
+
+  for(i=0; i<nhead; i++)
+    if(strcmp(sheader[i].colname,colname) == 0)
+      return i;
+
+  return -1;
+}
+
+/*.......................................................................
+ *
+ * Function read_secat_header
+ *
+ * Extracts the column definitions from the header of a SExtractor
+ *  catalog written with CATALOG_TYPE ASCII_HEAD, i.e., from the lines of
+ *  the form
+ *
+ *    #   1 NUMBER          Running object number
+ *    #   6 MAG_APER        Fixed aperture magnitude vector       [mag]
+ *
+ *  The number of elements of each column is the gap to the next column
+ *  number, and that of the last column is found from the number of
+ *  columns in the first data line.  The datatype member is set to the
+ *  scanf format of the Secat member that the column fills, or left
+ *  empty if there is no such member (see sext_member).  The file is
+ *  rewound before returning.
+ *
+ * Inputs: FILE *ifp           input file
+ *         int *nhead          number of columns found (set by function)
+ *
+ * Output: SHeader *sheader    column definitions, or NULL if the file has
+ *                              no usable header
+ *
+ */
+
+SHeader *read_secat_header(FILE *ifp, int *nhead)
+{
+  int i;                    /* Looping variable */
+  int nalloc=0;             /* Number of columns allocated in sheader */
+  int colnum;               /* Column number from a header line */
+  int ndata=0;              /* Number of columns in the first data line */
+  int pos;                  /* Position within a line */
+  int len;                  /* Length of a token */
+  int offset;               /* Offset of a member within Secat */
+  char type;                /* Type of a Secat member */
+  char line[MAXC];          /* General input string */
+  char colname[MAXC];       /* Column name from a header line */
+  SHeader *sheader=NULL;    /* Column definitions */
+
+  *nhead = 0;
+  while(fgets(line,MAXC,ifp) != NULL) {
+    if(line[0] != '#') {
+      for(pos=0; sscanf(line+pos,"%s%n",colname,&len) == 1; pos+=len)
+	ndata++;
+      break;
+    }
+    if(sscanf(line,"# %d %s",&colnum,colname) != 2 || colnum < 1 ||
+       (*nhead > 0 && colnum <= sheader[*nhead-1].colnum))
+      continue;
+    if(!(sheader = (SHeader *) grow_array(sheader,&nalloc,*nhead+1,
+					  sizeof(SHeader)))) {
+      *nhead = 0;
+      return NULL;
+    }
+    strcpy(sheader[*nhead].colname,colname);
+    sheader[*nhead].colnum = colnum;
+    sheader[*nhead].nelem = 1;
+    sheader[*nhead].datatype[0] = '\0';
+    if(sext_member(colname,0,&type,&offset) == 0)
+      strcpy(sheader[*nhead].datatype,
+	     type == 'd' ? "%lf" : (type == 'f' ? "%f" : "%d"));
+    (*nhead)++;
+  }
+  rewind(ifp);
+
+  for(i=0; i<*nhead-1; i++)
+    sheader[i].nelem = sheader[i+1].colnum - sheader[i].colnum;
+  if(*nhead > 0 && ndata > sheader[*nhead-1].colnum)
+    sheader[*nhead-1].nelem = ndata - sheader[*nhead-1].colnum + 1;
+
+  return sheader;
+}
+
+/*.......................................................................
+ *
+ * Function finish_sext_row
+ *
+ * Fills in the members of a catalog row that was read by column name
+ *  (read_fitscat, read_sexthead) but that are not columns themselves:
+ *  the ID, if there was no NUMBER column, the name, the old-style
+ *  aperture members and the RA,Dec components.
+ *
+ * Inputs: Secat *sptr         catalog row
+ *         int index           row number, counting from 0
+ *         int hasid           1 if there was a NUMBER column
+ *         int naper           number of MAG_APER elements
+ *         int haspos          1 if there were ALPHA_J2000, DELTA_J2000
+ *                              columns
+ *
+ * Output: (none)
+ *
+ */
+
+static void finish_sext_row(Secat *sptr, int index, int hasid, int naper,
+			    int haspos)
+{
+  if(!hasid)
+    sptr->id = index + 1;
+  sprintf(sptr->name,"%d",sptr->id);
+  sptr->naper = naper;
+  if(naper >= 3) {
+    sptr->ma1 = sptr->maper[0];
+    sptr->ma2 = sptr->maper[1];
+    sptr->ma3 = sptr->maper[2];
+    sptr->ma1err = sptr->mapererr[0];
+    sptr->ma2err = sptr->mapererr[1];
+    sptr->ma3err = sptr->mapererr[2];
+    sptr->fa1 = sptr->faper[0];
+    sptr->fa2 = sptr->faper[1];
+    sptr->fa3 = sptr->faper[2];
+    sptr->fa1err = sptr->fapererr[0];
+    sptr->fa2err = sptr->fapererr[1];
+    sptr->fa3err = sptr->fapererr[2];
+  }
+  if(haspos)
+    deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
+}
+
+/*.......................................................................
+ *
+ * FITS binary tables
+ *
+ * A self-contained reader for the binary tables written by SExtractor
+ *  with CATALOG_TYPE FITS_LDAC (the table is in the LDAC_OBJECTS
+ *  extension) or FITS_1.0 (the first extension).  The file is mapped and
+ *  the big-endian columns are converted straight into the Secat members.
+ */
+
+#define FITSBLOCK 2880
+#define FITSCARD 80
+
+typedef struct {
+  int bintable;      /* 1 if the HDU is a binary table */
+  int bitpix;        /* BITPIX */
+  int naxis;         /* NAXIS */
+  long long naxes[9]; /* NAXISn */
+  long long pcount;  /* PCOUNT */
+  long long gcount;  /* GCOUNT */
+  int tfields;       /* TFIELDS */
+  char extname[FITSCARD]; /* EXTNAME */
+  char *header;      /* Start of the header */
+  char *data;        /* Start of the data */
+  long long datasize; /* Size of the data, padded to whole blocks */
+} Fitshdu;
+
+/*.......................................................................
+ *
+ * Function fits_card_value
+ *
+ * Extracts the value of a FITS header card if its keyword matches.
+ *  Quotes around string values and trailing blanks are removed, as is
+ *  any comment after a numeric value.
+ *
+ * Inputs: char *card          80-character card
+ *         char *key           keyword to match
+ *         char *value         value (set by function, room for FITSCARD)
+ *
+ * Output: int (0 or 1)        1 ==> keyword matched, 0 ==> no match
+ *
+ */
+
+static int fits_card_value(char *card, char *key, char *value)
+{
+  int i,j;                  /* Looping variables */
+  int len;                  /* Length of key */
+
+  len = strlen(key);
+  if(strncmp(card,key,len) != 0)
+    return 0;
+  for(i=len; i<8; i++)
+    if(card[i] != ' ')
+      return 0;
+  if(card[8] != '=' || card[9] != ' ')
+    return 0;
+
+  for(i=10; i<FITSCARD && card[i] == ' '; i++);
+  j = 0;
+  if(i < FITSCARD && card[i] == '\'') {
+    for(i++; i<FITSCARD; i++) {
+      if(card[i] == '\'') {
+	if(i+1 < FITSCARD && card[i+1] == '\'')
+	  i++;
+	else
+	  break;
+      }
+      value[j++] = card[i];
+    }
+  }
+  else {
+    for(; i<FITSCARD && card[i] != '/' && card[i] != ' '; i++)
+      value[j++] = card[i];
+  }
+  while(j > 0 && value[j-1] == ' ')
+    j--;
+  value[j] = '\0';
+
+  return 1;
+}
+
+/*.......................................................................
+ *
+ * Function fits_read_hdu
+ *
+ * Reads the header of the HDU starting at ptr and works out where its
+ *  data lie.
+ *
+ * Inputs: char *ptr           start of the HDU (on a block boundary)
+ *         char *end           end of the file
+ *         Fitshdu *hdu        HDU description (filled by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> bad or truncated HDU
+ *
+ */
+
+static int fits_read_hdu(char *ptr, char *end, Fitshdu *hdu)
+{
+  int i;                    /* Looping variable */
+  int ncard=0;              /* Number of cards read */
+  int gotend=0;             /* Set to 1 when the END card is found */
+  long long nelem=1;        /* Number of data elements */
+  char key[FITSCARD];       /* NAXISn keyword */
+  char value[FITSCARD];     /* Card value */
+  char *card;               /* Current card */
+
+  memset(hdu,0,sizeof(Fitshdu));
+  hdu->gcount = 1;
+  hdu->header = ptr;
+
+  for(card=ptr; !gotend && card + FITSCARD <= end; card += FITSCARD) {
+    ncard++;
+    if(strncmp(card,"END     ",8) == 0)
+      gotend = 1;
+    else if(fits_card_value(card,"XTENSION",value))
+      hdu->bintable = (strcmp(value,"BINTABLE") == 0);
+    else if(fits_card_value(card,"BITPIX",value))
+      hdu->bitpix = atoi(value);
+    else if(fits_card_value(card,"NAXIS",value))
+      hdu->naxis = atoi(value);
+    else if(fits_card_value(card,"PCOUNT",value))
+      hdu->pcount = atoll(value);
+    else if(fits_card_value(card,"GCOUNT",value))
+      hdu->gcount = atoll(value);
+    else if(fits_card_value(card,"TFIELDS",value))
+      hdu->tfields = atoi(value);
+    else if(fits_card_value(card,"EXTNAME",value))
+      strcpy(hdu->extname,value);
+    else {
+      for(i=1; i<=9 && i<=hdu->naxis; i++) {
+	sprintf(key,"NAXIS%d",i);
+	if(fits_card_value(card,key,value))
+	  hdu->naxes[i-1] = atoll(value);
+      }
+    }
+  }
+  if(!gotend || hdu->naxis < 0 || hdu->naxis > 9 || hdu->bitpix == 0)
+    return 1;
+
+  hdu->data = ptr + ((ncard * FITSCARD + FITSBLOCK - 1) / FITSBLOCK) * 
+    FITSBLOCK;
+  if(hdu->naxis == 0)
+    nelem = 0;
+  for(i=0; i<hdu->naxis; i++)
+    nelem *= hdu->naxes[i];
+  hdu->datasize = (hdu->bitpix < 0 ? -hdu->bitpix : hdu->bitpix) / 8 *
+    hdu->gcount * (hdu->pcount + nelem);
+  hdu->datasize = ((hdu->datasize + FITSBLOCK - 1) / FITSBLOCK) * FITSBLOCK;
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function fits_tform
+ *
+ * Decodes a TFORMn value, e.g., "3E", into a repeat count, data type
+ *  code and the total width of the field in bytes.
+ *
+ * Inputs: char *tform         TFORMn value
+ *         int *repeat         repeat count (set by function)
+ *         char *code          data type code (set by function)
+ *
+ * Output: int width           width of the field in bytes, -1 if unknown
+ *
+ */
+
+static int fits_tform(char *tform, int *repeat, char *code)
+{
+  int size;                 /* Size of one element */
+  char *cptr;               /* Pointer to navigate tform */
+
+  for(cptr=tform; *cptr == ' '; cptr++);
+  *repeat = 1;
+  if(*cptr >= '0' && *cptr <= '9') {
+    *repeat = atoi(cptr);
+    while(*cptr >= '0' && *cptr <= '9')
+      cptr++;
+  }
+  *code = *cptr;
+
+  switch(*code) {
+  case 'L': case 'B': case 'A':
+    size = 1;
+    break;
+  case 'I':
+    size = 2;
+    break;
+  case 'J': case 'E':
+    size = 4;
+    break;
+  case 'K': case 'D': case 'C': case 'P':
+    size = 8;
+    break;
+  case 'M': case 'Q':
+    size = 16;
+    break;
+  case 'X':
+    return (*repeat + 7) / 8;
+  default:
+    return -1;
+  }
+
+  return *repeat * size;
+}
+
+/*.......................................................................
+ *
+ * Function fits_get_double
+ *
+ * Converts one big-endian element of a binary table column to a double.
+ *
+ * Inputs: unsigned char *b    start of the element
+ *         char code           data type code (B, I, J, K, E or D)
+ *
+ * Output: double val          value
+ *
+ */
+
+static double fits_get_double(unsigned char *b, char code)
+{
+  int i;                    /* Looping variable */
+  unsigned int u32;         /* 32-bit word */
+  unsigned long long u64=0; /* 64-bit word */
+  float fval;               /* Float value */
+  double dval;              /* Double value */
+
+  switch(code) {
+  case 'B':
+    return (double) b[0];
+  case 'I':
+    return (double) (short) ((b[0] << 8) | b[1]);
+  case 'J':
+    u32 = ((unsigned int) b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+    return (double) (int) u32;
+  case 'K':
+    for(i=0; i<8; i++)
+      u64 = (u64 << 8) | b[i];
+    return (double) (long long) u64;
+  case 'E':
+    u32 = ((unsigned int) b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+    memcpy(&fval,&u32,sizeof(float));
+    return (double) fval;
+  case 'D':
+    for(i=0; i<8; i++)
+      u64 = (u64 << 8) | b[i];
+    memcpy(&dval,&u64,sizeof(double));
+    return dval;
+  default:
+    return 0.0;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function read_fitscat
+ *
+ * Reads a SExtractor catalog that was written as a FITS binary table
+ *  (CATALOG_TYPE FITS_LDAC or FITS_1.0) into a Secat array.  The columns
+ *  are found by name (see sext_member), so they can be in any order and
+ *  any that are not Secat members are skipped.  Members without a
+ *  column keep the values set by init_secat, except that the IDs
+ *  count up from 1 if there is no NUMBER column.
+ *
+ * Inputs: char *inname        name of input file
+ *         int *nlines         number of catalog members (set by function)
+ *
+ * Output: Secat *newdata      filled array, or NULL on error
+ *
+ */
+
+Secat *read_fitscat(char *inname, int *nlines)
+{
+  int i,j,k;                /* Looping variables */
+  int no_error=1;           /* Flag set to 0 on error */
+  int ncols=0;              /* Number of table columns */
+  int nplan=0;              /* Number of columns to convert */
+  int naper=0;              /* Number of aperture magnitudes */
+  int repeat;               /* Repeat count of a column */
+  int width;                /* Width of a column */
+  int rowoff;               /* Offset of a column within a row */
+  int offset;               /* Offset of a member within Secat */
+  int hasid=0;              /* Set to 1 if there is a NUMBER column */
+  int haspos=0;             /* Set to 1 if there are alpha,delta columns */
+  size_t size;              /* Size of mapped file */
+  long long rowlen;         /* Length of a table row */
+  double val;               /* Converted value */
+  char code;                /* Data type code of a column */
+  char type;                /* Type of a Secat member */
+  char key[FITSCARD];       /* TTYPEn or TFORMn keyword */
+  char value[FITSCARD];     /* Card value */
+  char *data;               /* Mapped file */
+  char *ptr;                /* Start of the current HDU */
+  char *end;                /* End of mapped file */
+  char *card;               /* Current header card */
+  unsigned char *row;       /* Current table row */
+  Fitshdu hdu;              /* Current HDU */
+  Fitshdu table;            /* HDU holding the catalog */
+  SHeader *sheader=NULL;    /* Column definitions */
+  Secat *newdata=NULL;      /* Filled secat array */
+  Secat *sptr;              /* Pointer to navigate secat */
+  FILE *ifp=NULL;           /* Input file pointer */
+  struct {
+    int rowoff;             /* Offset of the element within a row */
+    char code;              /* Data type code */
+    char type;              /* Member type */
+    int offset;             /* Offset of the member within Secat */
+  } *plan=NULL;             /* Conversions to make for each row */
+
+  printf("read_fitscat: Input file: %s\n",inname);
+
+  /*
+   * Map the file and find the table: the LDAC_OBJECTS extension if there
+   *  is one, otherwise the first binary table
+   */
+
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: read_fitscat.\n");
+    return NULL;
+  }
+  if(map_readfile(ifp,&data,&size)) {
+    fprintf(stderr,"ERROR: read_fitscat.\n");
+    fclose(ifp);
+    return NULL;
+  }
+  fclose(ifp);
+  end = data + size;
+
+  if(size < FITSBLOCK || strncmp(data,"SIMPLE  =",9) != 0) {
+    fprintf(stderr,"ERROR: read_fitscat.  %s is not a FITS file.\n",inname);
+    unmap_file(data,size);
+    return NULL;
+  }
+
+  table.bintable = 0;
+  for(ptr=data; ptr < end; ptr = hdu.data + hdu.datasize) {
+    if(fits_read_hdu(ptr,end,&hdu))
+      break;
+    if(!hdu.bintable || strcmp(hdu.extname,"LDAC_IMHEAD") == 0)
+      continue;
+    if(!table.bintable || (strcmp(hdu.extname,"LDAC_OBJECTS") == 0 &&
+			   strcmp(table.extname,"LDAC_OBJECTS") != 0))
+      table = hdu;
+  }
+  if(!table.bintable || table.naxis != 2 || table.tfields < 1 ||
+     table.data + table.naxes[0] * table.naxes[1] > end) {
+    fprintf(stderr,"ERROR: read_fitscat.  No usable binary table in %s\n",
+	    inname);
+    unmap_file(data,size);
+    return NULL;
+  }
+  rowlen = table.naxes[0];
+  *nlines = (int) table.naxes[1];
+  ncols = table.tfields;
+
+  /*
+   * Read the column definitions
+   */
+
+  if(!(sheader = (SHeader *) calloc(ncols,sizeof(SHeader))) ||
+     !(plan = calloc(ncols * 100 + 3,sizeof(*plan)))) {
+    fprintf(stderr,"ERROR: read_fitscat.  Insufficient memory.\n");
+    no_error = 0;
+  }
+  for(card=table.header; no_error && card < table.data; card += FITSCARD) {
+    for(i=1; i<=ncols; i++) {
+      sprintf(key,"TTYPE%d",i);
+      if(fits_card_value(card,key,value)) {
+	strcpy(sheader[i-1].colname,value);
+	break;
+      }
+      sprintf(key,"TFORM%d",i);
+      if(fits_card_value(card,key,value)) {
+	sscanf(value,"%15s",sheader[i-1].datatype);
+	break;
+      }
+    }
+  }
+
+  /*
+   * Work out which elements go into which Secat members
+   */
+
+  rowoff = 0;
+  for(i=0; i<ncols && no_error; i++) {
+    sheader[i].colnum = i + 1;
+    if((width = fits_tform(sheader[i].datatype,&repeat,&code)) < 0) {
+      fprintf(stderr,"ERROR: read_fitscat.  Bad TFORM%d = %s\n",i+1,
+	      sheader[i].datatype);
+      no_error = 0;
+      break;
+    }
+    sheader[i].nelem = repeat;
+    if(strchr("BIJKED",code)) {
+      for(j=0; j<repeat; j++) {
+	if(sext_member(sheader[i].colname,j,&type,&offset))
+	  break;
+	plan[nplan].rowoff = rowoff + j * (width / repeat);
+	plan[nplan].code = code;
+	plan[nplan].type = type;
+	plan[nplan].offset = offset;
+	nplan++;
+      }
+      if(j > 0 && strcmp(sheader[i].colname,"NUMBER") == 0)
+	hasid = 1;
+      if(j > 0 && strcmp(sheader[i].colname,"MAG_APER") == 0)
+	naper = j;
+    }
+    rowoff += width;
+  }
+  if(no_error && rowoff != rowlen) {
+    fprintf(stderr,"ERROR: read_fitscat.  Column widths (%d) do not ",
+	    rowoff);
+    fprintf(stderr,"match the row length (%lld).\n",rowlen);
+    no_error = 0;
+  }
+  haspos = (find_sheader_column(sheader,ncols,"ALPHA_J2000") >= 0 &&
+	    find_sheader_column(sheader,ncols,"DELTA_J2000") >= 0);
+
+  /*
+   * Fill the catalog
+   */
+
+  if(no_error && *nlines < 1) {
+    fprintf(stderr,"ERROR: read_fitscat.  No valid data in input file.\n");
+    no_error = 0;
+  }
+  if(no_error && !(newdata = new_secat(*nlines)))
+    no_error = 0;
+
+  for(i=0; i<*nlines && no_error; i++) {
+    sptr = newdata + i;
+    row = (unsigned char *) table.data + i * rowlen;
+    init_secat(sptr);
+    for(k=0; k<nplan; k++) {
+      val = fits_get_double(row + plan[k].rowoff,plan[k].code);
+      switch(plan[k].type) {
+      case 'i':
+	*(int *) ((char *) sptr + plan[k].offset) = (int) val;
+	break;
+      case 'f':
+	*(float *) ((char *) sptr + plan[k].offset) = (float) val;
+	break;
+      case 'd':
+	*(double *) ((char *) sptr + plan[k].offset) = val;
+	break;
+      }
+    }
+    finish_sext_row(sptr,i,hasid,naper,haspos);
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  unmap_file(data,size);
+  if(sheader)
+    free(sheader);
+  if(plan)
+    free(plan);
+
+  if(no_error) {
+    printf("read_fitscat: %s has %d columns and %d lines\n",inname,
+	   ncols,*nlines);
+    return newdata;
+  }
+  else {
+    fprintf(stderr,"ERROR: read_fitscat.\n");
+    return del_secat(newdata);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function sheader_fields
+ *
+ * Builds the column layout (see secat_fields) for a catalog from its
+ *  header.  This is the header-driven counterpart of the built-in
+ *  layouts of the format codes: every column whose name is a Secat
+ *  member (see sext_member) is converted straight into that member, and
+ *  the others are marked 'x' and stepped over.
+ *
+ * Inputs: SHeader *sheader    column definitions (see read_secat_header)
+ *         int nhead           number of columns in sheader
+ *         int *nfields        number of columns in a data line (set by
+ *                              function)
+ *         int *hasid          1 if there is a NUMBER column (set by
+ *                              function)
+ *         int *naper          number of MAG_APER elements (set by
+ *                              function)
+ *         int *haspos         1 if there are ALPHA_J2000 and DELTA_J2000
+ *                              columns (set by function)
+ *
+ * Output: Secfield *fields    layout (to be freed by the caller), or NULL
+ *                              on error
+ *
+ */
+
+static Secfield *sheader_fields(SHeader *sheader, int nhead, int *nfields,
+				int *hasid, int *naper, int *haspos)
+{
+  int i,j;                  /* Looping variables */
+  int offset;               /* Offset of a member within Secat */
+  char type;                /* Type of a Secat member */
+  Secfield *fields;         /* Column layout */
+
+  *nfields = sheader[nhead-1].colnum + sheader[nhead-1].nelem - 1;
+  if(!(fields = (Secfield *) malloc(*nfields * sizeof(Secfield)))) {
+    fprintf(stderr,"ERROR: sheader_fields.  Insufficient memory.\n");
+    return NULL;
+  }
+  for(i=0; i<*nfields; i++) {
+    fields[i].type = 'x';
+    fields[i].offset = 0;
+  }
+
+  *hasid = *naper = 0;
+  for(i=0; i<nhead; i++) {
+    for(j=0; j<sheader[i].nelem; j++) {
+      if(sext_member(sheader[i].colname,j,&type,&offset))
+	break;
+      fields[sheader[i].colnum-1+j].type = type;
+      fields[sheader[i].colnum-1+j].offset = offset;
+    }
+    if(j > 0 && strcmp(sheader[i].colname,"NUMBER") == 0)
+      *hasid = 1;
+    if(j > 0 && strcmp(sheader[i].colname,"MAG_APER") == 0)
+      *naper = j;
+  }
+  *haspos = (find_sheader_column(sheader,nhead,"ALPHA_J2000") >= 0 &&
+	     find_sheader_column(sheader,nhead,"DELTA_J2000") >= 0);
+
+  return fields;
+}
+
+/*.......................................................................
+ *
+ * Function scan_catalog_line
+ *
+ * The slow path for rows that tok_catalog_line refuses when a layout is
+ *  read from a header: each column is copied out and converted with
+ *  sscanf on its own, so that the results are those of a scanf format
+ *  built from the layout.
+ *
+ * Inputs: const char *s       start of line
+ *         const char *e       end of line (the newline or end of file)
+ *         Secfield *fields    column layout
+ *         int nfields         number of columns in layout
+ *         void *rec           structure to fill
+ *
+ * Output: int ncols           number of columns converted
+ *
+ */
+
+static int scan_catalog_line(const char *s, const char *e, Secfield *fields,
+			     int nfields, void *rec)
+{
+  int i;                    /* Looping variable */
+  int ok;                   /* Set to 1 if a column converts */
+  const char *t;            /* End of current token */
+  char *member;             /* Location of the current member */
+  char token[MAXC];         /* Copy of the current token */
+
+  for(i=0; i<nfields; i++) {
+    while(s < e && TOK_SPACE(*s))
+      s++;
+    if(s == e)
+      return i;
+    for(t=s; t < e && !TOK_SPACE(*t); t++);
+    if(t - s >= MAXC)
+      return i;
+    memcpy(token,s,t-s);
+    token[t-s] = '\0';
+
+    member = (char *) rec + fields[i].offset;
+    switch(fields[i].type) {
+    case 'i':
+      ok = sscanf(token,"%d",(int *) member);
+      break;
+    case 'f':
+      ok = sscanf(token,"%f",(float *) member);
+      break;
+    case 'd':
+      ok = sscanf(token,"%lf",(double *) member);
+      break;
+    default:
+      ok = 1;
+      break;
+    }
+    if(ok != 1)
+      return i;
+    s = t;
+  }
+
+  return nfields;
+}
+
+/*.......................................................................
+ *
+ * Function read_sexthead
+ *
+ * Reads a SExtractor catalog written with CATALOG_TYPE ASCII_HEAD,
+ *  using its "# N NAME" header (see read_secat_header) rather than a
+ *  format code to find the columns.  The header is turned into a
+ *  column layout once (see sheader_fields), and each data line is then
+ *  read in place by tok_catalog_line, exactly as for the built-in
+ *  layouts of the format codes, so the columns can be in any order and
+ *  any that are not Secat members are stepped over.
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character (the header lines
+ *                              always start with '#')
+ *         int *nlines         number of catalog members (set by function)
+ *
+ * Output: Secat *newdata      filled array, or NULL on error
+ *
+ */
+
+Secat *read_sexthead(char *inname, char comment, int *nlines)
+{
+  int no_error=1;           /* Flag set to 0 on error */
+  int lc=0;                 /* Running counter for line number */
+  int nhead=0;              /* Number of header columns */
+  int nfields=0;            /* Number of columns in a data line */
+  int ncols;                /* Number of columns read from a line */
+  int nalloc=0;             /* Number of members allocated in newdata */
+  int hasid;                /* Set to 1 if there is a NUMBER column */
+  int naper;                /* Number of aperture magnitudes */
+  int haspos;               /* Set to 1 if there are alpha,delta columns */
+  size_t size;              /* Size of the mapped file */
+  double djunk;             /* Not used */
+  char *data=NULL;          /* Mapped file */
+  char *ptr;                /* Start of current line */
+  char *eol;                /* End of current line */
+  char *end;                /* End of mapped file */
+  SHeader *sheader=NULL;    /* Column definitions */
+  Secfield *fields=NULL;    /* Column layout from the header */
+  Secat *newdata=NULL;      /* Filled secat array */
+  Secat *sptr;              /* Pointer to navigate secat */
+  FILE *ifp=NULL;           /* Input file pointer */
+
+  printf("read_sexthead: Input file: %s\n",inname);
+
+  /*
+   * Read the header and turn it into a column layout
+   */
+
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: read_sexthead.\n");
+    return NULL;
+  }
+  if(!(sheader = read_secat_header(ifp,&nhead)) || nhead == 0) {
+    fprintf(stderr,"ERROR: read_sexthead.  No column header in %s\n",
+	    inname);
+    no_error = 0;
+  }
+  else if(!(fields = sheader_fields(sheader,nhead,&nfields,&hasid,&naper,
+				    &haspos)))
+    no_error = 0;
+  else if(map_readfile(ifp,&data,&size))
+    no_error = 0;
+  fclose(ifp);
+
+  /*
+   * Read in the data
+   */
+
+  *nlines = 0;
+  end = data + size;
+  for(ptr=data; no_error && ptr < end; ptr = eol + 1) {
+    if(!(eol = memchr(ptr,'\n',end - ptr)))
+      eol = end;
+    lc++;
+    if(*ptr == '#' || *ptr == comment)
+      continue;
+
+    if(!(newdata = (Secat *) grow_array(newdata,&nalloc,*nlines+1,
+					sizeof(Secat)))) {
+      no_error = 0;
+      break;
+    }
+    sptr = newdata + *nlines;
+    init_secat(sptr);
+    if(tok_catalog_line(ptr,eol,fields,nfields,sptr,&djunk) &&
+       (ncols = scan_catalog_line(ptr,eol,fields,nfields,sptr)) < nfields) {
+      fprintf(stderr,
+	      "ERROR: read_sexthead.  Bad input format in %s. (line = %d)\n",
+	      inname,lc);
+      fprintf(stderr," Header gives %d columns.",nfields);
+      fprintf(stderr," --  line contained %d usable columns.\n",ncols);
+      no_error = 0;
+      break;
+    }
+    finish_sext_row(sptr,*nlines,hasid,naper,haspos);
+    (*nlines)++;
+  }
+
+  if(no_error && *nlines == 0) {
+    fprintf(stderr,"ERROR: read_sexthead.  No valid data in input file.\n");
+    no_error = 0;
+  }
+
+  /*
+   * Clean up and exit
+   */
+
+  if(data)
+    unmap_file(data,size);
+  if(sheader)
+    free(sheader);
+  if(fields)
+    free(fields);
+
+  if(no_error) {
+    newdata = (Secat *) shrink_array(newdata,&nalloc,*nlines,sizeof(Secat));
+    printf("read_sexthead: %s has %d columns and %d lines\n",inname,
+	   nfields,*nlines);
+    return newdata;
+  }
+  else {
+    fprintf(stderr,"ERROR: read_sexthead.\n");
+    return del_secat(newdata);
+  }
+}
+
+/*.......................................................................
+ *
+ * Function print_secat_line
+ *
+ * Writes a single Secat structure to an output buffer as one line in the
+ *  requested format.  This is the per-line part of write_secat.  The
+ *  fields are formatted by the ob_* functions, which give the same
+ *  characters as the printf formats noted in secat_format.
+ *
+ * Inputs: Outbuf *ob          output buffer
+ *         Secat *sptr         catalog member to write
+ *         int format          output format (see secat_format)
+ *
+ * Output: int (0 or 1)        0 ==> OK.  1 ==> invalid format.
+ *
+ */
+
+static int print_secat_line(Outbuf *ob, Secat *sptr, int format)
+{
+  switch(format) {
+  case 0:
+    ob_puts(ob,sptr->name,19,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,11,7,OB_PLUS);
+    ob_putc(ob,' ');
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    ob_putc(ob,'\n');
+    break;
+  case 1:
+    ob_puts(ob,sptr->name,10,OB_LEFT);
+    ob_putc(ob,' ');
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,12,8,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,12,8,OB_PLUS);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dx,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dy,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dpos,8,2,0);
+    ob_putc(ob,'\n');
+    break;
+  case 2:
+  case 6:
+    ob_int(ob,sptr->id,4,OB_ZERO);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->x,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->y,8,2,0);
+    ob_putc(ob,' ');
+    ob_int(ob,sptr->fitflag,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->class,4,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->miso,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->misoerr,7,3,0);
+    ob_putc(ob,' ');
+    if(format == 2) {
+      ob_fixed(ob,sptr->mtot,7,3,0);
+      ob_putc(ob,' ');
+      ob_fixed(ob,sptr->merr,7,3,0);
+      ob_putc(ob,' ');
+    }
+    else {
+      ob_printf(ob,"%10g %10g ",sptr->fiso,sptr->fisoerr);
+      ob_fixed(ob,sptr->mtot,7,3,0);
+      ob_putc(ob,' ');
+      ob_fixed(ob,sptr->merr,7,3,0);
+      ob_printf(ob," %10g %10g ",sptr->fauto,sptr->fautoerr);
+    }
+    ob_fixed(ob,sptr->r_kron,6,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->bkgd,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->thresh,9,4,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->muthresh,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->isoarea,5,0,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->a_im,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->b_im,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->theta,6,1,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fwhm,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->ma1,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->ma2,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->ma3,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->ma1err,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->ma2err,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->ma3err,7,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fa1,9,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fa2,9,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fa3,9,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fa1err,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fa2err,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fa3err,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->r2,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->r5,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->r8,8,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,11,7,OB_PLUS);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dx,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dy,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dpos,8,2,0);
+    ob_putc(ob,' ');
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    ob_putc(ob,'\n');
+    break;
+  case 3:
+    ob_fixed(ob,sptr->x,7,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->y,7,2,0);
+    ob_putc(ob,' ');
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,11,7,OB_PLUS);
+    ob_puts(ob,sptr->name,0,0);
+    ob_putc(ob,' ');
+    ob_int(ob,sptr->id,5,OB_ZERO);
+    ob_puts(ob,"  ",0,0);
+    ob_fixed(ob,sptr->fwhm,6,2,0);
+    ob_putc(ob,'\n');
+    break;
+  case 4:
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    ob_puts(ob," 0.00 ",0,0);
+    ob_fixed(ob,sptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,11,7,OB_PLUS);
+    ob_putc(ob,'\n');
+    break;
+  case 9: case 10:
+    ob_puts(ob,sptr->name,0,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,11,7,OB_PLUS);
+    ob_puts(ob,"  ",0,0);
+    ob_fixed(ob,sptr->mtot,5,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->merr,5,2,0);
+    ob_puts(ob,"  ",0,0);
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    ob_puts(ob,"  ",0,0);
+    ob_fixed(ob,sptr->dx,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dy,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dpos,8,2,0);
+    ob_putc(ob,'\n');
+    break;
+  case 14:
+    ob_fixed(ob,sptr->x,7,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->y,7,2,0);
+    ob_putc(ob,' ');
+    ob_skypos(ob,&sptr->skypos,':',4,3);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,11,7,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,11,7,OB_PLUS);
+    ob_putc(ob,' ');
+    ob_puts(ob,sptr->name,0,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->fwhm,6,2,0);
+    ob_putc(ob,'\n');
+    break;
+#if 0
+  case 15:
+    ob_printf(ob,"05d %11.7f %+11.7f %7.4f %6.4f\n",
+	    sptr->id,sptr->alpha,sptr->delta,sptr->zspec,sptr->zspecerr);
+    break;
+#endif
+  default:
+    fprintf(stderr,"ERROR: write_secat.  ");
+    fprintf(stderr,"Format %d is not valid for this function.\n",format);
+    return 1;
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function print_secat_rows
+ *
+ * Writes a block of Secat structures to an output buffer, one line each.
+ *  Used by write_secat and, with one buffer per thread, by write_secat_par
+ *  in catpar.c.
+ *
+ * Inputs: Outbuf *ob          output buffer
+ *         Secat *secat        first catalog member to write
+ *         int nrows           number of members to write
+ *         int format          output format (see secat_format)
+ *
+ * Output: int (0 or 1)        0 ==> OK.  1 ==> invalid format or error.
+ *
+ */
+
+int print_secat_rows(Outbuf *ob, Secat *secat, int nrows, int format)
+{
+  int i;            /* Looping variable */
+  Secat *sptr;      /* Pointer to navigate secat */
+
+  for(i=0,sptr=secat; i<nrows; i++,sptr++)
+    if(print_secat_line(ob,sptr,format))
+      return 1;
+
+  return ob->error;
+}
+
+/*.......................................................................,
+ *
+ * Function write_secat
+ *
+ * Writes an array of Secat structures to an output file.
+ *
+ * Inputs: Secat *secat        secat array
+ *         int ncat            number of catalog members
+ *         char *outname       name of output file
+ *         int format          flag describing format of input file
+ *                              (see secat_format for format descriptions)
+ *         
+ * Output: int (0 or 1)       0 ==> OK.  1 ==> error.
+ *
+ * v2005Sep08 CDF, Added error checking on format code.
+ *                 Added output format for 2MASS format processed by catsort
+ *                  -- write out in USNO format (format 8)
+ * v2007Jul09 CDF, Added format 3
+ * v2007Jul29 CDF, Added format 14
+ * v2007Aug02 CDF, Added format 15
+ * v2009Jan24 CDF, Modified format 0 to be ID, alpha, delta
+ * v2026Oct16 AGT, Output goes through an Outbuf
+ *
+ */
+
+int write_secat(Secat *secat, int ncat, char *outname, int format)
+{
+  int no_error=1;   /* Flag set to 0 on error */
+  Outbuf *ob=NULL;  /* Output buffer */
+  FILE *ofp=NULL;   /* Output file pointer */
+
+
+  /*
+   * Open output file
+   */
+
+  if(!(ofp = open_writefile(outname))) {
+    fprintf(stderr,"ERROR: write_secat.\n");
+    return 1;
+  }
+  if(!(ob = new_outbuf(ofp,OUTBUFSIZE))) {
+    fprintf(stderr,"ERROR: write_secat.\n");
+    fclose(ofp);
+    return 1;
+  }
+
+  /*
+   * Add header for format 4 --> format 8
+   */
+
+  if(format == 4)
+    ob_puts(ob,".\n.\n.\n",0,0);
+
+  /*
+   * Write out data
+   */
+
+  if(print_secat_rows(ob,secat,ncat,format))
+    no_error = 0;
+
+  /*
+   * Clean up and exit
+   */
+
+  if(del_outbuf(ob))
+    no_error = 0;
+  if(ofp)
+    fclose(ofp);
+
+  if(no_error)
+    return 0;
+  else {
+    fprintf(stderr,"ERROR: write_secat.\n");
+    return 1;
+  }
+}
+
+/*.......................................................................,
+ *
+ * Function read_colcat
+ *
+ * Reads a secat-style catalog into a column-ordered Colcat structure.
+ *  The input formats are the same as for read_secat, and each line is
+ *  parsed in exactly the same way, but only a single scratch Secat is
+ *  used so that the memory cost per catalog member is that of the
+ *  Colcat columns rather than that of a full Secat.
+ * The aperture columns are only allocated for formats that contain
+ *  aperture photometry (formats 6 and 17), or that have MAG_APER columns
+ *  (formats 19 and 20).
+ *
+ * Inputs: char *inname        name of input file
+ *         char comment        comment character
+ *         int format          flag describing format of input file
+ *                              (see secat_format)
+ *         
+ * Output: Colcat *colcat      filled catalog, with colcat->ncat set.
+ *                              NULL on error.
+ *
+ */
+
+Colcat *read_colcat(char *inname, char comment, int format)
+{
+  int i;                    /* Looping variable */
   int no_error=1;           /* Flag set to 0 on error */
   int lc=0;                 /* Running counter for line number */
-  int nskip;                /* Nubmer of header lines to skip when reading in */
-  int ncols;                /* Number of columns in input file */
+  int nlines;               /* Number of data lines in input file */
+  int nskip;                /* Number of header lines to skip */
+  int ncols=0;              /* Number of columns in input file */
   int nexp;                 /* Number of columns expected in input file */
+  int naper;                /* Number of apertures in the format */
   int count=0;              /* Used to set ID number for catalogs with no IDs */
-  int rahr,ramin,decamin;   /* Components of hms format */
-  double rasec,decasec;     /* Components of hms format */
-  double djunk;             /* Variable used to read in unrequired data */
   char line[MAXC];          /* General input string */
-  char outformat[MAXC];     /* Output format string */
-  char decdeg[3];           /* Degrees of declination, in hms format */
-  Pos tmppos;               /* Temporary position holder */
-  Secat *newdata=NULL;      /* Filled secat array */
-  Secat *sptr;              /* Pointer to navigate secat */
+  Secat *tmpcat=NULL;       /* Scratch structure for parsing one line */
+  Colcat *colcat=NULL;      /* Filled catalog */
   FILE *ifp=NULL;           /* Input file pointer */
 
-  printf("read_secat: Input file: %s. Input format = %d\n",inname,format);
+  printf("read_colcat: Input file: %s. Input format = %d\n",inname,format);
 
   /*
-   * If file is in distcalc format, call read_distcalc
+   * The distcalc, FITS and header-driven formats have their own readers,
+   *  so just convert their output
    */
 
-  if(format == 5) {
-    if(!(newdata = (read_distcalc(inname,'#',nlines,0)))) {
-      fprintf(stderr,"ERROR: read_secat");
+  if(format == 5 || format == 19 || format == 20) {
+    if(format == 5)
+      tmpcat = read_distcalc(inname,'#',&nlines,0);
+    else if(format == 19)
+      tmpcat = read_fitscat(inname,&nlines);
+    else
+      tmpcat = read_sexthead(inname,comment,&nlines);
+    if(!tmpcat) {
+      fprintf(stderr,"ERROR: read_colcat\n");
       return NULL;
     }
-    else
-      return newdata;
+    if((colcat = new_colcat(nlines,format == 5 ? 0 : tmpcat->naper))) {
+      for(i=0; i<nlines && no_error; i++)
+	if(colcat_setrow(colcat,i,tmpcat+i))
+	  no_error = 0;
+      colcat->ncat = nlines;
+    }
+    tmpcat = del_secat(tmpcat);
+    if(!colcat || !no_error) {
+      fprintf(stderr,"ERROR: read_colcat\n");
+      return del_colcat(colcat);
+    }
+    return colcat;
   }
 
   /*
-   * Set up number of expected columns and number of lines to
-   *  skip when reading in data
+   * Set up number of expected columns, lines to skip, and apertures
    */
 
-  nskip = 0;
-  switch(format) {
-  case 0:
-    nexp = 3;
-    break;
-  case 1:
-    nexp = 2;
-    break;
-  case 2:
-    nexp = 6;
-    break;
-  case 3:
-    nexp = 8;
-    break;
-  case 4:
-    nskip = 14;
-    nexp = 2;
-    break;
-  case 6:
-    nexp = 39;
-    break;
-  case 7:
-    nexp = 48;
-    break;
-  case 8:
-    nskip = 3;
-    nexp = 7;
-    break;
-  case 9:
-    nexp = 7;
-    break;
-  case 10:
-    nexp = 3;
-    break;
-  case 13:
-    nexp = 20;
-    break;
-  case 15:
-    nexp = 5;
-    break;
-  case 16:
-    nexp = 8;
-    break;
-  case 17:
-    nexp = 47;
-    break;
-  case 18:
-    nexp = 6;
-    break;
-  default:
-    fprintf(stderr,"ERROR: read_secat. Not a valid format\n");
+  if(secat_format_info(format,&nexp,&nskip)) {
+    fprintf(stderr,"ERROR: read_colcat. Not a valid format\n");
     return NULL;
   }
+  naper = secat_format_naper(format);
 
   /*
-   * Open input file
+   * Use the binary cache if there is a current one
    */
 
-  if(!(ifp = open_readfile(inname))) {
-    fprintf(stderr,"ERROR: read_secat.\n");
-    return NULL;
+  if((colcat = read_bcat(inname,comment,format))) {
+    printf("read_colcat: %s has %d lines (from %s.bcat)\n",inname,
+	   colcat->ncat,inname);
+    return colcat;
   }
 
   /*
-   * Get number of lines in input file
+   * Open input file
    */
 
-  if((*nlines = n_lines(ifp,comment)) == 0) {
-    fprintf(stderr,"ERROR: read_secat.  No valid data in input file.\n");
-    no_error = 0;
-  }
-  else {
-    rewind(ifp);
-    *nlines = *nlines - nskip;
+  if(!(ifp = open_readfile(inname))) {
+    fprintf(stderr,"ERROR: read_colcat.\n");
+    return NULL;
   }
 
-
   /*
-   * Allocate memory for secat and point sptr at the beginning of
-   *  the array.
+   * Allocate the initial columns and the scratch structure
    */
 
-  if(no_error) {
-    if(!(newdata = new_secat(*nlines)))
-      no_error = 0;
-    else
-      sptr = newdata;
-  }
+  if(!(colcat = new_colcat(GROWMIN,naper)))
+    no_error = 0;
+  else if(!(tmpcat = new_secat(1)))
+    no_error = 0;
 
   /*
-   * Read in data
+   * Read in data in a single pass, growing the columns as needed
    */
 
   while(no_error && fgets(line,MAXC,ifp) != NULL) {
@@ -818,542 +5178,513 @@ Secat *read_secat(char *inname, char comment, int *nlines, int format)
     while(lc < nskip) {
       lc++;
       if(fgets(line,MAXC,ifp) == NULL) {
-	fprintf(stderr,"ERROR: read_secat. Bad file format for %s\n",
+	fprintf(stderr,"ERROR: read_colcat. Bad file format for %s\n",
 		inname);
-	return(del_secat(newdata));
+	no_error = 0;
+	break;
       }
     }
     lc++;
-    if(line[0] != comment) {
-      switch(format) {
-      case 0:
-	ncols = sscanf(line,"%lf %lf %lf",&djunk,&sptr->alpha,&sptr->delta);
-	sptr->id = (int) djunk;
-	sprintf(sptr->name,"%d",sptr->id);
-	break;
-      case 1:
-	ncols = sscanf(line,"%lf %lf",&sptr->alpha,&sptr->delta);
-	count++;
-	sptr->id = count; 
-	sprintf(sptr->name,"%d",count);
-	break;
-      case 2:
-	ncols = 
-	  sscanf(line,"%d %d %lf %d %d %lf",
-		 &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
-		 &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec);
-	count++;
-	sptr->id = count; 
-	sprintf(sptr->name,"%d",count);
-
-	/*
-	 * Convert RA,Dec to alpha,delta 
-	 */
-
-	spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
-	break;
-      case 3:
-	ncols = 
-	  sscanf(line,"%lf %lf %d %d %lf %d %d %lf",
-		 &sptr->x,&sptr->y,
-		 &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
-		 &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec);
-
-	/*
-	 * Convert RA,Dec to alpha,delta 
-	 */
-
-	spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
-	break;
-      case 4:
-	ncols = sscanf(line,"%lf %lf",&sptr->alpha,&sptr->delta);
-	count++;
-	sptr->id = count; 
-	sprintf(sptr->name,"%d",sptr->id);
-
-	/*
-	 * Convert alpha,delta to RA,Dec
-	 */
-
-	deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
-	break;
-      case 6:
-	ncols = 
-	  sscanf(line,"%d %lf %lf %d %f %f %f %g %g %f %f %g %g %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %lf %lf",
-		 &sptr->id,&sptr->x,&sptr->y,&sptr->fitflag,&sptr->class,
-		 &sptr->miso,&sptr->misoerr,&sptr->fiso,&sptr->fisoerr,
-		 &sptr->mtot,&sptr->merr,&sptr->fauto,&sptr->fautoerr,
-		 &sptr->r_kron,&sptr->bkgd,&sptr->thresh,&sptr->muthresh,
-	         &sptr->isoarea,&sptr->a_im,
-		 &sptr->b_im,&sptr->theta,&sptr->fwhm,
-		 &sptr->maper[0],&sptr->maper[1],&sptr->maper[2],
-		 &sptr->mapererr[0],&sptr->mapererr[1],&sptr->mapererr[2],
-		 &sptr->faper[0],&sptr->faper[1],&sptr->faper[2],
-		 &sptr->fapererr[0],&sptr->fapererr[1],&sptr->fapererr[2],
-		 &sptr->r2,&sptr->r5,&sptr->r8,&sptr->alpha,&sptr->delta);
-	sprintf(sptr->name,"%d",sptr->id);
-
-	/*
-	 * Convert alpha,delta to RA,Dec
-	 */
-
-	deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
-	break;
-      case 7:
-	ncols = 
-	  sscanf(line,"%d %lf %lf %d %f %f %f %g %g %f %f %g %g %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %lf %lf %lf %lf %lf %d %d %lf %d %d %lf",
-		 &sptr->id,&sptr->x,&sptr->y,&sptr->fitflag,&sptr->class,
-		 &sptr->miso,&sptr->misoerr,&sptr->fiso,&sptr->fisoerr,
-		 &sptr->mtot,&sptr->merr,&sptr->fauto,&sptr->fautoerr,
-		 &sptr->r_kron,&sptr->bkgd,&sptr->thresh,&sptr->muthresh,
-	         &sptr->isoarea,&sptr->a_im,
-		 &sptr->b_im,&sptr->theta,&sptr->fwhm,
-		 &sptr->ma1,&sptr->ma2,&sptr->ma3,
-		 &sptr->ma1err,&sptr->ma2err,&sptr->ma3err,
-		 &sptr->fa1,&sptr->fa2,&sptr->fa3,
-		 &sptr->fa1err,&sptr->fa2err,&sptr->fa3err,
-		 &sptr->r2,&sptr->r5,&sptr->r8,&sptr->alpha,&sptr->delta,
-		 &sptr->dx,&sptr->dy,&sptr->dpos,
-		 &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
-		 &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec);
-	sprintf(sptr->name,"%d",sptr->id);
-
-	/*
-	 * Convert dx,dy to r,theta
-	 */
-
-	tmppos.x = -sptr->dx;
-	tmppos.y = sptr->dy;
-	xy2rth(tmppos,&djunk,&sptr->dpostheta,1);
-	break;
-      case 8:
-	ncols = 
-	  sscanf(line,"%d %d %lf %d %d %lf %f",
-		 &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
-		 &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec,
-		 &sptr->mtot);
-	sptr->id = count + 1; 
-	sprintf(sptr->name,"%d",sptr->id);
-	count++;
-	/*
-	 * Convert RA,Dec to alpha,delta 
-	 */
-
-	spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
-	break;
-      case 9:
-	ncols = 
-	  sscanf(line,"%s %d %d %lf %d %d %lf %f %f",
-		 sptr->name,
-		 &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
-		 &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec,
-		 &sptr->mtot,&sptr->merr);
-	sptr->id = count + 1; 
-	count++;
-	/*
-	 * Convert RA,Dec to alpha,delta 
-	 */
-
-	spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
-	break;
-      case 10:
-	ncols = 
-	  sscanf(line,"%s %lf %lf %f %f",
-		 sptr->name,&sptr->alpha,&sptr->delta,&sptr->mtot,&sptr->merr);
-	sptr->id = count + 1; 
-	count++;
-	/*
-	 * Convert alpha,delta to RA,Dec
-	 */
-	deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
-	break;
-      case 13:
-	ncols = 
-	  sscanf(line,
-		 "%d %lf %lf %lf %lf %d %f %f %f %g %g %f %f %f %f %f %f %f %f %f",
-		 &sptr->id,&sptr->alpha,&sptr->delta,
-		 &sptr->x,&sptr->y,&sptr->fitflag,&sptr->class,
-		 &sptr->mtot,&sptr->merr,&sptr->fauto,&sptr->fautoerr,
-		 &sptr->r_kron,&sptr->a_im,&sptr->b_im,&sptr->theta,&sptr->fwhm,
-		 &sptr->bkgd,&sptr->thresh,&sptr->muthresh,&sptr->isoarea);
-	sprintf(sptr->name,"%d",sptr->id);
-
-	/*
-	 * Convert alpha,delta to RA,Dec
-	 */
-
-	deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
-	break;
-      case 15:
-	ncols = 
-	  sscanf(line,"%s %lf %lf %f %f",
-		 sptr->name,&sptr->alpha,&sptr->delta,&sptr->zspec,
-		 &sptr->zspecerr);
-	sptr->id = count + 1; 
-	count++;
-	/*
-	 * Convert alpha,delta to RA,Dec
-	 */
-
-	deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
-	break;
-      case 16:
-	ncols = 
-	  sscanf(line,"%s %d %d %lf %d %d %lf %f",
-		 sptr->name,
-		 &sptr->skypos.hr,&sptr->skypos.min,&sptr->skypos.sec,
-		 &sptr->skypos.deg,&sptr->skypos.amin,&sptr->skypos.asec,
-		 &sptr->zspec);
-	sptr->id = count + 1; 
-	count++;
-	/*
-	 * Convert RA,Dec to alpha,delta 
-	 */
-
-	spos2deg(sptr->skypos,&sptr->alpha,&sptr->delta);
-	break;
-      case 17:
-	ncols = 
-	  sscanf(line,"%d %lf %lf %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %d %f",
-		 &sptr->id,&sptr->x,&sptr->y,&sptr->mtot,&sptr->merr,
-		 &sptr->maper[0],&sptr->maper[1],&sptr->maper[2],
-		 &sptr->maper[3],&sptr->maper[4],&sptr->maper[5],
-		 &sptr->maper[6],&sptr->maper[7],&sptr->maper[8],
-		 &sptr->maper[9],&sptr->maper[10],&sptr->maper[11],
-		 &sptr->maper[12],&sptr->maper[13],&sptr->maper[14],
-		 &sptr->maper[15],&sptr->maper[16],&sptr->maper[17],
-		 &sptr->maper[18],&sptr->maper[19],
-		 &sptr->mapererr[0],&sptr->mapererr[1],&sptr->mapererr[2],
-		 &sptr->mapererr[3],&sptr->mapererr[4],&sptr->mapererr[5],
-		 &sptr->mapererr[6],&sptr->mapererr[7],&sptr->mapererr[8],
-		 &sptr->mapererr[9],&sptr->mapererr[10],&sptr->mapererr[11],
-		 &sptr->mapererr[12],&sptr->mapererr[13],&sptr->mapererr[14],
-		 &sptr->mapererr[15],&sptr->mapererr[16],&sptr->mapererr[17],
-		 &sptr->mapererr[18],&sptr->mapererr[19],
-		 &sptr->fitflag,&sptr->class);
-	sprintf(sptr->name,"%d",sptr->id);
-	break;
-      case 18:
-	ncols = sscanf(line,"%lf %lf %f %f %f %f",
-		       &sptr->x,&sptr->y,&sptr->a_im,&sptr->b_im,&sptr->theta,
-		       &sptr->r_kron);
-	break;
-      }
+    if(no_error && line[0] != comment) {
+      init_secat(tmpcat);
+      ncols = parse_secat_line(line,format,tmpcat,&count);
       if(ncols < nexp) {
 	fprintf(stderr,
-		"ERROR: read_secat.  Bad input format in %s. (line = %d)\n",
+		"ERROR: read_colcat.  Bad input format in %s. (line = %d)\n",
 		inname,lc);
 	fprintf(stderr," File must contain at least %d columns.",nexp);
 	fprintf(stderr," --  it contained %d columns.\n",ncols);
 	no_error = 0;
       }
-      else
-	sptr++;
+      else if(colcat->ncat >= colcat->nalloc &&
+	      resize_colcat(colcat,2 * colcat->nalloc)) {
+	fprintf(stderr,"ERROR: read_colcat.  Insufficient memory.\n");
+	no_error = 0;
+      }
+      else {
+	if(colcat_setrow(colcat,colcat->ncat,tmpcat))
+	  no_error = 0;
+	colcat->ncat++;
+      }
     }
   }
 
+  if(no_error && ferror(ifp)) {
+    fprintf(stderr,"ERROR: read_colcat.  Error reading %s\n",inname);
+    no_error = 0;
+  }
+  if(no_error && colcat->ncat == 0) {
+    fprintf(stderr,"ERROR: read_colcat.  No valid data in input file.\n");
+    no_error = 0;
+  }
+
   /*
    * Clean up and exit
    */
 
   if(ifp)
     fclose(ifp);
+  tmpcat = del_secat(tmpcat);
+  if(no_error && colcat->ncat < colcat->nalloc)
+    resize_colcat(colcat,colcat->ncat);
 
   if(no_error) {
-    printf("read_secat: %s has %d columns and %d lines\n",inname,
-	   ncols,*nlines);
-    return newdata;
+    printf("read_colcat: %s has %d columns and %d lines\n",inname,
+	   ncols,colcat->ncat);
+    if(write_bcat(colcat,inname,comment,format) > 0)
+      printf("read_colcat: Could not write binary cache %s.bcat\n",inname);
+    return colcat;
   }
   else {
-    fprintf(stderr,"ERROR: read_secat.\n");
-    return del_secat(newdata);
+    fprintf(stderr,"ERROR: read_colcat.\n");
+    return del_colcat(colcat);
   }
 }
 
-/*.......................................................................,
+/*.......................................................................
  *
- * Function read_secat2
+ * Function colmask_groups
+ *
+ * Widens a column mask (see colcat_colmask) so that columns that are
+ *  derived from each other while a line is parsed (see
+ *  finish_secat_line) are read together.  Asking for any of the
+ *  positions (alpha, delta or the RA,Dec components) reads them all,
+ *  and asking for dpostheta reads dx and dy.
+ *
+ * Inputs: char *mask          column mask (modified by function)
+ *
+ * Output: (none)
+ *
+ */
+
+static void colmask_groups(char *mask)
+{
+  int i,j,k;                /* Looping variables */
+  int ncols;                /* Number of scalar columns */
+  int want;                 /* Set to 1 if a group is wanted */
+  Colinfo *colinfo;         /* Column descriptions */
+  static char *groups[][9] = {
+    {"alpha","delta","hr","min","sec","deg","amin","asec",NULL},
+    {"dpostheta","dx","dy",NULL}
+  };
+
+  colinfo = colcat_colinfo(&ncols);
+  for(k=0; k<2; k++) {
+    want = 0;
+    for(i=0; i<ncols; i++)
+      for(j=0; groups[k][j]; j++)
+	if(mask[i] && strcmp(colinfo[i].name,groups[k][j]) == 0)
+	  want = 1;
+    if(!want)
+      continue;
+    for(i=0; i<ncols; i++)
+      for(j=0; groups[k][j]; j++)
+	if(strcmp(colinfo[i].name,groups[k][j]) == 0)
+	  mask[i] = 1;
+  }
+}
+
+/*.......................................................................
+ *
+ * Function project_fields
+ *
+ * Makes a copy of a column layout in which the columns that are not
+ *  wanted are marked 'x', so that tok_catalog_line steps over them
+ *  without converting them.  The ID, name and 'j' columns are always
+ *  kept, since finish_secat_line uses them.
+ *
+ * Inputs: Secfield *fields    column layout (see secat_fields)
+ *         int nfields         number of columns in layout
+ *         char *mask          wanted scalar columns (see colcat_colmask)
+ *         int aper            1 if the aperture columns are wanted
+ *
+ * Output: Secfield *proj      projected layout (to be freed by the caller),
+ *                              or NULL on error
+ *
+ */
+
+static Secfield *project_fields(Secfield *fields, int nfields, char *mask,
+				int aper)
+{
+  int i,j;                  /* Looping variables */
+  int ncols;                /* Number of scalar columns */
+  int aperstart;            /* Offset of the first aperture member */
+  int aperend;              /* Offset just past the last aperture member */
+  Colinfo *colinfo;         /* Column descriptions */
+  Secfield *proj;           /* Projected layout */
+
+  if(!(proj = (Secfield *) malloc(nfields * sizeof(Secfield)))) {
+    fprintf(stderr,"ERROR: project_fields.  Insufficient memory.\n");
+    return NULL;
+  }
+
+  colinfo = colcat_colinfo(&ncols);
+  aperstart = (int) offsetof(Secat,maper);
+  aperend = (int) (offsetof(Secat,fapererr) + sizeof(((Secat *) 0)->fapererr));
+  for(i=0; i<nfields; i++) {
+    proj[i] = fields[i];
+    if(fields[i].type == 's' || fields[i].type == 'j' ||
+       fields[i].offset == (int) offsetof(Secat,id))
+      continue;
+    if(fields[i].offset >= aperstart && fields[i].offset < aperend) {
+      if(!aper)
+	proj[i].type = 'x';
+      continue;
+    }
+    for(j=0; j<ncols; j++)
+      if(colinfo[j].secoff == fields[i].offset)
+	break;
+    if(j < ncols && !mask[j])
+      proj[i].type = 'x';
+  }
+
+  return proj;
+}
+
+/*.......................................................................
+ *
+ * Function read_colcat_cols
  *
- * Reads the output catalog from a SExtractor run and puts the results
- *  into a Secat array, which has its memory allocation 
- *  performed in the function.
+ * Reads only some of the columns of a secat-style catalog into a
+ *  projected Colcat, for programs that need just a few of them (e.g.,
+ *  positions).  The columns are given as a list of Secat member names
+ *  (see colcat_colmask).  Only those columns are allocated, and the
+ *  others are stepped over in each line without being converted.  The
+ *  IDs and names are always read.  Columns that were not asked for can
+ *  be loaded later with colcat_need.
+ * If there is a current binary cache, or the format has its own reader
+ *  (formats 5 and 19), this just returns the full catalog from
+ *  read_colcat.
  *
  * Inputs: char *inname        name of input file
  *         char comment        comment character
- *         int *nlines         number of lines in input file -- set by
- *                              this function.
- *         
- * Output: Secat *newdata filled array
+ *         int format          flag describing format of input file
+ *                              (see secat_format)
+ *         char *cols          columns to read, e.g., "alpha,delta"
+ *
+ * Output: Colcat *colcat      filled catalog, with colcat->ncat set.
+ *                              NULL on error.
  *
- * v23Apr2006 CDF, First attempt to generalize read_secat
  */
 
-Secat *read_secat2(char *inname, char comment, int *nlines)
+Colcat *read_colcat_cols(char *inname, char comment, int format, char *cols)
 {
   int no_error=1;           /* Flag set to 0 on error */
   int lc=0;                 /* Running counter for line number */
-  int nskip;                /* Nubmer of header lines to skip when reading in */
-  int ncols;                /* Number of columns in input file */
+  int nskip;                /* Number of header lines to skip */
+  int ncols=0;              /* Number of columns in input file */
   int nexp;                 /* Number of columns expected in input file */
+  int nfields;              /* Number of columns in the format layout */
+  int aper;                 /* 1 if the aperture columns are wanted */
   int count=0;              /* Used to set ID number for catalogs with no IDs */
-  double djunk;             /* Variable used to read in unrequired data */
-  char line[MAXC];          /* General input string */
-  char outformat[MAXC];     /* Output format string */
-  Pos tmppos;               /* Temporary position holder */
-  Secat *newdata=NULL;      /* Filled secat array */
-  Secat *sptr;              /* Pointer to navigate secat */
+  size_t size;              /* Size of the mapped file */
+  char mask[MAXCOLINFO];    /* Wanted scalar columns */
+  char *data=NULL;          /* Mapped file */
+  char *ptr;                /* Start of current line */
+  char *eol;                /* End of current line */
+  char *end;                /* End of mapped file */
+  Secfield *fields;         /* Column layout for the format */
+  Secfield *proj=NULL;      /* Projected column layout */
+  Secat *tmpcat=NULL;       /* Scratch structure for parsing one line */
+  Colcat *colcat=NULL;      /* Filled catalog */
   FILE *ifp=NULL;           /* Input file pointer */
 
-  /*
-   * Open input file
-   */
-
-  if(!(ifp = open_readfile(inname))) {
-    fprintf(stderr,"ERROR: read_secat.\n");
+  if(colcat_colmask(cols,mask,&aper)) {
+    fprintf(stderr,"ERROR: read_colcat_cols.\n");
     return NULL;
   }
+  colmask_groups(mask);
 
   /*
-   * Get number of lines in input file
+   * Fall back on read_colcat for the formats without a layout, or if the
+   *  binary cache already holds all of the columns
    */
 
-  if((*nlines = n_lines(ifp,comment)) == 0) {
-    fprintf(stderr,"ERROR: read_secat.  No valid data in input file.\n");
-    no_error = 0;
-  }
-  else {
-    rewind(ifp);
+  if(secat_format_info(format,&nexp,&nskip) ||
+     !(fields = secat_fields(format,&nfields)) || nfields < nexp)
+    return read_colcat(inname,comment,format);
+  if((colcat = read_bcat(inname,comment,format))) {
+    printf("read_colcat_cols: %s has %d lines (from %s.bcat)\n",inname,
+	   colcat->ncat,inname);
+    return colcat;
   }
-#if 0
+
+  printf("read_colcat_cols: Input file: %s. Input format = %d. ",inname,
+	 format);
+  printf("Columns: %s\n",cols);
+
   /*
-   * Read in header information
+   * Map the input file and set up the catalog
    */
 
-  while(no_error && fgets(line,MAXC,ifp) != NULL) {
-    if(line[0] == comment) {
-      if(sscanf(line,"%s %d %s",junk,&col,keyword) != 3) {
-	fprintf(stderr,"ERROR: read_secat.  Bad format in header for %s\n",
-		inname);
-	no_error = 0;
-      }
+  if(!(ifp = open_readfile(inname)))
+    no_error = 0;
+  else if(map_readfile(ifp,&data,&size))
+    no_error = 0;
+  if(ifp)
+    fclose(ifp);
+
+  if(no_error) {
+    if(!(proj = project_fields(fields,nfields,mask,aper)))
+      no_error = 0;
+    else if(!(colcat = new_colcat_cols(GROWMIN,
+				      aper ? secat_format_naper(format) : 0,
+				      mask)))
+      no_error = 0;
+    else if(!(tmpcat = new_secat(1)))
+      no_error = 0;
+    else if(!(colcat->srcname = (char *) malloc(strlen(inname) + 1)))
+      no_error = 0;
+    else {
+      strcpy(colcat->srcname,inname);
+      colcat->srccomment = comment;
+      colcat->srcformat = format;
     }
   }
 
-
   /*
-   * Allocate memory for secat and point sptr at the beginning of
-   *  the array.
+   * Read in the data
    */
 
-  if(no_error) {
-    if(!(newdata = new_secat(*nlines)))
+  end = data + size;
+  for(ptr=data; no_error && ptr < end; ptr = eol + 1) {
+    if(!(eol = memchr(ptr,'\n',end - ptr)))
+      eol = end;
+    /* Have to skip the first nskip lines */
+    if(++lc <= nskip || *ptr == comment)
+      continue;
+
+    ncols = parse_mapped_secat(ptr,eol,proj,nfields,format,tmpcat,&count);
+    if(ncols < nexp) {
+      fprintf(stderr,
+	      "ERROR: read_colcat_cols.  Bad input format in %s. (line = %d)\n",
+	      inname,lc);
+      fprintf(stderr," File must contain at least %d columns.",nexp);
+      fprintf(stderr," --  it contained %d columns.\n",ncols);
       no_error = 0;
-    else
-      sptr = newdata;
+    }
+    else if(colcat->ncat >= colcat->nalloc &&
+	    resize_colcat(colcat,2 * colcat->nalloc)) {
+      fprintf(stderr,"ERROR: read_colcat_cols.  Insufficient memory.\n");
+      no_error = 0;
+    }
+    else {
+      if(colcat_setrow(colcat,colcat->ncat,tmpcat))
+	no_error = 0;
+      colcat->ncat++;
+    }
   }
-#endif
+
+  if(no_error && colcat->ncat == 0) {
+    fprintf(stderr,"ERROR: read_colcat_cols.  No valid data in input file.\n");
+    no_error = 0;
+  }
+
   /*
    * Clean up and exit
    */
 
-  if(ifp)
-    fclose(ifp);
+  if(data)
+    unmap_file(data,size);
+  if(proj)
+    free(proj);
+  tmpcat = del_secat(tmpcat);
+  if(no_error && colcat->ncat < colcat->nalloc)
+    resize_colcat(colcat,colcat->ncat);
 
   if(no_error) {
-    printf("read_secat2: %s has %d columns and %d lines\n",inname,
-	   ncols,*nlines);
-    return newdata;
+    printf("read_colcat_cols: %s has %d columns and %d lines\n",inname,
+	   ncols,colcat->ncat);
+    return colcat;
   }
   else {
-    fprintf(stderr,"ERROR: read_secat2.\n");
-    return del_secat(newdata);
+    fprintf(stderr,"ERROR: read_colcat_cols.\n");
+    return del_colcat(colcat);
   }
 }
 
 /*.......................................................................
  *
- * Function read_secat_header
+ * Function colcat_need
+ *
+ * Returns a column of a Colcat, loading it from the catalog file first
+ *  if it is not there yet (see read_colcat_cols).  The loaded rows are
+ *  in file order, so any column that will be needed should be loaded
+ *  before the rows of the catalog are sorted or removed.  Any of the
+ *  aperture names (maper, mapererr, faper, fapererr) loads all four.
+ *
+ * Inputs: Colcat *colcat      catalog
+ *         char *colname       Secat member name of the column
+ *
+ * Output: void *col           column, or NULL on error
  *
- * Extracts the column definitions from the header information in a
- *  SExtractor catalog
  */
 
-SHeader *read_secat_header(FILE *ifp, int *nhead)
+void *colcat_need(Colcat *colcat, char *colname)
 {
-  SHeader *sheader=NULL;
+  int i,j;                  /* Looping variables */
+  int ncols;                /* Number of scalar columns */
+  int no_error=1;           /* Flag set to 0 on error */
+  int aper;                 /* 1 if colname is an aperture column */
+  size_t elsize;            /* Size of a column element */
+  char mask[MAXCOLINFO];    /* Column wanted */
+  void **colptr;            /* Address of a column pointer in colcat */
+  void *col;                /* Column in tmpcat */
+  Colinfo *cptr;            /* Pointer to navigate the column descriptions */
+  Colcat *tmpcat=NULL;      /* Catalog holding the loaded column */
+  float **afrom[4];         /* Aperture columns of tmpcat */
+  float **ato[4];           /* Aperture columns of colcat */
+
+  if(colcat_colmask(colname,mask,&aper)) {
+    fprintf(stderr,"ERROR: colcat_need.\n");
+    return NULL;
+  }
 
-  return sheader;
+  /*
+   * Return the column if it is already there
+   */
+
+  if(aper && colcat->naper > 0)
+    return strcmp(colname,"maper") == 0 ? (void *) colcat->maper :
+      (strcmp(colname,"mapererr") == 0 ? (void *) colcat->mapererr :
+       (strcmp(colname,"faper") == 0 ? (void *) colcat->faper :
+	(void *) colcat->fapererr));
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols && !aper; i++,cptr++)
+    if(mask[i] && colcat_column(colcat,cptr))
+      return colcat_column(colcat,cptr);
+
+  /*
+   * Otherwise read it (and any columns it is derived with) from the file
+   */
+
+  if(!colcat->srcname) {
+    fprintf(stderr,"ERROR: colcat_need.  Column %s is not loaded and ",
+	    colname);
+    fprintf(stderr,"there is no catalog file to load it from.\n");
+    return NULL;
+  }
+  if(!(tmpcat = read_colcat_cols(colcat->srcname,colcat->srccomment,
+				 colcat->srcformat,colname)))
+    no_error = 0;
+  else if(tmpcat->ncat != colcat->ncat) {
+    fprintf(stderr,"ERROR: colcat_need.  %s now has %d lines, not %d.\n",
+	    colcat->srcname,tmpcat->ncat,colcat->ncat);
+    no_error = 0;
+  }
+  else if(aper && tmpcat->naper == 0) {
+    fprintf(stderr,"ERROR: colcat_need.  Format %d has no apertures.\n",
+	    colcat->srcformat);
+    no_error = 0;
+  }
+
+  /*
+   * Copy the new columns into colcat, with room for colcat->nalloc members
+   */
+
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols && no_error; i++,cptr++) {
+    colptr = (void **) ((char *) colcat + cptr->coloff);
+    if(*colptr || !(col = colcat_column(tmpcat,cptr)))
+      continue;
+    elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    if(!(*colptr = calloc(colcat->nalloc,elsize))) {
+      fprintf(stderr,"ERROR: colcat_need.  Insufficient memory.\n");
+      no_error = 0;
+    }
+    else
+      memcpy(*colptr,col,colcat->ncat * elsize);
+  }
+  if(aper && no_error) {
+    afrom[0] = &tmpcat->maper;
+    afrom[1] = &tmpcat->mapererr;
+    afrom[2] = &tmpcat->faper;
+    afrom[3] = &tmpcat->fapererr;
+    ato[0] = &colcat->maper;
+    ato[1] = &colcat->mapererr;
+    ato[2] = &colcat->faper;
+    ato[3] = &colcat->fapererr;
+    for(j=0; j<4 && no_error; j++) {
+      if(!(*ato[j] = (float *) calloc(colcat->nalloc * tmpcat->naper,
+				      sizeof(float)))) {
+	fprintf(stderr,"ERROR: colcat_need.  Insufficient memory.\n");
+	no_error = 0;
+      }
+      else
+	memcpy(*ato[j],*afrom[j],
+	       colcat->ncat * tmpcat->naper * sizeof(float));
+    }
+    if(no_error)
+      colcat->naper = tmpcat->naper;
+  }
+  tmpcat = del_colcat(tmpcat);
+
+  if(!no_error) {
+    fprintf(stderr,"ERROR: colcat_need.\n");
+    return NULL;
+  }
+  return colcat_need(colcat,colname);
 }
 
 /*.......................................................................,
  *
- * Function write_secat
+ * Function write_colcat
  *
- * Writes an array of Secat structures to an output file.
+ * Writes a Colcat structure to an output file.  The output is identical
+ *  to that of write_secat for the same catalog and format.
  *
- * Inputs: Secat *secat        secat array
- *         int ncat            number of catalog members
+ * Inputs: Colcat *colcat      catalog
  *         char *outname       name of output file
- *         int format          flag describing format of input file
- *                              (see secat_format for format descriptions)
+ *         int format          output format (see secat_format)
  *         
  * Output: int (0 or 1)       0 ==> OK.  1 ==> error.
  *
- * v2005Sep08 CDF, Added error checking on format code.
- *                 Added output format for 2MASS format processed by catsort
- *                  -- write out in USNO format (format 8)
- * v2007Jul09 CDF, Added format 3
- * v2007Jul29 CDF, Added format 14
- * v2007Aug02 CDF, Added format 15
- * v2009Jan24 CDF, Modified format 0 to be ID, alpha, delta
- *
  */
 
-int write_secat(Secat *secat, int ncat, char *outname, int format)
+int write_colcat(Colcat *colcat, char *outname, int format)
 {
-  int i;            /* Looping variable */
-  int no_error=1;   /* Flag set to 0 on error */
-  Secat *sptr;      /* Pointer to navigate secat */
-  FILE *ofp=NULL;   /* Output file pointer */
-
-
-  /*
-   * Open output file
-   */
-
-  if(!(ofp = open_writefile(outname))) {
-    fprintf(stderr,"ERROR: write_secat.\n");
+  int i;                 /* Looping variable */
+  int no_error=1;        /* Flag set to 0 on error */
+  Secat *tmpcat=NULL;    /* Scratch structure for one catalog member */
+  Outbuf *ob=NULL;       /* Output buffer */
+  FILE *ofp=NULL;        /* Output file pointer */
+
+  if(!(tmpcat = new_secat(1))) {
+    fprintf(stderr,"ERROR: write_colcat.\n");
     return 1;
   }
+  init_secat(tmpcat);
 
-  /*
-   * Add header for format 4 --> format 8
-   */
+  if(!(ofp = open_writefile(outname)) || !(ob = new_outbuf(ofp,OUTBUFSIZE))) {
+    fprintf(stderr,"ERROR: write_colcat.\n");
+    if(ofp)
+      fclose(ofp);
+    del_secat(tmpcat);
+    return 1;
+  }
 
   if(format == 4)
-    fprintf(ofp,".\n.\n.\n");
-
-  /*
-   * Write out data
-   */
+    ob_puts(ob,".\n.\n.\n",0,0);
 
-  for(i=0,sptr=secat; i<ncat; i++,sptr++) {
-    if(no_error) {
-      switch(format) {
-      case 0:
-	fprintf(ofp,"%19s %11.7f %+11.7f %02d %02d %08.5f %+03d %02d %07.4f\n",
-		sptr->name,sptr->alpha,sptr->delta,
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec);
-	break;
-      case 1:
-	fprintf(ofp,
-		"%-10s %02d %02d %08.5f %+03d %02d %07.4f ",
-		sptr->name,sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec);
-	fprintf(ofp,"%12.8f %+12.8f %8.2f %8.2f %8.2f\n",
-		sptr->alpha,sptr->delta,sptr->dx,sptr->dy,sptr->dpos);
-	break;
-      case 2:
-	fprintf(ofp,"%04d %8.2f %8.2f %2d %4.2f %7.3f %7.3f %7.3f %7.3f ",
-		sptr->id,sptr->x,sptr->y,sptr->fitflag,sptr->class,
-		sptr->miso,sptr->misoerr,sptr->mtot,sptr->merr);
-	fprintf(ofp,"%6.2f %8.2f %9.4f %7.3f %5.0f %8.3f %8.3f %6.1f %8.3f ",
-		sptr->r_kron,sptr->bkgd,sptr->thresh,sptr->muthresh,
-		sptr->isoarea,sptr->a_im,sptr->b_im,sptr->theta,sptr->fwhm);
-	fprintf(ofp,"%7.3f %7.3f %7.3f %7.3f %7.3f %7.3f ",
-		sptr->ma1,sptr->ma2,sptr->ma3,
-		sptr->ma1err,sptr->ma2err,sptr->ma3err);
-	fprintf(ofp,"%9.2f %9.2f %9.2f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f ",
-		sptr->fa1,sptr->fa2,sptr->fa3,
-		sptr->fa1err,sptr->fa2err,sptr->fa3err,
-		sptr->r2,sptr->r5,sptr->r8);
-	fprintf(ofp,"%11.7f %+11.7f %8.2f %8.2f %8.2f ",
-		sptr->alpha,sptr->delta,sptr->dx,sptr->dy,sptr->dpos);
-	fprintf(ofp,"%02d %02d %08.5f %+03d %02d %07.4f\n",
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec);
-	break;
-      case 3:
-	fprintf(ofp,
-		"%7.2f %7.2f %02d %02d %08.5f %+03d %02d %07.4f %11.7f %+11.7f",
-		sptr->x,sptr->y,
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec,
-		sptr->alpha,sptr->delta);
-	fprintf(ofp,"%s %05d  %6.2f\n",sptr->name,sptr->id,sptr->fwhm);
-	break;
-      case 4:
-	fprintf(ofp,"%02d %02d %08.5f %+03d %02d %07.4f 0.00 %11.7f %+11.7f\n",
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec,
-		sptr->alpha,sptr->delta);
-	break;
-      case 6:
-	fprintf(ofp,"%04d %8.2f %8.2f %2d %4.2f %7.3f %7.3f %10g %10g ",
-		sptr->id,sptr->x,sptr->y,sptr->fitflag,sptr->class,
-		sptr->miso,sptr->misoerr,sptr->fiso,sptr->fisoerr);
-	fprintf(ofp,"%7.3f %7.3f %10g %10g ",sptr->mtot,sptr->merr,
-		sptr->fauto,sptr->fautoerr);
-	fprintf(ofp,"%6.2f %8.2f %9.4f %7.3f %5.0f %8.3f %8.3f %6.1f %8.3f ",
-		sptr->r_kron,sptr->bkgd,sptr->thresh,sptr->muthresh,
-		sptr->isoarea,sptr->a_im,sptr->b_im,sptr->theta,sptr->fwhm);
-	fprintf(ofp,"%7.3f %7.3f %7.3f %7.3f %7.3f %7.3f ",
-		sptr->ma1,sptr->ma2,sptr->ma3,
-		sptr->ma1err,sptr->ma2err,sptr->ma3err);
-	fprintf(ofp,"%9.2f %9.2f %9.2f %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f ",
-		sptr->fa1,sptr->fa2,sptr->fa3,
-		sptr->fa1err,sptr->fa2err,sptr->fa3err,
-		sptr->r2,sptr->r5,sptr->r8);
-	fprintf(ofp,"%11.7f %+11.7f %8.2f %8.2f %8.2f ",
-		sptr->alpha,sptr->delta,sptr->dx,sptr->dy,sptr->dpos);
-	fprintf(ofp,"%02d %02d %08.5f %+03d %02d %07.4f\n",
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec);
-	break;
-      case 9: case 10:
-	fprintf(ofp,"%s %11.7f %+11.7f  %5.2f %5.2f  ",
-		sptr->name,sptr->alpha,sptr->delta,sptr->mtot,sptr->merr);
-	fprintf(ofp,"%02d %02d %08.5f %+03d %02d %07.4f  ",
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec);
-	fprintf(ofp,"%8.2f %8.2f %8.2f\n",
-		sptr->dx,sptr->dy,sptr->dpos);
-	break;
-      case 14:
-	fprintf(ofp,
-		"%7.2f %7.2f %02d:%02d:%07.4f %+03d:%02d:%06.3f %11.7f %+11.7f",
-		sptr->x,sptr->y,
-		sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-		sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec,
-		sptr->alpha,sptr->delta);
-	fprintf(ofp," %s %6.2f\n",sptr->name,sptr->fwhm);
-	break;
-#if 0
-      case 15:
-	fprintf(ofp,"05d %11.7f %+11.7f %7.4f %6.4f\n",
-		sptr->id,sptr->alpha,sptr->delta,sptr->zspec,sptr->zspecerr);
-	break;
-#endif
-      default:
-	fprintf(stderr,"ERROR: write_secat.  ");
-	fprintf(stderr,"Format %d is not valid for this function.\n",format);
-	no_error = 0;
-      }
-    }
+  for(i=0; i<colcat->ncat && no_error; i++) {
+    colcat_getrow(colcat,i,tmpcat);
+    if(print_secat_line(ob,tmpcat,format))
+      no_error = 0;
   }
 
   /*
    * Clean up and exit
    */
 
+  if(del_outbuf(ob))
+    no_error = 0;
   if(ofp)
     fclose(ofp);
+  tmpcat = del_secat(tmpcat);
 
   if(no_error)
     return 0;
   else {
-    fprintf(stderr,"ERROR: write_secat.\n");
+    fprintf(stderr,"ERROR: write_colcat.\n");
     return 1;
   }
 }
@@ -1406,6 +5737,12 @@ void secat_format()
   fprintf(stderr,"    17 ==> standard star photometry format:\n");
   fprintf(stderr,"        id, x, y, mauto, errauto, (20 mag_apers), ");
   fprintf(stderr,"(20 mag_aper errors)\n");
+  fprintf(stderr,"    19 ==> SExtractor FITS_LDAC or FITS_1.0 binary table:\n");
+  fprintf(stderr,"        columns are matched by name (NUMBER, X_IMAGE, ");
+  fprintf(stderr,"MAG_APER, ...)\n");
+  fprintf(stderr,"    20 ==> SExtractor ASCII_HEAD catalog:\n");
+  fprintf(stderr,"        columns are found from the '# N NAME' header ");
+  fprintf(stderr,"lines\n");
   fprintf(stderr,"\n");
 }
 
@@ -1437,10 +5774,11 @@ Secat *read_distcalc(char *inname, char comment, int *nlines, int format)
   int lc=0;                 /* Running counter for line number */
   int ncols;                /* Number of columns in input file */
   int nexp;                 /* Number of columns expected in input file */
+  int nalloc=0;             /* Number of members allocated in newdata */
   double djunk;             /* Variable used to read in unrequired data */
   char line[MAXC];          /* General input string */
   char ew,ns;               /* Characters indicating offset direction */
-  Pos tmppos;               /* Temporary position holder */
+  Lpos tmppos;              /* Temporary position holder */
   Secat *newdata=NULL;      /* Filled secat array */
   Secat *sptr;              /* Pointer to navigate secat */
   FILE *ifp=NULL;           /* Input file pointer */
@@ -1454,31 +5792,6 @@ Secat *read_distcalc(char *inname, char comment, int *nlines, int format)
     return NULL;
   }
 
-  /*
-   * Get number of lines in input file
-   */
-
-  if((*nlines = n_lines(ifp,comment)) == 0) {
-    fprintf(stderr,"ERROR: read_distcalc.  No valid data in input file.\n");
-    no_error = 0;
-  }
-  else {
-    printf("read_distcalc: Found %d data lines in %s\n",*nlines,inname);
-    rewind(ifp);
-  }
-
-  /*
-   * Allocate memory for secat and point sptr at the beginning of
-   *  the array.
-   */
-
-  if(no_error) {
-    if(!(newdata = new_secat(*nlines)))
-      no_error = 0;
-    else
-      sptr = newdata;
-  }
-
   /*
    * Set up number of expected columns
    */
@@ -1489,12 +5802,20 @@ Secat *read_distcalc(char *inname, char comment, int *nlines, int format)
     nexp = 7;
 
   /*
-   * Read in data
+   * Read in data in a single pass, growing the array as needed
    */
 
+  *nlines = 0;
   while(no_error && fgets(line,MAXC,ifp) != NULL) {
     lc++;
     if(line[0] != comment) {
+      if(!(newdata = (Secat *) grow_array(newdata,&nalloc,*nlines+1,
+					  sizeof(Secat)))) {
+	no_error = 0;
+	break;
+      }
+      sptr = newdata + *nlines;
+      init_secat(sptr);
       if(format) {
 	ncols = 
 	  sscanf(line,"%s %d %d %lf %d %d %lf %lf %c %lf %c %lf",sptr->name,
@@ -1533,17 +5854,28 @@ Secat *read_distcalc(char *inname, char comment, int *nlines, int format)
 	  tmppos.y = sptr->dy;
 	  xy2rth(tmppos,&djunk,&sptr->dpostheta,1);
 	}
-	sptr++;
+	(*nlines)++;
       }
     }
   }
 
+  if(no_error) {
+    if(*nlines == 0) {
+      fprintf(stderr,"ERROR: read_distcalc.  No valid data in input file.\n");
+      no_error = 0;
+    }
+    else
+      printf("read_distcalc: Found %d data lines in %s\n",*nlines,inname);
+  }
+
   /*
    * Clean up and exit
    */
 
   if(ifp)
     fclose(ifp);
+  if(no_error)
+    newdata = (Secat *) shrink_array(newdata,&nalloc,*nlines,sizeof(Secat));
 
   if(no_error) {
     printf("read_distcalc: %s has %d columns and %d lines\n",inname,
@@ -1585,6 +5917,7 @@ SDSScat *read_sdss(char *inname, char comment, int *nlines, int format)
   int ncols;                /* Number of columns in input file */
   int nexp;                 /* Number of columns expected in input file */
   int count=0;              /* Used to set ID number for catalogs with no IDs */
+  int nalloc=0;             /* Number of members allocated in newdata */
   double djunk;             /* Variable used to read in unrequired data */
   char line[MAXC];          /* General input string */
   char outformat[MAXC];     /* Output format string */
@@ -1609,39 +5942,20 @@ SDSScat *read_sdss(char *inname, char comment, int *nlines, int format)
   }
 
   /*
-   * Get number of lines in input file
-   */
-
-  if((*nlines = n_lines(ifp,comment)) == 0) {
-    fprintf(stderr,"ERROR: read_sdss.  No valid data in input file.\n");
-    no_error = 0;
-  }
-  else {
-    rewind(ifp);
-  }
-
-  /*
-   * Allocate memory for SDSScat and point sptr at the beginning of
-   *  the array.
-   */
-
-  if(no_error) {
-    if(!(newdata = new_sdsscat(*nlines)))
-      no_error = 0;
-    else
-      sptr = newdata;
-  }
-
-  /*
-   * Read in data
+   * Read in data in a single pass, growing the array as needed
    */
 
+  *nlines = 0;
   while(no_error && fgets(line,MAXC,ifp) != NULL) {
+    lc++;
     if(line[0] != comment) {
-      ncols = sscanf(line,"%lf %lf %f %f %f %f %f %f",
-		     &sptr->alpha,&sptr->delta,
-		     &sptr->u,&sptr->g,&sptr->r,&sptr->i,&sptr->z,
-		     &sptr->class);
+      if(!(newdata = (SDSScat *) grow_array(newdata,&nalloc,*nlines+1,
+					    sizeof(SDSScat)))) {
+	no_error = 0;
+	break;
+      }
+      sptr = newdata + *nlines;
+      ncols = parse_sdss_line(line,sptr);
       if(ncols != nexp) {
 	fprintf(stderr,
 		"ERROR: read_sdss.  Bad input format in %s. (line = %d)\n",
@@ -1650,22 +5964,28 @@ SDSScat *read_sdss(char *inname, char comment, int *nlines, int format)
 	fprintf(stderr," --  it contained %d columns.\n",ncols);
 	no_error = 0;
       }
-
-      /*
-       * Convert alpha,delta to RA,Dec
-       */
-
-      deg2spos(sptr->alpha,sptr->delta,&sptr->skypos);
-      sptr++;
+      (*nlines)++;
     }
   }
 
+  if(no_error && ferror(ifp)) {
+    fprintf(stderr,"ERROR: read_sdss.  Error reading %s\n",inname);
+    no_error = 0;
+  }
+  if(no_error && *nlines == 0) {
+    fprintf(stderr,"ERROR: read_sdss.  No valid data in input file.\n");
+    no_error = 0;
+  }
+
   /*
    * Clean up and exit
    */
 
   if(ifp)
     fclose(ifp);
+  if(no_error)
+    newdata = (SDSScat *) shrink_array(newdata,&nalloc,*nlines,
+				       sizeof(SDSScat));
 
   if(no_error) {
     printf("read_sdss: %s has %d columns and %d lines\n",inname,
@@ -1708,6 +6028,7 @@ int write_sdss(SDSScat *scat, int ncat, char *outname, int format)
   int i;            /* Looping variable */
   int no_error=1;   /* Flag set to 0 on error */
   SDSScat *sptr;    /* Pointer to navigate scat */
+  Outbuf *ob=NULL;  /* Output buffer */
   FILE *ofp=NULL;   /* Output file pointer */
 
 
@@ -1715,35 +6036,56 @@ int write_sdss(SDSScat *scat, int ncat, char *outname, int format)
    * Open output file
    */
 
-  if(!(ofp = open_writefile(outname))) {
+  if(!(ofp = open_writefile(outname)) || !(ob = new_outbuf(ofp,OUTBUFSIZE))) {
     fprintf(stderr,"ERROR: write_sdss.\n");
+    if(ofp)
+      fclose(ofp);
     return 1;
   }
 
   /*
    * Write out data -- right now there are no differences between
-   *  the two formats
+   *  the two formats.  Same output as
+   *   "%04d %12.8f %+12.8f   %6.3f %6.3f %6.3f %6.3f %6.3f   "
+   *   "%4.2f %8.2f %8.2f %8.2f    %02d %02d %08.5f %+03d %02d %07.4f\n"
    */
 
   for(i=0,sptr=scat; i<ncat; i++,sptr++) {
-    if(no_error) {
-      fprintf(ofp,"%04d %12.8f %+12.8f   %6.3f %6.3f %6.3f %6.3f %6.3f   ",
-	      sptr->id,sptr->alpha,sptr->delta,
-	      sptr->u,sptr->g,sptr->r,sptr->i,sptr->z);
-      fprintf(ofp,"%4.2f %8.2f %8.2f %8.2f    ",
-	      sptr->class,sptr->dx,sptr->dy,sptr->dpos);
-      fprintf(ofp,"%02d %02d %08.5f %+03d %02d %07.4f",
-	      sptr->skypos.hr,sptr->skypos.min,sptr->skypos.sec,
-	      sptr->skypos.deg,sptr->skypos.amin,sptr->skypos.asec);
-      /* At a later time add spectroscopic info */
-      fprintf(ofp,"\n");
-    }
+    ob_int(ob,sptr->id,4,OB_ZERO);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->alpha,12,8,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->delta,12,8,OB_PLUS);
+    ob_puts(ob,"   ",0,0);
+    ob_fixed(ob,sptr->u,6,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->g,6,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->r,6,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->i,6,3,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->z,6,3,0);
+    ob_puts(ob,"   ",0,0);
+    ob_fixed(ob,sptr->class,4,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dx,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dy,8,2,0);
+    ob_putc(ob,' ');
+    ob_fixed(ob,sptr->dpos,8,2,0);
+    ob_puts(ob,"    ",0,0);
+    ob_skypos(ob,&sptr->skypos,' ',5,4);
+    /* At a later time add spectroscopic info */
+    ob_putc(ob,'\n');
   }
 
   /*
    * Clean up and exit
    */
 
+  if(del_outbuf(ob))
+    no_error = 0;
   if(ofp)
     fclose(ofp);
 
@@ -1764,7 +6106,7 @@ int write_sdss(SDSScat *scat, int ncat, char *outname, int format)
  *
  * Inputs: Skypos cent         central position (RA, Dec)
  *         Skypos *skypos      secondary positions (RA, Dec)
- *         Pos *offsets        (x,y) offsets
+ *         Lpos *offsets       (x,y) offsets
  *         int noffsets        number of offsets
  *         FILE *ofp           output file pointer (NULL if no output file)
  *
@@ -1772,28 +6114,33 @@ int write_sdss(SDSScat *scat, int ncat, char *outname, int format)
  *
  */
 
-int print_offsets(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
+int print_offsets(Skypos cent, Skypos *skypos, Lpos *offsets, int noffsets,
 		  FILE *ofp)
 {
-  int i;           /* Looping variable */
-  double r,theta;  /* Temporary polar coordinate holders */
-  char ew[5];      /* Direction of delta_RA */
-  char ns[5];      /* Direction of delta_Dec */
-  char line[MAXC];      /* General string for reading input */
-  Skypos *sptr;    /* Pointer used to navigate skypos */
-  Pos *optr;       /* Pointer used to navigate offsets */
+  int i;             /* Looping variable */
+  double r,theta;    /* Temporary polar coordinate holders */
+  double alphadeg;   /* RA in decimal degrees */
+  double deltadeg;   /* Dec in decimal degrees */
+  char ew[5];        /* Direction of delta_RA */
+  char ns[5];        /* Direction of delta_Dec */
+  char ra[HMSLEN];   /* RA in hh mm ss.ssss format */
+  char dec[HMSLEN];  /* Dec in dd mm ss.sss format */
+  Skypos *sptr;      /* Pointer used to navigate skypos */
+  Lpos *optr;        /* Pointer used to navigate offsets */
 
   /*
    * Print out the central position
    */
 
+  spos2deg(cent,&alphadeg,&deltadeg);
+  format_ra(alphadeg,' ',4,ra);
+  format_dec(deltadeg,' ',4,dec);
   if(ofp) {
     fprintf(ofp,"#\n");
     fprintf(ofp,"#\n");
     fprintf(ofp,"#                CENTRAL SOURCE:  %s\n",cent.label);
     fprintf(ofp,"#\n");
-    fprintf(ofp,"#Central source:  %02d %02d %07.4f  %+03d %02d %07.4f\n",
-	    cent.hr,cent.min,cent.sec,cent.deg,cent.amin,cent.asec);
+    fprintf(ofp,"#Central source:  %s  %s\n",ra,dec);
     fprintf(ofp,"#\n");
     fprintf(ofp,"#                                         ");
     fprintf(ofp,"   Shift FROM central source\n");
@@ -1812,8 +6159,7 @@ int print_offsets(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
     }
     printf("#\n");
     printf("#\n");
-    printf("#Central source:  %02d %02d %07.4f  %+03d %02d %07.4f\n",
-	   cent.hr,cent.min,cent.sec,cent.deg,cent.amin,cent.asec);
+    printf("#Central source:  %s  %s\n",ra,dec);
     printf("#\n");
     printf("#                                         ");
     printf("   Shift FROM central source\n");
@@ -1850,17 +6196,16 @@ int print_offsets(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
      * Print output to file or to STDOUT
      */
 
+    spos2deg(*sptr,&alphadeg,&deltadeg);
+    format_ra(alphadeg,' ',4,ra);
+    format_dec(deltadeg,' ',3,dec);
     if(ofp) {
-      fprintf(ofp,"%11s  %02d %02d %07.4f  %+03d %02d %06.3f ",
-	      sptr->label,sptr->hr,sptr->min,sptr->sec,
-	      sptr->deg,sptr->amin,sptr->asec);
+      fprintf(ofp,"%11s  %s  %s ",sptr->label,ra,dec);
       fprintf(ofp,"%8.2f %1s %8.2f %1s %8.2f  %+6.1f\n",
 	      fabs(optr->x),ew,fabs(optr->y),ns,r,theta);
     }
     else {
-      printf("%11s  %02d %02d %07.4f  %+03d %02d %06.3f ",
-	      sptr->label,sptr->hr,sptr->min,sptr->sec,
-	      sptr->deg,sptr->amin,sptr->asec);
+      printf("%11s  %s  %s ",sptr->label,ra,dec);
       printf("%8.2f %1s %8.2f %1s %8.2f  %+6.1f\n",
 	      fabs(optr->x),ew,fabs(optr->y),ns,r,theta);
     }
@@ -5,6 +5,33 @@
 #include "coords.h"
 
 #define MAX 1000
+#define GROWMIN 64  /* Initial number of elements allocated by grow_array */
+
+enum {
+  READ_STDIO,
+  READ_MMAP,
+  READ_PAR
+}; /* Enumeration for the input method of read_secat_mode (READ_PAR is
+      only understood by read_secat_method and read_sdss_method in
+      catpar.c) */
+
+#define OUTBUFSIZE 1048576 /* Default size of an Outbuf */
+#define SLURPSIZE 16777216 /* First memory for a stream read by map_readfile */
+#define OBMAXFIELD 256     /* Room reserved for one ob_printf call */
+
+enum {
+  OB_PLUS=1,
+  OB_ZERO=2,
+  OB_LEFT=4
+}; /* Flags for the ob_* formatting functions (printf '+', '0' and '-') */
+
+typedef struct {
+  FILE *ofp;         /* Output file (NULL ==> buffer grows in memory) */
+  char *buf;         /* Buffered output */
+  size_t size;       /* Allocated size of buf */
+  size_t used;       /* Number of characters in buf */
+  int error;         /* Set to 1 if a write or an allocation failed */
+} Outbuf;            /* Output buffer (see new_outbuf in dataio.c) */
 
 int file_exists(char *filename);
 FILE *open_readfile(char *filename);
@@ -12,17 +39,50 @@ FILE *open_writefile(char *filename);
 FILE *open_appendfile(char *filename, int verbose);
 int n_lines(FILE *ifp, char comchar);
 int n_cols(char *line, char comchar, int verbose);
+void *grow_array(void *array, int *nalloc, int nneed, size_t elsize);
+void *shrink_array(void *array, int *nalloc, int nused, size_t elsize);
+int map_readfile(FILE *ifp, char **data, size_t *size);
+void unmap_file(char *data, size_t size);
+Outbuf *new_outbuf(FILE *ofp, size_t size);
+int del_outbuf(Outbuf *ob);
+int ob_flush(Outbuf *ob);
+void ob_putc(Outbuf *ob, char c);
+void ob_puts(Outbuf *ob, const char *s, int width, int flags);
+void ob_int(Outbuf *ob, int val, int width, int flags);
+void ob_fixed(Outbuf *ob, double val, int width, int prec, int flags);
+void ob_skypos(Outbuf *ob, Skypos *spos, char sep, int secprec, int asecprec);
+void ob_printf(Outbuf *ob, const char *fmt, ...);
 Datastruct *read_datastruct(char *inname, char comment, int *nlines,
 			    int format);
 Secat *read_difmap(char *inname, char comment, int *nlines, Skypos *pos0);
 Secat *read_secat(char *inname, char comment, int *nlines, int format);
+Secat *read_secat_mode(char *inname, char comment, int *nlines, int format,
+		       int readmode);
 Secat *read_secat2(char *inname, char comment, int *nlines);
 int write_secat(Secat *secat, int ncat, char *outname, int format);
+int print_secat_rows(Outbuf *ob, Secat *secat, int nrows, int format);
 void secat_format();
+int secat_format_info(int format, int *nexp, int *nskip);
+int count_data_lines(char *start, char *end, char comment, int *nphys);
+int parse_secat_chunk(char *start, char *end, char comment, int format,
+		      int count, Secat *secat, int *lc, int *ncols);
+int parse_sdss_chunk(char *start, char *end, char comment, SDSScat *sdss,
+		     int *lc, int *ncols);
+int sext_member(char *colname, int elem, char *type, int *offset);
+int find_sheader_column(SHeader *sheader, int nhead, char *colname);
+Secat *read_fitscat(char *inname, int *nlines);
+SHeader *read_secat_header(FILE *ifp, int *nhead);
+Secat *read_sexthead(char *inname, char comment, int *nlines);
+Colcat *read_colcat(char *inname, char comment, int format);
+Colcat *read_colcat_cols(char *inname, char comment, int format, char *cols);
+void *colcat_need(Colcat *colcat, char *colname);
+int write_colcat(Colcat *colcat, char *outname, int format);
+int write_bcat(Colcat *colcat, char *srcname, char comment, int format);
+Colcat *read_bcat(char *srcname, char comment, int format);
 Secat *read_distcalc(char *inname, char comment, int *nlines, int format);
 SDSScat *read_sdss(char *inname, char comment, int *nlines, int format);
 int write_sdss(SDSScat *scat, int ncat, char *outname, int format);
-int print_offsets(Skypos cent, Skypos *skypos, Pos *offsets, int noffsets,
+int print_offsets(Skypos cent, Skypos *skypos, Lpos *offsets, int noffsets,
 		  FILE *ofp);
 
 #endif
@@ -7,12 +7,294 @@
  *                of a Pos array.
  * v12Jul03 CDF, Moved new_secat and del_secat functions from matchcat.c
  *               Moved new_skypos and del_skypos functions from coords.c
+ * v16Oct26 AGT, Added the column-ordered Colcat structure and its
+ *                row-access functions, plus init_secat.
+ *               Colcat columns can now live in a file map (see read_bcat
+ *                in dataio.c).
+ *               Colcats can hold a subset of the columns (see
+ *                read_colcat_cols in dataio.c).
+ *               Added Arenas.  The simple new_* functions now take their
+ *                memory from the current arena, if there is one.
+ *               Added the Lpos and Sample structures, which have no 
+ *                label buffer, and the Labpool side table for Lpos labels.
+ *               arena_free now leaves alone memory in any arena with an
+ *                open scope, not only the current one.
  */
 
 #include <stdlib.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
 #include "structdef.h"
 
+/*.......................................................................
+ *
+ * Arenas
+ *
+ * An Arena hands out memory by bumping a pointer through large blocks,
+ *  so that the many small, short-lived arrays made in inner loops cost
+ *  almost nothing to allocate.  Nothing is freed individually: the
+ *  memory is given back all at once when a scope ends.
+ *
+ *   Arenamark mark = arena_begin(arena);
+ *   ... new_pos(), new_secat(), etc. now draw from arena ...
+ *   arena_end(arena,mark);   -- everything since arena_begin is released
+ *
+ * Between arena_begin and arena_end the arena is the calling thread's
+ *  current arena.  The new_* functions below (and new_fluxrec) take
+ *  their memory from it, through arena_malloc.  The matching del_*
+ *  functions leave memory in any arena with an open scope on the 
+ *  thread alone, not only the current one, so the usual new/del pairs
+ *  need no change inside a scope, even one nested in another arena's.  Scopes nest, and each
+ *  thread has its own current arena, so threads should each use their
+ *  own Arena.  Memory from an arena must not be passed to a del_*
+ *  function, or to realloc, once its scope has ended.
+ *
+ * Functions:
+ *    new_arena         -  creates an arena
+ *    del_arena         -  frees an arena and all of its memory
+ *    arena_alloc       -  takes memory from an arena
+ *    arena_begin       -  starts a scope and makes the arena current
+ *    arena_end         -  releases the memory taken since arena_begin
+ *    arena_reset       -  releases all of the memory in an arena
+ *    arena_owns        -  checks whether memory came from an arena
+ *    current_arena     -  returns the current arena of the calling thread
+ *    arena_malloc      -  takes memory from the current arena, or malloc
+ *    arena_free        -  frees memory unless it is in an arena with an
+ *                          open scope
+ *    print_arena_stats -  prints allocation counts for profiling
+ *
+ */
+
+static __thread Arena *curr_arena=NULL; /* Current arena of this thread */
+static __thread Arena *open_arenas=NULL; /* Arenas with open scopes */
+static __thread long nheap=0;           /* arena_malloc calls using malloc */
+
+Arena *new_arena(size_t blocksize)
+{
+  Arena *arena;     /* New arena */
+
+  if(!(arena = (Arena *) calloc(1,sizeof(Arena)))) {
+    fprintf(stderr,"ERROR: new_arena.  Insufficient memory.\n");
+    return NULL;
+  }
+  arena->blocksize = (blocksize > 0) ? blocksize : ARENABLOCK;
+
+  return arena;
+}
+
+/*.......................................................................
+ *
+ * Function arena_unlink
+ *
+ * Takes an arena off the calling thread's list of arenas with open 
+ *  scopes (see arena_free).
+ *
+ * Inputs: Arena *arena        arena
+ *
+ * Output: (none)
+ *
+ */
+
+static void arena_unlink(Arena *arena)
+{
+  Arena **aptr;       /* Link that points at the arena */
+
+  for(aptr=&open_arenas; *aptr; aptr=&(*aptr)->nextopen)
+    if(*aptr == arena) {
+      *aptr = arena->nextopen;
+      break;
+    }
+  arena->nextopen = NULL;
+  arena->nscope = 0;
+}
+
+Arena *del_arena(Arena *arena)
+{
+  Arenablock *bptr;   /* Block being freed */
+
+  if(!arena)
+    return NULL;
+  if(curr_arena == arena)
+    curr_arena = NULL;
+  if(arena->nscope > 0)
+    arena_unlink(arena);
+  while((bptr = arena->block)) {
+    arena->block = bptr->next;
+    free(bptr);
+  }
+  if(arena->spare)
+    free(arena->spare);
+  free(arena);
+
+  return NULL;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+  size_t need;        /* Size of a new block */
+  Arenablock *bptr;   /* Block to take the memory from */
+  char *ptr;          /* Memory handed out */
+
+  size = (size + ARENAALIGN - 1) / ARENAALIGN * ARENAALIGN;
+  if(size == 0)
+    size = ARENAALIGN;
+
+  /*
+   * Start a new block if this one is full, reusing the spare if it is
+   *  big enough
+   */
+
+  if(!(bptr = arena->block) || bptr->size - bptr->used < size) {
+    if(arena->spare && arena->spare->size >= size) {
+      bptr = arena->spare;
+      arena->spare = NULL;
+    }
+    else {
+      need = (size > arena->blocksize) ? size : arena->blocksize;
+      if(!(bptr = (Arenablock *) malloc(sizeof(Arenablock) + need))) {
+	fprintf(stderr,"ERROR: arena_alloc.  Insufficient memory.\n");
+	return NULL;
+      }
+      bptr->size = need;
+      arena->nblock++;
+    }
+    bptr->used = 0;
+    bptr->next = arena->block;
+    arena->block = bptr;
+  }
+
+  ptr = (char *) (bptr + 1) + bptr->used;
+  bptr->used += size;
+  arena->inuse += size;
+  arena->nbytes += size;
+  arena->nalloc++;
+  if(arena->inuse > arena->peak)
+    arena->peak = arena->inuse;
+
+  return ptr;
+}
+
+/*.......................................................................
+ *
+ * Function arena_release
+ *
+ * Gives back the blocks of an arena that are newer than a given block,
+ *  and rewinds that block to the given point.  The largest block given
+ *  back is kept as the spare, so that a scope that is begun and ended
+ *  many times in a loop does not go back to malloc each time.
+ *
+ * Inputs: Arena *arena        arena
+ *         Arenablock *keep    oldest block to keep (NULL ==> none)
+ *         size_t used         bytes to keep in that block
+ *
+ * Output: (none)
+ *
+ */
+
+static void arena_release(Arena *arena, Arenablock *keep, size_t used)
+{
+  Arenablock *bptr;   /* Block being given back */
+
+  while((bptr = arena->block) && bptr != keep) {
+    arena->block = bptr->next;
+    if(!arena->spare || bptr->size > arena->spare->size) {
+      if(arena->spare)
+	free(arena->spare);
+      arena->spare = bptr;
+    }
+    else
+      free(bptr);
+  }
+  if(keep && arena->block == keep)
+    keep->used = used;
+  arena->nrelease++;
+}
+
+Arenamark arena_begin(Arena *arena)
+{
+  Arenamark mark;     /* Where the scope begins */
+
+  mark.block = arena->block;
+  mark.used = arena->block ? arena->block->used : 0;
+  mark.inuse = arena->inuse;
+  mark.prev = curr_arena;
+  curr_arena = arena;
+  if(arena->nscope++ == 0) {
+    arena->nextopen = open_arenas;
+    open_arenas = arena;
+  }
+
+  return mark;
+}
+
+void arena_end(Arena *arena, Arenamark mark)
+{
+  arena_release(arena,mark.block,mark.used);
+  arena->inuse = mark.inuse;
+  curr_arena = mark.prev;
+  if(arena->nscope > 0 && --arena->nscope == 0)
+    arena_unlink(arena);
+}
+
+void arena_reset(Arena *arena)
+{
+  arena_release(arena,NULL,0);
+  arena->inuse = 0;
+}
+
+int arena_owns(Arena *arena, void *ptr)
+{
+  char *cptr = (char *) ptr;   /* Byte pointer to memory */
+  Arenablock *bptr;            /* Pointer to navigate blocks */
+
+  if(!arena || !ptr)
+    return 0;
+  for(bptr=arena->block; bptr; bptr=bptr->next)
+    if(cptr >= (char *) (bptr + 1) && cptr < (char *) (bptr + 1) + bptr->size)
+      return 1;
+  return 0;
+}
+
+Arena *current_arena()
+{
+  return curr_arena;
+}
+
+void *arena_malloc(size_t size)
+{
+  if(curr_arena)
+    return arena_alloc(curr_arena,size);
+  nheap++;
+  return malloc(size);
+}
+
+void arena_free(void *ptr)
+{
+  Arena *aptr;        /* Pointer to navigate the open arenas */
+
+  if(!ptr)
+    return;
+  for(aptr=open_arenas; aptr; aptr=aptr->nextopen)
+    if(arena_owns(aptr,ptr))
+      return;
+  free(ptr);
+}
+
+void print_arena_stats(Arena *arena, FILE *fp)
+{
+  if(arena) {
+    fprintf(fp,"Arena: %ld allocations, %lu bytes, peak %lu bytes in use\n",
+	    arena->nalloc,(unsigned long) arena->nbytes,
+	    (unsigned long) arena->peak);
+    fprintf(fp,"Arena: %ld blocks of >= %lu bytes, %ld releases\n",
+	    arena->nblock,(unsigned long) arena->blocksize,arena->nrelease);
+  }
+  fprintf(fp,"Arena: %ld new_* allocations from the heap on this thread\n",
+	  nheap);
+}
+
 /*.......................................................................
  *
  * Strings
@@ -27,7 +309,7 @@ char *new_string(int size)
   int i;
   char *string;
 
-  string = (char *) malloc(sizeof(char) * size);
+  string = (char *) arena_malloc(sizeof(char) * size);
   if(!string) {
     fprintf(stderr,"Insufficient memory for string of length %d.\n",
 	    size);
@@ -39,8 +321,7 @@ char *new_string(int size)
 
 char *del_string(char *string)
 {
-  if(string)
-    free(string);
+  arena_free(string);
 
   return NULL;
 }
@@ -61,7 +342,7 @@ float *new_array(int size1,int size2)
   int i;
   float *array,*ptr;
 
-  array = (float *) malloc(sizeof(float) * size1 * size2);
+  array = (float *) arena_malloc(sizeof(float) * size1 * size2);
   if(!array) {
     fprintf(stderr,"Insufficient memory for %dx%d data array.\n",
 	    size1,size2);
@@ -75,8 +356,7 @@ float *new_array(int size1,int size2)
 
 float *del_array(float *array)
 {
-  if(array)
-    free(array);
+  arena_free(array);
 
   return NULL;
 }
@@ -129,7 +409,7 @@ int *new_intarray(int size1,int size2)
   int i;
   int *array,*ptr;
 
-  array = (int *) malloc(sizeof(int) * size1 * size2);
+  array = (int *) arena_malloc(sizeof(int) * size1 * size2);
   if(!array) {
     fprintf(stderr,"Insufficient memory for %dx%d data array.\n",
 	    size1,size2);
@@ -143,8 +423,7 @@ int *new_intarray(int size1,int size2)
 
 int *del_intarray(int *array)
 {
-  if(array)
-    free(array);
+  arena_free(array);
 
   return NULL;
 }
@@ -164,7 +443,7 @@ double *new_doubarray(int size)
   int i;
   double *array,*ptr;
 
-  array = (double *) malloc(sizeof(double) * size);
+  array = (double *) arena_malloc(sizeof(double) * size);
   if(!array) {
     fprintf(stderr,"Insufficient memory for %d data array.\n",size);
     return NULL;
@@ -177,8 +456,7 @@ double *new_doubarray(int size)
 
 double *del_doubarray(double *array)
 {
-  if(array)
-    free(array);
+  arena_free(array);
 
   return NULL;
 }
@@ -234,7 +512,7 @@ Datastruct *new_datastruct(int size)
   Datastruct *newinfo;
   Datastruct *dptr;
  
-  newinfo = (Datastruct *) malloc(sizeof(Datastruct) * size);
+  newinfo = (Datastruct *) arena_malloc(sizeof(Datastruct) * size);
   if(!newinfo) {
     fprintf(stderr,"new_datastruct: \n");
     fprintf(stderr,"Insufficient memory for Datastruct array.\n");
@@ -266,8 +544,7 @@ Datastruct *new_datastruct(int size)
 
 Datastruct *del_datastruct(Datastruct *datastruct)
 {
-  if(datastruct)
-    free(datastruct);
+  arena_free(datastruct);
  
   return NULL;
 }
@@ -296,7 +573,7 @@ Pos *new_pos(int n1,int n2)
    * Allocate memory for array
    */
 
-  pos = (Pos *) malloc(sizeof(Pos) * n1 * n2);
+  pos = (Pos *) arena_malloc(sizeof(Pos) * n1 * n2);
   if(!pos) {
     fprintf(stderr,"Insufficient memory for a %dx%d position array.\n",n1,n2);
     return NULL;
@@ -316,8 +593,7 @@ Pos *new_pos(int n1,int n2)
 
 Pos *del_pos(Pos *pos)
 {
-  if (pos)
-    free (pos);
+  arena_free(pos);
 
   return NULL;
 }
@@ -366,6 +642,241 @@ float **pos2xy(Pos *pos, int npts, int *ngood)
   return xy;
 }
 
+/*......................................................................
+ *
+ * Functions to allocate and free up arrays of the Lpos structure.  An
+ *   Lpos holds the same numbers as a Pos, but instead of a MAXC label
+ *   it carries the index of a label in a Labpool (or -1 for none), so an
+ *   array of them costs 40 bytes per point rather than about 1 kB.
+ *
+ * Functions:
+ *    new_lpos  -   allocates the array
+ *    del_lpos  -   frees the array
+ *
+ */
+
+Lpos *new_lpos(int n)
+{
+  int i;           /* Looping variable */
+  Lpos *lpos=NULL; /* New array to be allocated */
+  Lpos *lptr;      /* Pointer to navigate array */
+
+  lpos = (Lpos *) arena_malloc(sizeof(Lpos) * n);
+  if(!lpos) {
+    fprintf(stderr,"Insufficient memory for a %d position array.\n",n);
+    return NULL;
+  }
+
+  for(i=0,lptr=lpos; i<n; i++,lptr++) {
+    lptr->x = lptr->y = lptr->xerr = lptr->yerr = 0.0;
+    lptr->flag = 0;
+    lptr->labid = -1;
+  }
+
+  return lpos;
+}
+
+Lpos *del_lpos(Lpos *lpos)
+{
+  arena_free(lpos);
+
+  return NULL;
+}
+
+/*......................................................................
+ *
+ * Functions to allocate and free up arrays of the Sample structure, 
+ *   which holds one (x,y) point of a spectrum, an image slice or a
+ *   trace, and a flag.
+ *
+ * Functions:
+ *    new_sample  -   allocates the array
+ *    del_sample  -   frees the array
+ *    sample2xy   -   extracts the x and y components from a Sample array
+ *
+ */
+
+Sample *new_sample(int n)
+{
+  int i;                /* Looping variable */
+  Sample *sample=NULL;  /* New array to be allocated */
+  Sample *sptr;         /* Pointer to navigate array */
+
+  sample = (Sample *) arena_malloc(sizeof(Sample) * n);
+  if(!sample) {
+    fprintf(stderr,"Insufficient memory for a %d sample array.\n",n);
+    return NULL;
+  }
+
+  for(i=0,sptr=sample; i<n; i++,sptr++) {
+    sptr->x = sptr->y = 0.0;
+    sptr->flag = 0;
+  }
+
+  return sample;
+}
+
+Sample *del_sample(Sample *sample)
+{
+  arena_free(sample);
+
+  return NULL;
+}
+
+float **sample2xy(Sample *sample, int npts, int *ngood)
+{
+  int i;                 /* Looping variable */
+  float **xy={NULL};     /* x and y components of the Sample array */
+  float *xptr;           /* Pointer to navigate the x array */
+  float *yptr;           /* Pointer to navigate the y array */
+  Sample *sptr;          /* Pointer to navigate the Sample array */
+
+  if(!(xy = new_float2(2))) {
+    fprintf(stderr,"ERROR: sample2xy.\n");
+    return NULL;
+  }
+
+  if(!(xy[0] = new_array(npts,1)) || !(xy[1] = new_array(npts,1))) {
+    fprintf(stderr,"ERROR: sample2xy\n");
+    return del_float2(xy,2);
+  }
+
+  *ngood = 0;
+  for(i=0,sptr=sample,xptr=xy[0],yptr=xy[1]; i<npts; 
+      i++,sptr++,xptr++,yptr++) {
+    if(sptr->flag == 0) {
+      *xptr = (float) sptr->x;
+      *yptr = (float) sptr->y;
+      (*ngood)++;
+    }
+  }
+
+  return xy;
+}
+
+/*.......................................................................
+ *
+ * Labpool functions
+ *
+ * A Labpool keeps the labels of an Lpos array in one string pool, which
+ *  is grown geometrically as needed.  Labels are referred to by their
+ *  index, which is what goes in the labid member of an Lpos.
+ *
+ * Functions:
+ *    new_labpool    -  allocates a pool with room for about nlab labels
+ *    del_labpool    -  frees a pool
+ *    labpool_add    -  copies a label into a pool and returns its index
+ *    labpool_get    -  returns the label with a given index
+ *
+ */
+
+Labpool *new_labpool(int nlab)
+{
+  Labpool *labpool=NULL;  /* New pool */
+
+  if(nlab < 1)
+    nlab = 1;
+  if(!(labpool = (Labpool *) malloc(sizeof(Labpool)))) {
+    fprintf(stderr,"ERROR: new_labpool.  Insufficient memory.\n");
+    return NULL;
+  }
+  labpool->nlab = 0;
+  labpool->poolsize = 0;
+  labpool->nalloc = nlab;
+  labpool->poolalloc = 16 * nlab;
+  labpool->off = (int *) malloc(sizeof(int) * labpool->nalloc);
+  labpool->pool = (char *) malloc(labpool->poolalloc);
+  if(!labpool->off || !labpool->pool) {
+    fprintf(stderr,"ERROR: new_labpool.  Insufficient memory.\n");
+    return del_labpool(labpool);
+  }
+
+  return labpool;
+}
+
+Labpool *del_labpool(Labpool *labpool)
+{
+  if(labpool) {
+    if(labpool->off)
+      free(labpool->off);
+    if(labpool->pool)
+      free(labpool->pool);
+    free(labpool);
+  }
+
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function labpool_add
+ *
+ * Copies a label into a Labpool.
+ *
+ * Inputs: Labpool *labpool    pool
+ *         char *label         label
+ *
+ * Output: int labid           index of the label, or -1 on error
+ *
+ */
+
+int labpool_add(Labpool *labpool, char *label)
+{
+  int len;            /* Length of label, including the terminator */
+  int newalloc;       /* New size of an array */
+  int *newoff;        /* Reallocated offsets */
+  char *newpool;      /* Reallocated pool */
+
+  if(labpool->nlab == labpool->nalloc) {
+    newalloc = 2 * labpool->nalloc;
+    if(!(newoff = (int *) realloc(labpool->off,sizeof(int) * newalloc))) {
+      fprintf(stderr,"ERROR: labpool_add.  Insufficient memory.\n");
+      return -1;
+    }
+    labpool->off = newoff;
+    labpool->nalloc = newalloc;
+  }
+
+  len = strlen(label) + 1;
+  if(labpool->poolsize + len > labpool->poolalloc) {
+    newalloc = 2 * labpool->poolalloc;
+    while(newalloc < labpool->poolsize + len)
+      newalloc *= 2;
+    if(!(newpool = (char *) realloc(labpool->pool,newalloc))) {
+      fprintf(stderr,"ERROR: labpool_add.  Insufficient memory.\n");
+      return -1;
+    }
+    labpool->pool = newpool;
+    labpool->poolalloc = newalloc;
+  }
+
+  memcpy(labpool->pool + labpool->poolsize,label,len);
+  labpool->off[labpool->nlab] = labpool->poolsize;
+  labpool->poolsize += len;
+  return labpool->nlab++;
+}
+
+/*.......................................................................
+ *
+ * Function labpool_get
+ *
+ * Returns a label from a Labpool.  An index of -1 (no label), or a pool
+ *  of NULL, gives the empty string.
+ *
+ * Inputs: Labpool *labpool    pool
+ *         int labid           index of the label
+ *
+ * Output: char *label         label
+ *
+ */
+
+char *labpool_get(Labpool *labpool, int labid)
+{
+  if(!labpool || labid < 0 || labid >= labpool->nlab)
+    return "";
+  return labpool->pool + labpool->off[labid];
+}
+
 /*.......................................................................
  *
  * Function new_skypos
@@ -383,7 +894,7 @@ Skypos *new_skypos(int size)
 {
   Skypos *newinfo;
  
-  newinfo = (Skypos *) malloc(sizeof(Skypos) * size);
+  newinfo = (Skypos *) arena_malloc(sizeof(Skypos) * size);
   if(!newinfo) {
     fprintf(stderr,"Insufficient memory for data array.\n");
     return NULL;
@@ -405,8 +916,7 @@ Skypos *new_skypos(int size)
  
 Skypos *del_skypos(Skypos *skypos)
 {
-  if(skypos)
-    free(skypos);
+  arena_free(skypos);
  
   return NULL;
 }
@@ -485,7 +995,7 @@ Secat *new_secat(int size)
   Secat *newinfo;
   Secat *sptr;
  
-  newinfo = (Secat *) malloc(sizeof(Secat) * size);
+  newinfo = (Secat *) arena_malloc(sizeof(Secat) * size);
   if(!newinfo) {
     fprintf(stderr,"new_secat: \n");
     fprintf(stderr,"Insufficient memory for Secat array.\n");
@@ -519,12 +1029,708 @@ Secat *new_secat(int size)
 
 Secat *del_secat(Secat *secat)
 {
-  if(secat)
-    free(secat);
+  arena_free(secat);
  
   return NULL;
 }
 
+/*.......................................................................
+ *
+ * Function init_secat
+ *
+ * Sets a single Secat structure to the same default values that new_secat
+ *  uses, and zeroes the remaining scalar members.  Used when catalog rows
+ *  are parsed into a reusable scratch Secat rather than into a freshly
+ *  allocated array.
+ *
+ * Input:  Secat *secat        structure to initialize
+ *
+ * Output: (none)
+ *
+ */
+
+void init_secat(Secat *secat)
+{
+  int i;              /* Looping variable */
+  int ncols;          /* Number of scalar columns */
+  char *base;         /* Byte pointer to secat */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+
+  base = (char *) secat;
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    switch(cptr->type) {
+    case 'i':
+      *(int *) (base + cptr->secoff) = 0;
+      break;
+    case 'f':
+      *(float *) (base + cptr->secoff) = 0.0;
+      break;
+    case 'd':
+      *(double *) (base + cptr->secoff) = 0.0;
+      break;
+    }
+  }
+  secat->name[0] = '\0';
+  secat->skypos.label[0] = '\0';
+  secat->naper = 0;
+  secat->ma1 = secat->ma2 = secat->ma3 = secat->mtot = secat->miso = -99.0;
+  secat->matchflag[0] = secat->nmatch = 0;
+  secat->matchid[0] = 0;
+}
+
+/*.......................................................................
+ *
+ * Colcat structures
+ *
+ * A Colcat holds the same information as an array of Secat structures,
+ *  but stores each member as a contiguous column.  The aperture columns
+ *  are only allocated when naper > 0 and the source names are kept in a
+ *  single string pool, so a member costs a few hundred bytes instead of
+ *  the ~12 kB of a Secat.
+ * A projected Colcat (see read_colcat_cols in dataio.c) allocates only
+ *  the columns that were asked for.  The others have NULL pointers and
+ *  are skipped by the functions below.
+ *
+ * Functions:
+ *    new_colcat     -   allocates the columns
+ *    new_colcat_cols -  allocates a chosen subset of the columns
+ *    del_colcat     -   frees the columns and the structure
+ *    resize_colcat  -   changes the number of allocated members
+ *    colcat_colinfo -   returns the table describing the scalar columns
+ *    colcat_column  -   returns the column described by a Colinfo entry
+ *    colcat_colmask -   turns a list of column names into a column mask
+ *    colcat_name    -   returns the name of a catalog member
+ *    colcat_setname -   copies a name into the string pool
+ *    colcat_getrow  -   copies one member into a Secat structure
+ *    colcat_setrow  -   copies a Secat structure into one member
+ *    colcat_copyrow -   copies one member between two Colcats
+ *
+ */
+
+#define COLCAT_COL(name,type) \
+  {#name, type, offsetof(Secat,name), offsetof(Colcat,name)}
+#define COLCAT_SKYCOL(name,type) \
+  {#name, type, offsetof(Secat,skypos.name), offsetof(Colcat,name)}
+
+static Colinfo colcat_cols[] = {
+  COLCAT_COL(id,'i'),
+  COLCAT_COL(x,'d'),
+  COLCAT_COL(y,'d'),
+  COLCAT_COL(dx,'d'),
+  COLCAT_COL(dy,'d'),
+  COLCAT_COL(dpos,'d'),
+  COLCAT_COL(dpostheta,'d'),
+  COLCAT_SKYCOL(hr,'i'),
+  COLCAT_SKYCOL(min,'i'),
+  COLCAT_SKYCOL(sec,'d'),
+  COLCAT_SKYCOL(deg,'i'),
+  COLCAT_SKYCOL(amin,'i'),
+  COLCAT_SKYCOL(asec,'d'),
+  COLCAT_COL(alpha,'d'),
+  COLCAT_COL(delta,'d'),
+  COLCAT_COL(miso,'f'),
+  COLCAT_COL(misoerr,'f'),
+  COLCAT_COL(fiso,'f'),
+  COLCAT_COL(fisoerr,'f'),
+  COLCAT_COL(mtot,'f'),
+  COLCAT_COL(merr,'f'),
+  COLCAT_COL(fauto,'f'),
+  COLCAT_COL(fautoerr,'f'),
+  COLCAT_COL(r_kron,'f'),
+  COLCAT_COL(bkgd,'f'),
+  COLCAT_COL(thresh,'f'),
+  COLCAT_COL(muthresh,'f'),
+  COLCAT_COL(isoarea,'f'),
+  COLCAT_COL(ma1,'f'),
+  COLCAT_COL(ma2,'f'),
+  COLCAT_COL(ma3,'f'),
+  COLCAT_COL(ma1err,'f'),
+  COLCAT_COL(ma2err,'f'),
+  COLCAT_COL(ma3err,'f'),
+  COLCAT_COL(fa1,'f'),
+  COLCAT_COL(fa2,'f'),
+  COLCAT_COL(fa3,'f'),
+  COLCAT_COL(fa1err,'f'),
+  COLCAT_COL(fa2err,'f'),
+  COLCAT_COL(fa3err,'f'),
+  COLCAT_COL(a_im,'f'),
+  COLCAT_COL(b_im,'f'),
+  COLCAT_COL(theta,'f'),
+  COLCAT_COL(fwhm,'f'),
+  COLCAT_COL(r2,'f'),
+  COLCAT_COL(r5,'f'),
+  COLCAT_COL(r8,'f'),
+  COLCAT_COL(class,'f'),
+  COLCAT_COL(fitflag,'i'),
+  COLCAT_COL(zspec,'f'),
+  COLCAT_COL(zspecerr,'f')
+};
+
+Colinfo *colcat_colinfo(int *ncols)
+{
+  *ncols = sizeof(colcat_cols) / sizeof(colcat_cols[0]);
+  return colcat_cols;
+}
+
+void *colcat_column(Colcat *colcat, Colinfo *cinfo)
+{
+  return *(void **) ((char *) colcat + cinfo->coloff);
+}
+
+/*.......................................................................
+ *
+ * Function colcat_colmask
+ *
+ * Converts a list of column names, separated by commas or spaces, into a
+ *  mask with one entry per Colinfo column (1 ==> wanted).  The names are
+ *  the Secat member names.  Any of maper, mapererr, faper or fapererr
+ *  selects all four aperture columns, and "name" is accepted but ignored
+ *  because the names are always kept.
+ *
+ * Inputs: char *cols          list of column names
+ *         char *mask          column mask, with room for MAXCOLINFO
+ *                              entries (set by function)
+ *         int *aper           1 if the aperture columns are wanted,
+ *                              0 otherwise (set by function)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> unknown column name
+ *
+ */
+
+int colcat_colmask(char *cols, char *mask, int *aper)
+{
+  int i;              /* Looping variable */
+  int ncols;          /* Number of scalar columns */
+  int len;            /* Length of the current name */
+  char *cptr;         /* Pointer to navigate cols */
+  Colinfo *colinfo;   /* Column descriptions */
+
+  colinfo = colcat_colinfo(&ncols);
+  memset(mask,0,MAXCOLINFO);
+  *aper = 0;
+
+  for(cptr=cols; *cptr; cptr+=len) {
+    if(*cptr == ',' || *cptr == ' ') {
+      len = 1;
+      continue;
+    }
+    len = strcspn(cptr,", ");
+    for(i=0; i<ncols; i++)
+      if(strncmp(cptr,colinfo[i].name,len) == 0 && 
+	 colinfo[i].name[len] == '\0')
+	break;
+    if(i < ncols)
+      mask[i] = 1;
+    else if((len == 5 && strncmp(cptr,"maper",5) == 0) ||
+	    (len == 8 && strncmp(cptr,"mapererr",8) == 0) ||
+	    (len == 5 && strncmp(cptr,"faper",5) == 0) ||
+	    (len == 8 && strncmp(cptr,"fapererr",8) == 0))
+      *aper = 1;
+    else if(!(len == 4 && strncmp(cptr,"name",4) == 0)) {
+      fprintf(stderr,"ERROR: colcat_colmask.  Unknown column %.*s\n",len,
+	      cptr);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Functions new_colcat and new_colcat_cols
+ *
+ * Allocates a Colcat structure with room for size members.  The aperture
+ *  columns are only allocated if naper > 0.  The ncat member is set to
+ *  zero -- it is up to the calling function to fill the columns and set
+ *  ncat.  new_colcat_cols only allocates the scalar columns that are set
+ *  in mask (see colcat_colmask), or all of them if mask is NULL.  The
+ *  ID column is always allocated.
+ *
+ * Input:  int size            number of members to allocate
+ *         int naper           number of apertures per member (0 ==> none)
+ *         char *mask          scalar columns to allocate (new_colcat_cols)
+ *
+ * Output: Colcat *newcat      pointer to the new structure.  NULL if error
+ *
+ */
+
+Colcat *new_colcat(int size, int naper)
+{
+  return new_colcat_cols(size,naper,NULL);
+}
+
+Colcat *new_colcat_cols(int size, int naper, char *mask)
+{
+  int i,j;            /* Looping variables */
+  int ncols;          /* Number of scalar columns */
+  int no_error=1;     /* Flag set to 0 on error */
+  size_t elsize;      /* Size of a column element */
+  void **colptr;      /* Pointer to a column pointer */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+  Colcat *newcat;     /* New structure */
+  float **aptr[4];    /* Aperture columns */
+
+  if(naper < 0 || naper > 100) {
+    fprintf(stderr,"new_colcat: naper = %d is out of range (0-100)\n",naper);
+    return NULL;
+  }
+
+  newcat = (Colcat *) calloc(1,sizeof(Colcat));
+  if(!newcat) {
+    fprintf(stderr,"new_colcat: \n");
+    fprintf(stderr,"Insufficient memory for Colcat structure.\n");
+    return NULL;
+  }
+  if(size < 1)
+    size = 1;
+  newcat->ncat = 0;
+  newcat->nalloc = size;
+  newcat->naper = naper;
+
+  /*
+   * Allocate the scalar columns
+   */
+
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols && no_error; i++,cptr++) {
+    if(mask && !mask[i] && cptr->coloff != offsetof(Colcat,id))
+      continue;
+    colptr = (void **) ((char *) newcat + cptr->coloff);
+    elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    if(!(*colptr = calloc(size,elsize)))
+      no_error = 0;
+  }
+
+  /*
+   * Allocate the aperture columns, if requested
+   */
+
+  if(naper > 0) {
+    aptr[0] = &newcat->maper;
+    aptr[1] = &newcat->mapererr;
+    aptr[2] = &newcat->faper;
+    aptr[3] = &newcat->fapererr;
+    for(j=0; j<4 && no_error; j++)
+      if(!(*aptr[j] = (float *) calloc(size * naper,sizeof(float))))
+	no_error = 0;
+  }
+
+  /*
+   * Allocate the name offsets and an initial string pool
+   */
+
+  if(no_error) {
+    newcat->poolalloc = 16 * size;
+    if(!(newcat->nameoff = (int *) calloc(size,sizeof(int))))
+      no_error = 0;
+    else if(!(newcat->namepool = (char *) malloc(newcat->poolalloc)))
+      no_error = 0;
+    else {
+      newcat->namepool[0] = '\0';
+      newcat->poolsize = 1;
+    }
+  }
+
+  if(!no_error) {
+    fprintf(stderr,"new_colcat: \n");
+    fprintf(stderr,"Insufficient memory for %d-member Colcat.\n",size);
+    return del_colcat(newcat);
+  }
+
+  return newcat;
+}
+
+/*.......................................................................
+ *
+ * Function del_colcat
+ *
+ * Frees up memory allocated to a Colcat structure, or releases the file
+ *  map that holds its columns.
+ *
+ * Input:  Colcat *colcat      structure to be freed
+ *
+ * Output: NULL
+ */
+
+Colcat *del_colcat(Colcat *colcat)
+{
+  int i;              /* Looping variable */
+  int ncols;          /* Number of scalar columns */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+
+  if(colcat && colcat->srcname)
+    free(colcat->srcname);
+  if(colcat && colcat->mapdata) {
+    munmap(colcat->mapdata,colcat->mapsize);
+    free(colcat);
+  }
+  else if(colcat) {
+    for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++)
+      if(colcat_column(colcat,cptr))
+	free(colcat_column(colcat,cptr));
+    if(colcat->maper)
+      free(colcat->maper);
+    if(colcat->mapererr)
+      free(colcat->mapererr);
+    if(colcat->faper)
+      free(colcat->faper);
+    if(colcat->fapererr)
+      free(colcat->fapererr);
+    if(colcat->nameoff)
+      free(colcat->nameoff);
+    if(colcat->namepool)
+      free(colcat->namepool);
+    free(colcat);
+  }
+
+  return NULL;
+}
+
+/*.......................................................................
+ *
+ * Function detach_colcat
+ *
+ * Gives a Colcat whose columns live in a file map (see read_bcat in
+ *  dataio.c) its own allocated copies of the columns, so that it can be
+ *  resized or have names added.  Members can be changed in place without
+ *  this, since the map is private.  Does nothing for a Colcat that
+ *  already owns its columns.
+ *
+ * Inputs: Colcat *colcat      catalog
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+static int detach_colcat(Colcat *colcat)
+{
+  int i,j;            /* Looping variables */
+  int ncols;          /* Number of scalar columns */
+  size_t elsize;      /* Size of a column element */
+  char *newpool;      /* Reallocated pool */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+  Colcat *copy;       /* Allocated copy of colcat */
+  float *afrom[4];    /* Aperture columns of colcat */
+  float *ato[4];      /* Aperture columns of copy */
+
+  if(!colcat->mapdata)
+    return 0;
+
+  if(!(copy = new_colcat(colcat->nalloc,colcat->naper)))
+    return 1;
+  if(colcat->poolsize > copy->poolalloc) {
+    if(!(newpool = (char *) realloc(copy->namepool,colcat->poolsize))) {
+      del_colcat(copy);
+      return 1;
+    }
+    copy->namepool = newpool;
+    copy->poolalloc = colcat->poolsize;
+  }
+
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    memcpy(colcat_column(copy,cptr),colcat_column(colcat,cptr),
+	   colcat->ncat * elsize);
+  }
+  if(colcat->naper > 0) {
+    afrom[0] = colcat->maper;
+    afrom[1] = colcat->mapererr;
+    afrom[2] = colcat->faper;
+    afrom[3] = colcat->fapererr;
+    ato[0] = copy->maper;
+    ato[1] = copy->mapererr;
+    ato[2] = copy->faper;
+    ato[3] = copy->fapererr;
+    for(j=0; j<4; j++)
+      memcpy(ato[j],afrom[j],colcat->ncat * colcat->naper * sizeof(float));
+  }
+  memcpy(copy->nameoff,colcat->nameoff,colcat->ncat * sizeof(int));
+  memcpy(copy->namepool,colcat->namepool,colcat->poolsize);
+  copy->poolsize = colcat->poolsize;
+  copy->ncat = colcat->ncat;
+
+  munmap(colcat->mapdata,colcat->mapsize);
+  *colcat = *copy;
+  free(copy);
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Function resize_colcat
+ *
+ * Changes the number of members allocated in each column of a Colcat.
+ *  Used to grow a catalog while it is being read and to trim it to its
+ *  final size afterwards.  The name pool is not changed.
+ *
+ * Inputs: Colcat *colcat      catalog to resize
+ *         int nalloc          new number of members (must be >= ncat)
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int resize_colcat(Colcat *colcat, int nalloc)
+{
+  int i,j;            /* Looping variables */
+  int ncols;          /* Number of scalar columns */
+  size_t elsize;      /* Size of a column element */
+  void *newcol;       /* Reallocated column */
+  void **colptr;      /* Pointer to a column pointer */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+  float **aptr[4];    /* Aperture columns */
+
+  if(nalloc < colcat->ncat || nalloc < 1) {
+    fprintf(stderr,"ERROR: resize_colcat.  Cannot resize %d-member ",
+	    colcat->ncat);
+    fprintf(stderr,"catalog to %d members.\n",nalloc);
+    return 1;
+  }
+  if(detach_colcat(colcat))
+    return 1;
+
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    colptr = (void **) ((char *) colcat + cptr->coloff);
+    if(!*colptr)
+      continue;
+    elsize = (cptr->type == 'd') ? sizeof(double) : 
+      (cptr->type == 'f' ? sizeof(float) : sizeof(int));
+    if(!(newcol = realloc(*colptr,nalloc * elsize)))
+      return 1;
+    *colptr = newcol;
+  }
+
+  if(colcat->naper > 0) {
+    aptr[0] = &colcat->maper;
+    aptr[1] = &colcat->mapererr;
+    aptr[2] = &colcat->faper;
+    aptr[3] = &colcat->fapererr;
+    for(j=0; j<4; j++) {
+      if(!(newcol = realloc(*aptr[j],nalloc * colcat->naper * sizeof(float))))
+	return 1;
+      *aptr[j] = (float *) newcol;
+    }
+  }
+
+  if(!(newcol = realloc(colcat->nameoff,nalloc * sizeof(int))))
+    return 1;
+  colcat->nameoff = (int *) newcol;
+
+  colcat->nalloc = nalloc;
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Functions colcat_name and colcat_setname
+ *
+ * Access to the source names.  All names live in one string pool, which
+ *  is grown geometrically as needed.  A member whose name has not been
+ *  set points at the empty string at the start of the pool.
+ *
+ * Inputs: Colcat *colcat      catalog
+ *         int index           member index
+ *         char *name          name to copy into the pool (colcat_setname)
+ *
+ * Output: char *name          name of member (colcat_name)
+ *         int (0 or 1)        0 ==> success, 1 ==> error (colcat_setname)
+ *
+ */
+
+char *colcat_name(Colcat *colcat, int index)
+{
+  return colcat->namepool + colcat->nameoff[index];
+}
+
+int colcat_setname(Colcat *colcat, int index, char *name)
+{
+  int len;            /* Length of name, including the terminator */
+  int newalloc;       /* New size of the pool */
+  char *newpool;      /* Reallocated pool */
+
+  if(name[0] == '\0') {
+    colcat->nameoff[index] = 0;
+    return 0;
+  }
+
+  if(detach_colcat(colcat))
+    return 1;
+
+  len = strlen(name) + 1;
+  if(colcat->poolsize + len > colcat->poolalloc) {
+    newalloc = 2 * colcat->poolalloc;
+    while(newalloc < colcat->poolsize + len)
+      newalloc *= 2;
+    if(!(newpool = (char *) realloc(colcat->namepool,newalloc))) {
+      fprintf(stderr,"ERROR: colcat_setname.  Insufficient memory for ");
+      fprintf(stderr,"name pool.\n");
+      return 1;
+    }
+    colcat->namepool = newpool;
+    colcat->poolalloc = newalloc;
+  }
+
+  memcpy(colcat->namepool + colcat->poolsize,name,len);
+  colcat->nameoff[index] = colcat->poolsize;
+  colcat->poolsize += len;
+  return 0;
+}
+
+/*.......................................................................
+ *
+ * Functions colcat_getrow and colcat_setrow
+ *
+ * Copy a single catalog member between a Colcat and a Secat structure.
+ *  These are the adapters for code that still works on Secat structures.
+ *  The matching members of the Secat (nmatch, matchid, etc.) are not
+ *  part of a Colcat and are left untouched by colcat_getrow, as are the
+ *  members whose columns a projected Colcat does not hold.
+ *
+ * Inputs: Colcat *colcat      catalog
+ *         int index           member index
+ *         Secat *secat        single Secat structure
+ *
+ * Output: (none) for colcat_getrow
+ *         int (0 or 1)        0 ==> success, 1 ==> error (colcat_setrow)
+ *
+ */
+
+void colcat_getrow(Colcat *colcat, int index, Secat *secat)
+{
+  int i;              /* Looping variable */
+  int ncols;          /* Number of scalar columns */
+  int naper;          /* Number of apertures */
+  char *base;         /* Byte pointer to secat */
+  void *col;          /* Current column */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+
+  base = (char *) secat;
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    if(!(col = colcat_column(colcat,cptr)))
+      continue;
+    switch(cptr->type) {
+    case 'i':
+      *(int *) (base + cptr->secoff) = ((int *) col)[index];
+      break;
+    case 'f':
+      *(float *) (base + cptr->secoff) = ((float *) col)[index];
+      break;
+    case 'd':
+      *(double *) (base + cptr->secoff) = ((double *) col)[index];
+      break;
+    }
+  }
+
+  naper = secat->naper = colcat->naper;
+  if(naper > 0) {
+    memcpy(secat->maper,colcat->maper + index*naper,naper*sizeof(float));
+    memcpy(secat->mapererr,colcat->mapererr + index*naper,
+	   naper*sizeof(float));
+    memcpy(secat->faper,colcat->faper + index*naper,naper*sizeof(float));
+    memcpy(secat->fapererr,colcat->fapererr + index*naper,
+	   naper*sizeof(float));
+  }
+  strcpy(secat->name,colcat_name(colcat,index));
+}
+
+int colcat_setrow(Colcat *colcat, int index, Secat *secat)
+{
+  int i;              /* Looping variable */
+  int ncols;          /* Number of scalar columns */
+  int naper;          /* Number of apertures */
+  char *base;         /* Byte pointer to secat */
+  void *col;          /* Current column */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+
+  base = (char *) secat;
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    if(!(col = colcat_column(colcat,cptr)))
+      continue;
+    switch(cptr->type) {
+    case 'i':
+      ((int *) col)[index] = *(int *) (base + cptr->secoff);
+      break;
+    case 'f':
+      ((float *) col)[index] = *(float *) (base + cptr->secoff);
+      break;
+    case 'd':
+      ((double *) col)[index] = *(double *) (base + cptr->secoff);
+      break;
+    }
+  }
+
+  naper = colcat->naper;
+  if(naper > 0) {
+    memcpy(colcat->maper + index*naper,secat->maper,naper*sizeof(float));
+    memcpy(colcat->mapererr + index*naper,secat->mapererr,
+	   naper*sizeof(float));
+    memcpy(colcat->faper + index*naper,secat->faper,naper*sizeof(float));
+    memcpy(colcat->fapererr + index*naper,secat->fapererr,
+	   naper*sizeof(float));
+  }
+  return colcat_setname(colcat,index,secat->name);
+}
+
+/*.......................................................................
+ *
+ * Function colcat_copyrow
+ *
+ * Copies one member of a Colcat into a (possibly different) Colcat
+ *  without going through a Secat structure.  If the two catalogs have
+ *  different numbers of apertures, only the apertures common to both
+ *  are copied.  Columns that either catalog does not hold are skipped.
+ *
+ * Inputs: Colcat *from        source catalog
+ *         int ifrom           member index in source catalog
+ *         Colcat *to          destination catalog
+ *         int ito             member index in destination catalog
+ *
+ * Output: int (0 or 1)        0 ==> success, 1 ==> error
+ *
+ */
+
+int colcat_copyrow(Colcat *from, int ifrom, Colcat *to, int ito)
+{
+  int i;              /* Looping variable */
+  int ncols;          /* Number of scalar columns */
+  int naper;          /* Number of apertures to copy */
+  Colinfo *cptr;      /* Pointer to navigate the column descriptions */
+
+  for(i=0,cptr=colcat_colinfo(&ncols); i<ncols; i++,cptr++) {
+    if(!colcat_column(to,cptr) || !colcat_column(from,cptr))
+      continue;
+    switch(cptr->type) {
+    case 'i':
+      ((int *) colcat_column(to,cptr))[ito] = 
+	((int *) colcat_column(from,cptr))[ifrom];
+      break;
+    case 'f':
+      ((float *) colcat_column(to,cptr))[ito] = 
+	((float *) colcat_column(from,cptr))[ifrom];
+      break;
+    case 'd':
+      ((double *) colcat_column(to,cptr))[ito] = 
+	((double *) colcat_column(from,cptr))[ifrom];
+      break;
+    }
+  }
+
+  naper = (from->naper < to->naper) ? from->naper : to->naper;
+  if(naper > 0) {
+    memcpy(to->maper + ito*to->naper,from->maper + ifrom*from->naper,
+	   naper*sizeof(float));
+    memcpy(to->mapererr + ito*to->naper,from->mapererr + ifrom*from->naper,
+	   naper*sizeof(float));
+    memcpy(to->faper + ito*to->naper,from->faper + ifrom*from->naper,
+	   naper*sizeof(float));
+    memcpy(to->fapererr + ito*to->naper,from->fapererr + ifrom*from->naper,
+	   naper*sizeof(float));
+  }
+  return colcat_setname(to,ito,colcat_name(from,ifrom));
+}
+
 /*.......................................................................
  *
  * Function new_sdsscat
@@ -543,7 +1749,7 @@ SDSScat *new_sdsscat(int size)
   SDSScat *newinfo;
   SDSScat *sptr;
  
-  newinfo = (SDSScat *) malloc(sizeof(SDSScat) * size);
+  newinfo = (SDSScat *) arena_malloc(sizeof(SDSScat) * size);
   if(!newinfo) {
     fprintf(stderr,"new_sdsscat: \n");
     fprintf(stderr,"Insufficient memory for SDSScat array.\n");
@@ -575,8 +1781,7 @@ SDSScat *new_sdsscat(int size)
 
 SDSScat *del_sdsscat(SDSScat *sdsscat)
 {
-  if(sdsscat)
-    free(sdsscat);
+  arena_free(sdsscat);
  
   return NULL;
 }
@@ -1,8 +1,14 @@
 #ifndef structdef_h
 #define structdef_h
 
+#include <stdio.h>
+#include <stddef.h>
+
 #define MAXC 1000
+#define MAXMATCH 1000       /* Size of the match lists in a Secat */
 #define PI 3.141592653589793
+#define ARENABLOCK 65536     /* Default size of an Arena block */
+#define ARENAALIGN 16        /* Alignment of memory from an Arena */
 
 /*.......................................................................
  *
@@ -46,6 +52,30 @@ typedef struct {
   char label[MAXC];
 } Skypos;
 
+typedef struct {
+  double x;          /* First coord */
+  double y;          /* Second coord */
+  double xerr;       /* Error on x */
+  double yerr;       /* Error on y */
+  int flag;          /* Flag */
+  int labid;         /* Label index in a Labpool (-1 ==> no label) */
+} Lpos;              /* A Pos without the label buffer (see new_lpos) */
+
+typedef struct {
+  double x;          /* Abscissa (e.g., wavelength or pixel) */
+  double y;          /* Value (e.g., flux) */
+  int flag;          /* Flag (0 ==> good point) */
+} Sample;            /* One point of a spectrum, slice or trace */
+
+typedef struct {
+  int nlab;          /* Number of labels */
+  int nalloc;        /* Number of offsets allocated */
+  int *off;          /* Offset of each label within pool */
+  char *pool;        /* Null-terminated labels, one after the other */
+  int poolsize;      /* Number of bytes of pool in use */
+  int poolalloc;     /* Number of bytes allocated for pool */
+} Labpool;           /* Side table of labels for Lpos arrays */
+
 typedef struct {
   double x;          /* First coord */
   double y;          /* Second coord */
@@ -131,19 +161,90 @@ typedef struct {
   float class;       /* Star/gal classifier (0.0 --> 1.0 (most starlike)) */
   int fitflag;       /* Flag returned by SExtractor */
   int nmatch;        /* Number of matches found */
-  int matchcat[100]; /* Catalog in which the match was found */
-  int matchid[1000]; /* Flag indicating a match has been found */
+  int matchcat[MAXMATCH]; /* Catalog in which the match was found */
+  int matchid[MAXMATCH];  /* Flag indicating a match has been found */
   int matchflag[10]; /* NOT USED ANYMORE*/
-  float sep[1000];   /* Positional separation between catalogs */
+  float sep[MAXMATCH];    /* Positional separation between catalogs */
   float zspec;       /* Redshift of source */
   float zspecerr;    /* Error on redshift */
 } Secat;             /* Structure for SExtractor output info */
 
+typedef struct {
+  int ncat;          /* Number of catalog members */
+  int nalloc;        /* Number of members allocated in each column */
+  int naper;         /* Apertures per member (0 ==> no aperture columns) */
+  int *id;           /* ID number */
+  double *x;         /* First coord */
+  double *y;         /* Second coord */
+  double *dx;        /* x displacement (in arcsec) from lens system */
+  double *dy;        /* y displacement (in arcsec) from lens system */
+  double *dpos;      /* Total displacement from lens system */
+  double *dpostheta; /* For expressing dpos in (r,theta) format */
+  int *hr;           /* RA hours */
+  int *min;          /* RA minutes */
+  double *sec;       /* RA seconds */
+  int *deg;          /* Dec degrees */
+  int *amin;         /* Dec arcminutes */
+  double *asec;      /* Dec arcseconds */
+  double *alpha;     /* RA of object, in decimal degrees */
+  double *delta;     /* Dec of object, in decimal degrees */
+  float *miso;       /* Isophotal magnitude */
+  float *misoerr;    /* Error on isophotal magnitude */
+  float *fiso;       /* Flux in isophotal area */
+  float *fisoerr;    /* Error on isophotal flux */
+  float *mtot;       /* Total magnitude by "auto" method */
+  float *merr;       /* Error on mtot */
+  float *fauto;      /* Flux from "automatic" aperture */
+  float *fautoerr;   /* Error on fauto */
+  float *r_kron;     /* Kron radius */
+  float *bkgd;       /* Background level at centroid */
+  float *thresh;     /* Threshold in counts */
+  float *muthresh;   /* Threshold surface brightness */
+  float *isoarea;    /* Area enclosed by the isophotal region */
+  float *ma1,*ma2,*ma3;          /* Old-style aperture magnitudes */
+  float *ma1err,*ma2err,*ma3err; /* Old-style aperture magnitude errors */
+  float *fa1,*fa2,*fa3;          /* Old-style aperture fluxes */
+  float *fa1err,*fa2err,*fa3err; /* Old-style aperture flux errors */
+  float *a_im;       /* Profile RMS along major axis */
+  float *b_im;       /* Profile RMS along minor axis */
+  float *theta;      /* PA of major axis (math definition) */
+  float *fwhm;       /* FWHM of image */
+  float *r2;         /* Radius enclosing 20% of detected flux */
+  float *r5;         /* Radius enclosing half of detected flux */
+  float *r8;         /* Radius enclosing 80% of detected flux */
+  float *class;      /* Star/gal classifier */
+  int *fitflag;      /* Flag returned by SExtractor */
+  float *zspec;      /* Redshift of source */
+  float *zspecerr;   /* Error on redshift */
+  float *maper;      /* Aperture mags, naper per member (NULL if naper=0) */
+  float *mapererr;   /* Errors on aperture mags (NULL if naper=0) */
+  float *faper;      /* Aperture fluxes (NULL if naper=0) */
+  float *fapererr;   /* Errors on aperture fluxes (NULL if naper=0) */
+  int *nameoff;      /* Offset of each source name within namepool */
+  char *namepool;    /* Pool of null-terminated source names */
+  int poolsize;      /* Number of bytes of namepool in use */
+  int poolalloc;     /* Number of bytes allocated for namepool */
+  char *mapdata;     /* File map holding the columns (NULL if allocated) */
+  size_t mapsize;    /* Size of the file map */
+  char *srcname;     /* Catalog file for loading columns later (or NULL) */
+  char srccomment;   /* Comment character of srcname */
+  int srcformat;     /* Format of srcname */
+} Colcat;            /* Column-ordered (structure of arrays) SExtractor cat */
+
+typedef struct {
+  char *name;        /* Column name (same as the Secat member name) */
+  char type;         /* 'i' ==> int, 'f' ==> float, 'd' ==> double */
+  int secoff;        /* Byte offset of the member within a Secat */
+  int coloff;        /* Byte offset of the column pointer within a Colcat */
+} Colinfo;           /* Description of one scalar Colcat column */
+
+#define MAXCOLINFO 64 /* Upper limit on the number of Colinfo columns */
+
 typedef struct {
   char colname[MAXC]; /* Column name */
   int colnum;         /* Column position */
-  char nelem;         /* Number of elements (e.g., for mag_aper) */
-  char datatype[3];   /* Data type of column (e.g. %f) */
+  int nelem;          /* Number of elements (e.g., for mag_aper) */
+  char datatype[16];  /* Data type of column (e.g. %f, or TFORM such as 3E) */
 } SHeader; /* SExtractor catalog header structure */
 
 typedef struct {
@@ -218,12 +319,52 @@ typedef struct {
   int match;
 } Fluxrec; 
 
+typedef struct Arenablock {
+  struct Arenablock *next;  /* Next older block */
+  size_t size;              /* Usable bytes in the block */
+  size_t used;              /* Bytes handed out from the block */
+  size_t pad;               /* Keeps the data ARENAALIGN-aligned */
+} Arenablock;               /* Header of one block of an Arena */
+
+typedef struct Arena {
+  Arenablock *block;        /* Newest block (the one being used) */
+  Arenablock *spare;        /* Released block kept for reuse */
+  size_t blocksize;         /* Minimum size of a new block */
+  size_t inuse;             /* Bytes handed out and not yet released */
+  size_t peak;              /* Largest value of inuse */
+  size_t nbytes;            /* Total bytes handed out */
+  long nalloc;              /* Number of allocations */
+  long nblock;              /* Number of blocks obtained from malloc */
+  long nrelease;            /* Number of arena_end/arena_reset calls */
+  int nscope;               /* Number of scopes begun and not yet ended */
+  struct Arena *nextopen;   /* Next arena of this thread with open scopes */
+} Arena;                    /* Pointer-bump allocator (see structdef.c) */
+
+typedef struct {
+  Arenablock *block;        /* Newest block when the scope began */
+  size_t used;              /* Bytes used in that block */
+  size_t inuse;             /* Bytes in use in the arena */
+  Arena *prev;              /* Arena that was current before the scope */
+} Arenamark;                /* Start of an arena scope (see arena_begin) */
+
 /*.......................................................................
  *
  * Function declarations
  *
  */
 
+Arena *new_arena(size_t blocksize);
+Arena *del_arena(Arena *arena);
+void *arena_alloc(Arena *arena, size_t size);
+Arenamark arena_begin(Arena *arena);
+void arena_end(Arena *arena, Arenamark mark);
+void arena_reset(Arena *arena);
+int arena_owns(Arena *arena, void *ptr);
+Arena *current_arena();
+void *arena_malloc(size_t size);
+void arena_free(void *ptr);
+void print_arena_stats(Arena *arena, FILE *fp);
+
 char *new_string(int size);
 char *del_string(char *string);
 
@@ -251,6 +392,21 @@ Axisinfo *del_axisinfo(Axisinfo *axisinfo);
 Secat *new_secat(int size);
 Secat *del_secat(Secat *secat);
 
+void init_secat(Secat *secat);
+
+Colcat *new_colcat(int size, int naper);
+Colcat *new_colcat_cols(int size, int naper, char *mask);
+Colcat *del_colcat(Colcat *colcat);
+int resize_colcat(Colcat *colcat, int nalloc);
+Colinfo *colcat_colinfo(int *ncols);
+void *colcat_column(Colcat *colcat, Colinfo *cinfo);
+int colcat_colmask(char *cols, char *mask, int *aper);
+char *colcat_name(Colcat *colcat, int index);
+int colcat_setname(Colcat *colcat, int index, char *name);
+void colcat_getrow(Colcat *colcat, int index, Secat *secat);
+int colcat_setrow(Colcat *colcat, int index, Secat *secat);
+int colcat_copyrow(Colcat *from, int ifrom, Colcat *to, int ito);
+
 SDSScat *new_sdsscat(int size);
 SDSScat *del_sdsscat(SDSScat *sdsscat);
 
@@ -264,6 +420,18 @@ Pos *new_pos(int n1,int n2);
 Pos *del_pos(Pos *pos);
 float **pos2xy(Pos *pos, int npts, int *ngood);
 
+Lpos *new_lpos(int n);
+Lpos *del_lpos(Lpos *lpos);
+
+Sample *new_sample(int n);
+Sample *del_sample(Sample *sample);
+float **sample2xy(Sample *sample, int npts, int *ngood);
+
+Labpool *new_labpool(int nlab);
+Labpool *del_labpool(Labpool *labpool);
+int labpool_add(Labpool *labpool, char *label);
+char *labpool_get(Labpool *labpool, int labid);
+
 Poten *new_poten(int n1, int n2);
 void reinit_poten(Poten *potptr,int n1,int n2);
 Poten *del_poten(Poten *potptr);